@@ -40,6 +40,10 @@ struct Stat
   int64_t scan_open_failed_count = 0;
   int64_t mismatch_count         = 0;
   int64_t scan_other_count       = 0;
+
+  int64_t get_success_count   = 0;
+  int64_t get_not_found_count = 0;
+  int64_t get_other_count     = 0;
 };
 
 class BenchmarkBase : public Fixture
@@ -180,6 +184,21 @@ public:
     }
   }
 
+  void Get(uint32_t value, Stat &stat)
+  {
+    const char *key = reinterpret_cast<const char *>(&value);
+    list<RID>   rids;
+
+    RC rc = handler_.get_entry(key, sizeof(value), rids);
+    if (rc != RC::SUCCESS) {
+      stat.get_other_count++;
+    } else if (rids.empty()) {
+      stat.get_not_found_count++;
+    } else {
+      stat.get_success_count++;
+    }
+  }
+
 protected:
   BufferPoolManager bpm_{512};
   BplusTreeHandler  handler_;
@@ -294,6 +313,46 @@ BENCHMARK_REGISTER_F(ScanBenchmark, Scan)->Threads(10)->Arg(4 * 10000);
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * 点查询走乐观读，查找叶子节点时不在根节点上加锁，吞吐量应该随着线程数增长
+ */
+class PointLookupBenchmark : public BenchmarkBase
+{
+public:
+  string Name() const override { return "point_lookup"; }
+
+  void SetUp(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    BenchmarkBase::SetUp(state);
+
+    uint32_t max = static_cast<uint32_t>(state.range(0)) * 3;
+    ASSERT(max > 0, "invalid argument count. %ld", state.range(0));
+    FillUp(0, max);
+  }
+};
+
+BENCHMARK_DEFINE_F(PointLookupBenchmark, PointLookup)(State &state)
+{
+  IntegerGenerator generator(0, GetRangeMax(state) - 1);
+  Stat             stat;
+
+  for (auto _ : state) {
+    Get(static_cast<uint32_t>(generator.next()), stat);
+  }
+
+  state.counters["success"]   = Counter(stat.get_success_count, Counter::kIsRate);
+  state.counters["not_found"] = Counter(stat.get_not_found_count, Counter::kIsRate);
+  state.counters["other"]     = Counter(stat.get_other_count, Counter::kIsRate);
+}
+
+BENCHMARK_REGISTER_F(PointLookupBenchmark, PointLookup)->ThreadRange(1, 16)->Arg(4 * 10000);
+
+////////////////////////////////////////////////////////////////////////////////
+
 struct MixtureBenchmark : public BenchmarkBase
 {
   string Name() const override { return "mixture"; }
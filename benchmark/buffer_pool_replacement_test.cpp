@@ -0,0 +1,128 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <benchmark/benchmark.h>
+
+#include "common/lang/atomic.h"
+#include "common/lang/memory.h"
+#include "common/lang/random.h"
+#include "common/lang/stdexcept.h"
+#include "common/lang/thread.h"
+#include "common/log/log.h"
+#include "storage/buffer/disk_buffer_pool.h"
+
+using namespace std;
+using namespace common;
+using namespace benchmark;
+
+/**
+ * @brief 对比不同页面置换策略在扫描干扰下的命中率
+ * @details 后台线程不停地顺序扫描一个比内存大很多的文件，模拟全表扫描或者创建索引。
+ * 测试线程在一个能够完全放进内存的热点页面集合中随机访问，模拟B+树上的点查。
+ * 只在页帧管理器上测试，页面不做真正的读写，这样结果只和置换策略有关。
+ * 参数是 FrameReplacerType，计数器 hit_ratio 是点查的命中率。
+ */
+class ReplacementBenchmark : public Fixture
+{
+public:
+  void SetUp(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    LoggerFactory::init_default("buffer_pool_replacement_test.log", LOG_LEVEL_WARN);
+
+    FrameReplacerType type = static_cast<FrameReplacerType>(state.range(0));
+    frame_manager_         = make_unique<BPFrameManager>("ReplacementBenchmark");
+    if (OB_FAIL(frame_manager_->init(POOL_NUM, 0 /*shard_num*/, type))) {
+      throw runtime_error("failed to init frame manager");
+    }
+
+    running_.store(true);
+    scanner_ = thread([this]() {
+      while (running_.load()) {
+        for (PageNum page_num = 0; page_num < SCAN_PAGE_NUM && running_.load(); page_num++) {
+          (void)access(SCAN_BUFFER_POOL_ID, page_num);
+        }
+      }
+    });
+  }
+
+  void TearDown(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    running_.store(false);
+    scanner_.join();
+    frame_manager_->purge_frames(frame_manager_->total_frame_num(), [](Frame *) { return RC::SUCCESS; });
+    frame_manager_->cleanup();
+    frame_manager_.reset();
+  }
+
+  /**
+   * @brief 访问一个页面，页面不在内存中时淘汰一个页面再加载
+   * @return 是否命中
+   */
+  bool access(int buffer_pool_id, PageNum page_num)
+  {
+    Frame *frame = frame_manager_->get(buffer_pool_id, page_num);
+    bool   hit   = frame != nullptr;
+    while (frame == nullptr) {
+      frame = frame_manager_->alloc(buffer_pool_id, page_num);
+      if (frame == nullptr) {
+        frame_manager_->purge_frames(1, [](Frame *) { return RC::SUCCESS; });
+      }
+    }
+    frame->unpin();
+    return hit;
+  }
+
+protected:
+  static constexpr int POOL_NUM            = 4;     /// 一共 4 * 128 个页帧
+  static constexpr int HOT_PAGE_NUM        = 256;   /// 热点页面只占用一半的内存
+  static constexpr int SCAN_PAGE_NUM       = 8192;  /// 扫描的页面是内存的16倍
+  static constexpr int LOOKUP_BUFFER_POOL_ID = 1;
+  static constexpr int SCAN_BUFFER_POOL_ID   = 2;
+
+  unique_ptr<BPFrameManager> frame_manager_;
+  thread                     scanner_;
+  atomic_bool                running_{false};
+};
+
+BENCHMARK_DEFINE_F(ReplacementBenchmark, PointLookupWithScan)(State &state)
+{
+  state.SetLabel(frame_replacer_type_name(static_cast<FrameReplacerType>(state.range(0))));
+
+  mt19937                    random_engine(state.thread_index());
+  uniform_int_distribution<> page_distribution(0, HOT_PAGE_NUM - 1);
+
+  int64_t hit_count = 0;
+  for (auto _ : state) {
+    if (access(LOOKUP_BUFFER_POOL_ID, page_distribution(random_engine))) {
+      hit_count++;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.counters["hit_ratio"] =
+      Counter(static_cast<double>(hit_count) / max<int64_t>(state.iterations(), 1), Counter::kAvgThreads);
+}
+
+BENCHMARK_REGISTER_F(ReplacementBenchmark, PointLookupWithScan)
+    ->ArgName("policy")
+    ->DenseRange(static_cast<int>(FrameReplacerType::LRU), static_cast<int>(FrameReplacerType::TWO_Q))
+    ->Threads(1)
+    ->Threads(4)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
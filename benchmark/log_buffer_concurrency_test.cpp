@@ -0,0 +1,111 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <benchmark/benchmark.h>
+
+#include "common/lang/atomic.h"
+#include "common/lang/filesystem.h"
+#include "common/lang/limits.h"
+#include "common/lang/memory.h"
+#include "common/lang/stdexcept.h"
+#include "common/lang/thread.h"
+#include "common/log/log.h"
+#include "storage/clog/log_buffer.h"
+#include "storage/clog/log_file.h"
+
+using namespace std;
+using namespace common;
+using namespace benchmark;
+
+/**
+ * @brief 多线程并发向日志缓冲区追加日志
+ * @details 后台有一个线程不停地把缓冲区中的日志刷到文件中，文件不做持久化，只测试追加日志的并发性能。
+ * 参数是每条日志的大小。
+ */
+class LogBufferBenchmark : public Fixture
+{
+public:
+  void SetUp(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    LoggerFactory::init_default("log_buffer_concurrency_test.log", LOG_LEVEL_WARN);
+
+    filesystem::remove(filename_);
+    buffer_ = make_unique<LogEntryBuffer>();
+    writer_ = make_unique<LogFileWriter>();
+    if (OB_FAIL(buffer_->init(0)) ||
+        OB_FAIL(writer_->open(filename_, numeric_limits<int>::max(), LogSyncPolicy::NONE))) {
+      throw runtime_error("failed to init log buffer");
+    }
+
+    running_.store(true);
+    flusher_ = thread([this]() {
+      while (running_.load() || buffer_->entry_number() > 0) {
+        int count = 0;
+        if (OB_FAIL(buffer_->flush(*writer_, count))) {
+          break;
+        }
+        if (count == 0) {
+          this_thread::yield();
+        }
+      }
+    });
+  }
+
+  void TearDown(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    running_.store(false);
+    flusher_.join();
+    writer_.reset();
+    buffer_.reset();
+    filesystem::remove(filename_);
+  }
+
+protected:
+  const char                *filename_ = "log_buffer_concurrency_test.clog";
+  unique_ptr<LogEntryBuffer> buffer_;
+  unique_ptr<LogFileWriter>  writer_;
+  thread                     flusher_;
+  atomic_bool                running_{false};
+};
+
+BENCHMARK_DEFINE_F(LogBufferBenchmark, Append)(State &state)
+{
+  const size_t entry_size   = static_cast<size_t>(state.range(0));
+  int64_t      failed_count = 0;
+
+  for (auto _ : state) {
+    LSN          lsn = 0;
+    vector<char> data(entry_size);
+    if (OB_FAIL(buffer_->append(lsn, LogModule::Id::RECORD_MANAGER, std::move(data)))) {
+      failed_count++;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * entry_size);
+  state.counters["failed"] = Counter(failed_count);
+}
+
+BENCHMARK_REGISTER_F(LogBufferBenchmark, Append)
+    ->ArgName("entry_size")
+    ->Arg(64)
+    ->Arg(1024)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,110 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <benchmark/benchmark.h>
+
+#include "common/lang/chrono.h"
+#include "common/lang/filesystem.h"
+#include "common/lang/memory.h"
+#include "common/lang/stdexcept.h"
+#include "common/log/log.h"
+#include "storage/clog/disk_log_handler.h"
+#include "storage/clog/log_replayer.h"
+
+using namespace std;
+using namespace common;
+using namespace benchmark;
+
+class NoopLogReplayer : public LogReplayer
+{
+public:
+  RC replay(const LogEntry &) override { return RC::SUCCESS; }
+};
+
+/**
+ * @brief 对比不同日志持久化策略下的提交延迟和吞吐量
+ * @details 每次迭代模拟一次事务提交：追加一条日志，然后等待这条日志刷新完成。
+ * 参数是 LogSyncPolicy，多个线程并发提交时可以看出组提交的效果。
+ */
+class LogSyncBenchmark : public Fixture
+{
+public:
+  void SetUp(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    LoggerFactory::init_default("log_sync_policy_performance_test.log", LOG_LEVEL_WARN);
+
+    LogSyncPolicy policy = static_cast<LogSyncPolicy>(state.range(0));
+    directory_           = string("log_sync_benchmark_") + log_sync_policy_name(policy);
+    filesystem::remove_all(directory_);
+
+    handler_ = make_unique<DiskLogHandler>();
+
+    NoopLogReplayer replayer;
+    if (OB_FAIL(handler_->init(directory_.c_str())) || OB_FAIL(handler_->replay(replayer, 0))) {
+      throw runtime_error("failed to init log handler");
+    }
+    handler_->set_sync_policy(policy);
+    if (OB_FAIL(handler_->start())) {
+      throw runtime_error("failed to start log handler");
+    }
+  }
+
+  void TearDown(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    handler_->stop();
+    handler_->await_termination();
+    handler_.reset();
+    filesystem::remove_all(directory_);
+  }
+
+protected:
+  unique_ptr<DiskLogHandler> handler_;
+  string                     directory_;
+};
+
+BENCHMARK_DEFINE_F(LogSyncBenchmark, Commit)(State &state)
+{
+  int64_t failed_count = 0;
+  int64_t latency_us   = 0;
+
+  for (auto _ : state) {
+    auto begin = chrono::steady_clock::now();
+
+    LSN          lsn = 0;
+    vector<char> data(100);
+    if (OB_FAIL(handler_->append(lsn, LogModule::Id::TRANSACTION, std::move(data))) ||
+        OB_FAIL(handler_->wait_lsn(lsn))) {
+      failed_count++;
+    }
+
+    latency_us += chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - begin).count();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.counters["latency_us"] = Counter(latency_us, Counter::kAvgIterations);
+  state.counters["failed"]     = Counter(failed_count);
+}
+
+BENCHMARK_REGISTER_F(LogSyncBenchmark, Commit)
+    ->ArgName("policy")
+    ->DenseRange(static_cast<int>(LogSyncPolicy::PER_COMMIT), static_cast<int>(LogSyncPolicy::NONE))
+    ->Threads(1)
+    ->Threads(8)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -15,6 +15,8 @@ See the Mulan PSL v2 for more details. */
 #include <dirent.h>
 #include <iostream>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -367,6 +369,31 @@ int writen(int fd, const void *buf, int size)
   return 0;
 }
 
+int writevn(int fd, struct iovec *iov, int iovcnt)
+{
+  while (iovcnt > 0) {
+    ssize_t ret = ::writev(fd, iov, iovcnt);
+    if (ret < 0) {
+      const int err = errno;
+      if (EAGAIN != err && EINTR != err)
+        return err;
+      continue;
+    }
+
+    // 跳过已经完整写入的数据段，并调整写了一半的数据段
+    while (iovcnt > 0 && ret >= (ssize_t)iov->iov_len) {
+      ret -= iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = (char *)iov->iov_base + ret;
+      iov->iov_len -= ret;
+    }
+  }
+  return 0;
+}
+
 int readn(int fd, void *buf, int size)
 {
   char *tmp = (char *)buf;
@@ -386,4 +413,72 @@ int readn(int fd, void *buf, int size)
   }
   return 0;
 }
+
+static bool is_aligned(const void *buf, int alignment)
+{
+  return alignment <= 0 || reinterpret_cast<uintptr_t>(buf) % alignment == 0;
+}
+
+int pwriten(int fd, const void *buf, int size, off_t offset, int alignment /* = 0 */)
+{
+  if (!is_aligned(buf, alignment)) {
+    void *aligned_buf = nullptr;
+    if (posix_memalign(&aligned_buf, alignment, size) != 0) {
+      return ENOMEM;
+    }
+    memcpy(aligned_buf, buf, size);
+    const int ret = pwriten(fd, aligned_buf, size, offset, alignment);
+    free(aligned_buf);
+    return ret;
+  }
+
+  const char *tmp = (const char *)buf;
+  while (size > 0) {
+    const ssize_t ret = ::pwrite(fd, tmp, size, offset);
+    if (ret >= 0) {
+      tmp += ret;
+      size -= ret;
+      offset += ret;
+      continue;
+    }
+    const int err = errno;
+    if (EAGAIN != err && EINTR != err)
+      return err;
+  }
+  return 0;
+}
+
+int preadn(int fd, void *buf, int size, off_t offset, int alignment /* = 0 */)
+{
+  if (!is_aligned(buf, alignment)) {
+    void *aligned_buf = nullptr;
+    if (posix_memalign(&aligned_buf, alignment, size) != 0) {
+      return ENOMEM;
+    }
+    const int ret = preadn(fd, aligned_buf, size, offset, alignment);
+    if (0 == ret) {
+      memcpy(buf, aligned_buf, size);
+    }
+    free(aligned_buf);
+    return ret;
+  }
+
+  char *tmp = (char *)buf;
+  while (size > 0) {
+    const ssize_t ret = ::pread(fd, tmp, size, offset);
+    if (ret > 0) {
+      tmp += ret;
+      size -= ret;
+      offset += ret;
+      continue;
+    }
+    if (0 == ret)
+      return -1;  // end of file
+
+    const int err = errno;
+    if (EAGAIN != err && EINTR != err)
+      return err;
+  }
+  return 0;
+}
 }  // namespace common
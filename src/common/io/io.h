@@ -14,6 +14,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <sys/types.h>
+#include <sys/uio.h>
 #include <vector>
 
 #include "common/defs.h"
@@ -67,6 +69,17 @@ int getFileSize(const char *filePath, uint64_t &fileLen);
  */
 int writen(int fd, const void *buf, int size);
 
+/**
+ * @brief 使用writev一次性写入多段数据
+ * @details 如果只写入了一部分，会调整iov继续写入剩余的数据，所以调用后iov的内容可能被修改
+ *
+ * @param fd  写入的描述符
+ * @param iov 写入的数据段
+ * @param iovcnt 数据段的个数，不能超过IOV_MAX
+ * @return int 0 表示成功，否则返回errno
+ */
+int writevn(int fd, struct iovec *iov, int iovcnt);
+
 /**
  * @brief 一次性读取指定长度的数据
  *
@@ -77,4 +90,26 @@ int writen(int fd, const void *buf, int size);
  */
 int readn(int fd, void *buf, int size);
 
+/**
+ * @brief 在指定的文件偏移处一次性写入所有数据，不会修改文件偏移
+ * @details 使用 O_DIRECT 打开的文件，内存地址、长度和文件偏移都需要对齐。
+ * alignment 大于0时，如果 buf 没有按照 alignment 对齐，会先复制到一块对齐的内存中再写入。
+ * 长度和文件偏移由调用者保证对齐。
+ *
+ * @param fd  写入的描述符
+ * @param buf 写入的数据
+ * @param size 写入多少数据
+ * @param offset 写入的文件偏移
+ * @param alignment 内存地址的对齐要求，0表示没有要求
+ * @return int 0 表示成功，否则返回errno
+ */
+int pwriten(int fd, const void *buf, int size, off_t offset, int alignment = 0);
+
+/**
+ * @brief 从指定的文件偏移处一次性读取指定长度的数据，不会修改文件偏移
+ * @details 对齐的要求与 pwriten 相同
+ * @return int 返回0表示成功。-1 表示读取到文件尾，并且没有读到size大小数据，其它表示errno
+ */
+int preadn(int fd, void *buf, int size, off_t offset, int alignment = 0);
+
 }  // namespace common
@@ -12,6 +12,10 @@ See the Mulan PSL v2 for more details. */
 
 #include <algorithm>
 
+using std::all_of;
+using std::clamp;
+using std::find;
+using std::find_if;
 using std::max;
 using std::min;
 using std::swap;
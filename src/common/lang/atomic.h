@@ -13,4 +13,7 @@ See the Mulan PSL v2 for more details. */
 #include <atomic>
 
 using std::atomic;
-using std::atomic_bool;
\ No newline at end of file
+using std::atomic_bool;
+using std::memory_order_acquire;
+using std::memory_order_relaxed;
+using std::memory_order_release;
@@ -23,6 +23,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/log/log.h"
 #include "common/lang/algorithm.h"
 #include "common/lang/cmath.h"
+#include "common/lang/limits.h"
 #include "common/lang/iomanip.h"
 
 namespace common {
@@ -229,6 +230,41 @@ char *hex_to_bin(const char *s, char *bin_buff, int *dest_len)
   return bin_buff;
 }
 
+bool str_to_bytes(const string &str, int64_t &bytes)
+{
+  string value(str);
+  strip(value);
+  str_to_upper(value);
+  if (!value.empty() && value.back() == 'B') {
+    value.pop_back();
+  }
+
+  int shift = 0;
+  if (!value.empty()) {
+    switch (value.back()) {
+      case 'K': shift = 10; break;
+      case 'M': shift = 20; break;
+      case 'G': shift = 30; break;
+      case 'T': shift = 40; break;
+      default: break;
+    }
+    if (shift != 0) {
+      value.pop_back();
+    }
+  }
+
+  if (value.empty() || !all_of(value.begin(), value.end(), [](char c) { return isdigit(c); })) {
+    return false;
+  }
+
+  int64_t number = 0;
+  if (!str_to_val(value, number) || number > (numeric_limits<int64_t>::max() >> shift)) {
+    return false;
+  }
+  bytes = number << shift;
+  return true;
+}
+
 bool is_blank(const char *s)
 {
   if (s == nullptr) {
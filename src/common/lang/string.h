@@ -127,6 +127,13 @@ string double_to_str(double v);
 
 bool is_blank(const char *s);
 
+/**
+ * @brief 解析表示内存或文件大小的字符串，比如 "512M"、"16GB"、"4096"
+ * @details 单位不区分大小写，支持 K、M、G、T，可以带B后缀，1K 等于 1024。没有单位时就是字节数
+ * @return 格式不对或者数值溢出时返回false
+ */
+bool str_to_bytes(const string &str, int64_t &bytes);
+
 /**
  * 获取子串
  * 从s中提取下标为n1~n2的字符组成一个新字符串，然后返回这个新串的首地址
@@ -12,4 +12,5 @@ See the Mulan PSL v2 for more details. */
 
 #include <unordered_map>
 
-using std::unordered_map;
\ No newline at end of file
+using std::unordered_map;
+using std::unordered_multimap;
\ No newline at end of file
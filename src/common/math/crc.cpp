@@ -12,6 +12,15 @@ See the Mulan PSL v2 for more details. */
 // Created by Wenbin on 2024/3/25.
 //
 
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+#include "common/math/crc.h"
+
 unsigned int crc_table[] = {0x00000000,
     0x77073096,
     0xEE0E612C,
@@ -276,4 +285,109 @@ unsigned int crc32(const char *buffer, unsigned int size)
     crc = crc_table[(crc ^ buffer[i]) & 0xff] ^ (crc >> 8);
   }
   return crc;
-}
\ No newline at end of file
+}
+////////////////////////////////////////////////////////////////////////////////
+// CRC32C
+namespace {
+
+/// CRC32C 多项式 0x1EDC6F41 的反转形式
+constexpr uint32_t CRC32C_POLY = 0x82F63B78;
+
+/**
+ * @brief slicing-by-8 使用的表
+ * @details table[0] 是普通的逐字节查表，table[k][i] 表示字节 i 后面再跟 k 个0字节时的校验码，
+ * 这样每次可以处理8个字节，8次查表之间没有依赖。
+ */
+struct Crc32cTable
+{
+  uint32_t table[8][256];
+
+  Crc32cTable()
+  {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int j = 0; j < 8; j++) {
+        crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLY : 0);
+      }
+      table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+      for (int k = 1; k < 8; k++) {
+        table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xff];
+      }
+    }
+  }
+};
+
+const Crc32cTable &crc32c_table()
+{
+  static const Crc32cTable table;
+  return table;
+}
+
+uint32_t crc32c_slicing_by_8(const unsigned char *buffer, size_t size, uint32_t crc)
+{
+  const auto &t = crc32c_table().table;
+  while (size >= 8) {
+    uint64_t word;
+    memcpy(&word, buffer, sizeof(word));  // 按照小端处理
+    word ^= crc;
+    crc = t[7][word & 0xff] ^ t[6][(word >> 8) & 0xff] ^ t[5][(word >> 16) & 0xff] ^ t[4][(word >> 24) & 0xff] ^
+          t[3][(word >> 32) & 0xff] ^ t[2][(word >> 40) & 0xff] ^ t[1][(word >> 48) & 0xff] ^ t[0][word >> 56];
+    buffer += 8;
+    size -= 8;
+  }
+  while (size > 0) {
+    crc = t[0][(crc ^ *buffer) & 0xff] ^ (crc >> 8);
+    buffer++;
+    size--;
+  }
+  return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) uint32_t crc32c_sse42(const unsigned char *buffer, size_t size, uint32_t crc)
+{
+  uint64_t crc64 = crc;
+  while (size >= 8) {
+    uint64_t word;
+    memcpy(&word, buffer, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+    buffer += 8;
+    size -= 8;
+  }
+  crc = static_cast<uint32_t>(crc64);
+  while (size > 0) {
+    crc = _mm_crc32_u8(crc, *buffer);
+    buffer++;
+    size--;
+  }
+  return crc;
+}
+#endif
+
+using Crc32cFunction = uint32_t (*)(const unsigned char *, size_t, uint32_t);
+
+Crc32cFunction choose_crc32c_function()
+{
+#if defined(__x86_64__)
+  if (__builtin_cpu_supports("sse4.2")) {
+    return crc32c_sse42;
+  }
+#endif
+  return crc32c_slicing_by_8;
+}
+
+}  // namespace
+
+unsigned int crc32c(const char *buffer, unsigned int size, unsigned int crc /* = 0 */)
+{
+  // 函数内的静态变量，其它文件的静态变量初始化时也可以使用
+  static const Crc32cFunction crc32c_function = choose_crc32c_function();
+  return ~crc32c_function(reinterpret_cast<const unsigned char *>(buffer), size, ~crc);
+}
+
+unsigned int crc32c_software(const char *buffer, unsigned int size, unsigned int crc /* = 0 */)
+{
+  return ~crc32c_slicing_by_8(reinterpret_cast<const unsigned char *>(buffer), size, ~crc);
+}
@@ -16,3 +16,14 @@ See the Mulan PSL v2 for more details. */
 
 /// 计算buffer的crc校验码
 unsigned int crc32(const char *buffer, unsigned int size);
+
+/**
+ * @brief 计算buffer的CRC32C(Castagnoli)校验码
+ * @details 运行时检测CPU，支持SSE4.2时使用crc32指令每次处理8个字节，否则使用slicing-by-8查表法。
+ * 两种方法的结果完全相同。
+ * @param crc 上一段数据的校验码，可以分段计算，第一段传0
+ */
+unsigned int crc32c(const char *buffer, unsigned int size, unsigned int crc = 0);
+
+/// 不使用硬件指令计算CRC32C，测试使用
+unsigned int crc32c_software(const char *buffer, unsigned int size, unsigned int crc = 0);
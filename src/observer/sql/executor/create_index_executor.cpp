@@ -19,6 +19,7 @@ See the Mulan PSL v2 for more details. */
 #include "session/session.h"
 #include "sql/stmt/create_index_stmt.h"
 #include "storage/table/table.h"
+#include "storage/trx/trx.h"
 
 RC CreateIndexExecutor::execute(SQLStageEvent *sql_event)
 {
@@ -30,8 +31,22 @@ RC CreateIndexExecutor::execute(SQLStageEvent *sql_event)
 
   CreateIndexStmt *create_index_stmt = static_cast<CreateIndexStmt *>(stmt);
 
-  Trx   *trx   = session->current_trx();
+  // 建索引时按照事务的可见性扫描数据，需要一个新的事务号，才能看到前面已经提交的数据
+  Trx *trx = session->current_trx();
+  trx->start_if_need();
+
   Table *table = create_index_stmt->table();
   //重定义
-  return table->create_index(trx, create_index_stmt->field_meta(), create_index_stmt->index_name().c_str(), create_index_stmt->index_type());
+  RC rc = table->create_index(trx, create_index_stmt->field_metas(), create_index_stmt->index_name().c_str(), create_index_stmt->index_type());
+
+  if (!session->is_trx_multi_operation_mode()) {
+    RC rc2 = OB_SUCC(rc) ? trx->commit() : trx->rollback();
+    if (OB_FAIL(rc2)) {
+      LOG_WARN("failed to end trx after creating index. rc=%s", strrc(rc2));
+      if (OB_SUCC(rc)) {
+        rc = rc2;
+      }
+    }
+  }
+  return rc;
 }
\ No newline at end of file
@@ -0,0 +1,95 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/executor/show_buffer_pool_executor.h"
+
+#include "common/lang/filesystem.h"
+#include "common/log/log.h"
+#include "event/session_event.h"
+#include "event/sql_event.h"
+#include "session/session.h"
+#include "sql/operator/string_list_physical_operator.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/db/db.h"
+
+using namespace std;
+
+/// 结果中直接输出的计数，READ_TIME_US 换算成了平均读取时间
+static const BufferPoolStatType COUNTER_COLUMNS[] = {
+    BufferPoolStatType::PREFETCH,
+    BufferPoolStatType::EVICT,
+    BufferPoolStatType::PIN_WAIT,
+    BufferPoolStatType::DIRTY_FLUSH,
+    BufferPoolStatType::DBLWR_WRITE,
+    BufferPoolStatType::PAGE_WRITE,
+};
+
+static uint64_t stat_value(const BufferPoolStat::Values &values, BufferPoolStatType type)
+{
+  return values[static_cast<size_t>(type)];
+}
+
+vector<string> ShowBufferPoolExecutor::format_row(const string &name, const BufferPoolStat::Values &values)
+{
+  const uint64_t hits      = stat_value(values, BufferPoolStatType::PAGE_HIT);
+  const uint64_t misses    = stat_value(values, BufferPoolStatType::PAGE_MISS);
+  const uint64_t reads     = stat_value(values, BufferPoolStatType::PAGE_READ);
+  const uint64_t read_time = stat_value(values, BufferPoolStatType::READ_TIME_US);
+
+  char hit_ratio[32]   = "-";
+  char avg_read_us[32] = "-";
+  if (hits + misses > 0) {
+    snprintf(hit_ratio, sizeof(hit_ratio), "%.2f%%", 100.0 * hits / (hits + misses));
+  }
+  if (reads > 0) {
+    snprintf(avg_read_us, sizeof(avg_read_us), "%.2f", static_cast<double>(read_time) / reads);
+  }
+
+  vector<string> row{name, to_string(hits), to_string(misses), hit_ratio, to_string(reads), avg_read_us};
+  for (BufferPoolStatType type : COUNTER_COLUMNS) {
+    row.push_back(to_string(stat_value(values, type)));
+  }
+  return row;
+}
+
+RC ShowBufferPoolExecutor::execute(SQLStageEvent *sql_event)
+{
+  SessionEvent *session_event = sql_event->session_event();
+  SqlResult    *sql_result    = session_event->sql_result();
+  Db           *db            = session_event->session()->get_current_db();
+
+  TupleSchema tuple_schema;
+  for (const char *name : {"File", "Hits", "Misses", "Hit_Ratio", "Reads", "Avg_Read_Us"}) {
+    tuple_schema.append_cell(TupleCellSpec("", name, name));
+  }
+  for (BufferPoolStatType type : COUNTER_COLUMNS) {
+    const char *name = buffer_pool_stat_name(type);
+    tuple_schema.append_cell(TupleCellSpec("", name, name));
+  }
+  sql_result->set_tuple_schema(tuple_schema);
+
+  vector<pair<string, BufferPoolStat::Values>> stats;
+  db->buffer_pool_manager().collect_stats(stats);
+
+  auto                   oper  = new StringListPhysicalOperator;
+  BufferPoolStat::Values total = {};
+  for (const auto &[file_name, values] : stats) {
+    vector<string> row = format_row(filesystem::path(file_name).filename().string(), values);
+    oper->append(row.begin(), row.end());
+    for (size_t i = 0; i < total.size(); i++) {
+      total[i] += values[i];
+    }
+  }
+  vector<string> total_row = format_row("TOTAL", total);
+  oper->append(total_row.begin(), total_row.end());
+
+  sql_result->set_operator(unique_ptr<PhysicalOperator>(oper));
+  return RC::SUCCESS;
+}
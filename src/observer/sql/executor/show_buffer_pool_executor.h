@@ -0,0 +1,38 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "common/sys/rc.h"
+#include "storage/buffer/buffer_pool_stat.h"
+
+class SQLStageEvent;
+
+/**
+ * @brief 显示buffer pool访问统计的执行器
+ * @ingroup Executor
+ * @details 每个打开的buffer pool文件一行，最后一行是所有文件的合计。
+ * 除了原始的计数，还给出了命中率和每个页面的平均读取时间。
+ */
+class ShowBufferPoolExecutor
+{
+public:
+  ShowBufferPoolExecutor()          = default;
+  virtual ~ShowBufferPoolExecutor() = default;
+
+  RC execute(SQLStageEvent *sql_event);
+
+  /**
+   * @brief 把一个文件的统计转换成结果中的一行
+   */
+  static vector<string> format_row(const string &name, const BufferPoolStat::Values &values);
+};
@@ -30,7 +30,12 @@ RC SqlResult::open()
 
   Trx *trx = session_->current_trx();
   trx->start_if_need();
-  return operator_->open(trx);
+  RC rc = operator_->open(trx);
+  if (OB_FAIL(rc)) {
+    // 打开时可能已经修改了一部分数据，比如更新时唯一索引冲突，关闭时需要回滚
+    return_code_ = rc;
+  }
+  return rc;
 }
 
 RC SqlResult::close()
@@ -46,7 +51,7 @@ RC SqlResult::close()
   operator_.reset();
 
   if (session_ && !session_->is_trx_multi_operation_mode()) {
-    if (rc == RC::SUCCESS) {
+    if (rc == RC::SUCCESS && OB_SUCC(return_code_)) {
       rc = session_->current_trx()->commit();
     } else {
       RC rc2 = session_->current_trx()->rollback();
@@ -254,6 +254,40 @@ RC ComparisonExpr::compare_column(const Column &left, const Column &right, vecto
 
   bool left_const  = left.column_type() == Column::Type::CONSTANT_COLUMN;
   bool right_const = right.column_type() == Column::Type::CONSTANT_COLUMN;
+
+  // 表中的字段在数据后面还有一个字节的 null 标记，列中的数据不是紧密排列的，只能逐行比较
+  const bool left_strided  = !left_const && left.attr_len() != static_cast<int>(sizeof(T));
+  const bool right_strided = !right_const && right.attr_len() != static_cast<int>(sizeof(T));
+  if (left_strided || right_strided) {
+    const int n = left_const ? right.count() : left.count();
+    for (int i = 0; i < n; i++) {
+      const char *left_data  = left.data() + (left_const ? 0 : i * left.attr_len());
+      const char *right_data = right.data() + (right_const ? 0 : i * right.attr_len());
+      if ((left_strided && left_data[left.attr_len() - 1] == 1) ||
+          (right_strided && right_data[right.attr_len() - 1] == 1)) {
+        result[i] = 0;  // null 与任何值比较的结果都不为真
+        continue;
+      }
+
+      T left_value;
+      T right_value;
+      memcpy(&left_value, left_data, sizeof(T));
+      memcpy(&right_value, right_data, sizeof(T));
+      bool matched = true;
+      switch (comp_) {
+        case EQUAL_TO: matched = left_value == right_value; break;
+        case NOT_EQUAL: matched = left_value != right_value; break;
+        case LESS_THAN: matched = left_value < right_value; break;
+        case LESS_EQUAL: matched = left_value <= right_value; break;
+        case GREAT_THAN: matched = left_value > right_value; break;
+        case GREAT_EQUAL: matched = left_value >= right_value; break;
+        default: break;
+      }
+      result[i] &= matched ? 1 : 0;
+    }
+    return rc;
+  }
+
   if (left_const && right_const) {
     compare_result<T, true, true>((T *)left.data(), (T *)right.data(), left.count(), result, comp_);
   } else if (left_const && !right_const) {
@@ -0,0 +1,217 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/hash_join_physical_operator.h"
+#include "common/log/log.h"
+
+static string key_name(const Expression &expr)
+{
+  if (expr.type() == ExprType::FIELD) {
+    const auto &field_expr = static_cast<const FieldExpr &>(expr);
+    return string(field_expr.table_name()) + "." + field_expr.field_name();
+  }
+  return expr.name();
+}
+
+size_t HashJoinPhysicalOperator::KeyHash::operator()(const vector<Value> &keys) const
+{
+  size_t hash_val = 0;
+  for (const Value &key : keys) {
+    size_t key_hash = 0;
+    switch (key.attr_type()) {
+      case AttrType::INTS:
+      case AttrType::DATES: key_hash = hash<int>()(key.get_int()); break;
+      case AttrType::FLOATS: key_hash = hash<float>()(key.get_float()); break;
+      default: key_hash = hash<string>()(key.to_string()); break;
+    }
+    hash_val = hash_val * 31 + key_hash;
+  }
+  return hash_val;
+}
+
+bool HashJoinPhysicalOperator::KeyEqual::operator()(const vector<Value> &lhs, const vector<Value> &rhs) const
+{
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    if (lhs[i].compare(rhs[i]) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+HashJoinPhysicalOperator::HashJoinPhysicalOperator(
+    vector<unique_ptr<Expression>> &&left_keys, vector<unique_ptr<Expression>> &&right_keys)
+    : left_keys_(std::move(left_keys)), right_keys_(std::move(right_keys))
+{
+  ASSERT(left_keys_.size() == right_keys_.size(), "join keys should be paired");
+}
+
+RC HashJoinPhysicalOperator::open(Trx *trx)
+{
+  if (children_.size() != 2) {
+    LOG_WARN("hash join operator should have 2 children");
+    return RC::INTERNAL;
+  }
+
+  left_  = children_[0].get();
+  right_ = children_[1].get();
+
+  RC rc = right_->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open right oper. rc=%s", strrc(rc));
+    return rc;
+  }
+  right_closed_ = false;
+
+  rc = build_hash_table();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  // 右表的数据都已经保存下来了，可以提前关闭
+  rc            = right_->close();
+  right_closed_ = true;
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to close right oper. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  matches_ = make_pair(hash_table_.end(), hash_table_.end());
+  return left_->open(trx);
+}
+
+RC HashJoinPhysicalOperator::build_hash_table()
+{
+  right_tuples_.clear();
+  hash_table_.clear();
+
+  RC            rc = RC::SUCCESS;
+  vector<Value> keys;
+  while (RC::SUCCESS == (rc = right_->next())) {
+    Tuple *tuple = right_->current_tuple();
+    if (nullptr == tuple) {
+      LOG_WARN("failed to get tuple from right oper");
+      return RC::INTERNAL;
+    }
+
+    bool has_null = false;
+    rc            = eval_keys(right_keys_, *tuple, keys, has_null);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    if (has_null) {
+      continue;
+    }
+
+    ValueListTuple value_list;
+    rc = ValueListTuple::make(*tuple, value_list);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to copy tuple of right oper. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    hash_table_.emplace(keys, right_tuples_.size());
+    right_tuples_.emplace_back(std::move(value_list));
+  }
+
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to read right oper. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  LOG_TRACE("hash join build hash table done. tuples=%d", right_tuples_.size());
+  return RC::SUCCESS;
+}
+
+RC HashJoinPhysicalOperator::next()
+{
+  RC rc = RC::SUCCESS;
+  while (matches_.first == matches_.second) {
+    rc = left_->next();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    Tuple *left_tuple = left_->current_tuple();
+    bool   has_null   = false;
+    rc                = eval_keys(left_keys_, *left_tuple, probe_keys_, has_null);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    if (has_null) {
+      continue;
+    }
+
+    joined_tuple_.set_left(left_tuple);
+    matches_ = hash_table_.equal_range(probe_keys_);
+  }
+
+  joined_tuple_.set_right(&right_tuples_[matches_.first->second]);
+  ++matches_.first;
+  return rc;
+}
+
+RC HashJoinPhysicalOperator::close()
+{
+  RC rc = left_->close();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to close left oper. rc=%s", strrc(rc));
+  }
+
+  if (!right_closed_) {
+    rc = right_->close();
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to close right oper. rc=%s", strrc(rc));
+    }
+    right_closed_ = true;
+  }
+
+  hash_table_.clear();
+  right_tuples_.clear();
+  matches_ = make_pair(hash_table_.end(), hash_table_.end());
+  return rc;
+}
+
+Tuple *HashJoinPhysicalOperator::current_tuple() { return &joined_tuple_; }
+
+string HashJoinPhysicalOperator::param() const
+{
+  string result;
+  for (size_t i = 0; i < left_keys_.size(); i++) {
+    if (i > 0) {
+      result += " AND ";
+    }
+    result += key_name(*left_keys_[i]);
+    result += "=";
+    result += key_name(*right_keys_[i]);
+  }
+  return result;
+}
+
+RC HashJoinPhysicalOperator::eval_keys(
+    vector<unique_ptr<Expression>> &key_exprs, const Tuple &tuple, vector<Value> &keys, bool &has_null)
+{
+  keys.resize(key_exprs.size());
+  has_null = false;
+  for (size_t i = 0; i < key_exprs.size(); i++) {
+    RC rc = key_exprs[i]->get_value(tuple, keys[i]);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get value of join key. rc=%s", strrc(rc));
+      return rc;
+    }
+    if (keys[i].is_null()) {
+      has_null = true;
+    }
+  }
+  return RC::SUCCESS;
+}
@@ -0,0 +1,77 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/unordered_map.h"
+#include "sql/expr/tuple.h"
+#include "sql/operator/physical_operator.h"
+
+/**
+ * @brief 等值连接的 hash join 算子
+ * @ingroup PhysicalOperator
+ * @details 打开算子时把右表的数据全部读出来，按照连接键构建哈希表，然后依次遍历左表的每一行去哈希表中查找。
+ * 右表的每一行数据只会读取一次，不像 NestedLoopJoin 那样对左表的每一行都要重新扫描右表。
+ * 连接键中有 null 的行不会与任何行匹配。其它的连接条件由上层的 Predicate 算子处理。
+ */
+class HashJoinPhysicalOperator : public PhysicalOperator
+{
+public:
+  /**
+   * @param left_keys  在左表的 tuple 上计算的连接键
+   * @param right_keys 在右表的 tuple 上计算的连接键，与 left_keys 一一对应
+   */
+  HashJoinPhysicalOperator(vector<unique_ptr<Expression>> &&left_keys, vector<unique_ptr<Expression>> &&right_keys);
+  virtual ~HashJoinPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::HASH_JOIN; }
+
+  string param() const override;
+
+  RC     open(Trx *trx) override;
+  RC     next() override;
+  RC     close() override;
+  Tuple *current_tuple() override;
+
+private:
+  struct KeyHash
+  {
+    size_t operator()(const vector<Value> &keys) const;
+  };
+
+  struct KeyEqual
+  {
+    bool operator()(const vector<Value> &lhs, const vector<Value> &rhs) const;
+  };
+
+  using HashTable = unordered_multimap<vector<Value>, size_t, KeyHash, KeyEqual>;
+
+  /**
+   * @brief 计算连接键
+   * @param has_null 连接键中是否有 null
+   */
+  RC eval_keys(vector<unique_ptr<Expression>> &key_exprs, const Tuple &tuple, vector<Value> &keys, bool &has_null);
+  RC build_hash_table();
+
+private:
+  vector<unique_ptr<Expression>> left_keys_;
+  vector<unique_ptr<Expression>> right_keys_;
+
+  PhysicalOperator *left_         = nullptr;
+  PhysicalOperator *right_        = nullptr;
+  bool              right_closed_ = true;  //! 右表算子是否已经关闭
+
+  vector<ValueListTuple> right_tuples_;  //! 右表的所有数据
+  HashTable              hash_table_;    //! 连接键到右表数据下标的映射
+
+  vector<Value>                                  probe_keys_;
+  pair<HashTable::iterator, HashTable::iterator> matches_;  //! 左表当前行在哈希表中匹配的范围
+  JoinedTuple                                    joined_tuple_;
+};
@@ -0,0 +1,468 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/hash_join_vec_physical_operator.h"
+#include "common/lang/string_view.h"
+#include "common/log/log.h"
+
+using namespace std;
+
+namespace {
+
+/**
+ * @brief 取出连接键的有效数据，null 返回空的 data
+ */
+string_view key_value(const Column &column, bool has_null_marker, int row)
+{
+  const int   attr_len = column.attr_len();
+  const char *data     = column.data();
+  if (column.column_type() == Column::Type::NORMAL_COLUMN) {
+    data += static_cast<size_t>(row) * attr_len;
+  }
+
+  int value_len = attr_len;
+  if (has_null_marker) {
+    if (data[attr_len - 1] == 1) {
+      return string_view();
+    }
+    value_len -= 1;
+  }
+
+  if (column.attr_type() == AttrType::CHARS) {
+    value_len = strnlen(data, value_len);
+  }
+  return string_view(data, value_len);
+}
+
+uint64_t hash_bytes(string_view value)
+{
+  if (value.size() == sizeof(uint32_t)) {
+    // 整数、浮点数和日期都是4个字节，用 murmur3 的 fmix64 即可
+    uint32_t v;
+    memcpy(&v, value.data(), sizeof(v));
+    uint64_t h = v;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+  return hash<string_view>()(value);
+}
+
+}  // namespace
+
+HashJoinVecPhysicalOperator::HashJoinVecPhysicalOperator(vector<unique_ptr<Expression>> &&left_keys,
+    vector<unique_ptr<Expression>> &&right_keys, vector<unique_ptr<Expression>> &&predicates)
+    : left_keys_(std::move(left_keys)), right_keys_(std::move(right_keys)), predicates_(std::move(predicates))
+{
+  ASSERT(left_keys_.size() == right_keys_.size(), "join keys should be paired");
+  for (size_t i = 0; i < left_keys_.size(); i++) {
+    left_key_formats_.push_back(KeyFormat{left_keys_[i]->value_type(), left_keys_[i]->type() == ExprType::FIELD});
+    right_key_formats_.push_back(KeyFormat{right_keys_[i]->value_type(), right_keys_[i]->type() == ExprType::FIELD});
+  }
+}
+
+RC HashJoinVecPhysicalOperator::open(Trx *trx)
+{
+  ASSERT(children_.size() == 2, "hash join operator should have 2 children, but got %d", children_.size());
+
+  left_  = children_[0].get();
+  right_ = children_[1].get();
+
+  RC rc = left_->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open left child operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rc = right_->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open right child operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  build_chunks_.clear();
+  build_key_columns_.clear();
+  pending_probe_chunks_.clear();
+  probe_holder_.reset();
+  probe_chunk_ = nullptr;
+  probe_eof_   = false;
+  output_chunk_.reset();
+  filtered_chunk_.reset();
+
+  rc = read_children();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  return build_hash_table();
+}
+
+RC HashJoinVecPhysicalOperator::read_children()
+{
+  // 交替读取左右两侧，先读完的一侧数据量较小，用来构建哈希表
+  vector<unique_ptr<Chunk>> left_chunks;
+  vector<unique_ptr<Chunk>> right_chunks;
+  Chunk                     input;
+
+  RC rc = RC::SUCCESS;
+  while (true) {
+    input.reset();
+    rc = left_->next(input);
+    if (rc == RC::RECORD_EOF) {
+      build_is_left_ = true;
+      break;
+    } else if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get next chunk from left child. rc=%s", strrc(rc));
+      return rc;
+    } else if (input.rows() > 0) {
+      left_chunks.emplace_back(copy_chunk(input));
+    }
+
+    input.reset();
+    rc = right_->next(input);
+    if (rc == RC::RECORD_EOF) {
+      build_is_left_ = false;
+      break;
+    } else if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get next chunk from right child. rc=%s", strrc(rc));
+      return rc;
+    } else if (input.rows() > 0) {
+      right_chunks.emplace_back(copy_chunk(input));
+    }
+  }
+
+  vector<unique_ptr<Chunk>> &probe_chunks = build_is_left_ ? right_chunks : left_chunks;
+  build_chunks_ = std::move(build_is_left_ ? left_chunks : right_chunks);
+  for (unique_ptr<Chunk> &chunk : probe_chunks) {
+    pending_probe_chunks_.emplace_back(std::move(chunk));
+  }
+
+  LOG_TRACE("hash join build side is %s, build chunks=%d, pending probe chunks=%d",
+            build_is_left_ ? "left" : "right", build_chunks_.size(), pending_probe_chunks_.size());
+  return RC::SUCCESS;
+}
+
+RC HashJoinVecPhysicalOperator::build_hash_table()
+{
+  vector<unique_ptr<Expression>> &build_keys    = build_is_left_ ? left_keys_ : right_keys_;
+  const vector<KeyFormat>        &build_formats = build_is_left_ ? left_key_formats_ : right_key_formats_;
+
+  size_t total_rows = 0;
+  for (unique_ptr<Chunk> &chunk : build_chunks_) {
+    total_rows += chunk->rows();
+  }
+
+  // 负载因子不超过0.5，保证探测时一定能遇到空槽位
+  size_t capacity = 16;
+  while (capacity < total_rows * 2) {
+    capacity <<= 1;
+  }
+  slots_.assign(capacity, Slot());
+  slot_mask_ = capacity - 1;
+
+  build_key_columns_.resize(build_chunks_.size());
+  vector<uint64_t> hashes;
+  vector<uint8_t>  valid;
+  for (size_t chunk_idx = 0; chunk_idx < build_chunks_.size(); chunk_idx++) {
+    Chunk &chunk = *build_chunks_[chunk_idx];
+    RC     rc    = eval_keys(build_keys, chunk, build_key_columns_[chunk_idx]);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    hash_keys(build_key_columns_[chunk_idx], build_formats, chunk.rows(), hashes, valid);
+    for (int row = 0; row < chunk.rows(); row++) {
+      if (!valid[row]) {
+        continue;
+      }
+
+      uint64_t pos = hashes[row] & slot_mask_;
+      while (slots_[pos].chunk_idx != -1) {
+        pos = (pos + 1) & slot_mask_;
+      }
+      slots_[pos].hash      = hashes[row];
+      slots_[pos].chunk_idx = static_cast<int32_t>(chunk_idx);
+      slots_[pos].row_idx   = row;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC HashJoinVecPhysicalOperator::next(Chunk &chunk)
+{
+  if (build_chunks_.empty()) {
+    return RC::RECORD_EOF;
+  }
+
+  RC rc = RC::SUCCESS;
+  while (true) {
+    if (probe_chunk_ == nullptr || probe_row_ >= probe_chunk_->rows()) {
+      rc = next_probe_chunk();
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+      continue;
+    }
+
+    probe();
+    gather_output();
+
+    Chunk *result = nullptr;
+    rc            = filter_output(result);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    if (result->rows() > 0) {
+      return chunk.reference(*result);
+    }
+  }
+  return rc;
+}
+
+RC HashJoinVecPhysicalOperator::next_probe_chunk()
+{
+  probe_row_   = 0;
+  slot_pos_    = -1;
+  probe_chunk_ = nullptr;
+  probe_holder_.reset();
+
+  if (!pending_probe_chunks_.empty()) {
+    probe_holder_ = std::move(pending_probe_chunks_.front());
+    pending_probe_chunks_.pop_front();
+    probe_chunk_ = probe_holder_.get();
+  } else {
+    if (probe_eof_) {
+      return RC::RECORD_EOF;
+    }
+
+    PhysicalOperator *probe_child = build_is_left_ ? right_ : left_;
+    probe_input_.reset();
+    RC rc = probe_child->next(probe_input_);
+    if (rc == RC::RECORD_EOF) {
+      probe_eof_ = true;
+      return rc;
+    } else if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get next chunk from probe side. rc=%s", strrc(rc));
+      return rc;
+    }
+    probe_chunk_ = &probe_input_;
+  }
+
+  init_output_chunks();
+
+  vector<unique_ptr<Expression>> &probe_keys = build_is_left_ ? right_keys_ : left_keys_;
+  RC rc = eval_keys(probe_keys, *probe_chunk_, probe_key_columns_);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  hash_keys(probe_key_columns_, build_is_left_ ? right_key_formats_ : left_key_formats_, probe_chunk_->rows(),
+      probe_hashes_, probe_valid_);
+  return RC::SUCCESS;
+}
+
+void HashJoinVecPhysicalOperator::probe()
+{
+  match_probe_rows_.clear();
+  match_build_rows_.clear();
+
+  const int max_rows   = output_chunk_.capacity();
+  const int probe_rows = probe_chunk_->rows();
+  for (; probe_row_ < probe_rows; probe_row_++) {
+    if (!probe_valid_[probe_row_]) {
+      continue;
+    }
+
+    const uint64_t hash = probe_hashes_[probe_row_];
+    if (slot_pos_ == -1) {
+      slot_pos_ = static_cast<int64_t>(hash & slot_mask_);
+    }
+
+    for (; slots_[slot_pos_].chunk_idx != -1; slot_pos_ = (slot_pos_ + 1) & slot_mask_) {
+      if (static_cast<int>(match_probe_rows_.size()) >= max_rows) {
+        // 输出已经满了，下次从当前的行和槽位继续
+        return;
+      }
+
+      const Slot &slot = slots_[slot_pos_];
+      if (slot.hash == hash &&
+          keys_equal(build_key_columns_[slot.chunk_idx], slot.row_idx, probe_key_columns_, probe_row_)) {
+        match_probe_rows_.push_back(probe_row_);
+        match_build_rows_.emplace_back(slot.chunk_idx, slot.row_idx);
+      }
+    }
+    slot_pos_ = -1;
+  }
+}
+
+void HashJoinVecPhysicalOperator::init_output_chunks()
+{
+  if (output_chunk_.column_num() > 0) {
+    return;
+  }
+
+  Chunk &left_chunk  = build_is_left_ ? *build_chunks_.front() : *probe_chunk_;
+  Chunk &right_chunk = build_is_left_ ? *probe_chunk_ : *build_chunks_.front();
+  int    col_idx     = 0;
+  for (Chunk *child_chunk : {&left_chunk, &right_chunk}) {
+    for (int i = 0; i < child_chunk->column_num(); i++, col_idx++) {
+      const Column &column = child_chunk->column(i);
+      output_chunk_.add_column(make_unique<Column>(column.attr_type(), column.attr_len()), col_idx);
+      filtered_chunk_.add_column(make_unique<Column>(column.attr_type(), column.attr_len()), col_idx);
+    }
+  }
+}
+
+void HashJoinVecPhysicalOperator::gather_output()
+{
+  output_chunk_.reset_data();
+
+  // 按列复制匹配上的数据，左侧的列在前
+  const int left_column_num = build_is_left_ ? build_chunks_.front()->column_num() : probe_chunk_->column_num();
+  const int match_num       = static_cast<int>(match_probe_rows_.size());
+  for (int col_idx = 0; col_idx < output_chunk_.column_num(); col_idx++) {
+    Column    &output      = output_chunk_.column(col_idx);
+    const bool from_left   = col_idx < left_column_num;
+    const int  child_col   = from_left ? col_idx : col_idx - left_column_num;
+    const bool from_build  = (from_left == build_is_left_);
+    const int  attr_len    = output.attr_len();
+    for (int i = 0; i < match_num; i++) {
+      const Column *input = nullptr;
+      int           row   = 0;
+      if (from_build) {
+        input = &build_chunks_[match_build_rows_[i].first]->column(child_col);
+        row   = match_build_rows_[i].second;
+      } else {
+        input = &probe_chunk_->column(child_col);
+        row   = match_probe_rows_[i];
+      }
+      output.append_one(input->data() + static_cast<size_t>(row) * attr_len);
+    }
+  }
+}
+
+RC HashJoinVecPhysicalOperator::filter_output(Chunk *&result)
+{
+  result = &output_chunk_;
+  if (predicates_.empty() || output_chunk_.rows() == 0) {
+    return RC::SUCCESS;
+  }
+
+  select_.assign(output_chunk_.rows(), 1);
+  for (unique_ptr<Expression> &predicate : predicates_) {
+    RC rc = predicate->eval(output_chunk_, select_);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to eval join predicate. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  filtered_chunk_.reset_data();
+  for (int col_idx = 0; col_idx < output_chunk_.column_num(); col_idx++) {
+    Column &input    = output_chunk_.column(col_idx);
+    Column &output   = filtered_chunk_.column(col_idx);
+    const int attr_len = input.attr_len();
+    for (int row = 0; row < input.count(); row++) {
+      if (select_[row]) {
+        output.append_one(input.data() + static_cast<size_t>(row) * attr_len);
+      }
+    }
+  }
+  result = &filtered_chunk_;
+  return RC::SUCCESS;
+}
+
+RC HashJoinVecPhysicalOperator::eval_keys(
+    vector<unique_ptr<Expression>> &key_exprs, Chunk &chunk, vector<unique_ptr<Column>> &key_columns)
+{
+  key_columns.clear();
+  for (unique_ptr<Expression> &key_expr : key_exprs) {
+    auto column = make_unique<Column>();
+    RC   rc     = key_expr->get_column(chunk, *column);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get column of join key. expr=%s, rc=%s", key_expr->name(), strrc(rc));
+      return rc;
+    }
+    key_columns.emplace_back(std::move(column));
+  }
+  return RC::SUCCESS;
+}
+
+void HashJoinVecPhysicalOperator::hash_keys(const vector<unique_ptr<Column>> &key_columns,
+    const vector<KeyFormat> &formats, int rows, vector<uint64_t> &hashes, vector<uint8_t> &valid) const
+{
+  hashes.assign(rows, 0);
+  valid.assign(rows, 1);
+  for (size_t key_idx = 0; key_idx < key_columns.size(); key_idx++) {
+    const Column &column          = *key_columns[key_idx];
+    const bool    has_null_marker = formats[key_idx].has_null_marker;
+    for (int row = 0; row < rows; row++) {
+      string_view value = key_value(column, has_null_marker, row);
+      if (value.data() == nullptr) {
+        valid[row] = 0;
+        continue;
+      }
+      hashes[row] = hashes[row] * 31 + hash_bytes(value);
+    }
+  }
+}
+
+bool HashJoinVecPhysicalOperator::keys_equal(const vector<unique_ptr<Column>> &build_columns, int build_row,
+    const vector<unique_ptr<Column>> &probe_columns, int probe_row) const
+{
+  const vector<KeyFormat> &build_formats = build_is_left_ ? left_key_formats_ : right_key_formats_;
+  const vector<KeyFormat> &probe_formats = build_is_left_ ? right_key_formats_ : left_key_formats_;
+  for (size_t key_idx = 0; key_idx < build_columns.size(); key_idx++) {
+    string_view build_value = key_value(*build_columns[key_idx], build_formats[key_idx].has_null_marker, build_row);
+    string_view probe_value = key_value(*probe_columns[key_idx], probe_formats[key_idx].has_null_marker, probe_row);
+    if (build_value != probe_value) {
+      return false;
+    }
+  }
+  return true;
+}
+
+unique_ptr<Chunk> HashJoinVecPhysicalOperator::copy_chunk(Chunk &chunk)
+{
+  auto copied = make_unique<Chunk>();
+  for (int i = 0; i < chunk.column_num(); i++) {
+    Column &column = chunk.column(i);
+    ASSERT(column.column_type() == Column::Type::NORMAL_COLUMN, "constant column is not supported in hash join");
+    auto copied_column = make_unique<Column>(column.attr_type(), column.attr_len(), max(column.count(), 1));
+    copied_column->append(column.data(), column.count());
+    copied->add_column(std::move(copied_column), chunk.column_ids(i));
+  }
+  return copied;
+}
+
+RC HashJoinVecPhysicalOperator::close()
+{
+  build_chunks_.clear();
+  build_key_columns_.clear();
+  slots_.clear();
+  pending_probe_chunks_.clear();
+  probe_holder_.reset();
+  probe_chunk_ = nullptr;
+  probe_key_columns_.clear();
+
+  RC rc = RC::SUCCESS;
+  for (unique_ptr<PhysicalOperator> &child : children_) {
+    RC child_rc = child->close();
+    if (OB_FAIL(child_rc)) {
+      LOG_WARN("failed to close child operator. rc=%s", strrc(child_rc));
+      rc = child_rc;
+    }
+  }
+  return rc;
+}
@@ -0,0 +1,110 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/deque.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/physical_operator.h"
+
+/**
+ * @brief 两表等值连接的 hash join 算子(vectorized)
+ * @ingroup PhysicalOperator
+ * @details 打开算子时交替读取左右两个子算子，先读完的一侧就是较小的一侧，用它来构建哈希表，
+ * 另一侧已经读出来的数据缓存起来，作为最先探测的数据。
+ * 哈希表使用开放地址法（线性探测），槽位中只保存哈希值和记录所在的位置，数据仍按列保存在 chunk 中。
+ * 探测时按批计算一个 chunk 中所有记录的哈希值，再逐行探测。
+ * 输出的 chunk 中先是左表的列，再是右表的列。连接键中的 null 不会与任何值相等。
+ * 没有连接键时退化为笛卡尔积，其它的连接条件在输出之前按批过滤。
+ */
+class HashJoinVecPhysicalOperator : public PhysicalOperator
+{
+public:
+  /**
+   * @param left_keys  在左侧子算子输出的 chunk 上计算的连接键
+   * @param right_keys 在右侧子算子输出的 chunk 上计算的连接键，与 left_keys 一一对应
+   * @param predicates 其它的连接条件，在连接后的 chunk 上计算
+   */
+  HashJoinVecPhysicalOperator(vector<unique_ptr<Expression>> &&left_keys, vector<unique_ptr<Expression>> &&right_keys,
+      vector<unique_ptr<Expression>> &&predicates);
+
+  virtual ~HashJoinVecPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::HASH_JOIN_VEC; }
+
+  RC open(Trx *trx) override;
+  RC next(Chunk &chunk) override;
+  RC close() override;
+
+private:
+  /// 哈希表中的一个槽位，chunk_idx 为 -1 表示空槽位
+  struct Slot
+  {
+    uint64_t hash      = 0;
+    int32_t  chunk_idx = -1;
+    int32_t  row_idx   = -1;
+  };
+
+  /// 连接键的存储格式。表中的字段在数据后面还有一个字节的 null 标记
+  struct KeyFormat
+  {
+    AttrType type;
+    bool     has_null_marker;
+  };
+
+  RC   read_children();
+  RC   build_hash_table();
+  RC   next_probe_chunk();
+  void probe();
+  void init_output_chunks();
+  void gather_output();
+  RC   filter_output(Chunk *&result);
+
+  RC   eval_keys(vector<unique_ptr<Expression>> &key_exprs, Chunk &chunk, vector<unique_ptr<Column>> &key_columns);
+  void hash_keys(const vector<unique_ptr<Column>> &key_columns, const vector<KeyFormat> &formats, int rows,
+      vector<uint64_t> &hashes, vector<uint8_t> &valid) const;
+  bool keys_equal(const vector<unique_ptr<Column>> &build_columns, int build_row,
+      const vector<unique_ptr<Column>> &probe_columns, int probe_row) const;
+
+  static unique_ptr<Chunk> copy_chunk(Chunk &chunk);
+
+private:
+  vector<unique_ptr<Expression>> left_keys_;
+  vector<unique_ptr<Expression>> right_keys_;
+  vector<unique_ptr<Expression>> predicates_;
+  vector<KeyFormat>              left_key_formats_;
+  vector<KeyFormat>              right_key_formats_;
+
+  PhysicalOperator *left_          = nullptr;
+  PhysicalOperator *right_         = nullptr;
+  bool              build_is_left_ = false;  ///< 是否用左侧的数据构建哈希表
+  bool              probe_eof_     = false;  ///< 探测侧的子算子是否已经读完
+
+  vector<unique_ptr<Chunk>>          build_chunks_;       ///< 构建侧的所有数据
+  vector<vector<unique_ptr<Column>>> build_key_columns_;  ///< 构建侧每个 chunk 对应的连接键
+  vector<Slot>                       slots_;
+  uint64_t                           slot_mask_ = 0;
+
+  deque<unique_ptr<Chunk>>   pending_probe_chunks_;  ///< 确定构建侧时已经从探测侧读出来的数据
+  unique_ptr<Chunk>          probe_holder_;          ///< 持有从 pending_probe_chunks_ 中取出的数据
+  Chunk                      probe_input_;           ///< 从探测侧子算子直接读取的数据
+  Chunk                     *probe_chunk_ = nullptr; ///< 当前正在探测的数据
+  vector<unique_ptr<Column>> probe_key_columns_;
+  vector<uint64_t>           probe_hashes_;
+  vector<uint8_t>            probe_valid_;
+  int                        probe_row_ = 0;   ///< 当前探测到第几行
+  int64_t                    slot_pos_  = -1;  ///< 当前行探测到哪个槽位，-1表示还没有开始
+
+  vector<int>                    match_probe_rows_;  ///< 本批匹配上的探测侧的行
+  vector<pair<int32_t, int32_t>> match_build_rows_;  ///< 本批匹配上的构建侧的 chunk 和行
+  Chunk                          output_chunk_;
+  Chunk                          filtered_chunk_;
+  vector<uint8_t>                select_;
+};
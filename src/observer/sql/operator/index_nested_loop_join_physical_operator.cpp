@@ -0,0 +1,124 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/index_nested_loop_join_physical_operator.h"
+#include "common/log/log.h"
+#include "storage/index/index.h"
+#include "storage/table/table.h"
+
+IndexNestedLoopJoinPhysicalOperator::IndexNestedLoopJoinPhysicalOperator(unique_ptr<Expression> left_key)
+    : left_key_(std::move(left_key))
+{}
+
+RC IndexNestedLoopJoinPhysicalOperator::open(Trx *trx)
+{
+  if (children_.size() != 2 || children_[1]->type() != PhysicalOperatorType::INDEX_SCAN) {
+    LOG_WARN("index nested loop join operator should have 2 children and the right one should be index scan");
+    return RC::INTERNAL;
+  }
+
+  left_         = children_[0].get();
+  right_        = static_cast<IndexScanPhysicalOperator *>(children_[1].get());
+  right_closed_ = true;
+  trx_          = trx;
+  return left_->open(trx);
+}
+
+RC IndexNestedLoopJoinPhysicalOperator::next()
+{
+  RC rc = RC::SUCCESS;
+  while (true) {
+    if (!right_closed_) {
+      rc = right_->next();
+      if (rc == RC::SUCCESS) {
+        joined_tuple_.set_right(right_->current_tuple());
+        return rc;
+      } else if (rc != RC::RECORD_EOF) {
+        return rc;
+      }
+    }
+
+    rc = left_next();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return rc;
+}
+
+RC IndexNestedLoopJoinPhysicalOperator::left_next()
+{
+  RC rc = RC::SUCCESS;
+  if (!right_closed_) {
+    rc            = right_->close();
+    right_closed_ = true;
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to close right oper. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  while (RC::SUCCESS == (rc = left_->next())) {
+    Tuple *left_tuple = left_->current_tuple();
+    rc                = left_key_->get_value(*left_tuple, key_value_);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get value of join key. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    // null 不与任何值相等
+    if (key_value_.is_null()) {
+      continue;
+    }
+
+    joined_tuple_.set_left(left_tuple);
+    right_->set_scan_range(&key_value_, true /*left_inclusive*/, &key_value_, true /*right_inclusive*/);
+    rc = right_->open(trx_);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to open right oper. rc=%s", strrc(rc));
+      return rc;
+    }
+    right_closed_ = false;
+    return rc;
+  }
+  return rc;
+}
+
+RC IndexNestedLoopJoinPhysicalOperator::close()
+{
+  RC rc = left_->close();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to close left oper. rc=%s", strrc(rc));
+  }
+
+  if (!right_closed_) {
+    rc = right_->close();
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to close right oper. rc=%s", strrc(rc));
+    }
+    right_closed_ = true;
+  }
+  return rc;
+}
+
+Tuple *IndexNestedLoopJoinPhysicalOperator::current_tuple() { return &joined_tuple_; }
+
+string IndexNestedLoopJoinPhysicalOperator::param() const
+{
+  string key_name = left_key_->name();
+  if (left_key_->type() == ExprType::FIELD) {
+    const auto &field_expr = static_cast<const FieldExpr &>(*left_key_);
+    key_name               = string(field_expr.table_name()) + "." + field_expr.field_name();
+  }
+
+  // explain 时算子还没有打开，只能从 children_ 中取右表
+  auto *index_scan = static_cast<IndexScanPhysicalOperator *>(children_[1].get());
+  return key_name + "=" + index_scan->table()->name() + "." + index_scan->index()->index_meta().field();
+}
@@ -0,0 +1,54 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "sql/expr/tuple.h"
+#include "sql/operator/index_scan_physical_operator.h"
+
+/**
+ * @brief 使用右表索引的 nested loop join 算子
+ * @ingroup PhysicalOperator
+ * @details 依次遍历左表的每一行，计算出连接键的值，然后用这个值在右表的索引上做一次等值查找，
+ * 而不是像 NestedLoopJoin 那样把右表全部扫描一遍。
+ * 右侧的子算子必须是建立在连接字段索引上的 IndexScan 算子。其它的连接条件由上层的 Predicate 算子处理。
+ */
+class IndexNestedLoopJoinPhysicalOperator : public PhysicalOperator
+{
+public:
+  /**
+   * @param left_key 在左表的 tuple 上计算的连接键，类型与右表的索引字段相同
+   */
+  IndexNestedLoopJoinPhysicalOperator(unique_ptr<Expression> left_key);
+  virtual ~IndexNestedLoopJoinPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::INDEX_NESTED_LOOP_JOIN; }
+
+  string param() const override;
+
+  RC     open(Trx *trx) override;
+  RC     next() override;
+  RC     close() override;
+  Tuple *current_tuple() override;
+
+private:
+  RC left_next();  //! 左表遍历下一条数据，并用它的连接键重新打开右表的索引扫描
+
+private:
+  Trx *trx_ = nullptr;
+
+  unique_ptr<Expression> left_key_;
+  Value                  key_value_;
+
+  PhysicalOperator          *left_         = nullptr;
+  IndexScanPhysicalOperator *right_        = nullptr;
+  bool                       right_closed_ = true;  //! 右表算子是否已经关闭
+  JoinedTuple                joined_tuple_;
+};
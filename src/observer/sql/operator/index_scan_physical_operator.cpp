@@ -13,23 +13,46 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "sql/operator/index_scan_physical_operator.h"
+#include "common/lang/algorithm.h"
 #include "storage/index/index.h"
 #include "storage/trx/trx.h"
 
 IndexScanPhysicalOperator::IndexScanPhysicalOperator(Table *table, Index *index, ReadWriteMode mode, const Value *left_value,
     bool left_inclusive, const Value *right_value, bool right_inclusive)
-    : table_(table),
-      index_(index),
-      mode_(mode),
-      left_inclusive_(left_inclusive),
-      right_inclusive_(right_inclusive)
+    : table_(table), index_(index), mode_(mode)
 {
-  if (left_value) {
-    left_value_ = *left_value;
+  set_scan_range(left_value, left_inclusive, right_value, right_inclusive);
+}
+
+IndexScanPhysicalOperator::IndexScanPhysicalOperator(Table *table, Index *index, ReadWriteMode mode,
+    const vector<Value> &left_values, bool left_inclusive, const vector<Value> &right_values, bool right_inclusive)
+    : table_(table), index_(index), mode_(mode)
+{
+  set_scan_range(left_values, left_inclusive, right_values, right_inclusive);
+}
+
+void IndexScanPhysicalOperator::set_scan_range(
+    const Value *left_value, bool left_inclusive, const Value *right_value, bool right_inclusive)
+{
+  left_values_.clear();
+  right_values_.clear();
+  if (left_value != nullptr) {
+    left_values_.push_back(*left_value);
   }
-  if (right_value) {
-    right_value_ = *right_value;
+  if (right_value != nullptr) {
+    right_values_.push_back(*right_value);
   }
+  left_inclusive_  = left_inclusive;
+  right_inclusive_ = right_inclusive;
+}
+
+void IndexScanPhysicalOperator::set_scan_range(
+    const vector<Value> &left_values, bool left_inclusive, const vector<Value> &right_values, bool right_inclusive)
+{
+  left_values_     = left_values;
+  right_values_    = right_values;
+  left_inclusive_  = left_inclusive;
+  right_inclusive_ = right_inclusive;
 }
 
 RC IndexScanPhysicalOperator::open(Trx *trx)
@@ -38,12 +61,43 @@ RC IndexScanPhysicalOperator::open(Trx *trx)
     return RC::INTERNAL;
   }
 
-  IndexScanner *index_scanner = index_->create_scanner(left_value_.data(),
-      left_value_.length(),
-      left_inclusive_,
-      right_value_.data(),
-      right_value_.length(),
-      right_inclusive_);
+  trx_ = trx;
+  tuple_.set_schema(table_, table_->table_meta().field_metas());
+
+  // 多个条件取交集后可能是一个空的范围，B+树不接受这样的范围
+  empty_range_   = false;
+  unique_lookup_ = false;
+  unique_found_  = false;
+  if (!left_values_.empty() && !right_values_.empty()) {
+    int result = 0;
+    for (size_t i = 0; i < min(left_values_.size(), right_values_.size()) && result == 0; i++) {
+      result = left_values_[i].compare(right_values_[i]);
+    }
+    if (result > 0 ||
+        (result == 0 && left_values_.size() == right_values_.size() && !(left_inclusive_ && right_inclusive_))) {
+      empty_range_ = true;
+      return RC::SUCCESS;
+    }
+
+    // 唯一索引的所有字段都是等值条件，一个事务最多只能看到一条记录
+    unique_lookup_ = result == 0 && index_->index_meta().type() == IndexMeta::IndexType::INDEX_TYPE_UNIQUE &&
+                     left_values_.size() == index_->field_metas().size() &&
+                     right_values_.size() == left_values_.size();
+  }
+
+  vector<char> left_buffer;
+  vector<char> right_buffer;
+  const char  *left_key        = nullptr;
+  const char  *right_key       = nullptr;
+  int          left_len        = 0;
+  int          right_len       = 0;
+  bool         left_inclusive  = left_inclusive_;
+  bool         right_inclusive = right_inclusive_;
+  make_key(left_values_, true /*is_left*/, left_inclusive, left_buffer, left_key, left_len);
+  make_key(right_values_, false /*is_left*/, right_inclusive, right_buffer, right_key, right_len);
+
+  IndexScanner *index_scanner =
+      index_->create_scanner(left_key, left_len, left_inclusive, right_key, right_len, right_inclusive);
   if (nullptr == index_scanner) {
     LOG_WARN("failed to create index scanner");
     return RC::INTERNAL;
@@ -56,10 +110,6 @@ RC IndexScanPhysicalOperator::open(Trx *trx)
     return RC::INTERNAL;
   }
   index_scanner_ = index_scanner;
-
-  tuple_.set_schema(table_, table_->table_meta().field_metas());
-
-  trx_ = trx;
   return RC::SUCCESS;
 }
 
@@ -68,6 +118,10 @@ RC IndexScanPhysicalOperator::next()
   RID rid;
   RC  rc = RC::SUCCESS;
 
+  if (empty_range_ || unique_found_) {
+    return RC::RECORD_EOF;
+  }
+
   bool filter_result = false;
   while (RC::SUCCESS == (rc = index_scanner_->next_entry(&rid))) {
     rc = record_handler_->get_record(rid, current_record_);
@@ -94,9 +148,11 @@ RC IndexScanPhysicalOperator::next()
     if (rc == RC::RECORD_INVISIBLE) {
       LOG_TRACE("record invisible");
       continue;
-    } else {
-      return rc;
     }
+
+    // 唯一索引的等值查询找到一条以后就结束，不再扫描相同属性值的其它索引项
+    unique_found_ = unique_lookup_ && OB_SUCC(rc);
+    return rc;
   }
 
   return rc;
@@ -104,8 +160,10 @@ RC IndexScanPhysicalOperator::next()
 
 RC IndexScanPhysicalOperator::close()
 {
-  index_scanner_->destroy();
-  index_scanner_ = nullptr;
+  if (index_scanner_ != nullptr) {
+    index_scanner_->destroy();
+    index_scanner_ = nullptr;
+  }
   return RC::SUCCESS;
 }
 
@@ -141,6 +199,41 @@ RC IndexScanPhysicalOperator::filter(RowTuple &tuple, bool &result)
   return rc;
 }
 
+void IndexScanPhysicalOperator::make_key(const vector<Value> &values, bool is_left, bool &inclusive,
+    vector<char> &buffer, const char *&key, int &key_len) const
+{
+  key     = nullptr;
+  key_len = 0;
+  if (values.empty()) {
+    return;
+  }
+
+  const vector<FieldMeta> &field_metas = index_->field_metas();
+  if (field_metas.size() == 1) {
+    key     = values[0].data();
+    key_len = values[0].length();
+    return;
+  }
+
+  buffer.clear();
+  for (size_t i = 0; i < values.size() && i < field_metas.size(); i++) {
+    const Value &value      = values[i];
+    const int    column_len = field_metas[i].len() - 1;  // -1 for null marker
+    const size_t offset     = buffer.size();
+    buffer.resize(offset + column_len, 0);
+    memcpy(buffer.data() + offset, value.data(), min(value.length(), column_len));
+
+    // 字段中存放的字符串都比这个值小或者是它的前缀，后面的字段不需要再比较了
+    if (value.attr_type() == AttrType::CHARS && value.length() > column_len) {
+      inclusive = !is_left;
+      break;
+    }
+  }
+
+  key     = buffer.data();
+  key_len = static_cast<int>(buffer.size());
+}
+
 string IndexScanPhysicalOperator::param() const
 {
   return string(index_->index_meta().name()) + " ON " + table_->name();
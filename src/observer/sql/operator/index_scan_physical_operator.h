@@ -28,6 +28,13 @@ public:
   IndexScanPhysicalOperator(Table *table, Index *index, ReadWriteMode mode, const Value *left_value,
       bool left_inclusive, const Value *right_value, bool right_inclusive);
 
+  /**
+   * @brief 组合索引按照最左前缀扫描
+   * @details 边界是索引前面若干个字段的值，没有给出的字段不限制。值为空时表示这一边没有边界
+   */
+  IndexScanPhysicalOperator(Table *table, Index *index, ReadWriteMode mode, const vector<Value> &left_values,
+      bool left_inclusive, const vector<Value> &right_values, bool right_inclusive);
+
   virtual ~IndexScanPhysicalOperator() = default;
 
   PhysicalOperatorType type() const override { return PhysicalOperatorType::INDEX_SCAN; }
@@ -42,10 +49,29 @@ public:
 
   void set_predicates(vector<unique_ptr<Expression>> &&exprs);
 
+  /**
+   * @brief 重新设置扫描的范围，下次 open 时生效
+   * @details IndexNestedLoopJoin 对左表的每一行都会用新的值重新扫描一次索引
+   */
+  void set_scan_range(const Value *left_value, bool left_inclusive, const Value *right_value, bool right_inclusive);
+  void set_scan_range(
+      const vector<Value> &left_values, bool left_inclusive, const vector<Value> &right_values, bool right_inclusive);
+
+  Table *table() const { return table_; }
+  Index *index() const { return index_; }
+
 private:
   // 与TableScanPhysicalOperator代码相同，可以优化
   RC filter(RowTuple &tuple, bool &result);
 
+  /**
+   * @brief 把边界的值转换成索引的键值
+   * @details 单个字段的索引直接使用值的数据。组合索引把各个字段的值按照字段长度拼接到 buffer 中，
+   * 字符串比字段长时只保留到这个字段，这时左边界不包含、右边界包含截断后的值
+   */
+  void make_key(const vector<Value> &values, bool is_left, bool &inclusive, vector<char> &buffer, const char *&key,
+      int &key_len) const;
+
 private:
   Trx               *trx_            = nullptr;
   Table             *table_          = nullptr;
@@ -57,10 +83,13 @@ private:
   Record   current_record_;
   RowTuple tuple_;
 
-  Value left_value_;
-  Value right_value_;
-  bool  left_inclusive_  = false;
-  bool  right_inclusive_ = false;
+  vector<Value> left_values_;   ///< 左边界，索引前面若干个字段的值
+  vector<Value> right_values_;  ///< 右边界，索引前面若干个字段的值
+  bool          left_inclusive_  = false;
+  bool          right_inclusive_ = false;
+  bool          empty_range_     = false;  ///< 扫描范围为空，不需要访问索引
+  bool          unique_lookup_   = false;  ///< 唯一索引所有字段上的等值查询，最多返回一条记录
+  bool          unique_found_    = false;  ///< 唯一索引的等值查询已经返回了一条记录
 
   vector<unique_ptr<Expression>> predicates_;
 };
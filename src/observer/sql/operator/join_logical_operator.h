@@ -20,6 +20,7 @@ See the Mulan PSL v2 for more details. */
  * @brief 连接算子
  * @ingroup LogicalOperator
  * @details 连接算子，用于连接两个表。对应的物理算子或者实现，可能有NestedLoopJoin，HashJoin等等。
+ * expressions() 中保存的是连接条件，由谓词下推时放进来。
  */
 class JoinLogicalOperator : public LogicalOperator
 {
@@ -37,6 +37,9 @@ enum class PhysicalOperatorType
   TABLE_SCAN_VEC,
   INDEX_SCAN,
   NESTED_LOOP_JOIN,
+  HASH_JOIN,
+  INDEX_NESTED_LOOP_JOIN,
+  HASH_JOIN_VEC,
   EXPLAIN,
   PREDICATE,
   PREDICATE_VEC,
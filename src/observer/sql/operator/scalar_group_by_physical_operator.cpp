@@ -104,6 +104,7 @@ RC ScalarGroupByPhysicalOperator::next()
 
 RC ScalarGroupByPhysicalOperator::close()
 {
+  children_[0]->close();
   group_value_.reset();
   emitted_ = false;
   return RC::SUCCESS;
@@ -16,49 +16,32 @@ using namespace std;
 
 RC TableScanVecPhysicalOperator::open(Trx *trx)
 {
-  RC rc = table_->get_chunk_scanner(chunk_scanner_, trx, mode_);
+  vector<Expression *> predicates;
+  for (unique_ptr<Expression> &expr : predicates_) {
+    predicates.push_back(expr.get());
+  }
+
+  RC rc = table_->get_chunk_scanner(chunk_scanner_, trx, mode_, predicates);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to get chunk scanner", strrc(rc));
     return rc;
   }
   // TODO: don't need to fetch all columns from record manager
-  for (int i = 0; i < table_->table_meta().field_num(); ++i) {
-    all_columns_.add_column(
-        make_unique<Column>(*table_->table_meta().field(i)), table_->table_meta().field(i)->field_id());
-    filterd_columns_.add_column(
-        make_unique<Column>(*table_->table_meta().field(i)), table_->table_meta().field(i)->field_id());
+  // 事务字段只在扫描器内部判断可见性时使用，不输出给上层算子
+  const TableMeta &table_meta = table_->table_meta();
+  all_columns_.reset();
+  for (int i = table_meta.sys_field_num(); i < table_meta.field_num(); ++i) {
+    all_columns_.add_column(make_unique<Column>(*table_meta.field(i)), table_meta.field(i)->field_id());
   }
   return rc;
 }
 
 RC TableScanVecPhysicalOperator::next(Chunk &chunk)
 {
-  RC rc = RC::SUCCESS;
-
   all_columns_.reset_data();
-  filterd_columns_.reset_data();
-  if (OB_SUCC(rc = chunk_scanner_.next_chunk(all_columns_))) {
-    select_.assign(all_columns_.rows(), 1);
-    if (predicates_.empty()) {
-      chunk.reference(all_columns_);
-    } else {
-      rc = filter(all_columns_);
-      if (rc != RC::SUCCESS) {
-        LOG_TRACE("filtered failed=%s", strrc(rc));
-        return rc;
-      }
-      // TODO: if all setted, it doesn't need to set one by one
-      for (int i = 0; i < all_columns_.rows(); i++) {
-        if (select_[i] == 0) {
-          continue;
-        }
-        for (int j = 0; j < all_columns_.column_num(); j++) {
-          filterd_columns_.column(j).append_one(
-              (char *)all_columns_.column(filterd_columns_.column_ids(j)).get_value(i).data());
-        }
-      }
-      chunk.reference(filterd_columns_);
-    }
+  RC rc = chunk_scanner_.next_chunk(all_columns_);
+  if (OB_SUCC(rc)) {
+    chunk.reference(all_columns_);
   }
   return rc;
 }
@@ -71,15 +54,3 @@ void TableScanVecPhysicalOperator::set_predicates(vector<unique_ptr<Expression>>
 {
   predicates_ = std::move(exprs);
 }
-
-RC TableScanVecPhysicalOperator::filter(Chunk &chunk)
-{
-  RC rc = RC::SUCCESS;
-  for (unique_ptr<Expression> &expr : predicates_) {
-    rc = expr->eval(chunk, select_);
-    if (rc != RC::SUCCESS) {
-      return rc;
-    }
-  }
-  return rc;
-}
@@ -36,17 +36,16 @@ public:
   RC next(Chunk &chunk) override;
   RC close() override;
 
+  /**
+   * @brief 设置过滤条件
+   * @details 过滤条件会下推到 ChunkFileScanner 中，在读取页面数据之前计算
+   */
   void set_predicates(vector<unique_ptr<Expression>> &&exprs);
 
-private:
-  RC filter(Chunk &chunk);
-
 private:
   Table                         *table_ = nullptr;
   ReadWriteMode                  mode_  = ReadWriteMode::READ_WRITE;
   ChunkFileScanner               chunk_scanner_;
-  Chunk                          all_columns_;
-  Chunk                          filterd_columns_;
-  vector<uint8_t>                select_;
+  Chunk                          all_columns_;  ///< 表中所有的用户字段，不包括事务字段
   vector<unique_ptr<Expression>> predicates_;
 };
@@ -24,6 +24,9 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/explain_physical_operator.h"
 #include "sql/operator/expr_vec_physical_operator.h"
 #include "sql/operator/group_by_vec_physical_operator.h"
+#include "sql/operator/hash_join_physical_operator.h"
+#include "sql/operator/hash_join_vec_physical_operator.h"
+#include "sql/operator/index_nested_loop_join_physical_operator.h"
 #include "sql/operator/index_scan_physical_operator.h"
 #include "sql/operator/insert_logical_operator.h"
 #include "sql/operator/insert_physical_operator.h"
@@ -44,9 +47,200 @@ See the Mulan PSL v2 for more details. */
 #include "sql/optimizer/physical_plan_generator.h"
 #include "sql/operator/order_by_logical_operator.h"
 #include "sql/operator/order_by_physical_operator.h"
+#include "sql/expr/expression_iterator.h"
+#include "storage/index/index.h"
+#include "storage/table/table.h"
 
 using namespace std;
 
+/**
+ * @brief 按照从左到右的顺序收集算子树中的表
+ * @details 这也是向量化算子输出 chunk 中列的顺序：向量化的 table scan 按照 field_id 输出所有的用户字段，
+ * hash join 先输出左侧的列再输出右侧的列。group by 的输出与表无关，不再继续向下查找。
+ */
+static void collect_tables(LogicalOperator &oper, vector<const Table *> &tables)
+{
+  if (oper.type() == LogicalOperatorType::TABLE_GET) {
+    tables.push_back(static_cast<TableGetLogicalOperator &>(oper).table());
+    return;
+  }
+  if (oper.type() == LogicalOperatorType::GROUP_BY) {
+    return;
+  }
+
+  for (unique_ptr<LogicalOperator> &child : oper.children()) {
+    collect_tables(*child, tables);
+  }
+}
+
+/**
+ * @brief 根据 chunk 中列的布局，设置表达式中字段在 chunk 中的位置
+ * @details 已经设置了位置的表达式(比如聚合表达式)保持不变，只处理它的子表达式
+ */
+static RC bind_field_pos(Expression &expr, const vector<const Table *> &tables)
+{
+  if (expr.type() != ExprType::FIELD) {
+    return ExpressionIterator::iterate_child_expr(
+        expr, [&tables](unique_ptr<Expression> &child) { return bind_field_pos(*child, tables); });
+  }
+
+  FieldExpr   *field_expr = static_cast<FieldExpr *>(&expr);
+  const Table *table      = field_expr->field().table();
+  int          pos        = 0;
+  for (const Table *layout_table : tables) {
+    const TableMeta &table_meta = layout_table->table_meta();
+    if (layout_table == table) {
+      field_expr->set_pos(pos + field_expr->field().meta()->field_id());
+      return RC::SUCCESS;
+    }
+    pos += table_meta.field_num() - table_meta.sys_field_num();
+  }
+
+  LOG_WARN("cannot find table of field in chunk layout. field=%s.%s",
+           field_expr->table_name(), field_expr->field_name());
+  return RC::SCHEMA_FIELD_NOT_EXIST;
+}
+
+/**
+ * @brief 把连接条件拆分成连接键和其它条件
+ * @details 左右两侧字段之间类型相同的等值比较作为连接键，left_keys 中的字段都来自左侧。
+ */
+static void split_join_conditions(vector<unique_ptr<Expression>> &conditions, const vector<const Table *> &left_tables,
+    const vector<const Table *> &right_tables, vector<unique_ptr<Expression>> &left_keys,
+    vector<unique_ptr<Expression>> &right_keys, vector<unique_ptr<Expression>> &predicates)
+{
+  auto in_tables = [](const vector<const Table *> &tables, const Expression &expr) {
+    if (expr.type() != ExprType::FIELD) {
+      return false;
+    }
+    const Table *table = static_cast<const FieldExpr &>(expr).field().table();
+    return find(tables.begin(), tables.end(), table) != tables.end();
+  };
+
+  for (unique_ptr<Expression> &expr : conditions) {
+    if (expr->type() == ExprType::COMPARISON) {
+      auto                   *comparison_expr = static_cast<ComparisonExpr *>(expr.get());
+      unique_ptr<Expression> &left            = comparison_expr->left();
+      unique_ptr<Expression> &right           = comparison_expr->right();
+      if (comparison_expr->comp() == CompOp::EQUAL_TO && left->value_type() == right->value_type() &&
+          left->value_type() != AttrType::VECTORS) {
+        if (in_tables(left_tables, *left) && in_tables(right_tables, *right)) {
+          left_keys.emplace_back(std::move(left));
+          right_keys.emplace_back(std::move(right));
+          continue;
+        } else if (in_tables(right_tables, *left) && in_tables(left_tables, *right)) {
+          left_keys.emplace_back(std::move(right));
+          right_keys.emplace_back(std::move(left));
+          continue;
+        }
+      }
+    }
+
+    predicates.emplace_back(std::move(expr));
+  }
+  conditions.clear();
+}
+
+/**
+ * @brief 一个字段上的扫描范围
+ * @details 由这个字段上的多个比较条件取交集得到
+ */
+struct FieldRange
+{
+  explicit FieldRange(const char *field_name) : field_name(field_name) {}
+
+  string field_name;
+  Value  low;
+  Value  high;
+  bool   has_low        = false;
+  bool   has_high       = false;
+  bool   low_inclusive  = false;
+  bool   high_inclusive = false;
+
+  /// value op field 转换成 field op value 时的比较符
+  static CompOp reverse(CompOp comp)
+  {
+    switch (comp) {
+      case LESS_THAN: return GREAT_THAN;
+      case LESS_EQUAL: return GREAT_EQUAL;
+      case GREAT_THAN: return LESS_THAN;
+      case GREAT_EQUAL: return LESS_EQUAL;
+      default: return comp;
+    }
+  }
+
+  /// 与 field comp value 表示的范围取交集
+  void intersect(CompOp comp, const Value &value)
+  {
+    switch (comp) {
+      case EQUAL_TO: {
+        tighten_low(value, true);
+        tighten_high(value, true);
+      } break;
+      case GREAT_THAN: tighten_low(value, false); break;
+      case GREAT_EQUAL: tighten_low(value, true); break;
+      case LESS_THAN: tighten_high(value, false); break;
+      case LESS_EQUAL: tighten_high(value, true); break;
+      default: break;
+    }
+  }
+
+  /// 范围越小越好：等值查找 > 两边都有边界 > 只有一边有边界
+  int rank() const
+  {
+    if (is_equal()) {
+      return 3;
+    }
+    return (has_low ? 1 : 0) + (has_high ? 1 : 0);
+  }
+
+  bool is_equal() const
+  {
+    return has_low && has_high && low_inclusive && high_inclusive && low.compare(high) == 0;
+  }
+
+private:
+  void tighten_low(const Value &value, bool inclusive)
+  {
+    const int result = has_low ? value.compare(low) : 1;
+    if (result > 0 || (result == 0 && !inclusive)) {
+      low           = value;
+      low_inclusive = inclusive;
+      has_low       = true;
+    }
+  }
+
+  void tighten_high(const Value &value, bool inclusive)
+  {
+    const int result = has_high ? value.compare(high) : -1;
+    if (result < 0 || (result == 0 && !inclusive)) {
+      high           = value;
+      high_inclusive = inclusive;
+      has_high       = true;
+    }
+  }
+};
+
+/**
+ * @brief 子算子树中有多张表时，字段在 chunk 中的位置与 field_id 不同，需要重新设置
+ */
+static RC bind_field_pos(const vector<Expression *> &exprs, LogicalOperator &child_oper)
+{
+  vector<const Table *> tables;
+  collect_tables(child_oper, tables);
+  if (tables.size() <= 1) {
+    return RC::SUCCESS;
+  }
+
+  for (Expression *expr : exprs) {
+    RC rc = bind_field_pos(*expr, tables);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
 RC PhysicalPlanGenerator::create(LogicalOperator &logical_operator, unique_ptr<PhysicalOperator> &oper)
 {
   RC rc = RC::SUCCESS;
@@ -121,6 +315,9 @@ RC PhysicalPlanGenerator::create_vec(LogicalOperator &logical_operator, unique_p
     case LogicalOperatorType::EXPLAIN: {
       return create_vec_plan(static_cast<ExplainLogicalOperator &>(logical_operator), oper);
     } break;
+    case LogicalOperatorType::JOIN: {
+      return create_vec_plan(static_cast<JoinLogicalOperator &>(logical_operator), oper);
+    } break;
     default: {
       return RC::INVALID_ARGUMENT;
     }
@@ -133,66 +330,123 @@ RC PhysicalPlanGenerator::create_vec(LogicalOperator &logical_operator, unique_p
 RC PhysicalPlanGenerator::create_plan(TableGetLogicalOperator &table_get_oper, unique_ptr<PhysicalOperator> &oper)
 {
   vector<unique_ptr<Expression>> &predicates = table_get_oper.predicates();
-  // 看看是否有可以用于索引查找的表达式
+  // 看看是否有可以用于索引查找的表达式，同一个字段上的多个比较合并成一个范围
   Table *table = table_get_oper.table();
 
-  Index     *index      = nullptr;
-  ValueExpr *value_expr = nullptr;
+  vector<FieldRange> ranges;
   for (auto &expr : predicates) {
-    if (expr->type() == ExprType::COMPARISON) {
-      auto comparison_expr = static_cast<ComparisonExpr *>(expr.get());
-      // 简单处理，就找等值查询
-      if (comparison_expr->comp() != EQUAL_TO) {
-        continue;
-      }
+    if (expr->type() != ExprType::COMPARISON) {
+      continue;
+    }
 
-      unique_ptr<Expression> &left_expr  = comparison_expr->left();
-      unique_ptr<Expression> &right_expr = comparison_expr->right();
-      // 左右比较的一边最少是一个值
-      if (left_expr->type() != ExprType::VALUE && right_expr->type() != ExprType::VALUE) {
+    auto                   *comparison_expr = static_cast<ComparisonExpr *>(expr.get());
+    unique_ptr<Expression> &left_expr       = comparison_expr->left();
+    unique_ptr<Expression> &right_expr      = comparison_expr->right();
+
+    // 统一成 field op value 的形式
+    CompOp     comp       = comparison_expr->comp();
+    FieldExpr *field_expr = nullptr;
+    ValueExpr *value_expr = nullptr;
+    if (left_expr->type() == ExprType::FIELD && right_expr->type() == ExprType::VALUE) {
+      field_expr = static_cast<FieldExpr *>(left_expr.get());
+      value_expr = static_cast<ValueExpr *>(right_expr.get());
+    } else if (left_expr->type() == ExprType::VALUE && right_expr->type() == ExprType::FIELD) {
+      field_expr = static_cast<FieldExpr *>(right_expr.get());
+      value_expr = static_cast<ValueExpr *>(left_expr.get());
+      comp       = FieldRange::reverse(comp);
+    } else {
+      continue;
+    }
+
+    // 范围的边界必须和索引字段的类型相同
+    Value value = value_expr->get_value();
+    if (value.is_null()) {
+      continue;
+    }
+    if (value.attr_type() != field_expr->value_type()) {
+      Value cast_value;
+      if (OB_FAIL(Value::cast_to(value, field_expr->value_type(), cast_value))) {
         continue;
       }
+      value = cast_value;
+    }
 
-      FieldExpr *field_expr = nullptr;
-      if (left_expr->type() == ExprType::FIELD) {
-        ASSERT(right_expr->type() == ExprType::VALUE, "right expr should be a value expr while left is field expr");
-        field_expr = static_cast<FieldExpr *>(left_expr.get());
-        value_expr = static_cast<ValueExpr *>(right_expr.get());
-      } else if (right_expr->type() == ExprType::FIELD) {
-        ASSERT(left_expr->type() == ExprType::VALUE, "left expr should be a value expr while right is a field expr");
-        field_expr = static_cast<FieldExpr *>(right_expr.get());
-        value_expr = static_cast<ValueExpr *>(left_expr.get());
-      }
+    const char *field_name = field_expr->field().field_name();
+    auto        iter       = find_if(
+        ranges.begin(), ranges.end(), [field_name](const FieldRange &range) { return range.field_name == field_name; });
+    if (iter == ranges.end()) {
+      ranges.emplace_back(field_name);
+      iter = ranges.end() - 1;
+    }
+    iter->intersect(comp, value);
+  }
 
-      if (field_expr == nullptr) {
-        continue;
+  // 按照最左前缀匹配索引：前面的字段都是等值条件，后面紧跟着的一个字段可以是范围。
+  // 优先选择等值条件多的索引，其次是最后一个字段的范围小的
+  Index                     *best_index = nullptr;
+  vector<const FieldRange *> best_prefix;
+  int                        best_eq_num = -1;
+  int                        best_rank   = 0;
+  for (Index *index : table->indexes()) {
+    vector<const FieldRange *> prefix;
+    int                        eq_num = 0;
+    int                        rank   = 0;
+    for (const string &field_name : index->index_meta().fields()) {
+      auto iter = find_if(
+          ranges.begin(), ranges.end(), [&field_name](const FieldRange &range) { return range.field_name == field_name; });
+      if (iter == ranges.end()) {
+        break;
       }
 
-      const Field &field = field_expr->field();
-      index              = table->find_index_by_field(field.field_name());
-      if (nullptr != index) {
+      prefix.push_back(&*iter);
+      if (!iter->is_equal()) {
+        rank = iter->rank();
         break;
       }
+      eq_num++;
+    }
+
+    if (eq_num == 0 && rank == 0) {  // 第一个字段上没有可用的范围
+      continue;
+    }
+    if (eq_num > best_eq_num || (eq_num == best_eq_num && rank > best_rank)) {
+      best_index  = index;
+      best_prefix = std::move(prefix);
+      best_eq_num = eq_num;
+      best_rank   = rank;
     }
   }
 
-    if (index != nullptr) {
-    ASSERT(value_expr != nullptr, "got an index but value expr is null ?");
+  if (best_index != nullptr) {
+    // 等值的字段同时出现在两边的边界中，最后一个字段有哪边的边界就加到哪边
+    vector<Value> left_values;
+    vector<Value> right_values;
+    bool          left_inclusive  = true;
+    bool          right_inclusive = true;
+    for (const FieldRange *range : best_prefix) {
+      if (range->has_low) {
+        left_values.push_back(range->low);
+        left_inclusive = range->low_inclusive;
+      }
+      if (range->has_high) {
+        right_values.push_back(range->high);
+        right_inclusive = range->high_inclusive;
+      }
+    }
 
-    const Value               &value           = value_expr->get_value();
-       IndexScanPhysicalOperator *index_scan_oper = new IndexScanPhysicalOperator(table,
-        index,
+    IndexScanPhysicalOperator *index_scan_oper = new IndexScanPhysicalOperator(table,
+        best_index,
         table_get_oper.read_write_mode(),
-        &value,
-        true ,//左边界
-        &value,
-        true );//右边界
+        left_values,
+        left_inclusive,
+        right_values,
+        right_inclusive);
 
+    // 谓词仍然全部保留，索引只用来缩小扫描的范围
     index_scan_oper->set_predicates(std::move(predicates));
     oper = unique_ptr<PhysicalOperator>(index_scan_oper);
     LOG_TRACE("use index scan");
-  } else 
-  {
+  } else {
     auto table_scan_oper = new TableScanPhysicalOperator(table, table_get_oper.read_write_mode());
     table_scan_oper->set_predicates(std::move(predicates));
     oper = unique_ptr<PhysicalOperator>(table_scan_oper);
@@ -340,16 +594,83 @@ RC PhysicalPlanGenerator::create_plan(JoinLogicalOperator &join_oper, unique_ptr
     return RC::INTERNAL;
   }
 
-  unique_ptr<PhysicalOperator> join_physical_oper(new NestedLoopJoinPhysicalOperator);
-  for (auto &child_oper : child_opers) {
-    unique_ptr<PhysicalOperator> child_physical_oper;
-    rc = create(*child_oper, child_physical_oper);
-    if (rc != RC::SUCCESS) {
+  vector<const Table *> left_tables;
+  vector<const Table *> right_tables;
+  collect_tables(*child_opers[0], left_tables);
+  collect_tables(*child_opers[1], right_tables);
+
+  vector<unique_ptr<Expression>> left_keys;
+  vector<unique_ptr<Expression>> right_keys;
+  vector<unique_ptr<Expression>> predicates;
+  split_join_conditions(join_oper.expressions(), left_tables, right_tables, left_keys, right_keys, predicates);
+
+  unique_ptr<PhysicalOperator> left_physical_oper;
+  rc = create(*child_opers[0], left_physical_oper);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to create physical child oper. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  // 右表的连接字段上有索引时，对左表的每一行到索引中查找；否则有连接键就用 hash join
+  Index *index     = nullptr;
+  size_t index_key = 0;
+  if (child_opers[1]->type() == LogicalOperatorType::TABLE_GET) {
+    Table *table = static_cast<TableGetLogicalOperator &>(*child_opers[1]).table();
+    for (size_t i = 0; i < right_keys.size() && index == nullptr; i++) {
+      const Field &field = static_cast<FieldExpr &>(*right_keys[i]).field();
+      index              = table->find_index_by_field(field.field_name());
+      index_key          = i;
+    }
+  }
+
+  unique_ptr<PhysicalOperator> join_physical_oper;
+  unique_ptr<PhysicalOperator> right_physical_oper;
+  if (index != nullptr) {
+    auto &table_get_oper = static_cast<TableGetLogicalOperator &>(*child_opers[1]);
+    auto  index_scan_oper = make_unique<IndexScanPhysicalOperator>(table_get_oper.table(),
+        index,
+        table_get_oper.read_write_mode(),
+        nullptr /*left_value*/,
+        false /*left_inclusive*/,
+        nullptr /*right_value*/,
+        false /*right_inclusive*/);
+    index_scan_oper->set_predicates(std::move(table_get_oper.predicates()));
+    right_physical_oper = std::move(index_scan_oper);
+    join_physical_oper  = make_unique<IndexNestedLoopJoinPhysicalOperator>(std::move(left_keys[index_key]));
+
+    // 其它的连接键作为普通的连接条件
+    for (size_t i = 0; i < left_keys.size(); i++) {
+      if (i != index_key) {
+        predicates.emplace_back(
+            make_unique<ComparisonExpr>(CompOp::EQUAL_TO, std::move(left_keys[i]), std::move(right_keys[i])));
+      }
+    }
+    LOG_TRACE("use index nested loop join. index=%s", index->index_meta().name());
+  } else {
+    rc = create(*child_opers[1], right_physical_oper);
+    if (OB_FAIL(rc)) {
       LOG_WARN("failed to create physical child oper. rc=%s", strrc(rc));
       return rc;
     }
 
-    join_physical_oper->add_child(std::move(child_physical_oper));
+    if (!left_keys.empty()) {
+      join_physical_oper = make_unique<HashJoinPhysicalOperator>(std::move(left_keys), std::move(right_keys));
+      LOG_TRACE("use hash join");
+    } else {
+      join_physical_oper = make_unique<NestedLoopJoinPhysicalOperator>();
+      LOG_TRACE("use nested loop join");
+    }
+  }
+
+  join_physical_oper->add_child(std::move(left_physical_oper));
+  join_physical_oper->add_child(std::move(right_physical_oper));
+
+  // 其它的连接条件在连接之后过滤
+  if (!predicates.empty()) {
+    unique_ptr<Expression> predicate(new ConjunctionExpr(ConjunctionExpr::Type::AND, predicates));
+    unique_ptr<PhysicalOperator> predicate_oper = make_unique<PredicatePhysicalOperator>(std::move(predicate));
+    predicate_oper->add_child(std::move(join_physical_oper));
+    join_physical_oper = std::move(predicate_oper);
   }
 
   oper = std::move(join_physical_oper);
@@ -409,6 +730,20 @@ RC PhysicalPlanGenerator::create_vec_plan(TableGetLogicalOperator &table_get_ope
 RC PhysicalPlanGenerator::create_vec_plan(GroupByLogicalOperator &logical_oper, unique_ptr<PhysicalOperator> &oper)
 {
   RC rc = RC::SUCCESS;
+
+  // 聚合表达式的位置对应 group by 输出的列，这里只设置它们的参数在子算子输出中的位置
+  vector<Expression *> bound_exprs(
+      logical_oper.aggregate_expressions().begin(), logical_oper.aggregate_expressions().end());
+  for (unique_ptr<Expression> &expr : logical_oper.group_by_expressions()) {
+    bound_exprs.push_back(expr.get());
+  }
+  ASSERT(logical_oper.children().size() == 1, "group by operator should have 1 child");
+  rc = bind_field_pos(bound_exprs, *logical_oper.children().front());
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to bind fields of group by(vec) operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
   unique_ptr<PhysicalOperator> physical_oper = nullptr;
   if (logical_oper.group_by_expressions().empty()) {
     physical_oper = make_unique<AggregateVecPhysicalOperator>(std::move(logical_oper.aggregate_expressions()));
@@ -418,8 +753,6 @@ RC PhysicalPlanGenerator::create_vec_plan(GroupByLogicalOperator &logical_oper,
 
   }
 
-  ASSERT(logical_oper.children().size() == 1, "group by operator should have 1 child");
-
   LogicalOperator             &child_oper = *logical_oper.children().front();
   unique_ptr<PhysicalOperator> child_physical_oper;
   rc = create_vec(child_oper, child_physical_oper);
@@ -459,6 +792,12 @@ RC PhysicalPlanGenerator::create_vec_plan(ProjectLogicalOperator &project_oper,
     for (auto &expr : project_operator->expressions()) {
       expressions.push_back(expr.get());
     }
+
+    rc = bind_field_pos(expressions, *child_opers.front());
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to bind fields of project(vec) operator. rc=%s", strrc(rc));
+      return rc;
+    }
     auto expr_operator = make_unique<ExprVecPhysicalOperator>(std::move(expressions));
     expr_operator->add_child(std::move(child_phy_oper));
     project_operator->add_child(std::move(expr_operator));
@@ -471,6 +810,59 @@ RC PhysicalPlanGenerator::create_vec_plan(ProjectLogicalOperator &project_oper,
 }
 
 
+RC PhysicalPlanGenerator::create_vec_plan(JoinLogicalOperator &join_oper, unique_ptr<PhysicalOperator> &oper)
+{
+  RC rc = RC::SUCCESS;
+
+  vector<unique_ptr<LogicalOperator>> &child_opers = join_oper.children();
+  if (child_opers.size() != 2) {
+    LOG_WARN("join operator should have 2 children, but have %d", child_opers.size());
+    return RC::INTERNAL;
+  }
+
+  vector<const Table *> left_tables;
+  vector<const Table *> right_tables;
+  collect_tables(*child_opers[0], left_tables);
+  collect_tables(*child_opers[1], right_tables);
+
+  // 两侧字段的等值比较作为连接键，其它的条件在连接之后过滤
+  vector<unique_ptr<Expression>> left_keys;
+  vector<unique_ptr<Expression>> right_keys;
+  vector<unique_ptr<Expression>> predicates;
+  split_join_conditions(join_oper.expressions(), left_tables, right_tables, left_keys, right_keys, predicates);
+
+  vector<const Table *> tables(left_tables);
+  tables.insert(tables.end(), right_tables.begin(), right_tables.end());
+  for (auto &[exprs, layout] : {make_pair(&left_keys, &left_tables),
+           make_pair(&right_keys, &right_tables),
+           make_pair(&predicates, &tables)}) {
+    for (unique_ptr<Expression> &expr : *exprs) {
+      rc = bind_field_pos(*expr, *layout);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to bind fields of join condition. rc=%s", strrc(rc));
+        return rc;
+      }
+    }
+  }
+
+  LOG_TRACE("use vectorized hash join. keys=%d, predicates=%d", left_keys.size(), predicates.size());
+  unique_ptr<PhysicalOperator> join_physical_oper = make_unique<HashJoinVecPhysicalOperator>(
+      std::move(left_keys), std::move(right_keys), std::move(predicates));
+  for (unique_ptr<LogicalOperator> &child_oper : child_opers) {
+    unique_ptr<PhysicalOperator> child_physical_oper;
+    rc = create_vec(*child_oper, child_physical_oper);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to create child physical operator of join(vec) operator. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    join_physical_oper->add_child(std::move(child_physical_oper));
+  }
+
+  oper = std::move(join_physical_oper);
+  return rc;
+}
+
 RC PhysicalPlanGenerator::create_vec_plan(ExplainLogicalOperator &explain_oper, unique_ptr<PhysicalOperator> &oper)
 {
   vector<unique_ptr<LogicalOperator>> &child_opers = explain_oper.children();
@@ -61,4 +61,5 @@ private:
   RC create_vec_plan(TableGetLogicalOperator &logical_oper, unique_ptr<PhysicalOperator> &oper);
   RC create_vec_plan(GroupByLogicalOperator &logical_oper, unique_ptr<PhysicalOperator> &oper);
   RC create_vec_plan(ExplainLogicalOperator &logical_oper, unique_ptr<PhysicalOperator> &oper);
+  RC create_vec_plan(JoinLogicalOperator &logical_oper, unique_ptr<PhysicalOperator> &oper);
 };
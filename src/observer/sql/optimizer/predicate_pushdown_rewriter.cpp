@@ -15,8 +15,39 @@ See the Mulan PSL v2 for more details. */
 #include "sql/optimizer/predicate_pushdown_rewriter.h"
 #include "common/log/log.h"
 #include "sql/expr/expression.h"
+#include "sql/expr/expression_iterator.h"
 #include "sql/operator/logical_operator.h"
 #include "sql/operator/table_get_logical_operator.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/unordered_set.h"
+
+/**
+ * @brief 收集表达式或者算子树中用到的表
+ */
+static void collect_tables(Expression &expr, unordered_set<const Table *> &tables)
+{
+  if (expr.type() == ExprType::FIELD) {
+    tables.insert(static_cast<FieldExpr &>(expr).field().table());
+    return;
+  }
+
+  ExpressionIterator::iterate_child_expr(expr, [&tables](unique_ptr<Expression> &child) {
+    collect_tables(*child, tables);
+    return RC::SUCCESS;
+  });
+}
+
+static void collect_tables(LogicalOperator &oper, unordered_set<const Table *> &tables)
+{
+  if (oper.type() == LogicalOperatorType::TABLE_GET) {
+    tables.insert(static_cast<TableGetLogicalOperator &>(oper).table());
+    return;
+  }
+
+  for (unique_ptr<LogicalOperator> &child : oper.children()) {
+    collect_tables(*child, tables);
+  }
+}
 
 RC PredicatePushdownRewriter::rewrite(unique_ptr<LogicalOperator> &oper, bool &change_made)
 {
@@ -30,18 +61,32 @@ RC PredicatePushdownRewriter::rewrite(unique_ptr<LogicalOperator> &oper, bool &c
   }
 
   unique_ptr<LogicalOperator> &child_oper = oper->children().front();
-  if (child_oper->type() != LogicalOperatorType::TABLE_GET) {
+  if (child_oper->type() != LogicalOperatorType::TABLE_GET && child_oper->type() != LogicalOperatorType::JOIN) {
     return rc;
   }
 
-  auto table_get_oper = static_cast<TableGetLogicalOperator *>(child_oper.get());
-
   vector<unique_ptr<Expression>> &predicate_oper_exprs = oper->expressions();
   if (predicate_oper_exprs.size() != 1) {
     return rc;
   }
 
-  unique_ptr<Expression>             &predicate_expr = predicate_oper_exprs.front();
+  unique_ptr<Expression> &predicate_expr = predicate_oper_exprs.front();
+  if (child_oper->type() == LogicalOperatorType::JOIN) {
+    rc = pushdown_to_join(predicate_expr, *child_oper, change_made);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to pushdown predicates to join. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    if (change_made && (!predicate_expr || is_empty_predicate(predicate_expr))) {
+      LOG_TRACE("all expressions of predicate operator were pushdown to join operator, then make a fake one");
+      predicate_expr = unique_ptr<Expression>(new ValueExpr(Value((bool)true)));
+    }
+    return rc;
+  }
+
+  auto table_get_oper = static_cast<TableGetLogicalOperator *>(child_oper.get());
+
   vector<unique_ptr<Expression>> pushdown_exprs;
   rc = get_exprs_can_pushdown(predicate_expr, pushdown_exprs);
   if (rc != RC::SUCCESS) {
@@ -136,3 +181,91 @@ RC PredicatePushdownRewriter::get_exprs_can_pushdown(
   }
   return rc;
 }
+
+RC PredicatePushdownRewriter::pushdown_to_join(unique_ptr<Expression> &expr, LogicalOperator &join_oper, bool &change_made)
+{
+  RC rc = RC::SUCCESS;
+  if (expr->type() == ExprType::CONJUNCTION &&
+      static_cast<ConjunctionExpr *>(expr.get())->conjunction_type() == ConjunctionExpr::Type::AND) {
+    vector<unique_ptr<Expression>> &child_exprs = static_cast<ConjunctionExpr *>(expr.get())->children();
+    for (auto iter = child_exprs.begin(); iter != child_exprs.end();) {
+      rc = pushdown_to_join(*iter, join_oper, change_made);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+
+      if (!*iter) {
+        iter = child_exprs.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+    return rc;
+  }
+
+  unordered_set<const Table *> expr_tables;
+  collect_tables(*expr, expr_tables);
+  if (expr_tables.empty()) {
+    return rc;
+  }
+
+  auto covers = [&expr_tables](LogicalOperator &oper) {
+    unordered_set<const Table *> oper_tables;
+    collect_tables(oper, oper_tables);
+    return all_of(expr_tables.begin(), expr_tables.end(),
+        [&oper_tables](const Table *table) { return oper_tables.count(table) > 0; });
+  };
+
+  if (!covers(join_oper)) {
+    return rc;
+  }
+
+  // 找到能覆盖表达式中所有表的最下层的 join 算子，以及 table get 算子(如果只涉及一张表)
+  LogicalOperator *target_join = &join_oper;
+  LogicalOperator *target_table = nullptr;
+  while (target_join != nullptr && target_table == nullptr) {
+    LogicalOperator *covered_child = nullptr;
+    for (unique_ptr<LogicalOperator> &child : target_join->children()) {
+      if (covers(*child)) {
+        covered_child = child.get();
+        break;
+      }
+    }
+
+    if (covered_child == nullptr) {
+      break;
+    } else if (covered_child->type() == LogicalOperatorType::JOIN) {
+      target_join = covered_child;
+    } else if (covered_child->type() == LogicalOperatorType::TABLE_GET) {
+      target_table = covered_child;
+    } else {
+      break;
+    }
+  }
+
+  if (target_table != nullptr && can_pushdown_to_table(*expr)) {
+    static_cast<TableGetLogicalOperator *>(target_table)->predicates().emplace_back(std::move(expr));
+  } else {
+    target_join->expressions().emplace_back(std::move(expr));
+  }
+
+  change_made = true;
+  return rc;
+}
+
+bool PredicatePushdownRewriter::can_pushdown_to_table(Expression &expr)
+{
+  if (expr.type() != ExprType::COMPARISON) {
+    return false;
+  }
+
+  // 与 get_exprs_can_pushdown 的条件相同
+  auto    &comparison_expr = static_cast<ComparisonExpr &>(expr);
+  ExprType left_type       = comparison_expr.left()->type();
+  ExprType right_type      = comparison_expr.right()->type();
+  if (left_type != ExprType::FIELD && right_type != ExprType::FIELD) {
+    return false;
+  }
+  return (left_type == ExprType::FIELD || left_type == ExprType::VALUE) &&
+         (right_type == ExprType::FIELD || right_type == ExprType::VALUE);
+}
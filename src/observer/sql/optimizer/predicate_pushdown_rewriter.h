@@ -33,4 +33,14 @@ public:
 private:
   RC   get_exprs_can_pushdown(unique_ptr<Expression> &expr, vector<unique_ptr<Expression>> &pushdown_exprs);
   bool is_empty_predicate(unique_ptr<Expression> &expr);
+
+  /**
+   * @brief 把 join 上面的谓词尽量往下推
+   * @details 只涉及一张表的比较下推到对应的 table get 算子，其它的下推到能覆盖这些表的最下层的 join 算子，
+   * 作为 join 的连接条件。
+   * @param expr 当前的表达式。如果被下推了，执行完成后expr就为空
+   * @param join_oper predicate 算子下面的 join 算子
+   */
+  RC   pushdown_to_join(unique_ptr<Expression> &expr, LogicalOperator &join_oper, bool &change_made);
+  bool can_pushdown_to_table(Expression &expr);
 };
@@ -70,6 +70,9 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
         GROUP
         TABLE
         TABLES
+        BUFFER
+        POOL
+        STATUS
         INDEX
         CALC
         SELECT
@@ -141,6 +144,7 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
   vector<RelAttrSqlNode> *              rel_attr_list;
   vector<RelationSqlNode> *             relation_list;
   vector<JoinSqlNode> *                 join_list;
+  vector<string> *                      id_list;
   char *                                     cstring;
   int                                        number;
   float                                      floats;
@@ -182,6 +186,7 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
 %type <order_by_node>       order_by_item
 %type <cstring>             aggregate_type
 %type <cstring>             index_type
+%type <id_list>             index_attr_list
 %type <sql_node>            calc_stmt
 %type <sql_node>            select_stmt
 %type <sql_node>            insert_stmt
@@ -190,6 +195,7 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
 %type <sql_node>            create_table_stmt
 %type <sql_node>            drop_table_stmt
 %type <sql_node>            show_tables_stmt
+%type <sql_node>            show_buffer_pool_stmt
 %type <sql_node>            desc_table_stmt
 %type <sql_node>            create_index_stmt
 %type <sql_node>            drop_index_stmt
@@ -227,6 +233,7 @@ command_wrapper:
   | create_table_stmt
   | drop_table_stmt
   | show_tables_stmt
+  | show_buffer_pool_stmt
   | desc_table_stmt
   | create_index_stmt
   | drop_index_stmt
@@ -288,6 +295,12 @@ show_tables_stmt:
     }
     ;
 
+show_buffer_pool_stmt:
+    SHOW BUFFER POOL STATUS {
+      $$ = new ParsedSqlNode(SCF_SHOW_BUFFER_POOL_STATUS);
+    }
+    ;
+
 desc_table_stmt:
     DESC ID  {
       $$ = new ParsedSqlNode(SCF_DESC_TABLE);
@@ -296,7 +309,7 @@ desc_table_stmt:
     ;
 
 create_index_stmt:    /*create index 语句的语法解析树*/
-    CREATE index_type INDEX ID ON ID LBRACE ID RBRACE
+    CREATE index_type INDEX ID ON ID LBRACE ID index_attr_list RBRACE
     {
       $$ = new ParsedSqlNode(SCF_CREATE_INDEX);
       CreateIndexSqlNode &create_index = $$->create_index;
@@ -307,7 +320,28 @@ create_index_stmt:    /*create index 语句的语法解析树*/
       }
       create_index.index_name = $4;
       create_index.relation_name = $6;
-      create_index.attribute_name = $8;
+      if ($9 != nullptr) {
+        create_index.attribute_names.swap(*$9);
+        delete $9;
+      }
+      create_index.attribute_names.emplace_back($8);
+      reverse(create_index.attribute_names.begin(), create_index.attribute_names.end());
+    }
+    ;
+
+index_attr_list:
+    /* empty */
+    {
+      $$ = nullptr;
+    }
+    | COMMA ID index_attr_list
+    {
+      if ($3 != nullptr) {
+        $$ = $3;
+      } else {
+        $$ = new vector<string>;
+      }
+      $$->emplace_back($2);
     }
     ;
 
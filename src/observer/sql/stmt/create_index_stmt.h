@@ -28,8 +28,9 @@ class FieldMeta;
 class CreateIndexStmt : public Stmt
 {
 public:
-  CreateIndexStmt(Table *table, const FieldMeta *field_meta, const std::string &index_name, const IndexMeta::IndexType index_type)
-      : table_(table), field_meta_(field_meta), index_name_(index_name), index_type_(index_type)
+  CreateIndexStmt(Table *table, const vector<const FieldMeta *> &field_metas, const std::string &index_name,
+      const IndexMeta::IndexType index_type)
+      : table_(table), field_metas_(field_metas), index_name_(index_name), index_type_(index_type)
   {}
 
   virtual ~CreateIndexStmt() = default;
@@ -37,7 +38,7 @@ public:
   StmtType type() const override { return StmtType::CREATE_INDEX; }
 
   Table           *table() const { return table_; }
-  const FieldMeta *field_meta() const { return field_meta_; }
+  const vector<const FieldMeta *> &field_metas() const { return field_metas_; }
   const string    &index_name() const { return index_name_; }
   const IndexMeta::IndexType &index_type() const { return index_type_; }
 
@@ -46,7 +47,7 @@ public:
 
 private:
   Table           *table_      = nullptr;
-  const FieldMeta *field_meta_ = nullptr;
+  vector<const FieldMeta *> field_metas_;  ///< 组合索引有多个字段
   string           index_name_;
   IndexMeta::IndexType      index_type_;
 };
@@ -0,0 +1,35 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "sql/stmt/stmt.h"
+
+class Db;
+
+/**
+ * @brief 查看buffer pool访问统计的语句
+ * @ingroup Statement
+ * @details SHOW BUFFER POOL STATUS
+ */
+class ShowBufferPoolStmt : public Stmt
+{
+public:
+  ShowBufferPoolStmt()          = default;
+  virtual ~ShowBufferPoolStmt() = default;
+
+  StmtType type() const override { return StmtType::SHOW_BUFFER_POOL_STATUS; }
+
+  static RC create(Db *db, Stmt *&stmt)
+  {
+    stmt = new ShowBufferPoolStmt();
+    return RC::SUCCESS;
+  }
+};
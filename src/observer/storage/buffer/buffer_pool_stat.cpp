@@ -0,0 +1,54 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/buffer/buffer_pool_stat.h"
+
+const char *buffer_pool_stat_name(BufferPoolStatType type)
+{
+  switch (type) {
+    case BufferPoolStatType::PAGE_HIT: return "Hits";
+    case BufferPoolStatType::PAGE_MISS: return "Misses";
+    case BufferPoolStatType::PAGE_READ: return "Reads";
+    case BufferPoolStatType::READ_TIME_US: return "Read_Time_Us";
+    case BufferPoolStatType::PREFETCH: return "Prefetched";
+    case BufferPoolStatType::EVICT: return "Evictions";
+    case BufferPoolStatType::PIN_WAIT: return "Pin_Waits";
+    case BufferPoolStatType::DIRTY_FLUSH: return "Dirty_Flushes";
+    case BufferPoolStatType::DBLWR_WRITE: return "Dblwr_Writes";
+    case BufferPoolStatType::PAGE_WRITE: return "Page_Writes";
+    case BufferPoolStatType::COUNT: break;
+  }
+  return "unknown";
+}
+
+size_t BufferPoolStat::thread_shard()
+{
+  static atomic<size_t>    next_shard{0};
+  static thread_local size_t shard = next_shard.fetch_add(1, memory_order_relaxed) % SHARD_NUM;
+  return shard;
+}
+
+uint64_t BufferPoolStat::get(BufferPoolStatType type) const
+{
+  uint64_t value = 0;
+  for (const Shard &shard : shards_) {
+    value += shard.counters[static_cast<size_t>(type)].load(memory_order_relaxed);
+  }
+  return value;
+}
+
+void BufferPoolStat::collect(Values &values) const
+{
+  for (const Shard &shard : shards_) {
+    for (size_t i = 0; i < values.size(); i++) {
+      values[i] += shard.counters[i].load(memory_order_relaxed);
+    }
+  }
+}
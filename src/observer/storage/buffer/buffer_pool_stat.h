@@ -0,0 +1,75 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/array.h"
+#include "common/lang/atomic.h"
+
+/**
+ * @brief buffer pool 统计项
+ * @ingroup BufferPool
+ */
+enum class BufferPoolStatType
+{
+  PAGE_HIT,      ///< 访问页面时页面已经在内存中
+  PAGE_MISS,     ///< 访问页面时需要从磁盘加载
+  PAGE_READ,     ///< 从磁盘读取的页面个数，包括预读的页面
+  READ_TIME_US,  ///< 从磁盘读取页面花费的时间，单位微秒
+  PREFETCH,      ///< 预读加载的页面个数
+  EVICT,         ///< 为了加载这个文件的页面而淘汰的页帧个数，被淘汰的页面可能属于其它文件
+  PIN_WAIT,      ///< 分配页帧时候选的页面都被pin住或者正在使用，需要重试的次数
+  DIRTY_FLUSH,   ///< 从内存中刷出的脏页个数
+  DBLWR_WRITE,   ///< 写入 double write buffer 的页面个数，同一个页面在刷盘前多次写入只算一次
+  PAGE_WRITE,    ///< 写回数据文件的页面个数
+  COUNT,
+};
+
+const char *buffer_pool_stat_name(BufferPoolStatType type);
+
+/**
+ * @brief buffer pool 的统计计数
+ * @ingroup BufferPool
+ * @details 计数器在访问页面的热点路径上更新，所以按照线程分散到多个独占缓存行的分片中，
+ * 不同线程更新计数时基本不会竞争同一个缓存行。读取时把所有分片加起来，读到的不是一个精确的快照。
+ */
+class BufferPoolStat
+{
+public:
+  using Values = array<uint64_t, static_cast<size_t>(BufferPoolStatType::COUNT)>;
+
+  void add(BufferPoolStatType type, uint64_t value = 1)
+  {
+    shards_[thread_shard()].counters[static_cast<size_t>(type)].fetch_add(value, memory_order_relaxed);
+  }
+
+  uint64_t get(BufferPoolStatType type) const;
+
+  /**
+   * @brief 把所有的计数累加到 values 中
+   */
+  void collect(Values &values) const;
+
+private:
+  /**
+   * @brief 当前线程使用的分片。线程第一次使用时轮流分配
+   */
+  static size_t thread_shard();
+
+private:
+  static constexpr size_t SHARD_NUM = 16;
+
+  struct alignas(64) Shard
+  {
+    atomic<uint64_t> counters[static_cast<size_t>(BufferPoolStatType::COUNT)]{};
+  };
+
+  Shard shards_[SHARD_NUM];
+};
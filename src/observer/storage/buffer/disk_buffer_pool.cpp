@@ -13,19 +13,22 @@ See the Mulan PSL v2 for more details. */
 //
 #include <errno.h>
 #include <string.h>
+#include <sys/uio.h>
 
 #include "common/io/io.h"
 #include "common/lang/mutex.h"
 #include "common/lang/algorithm.h"
+#include "common/lang/chrono.h"
+#include "common/lang/thread.h"
 #include "common/log/log.h"
-#include "common/math/crc.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/buffer/buffer_pool_log.h"
 #include "storage/db/db.h"
 
 using namespace common;
 
-static const int MEM_POOL_ITEM_NUM = 20;
+static const int MEM_POOL_ITEM_NUM   = 20;  /// 没有配置内存大小时默认的内存池个数
+static const int MAX_FRAME_SHARD_NUM = 16;
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -40,105 +43,225 @@ string BPFileHeader::to_string() const
 
 BPFrameManager::BPFrameManager(const char *name) : allocator_(name) {}
 
-RC BPFrameManager::init(int pool_num)
+RC BPFrameManager::init(
+    int pool_num, int shard_num /* = 0 */, FrameReplacerType replacer_type /* = LRU */, bool huge_page /* = false */)
 {
   int ret = allocator_.init(false, pool_num);
-  if (ret == 0) {
-    return RC::SUCCESS;
+  if (ret != 0) {
+    return RC::NOMEM;
+  }
+
+  const int total_frame_num = allocator_.get_size();
+  if (shard_num <= 0) {
+    // 每个分片至少有一个内存池的页帧，否则分片内的LRU淘汰效果会比较差
+    shard_num = clamp(total_frame_num / DEFAULT_ITEM_NUM_PER_POOL, 1, MAX_FRAME_SHARD_NUM);
   }
-  return RC::NOMEM;
+  shard_num = clamp(shard_num, 1, total_frame_num);
+
+  const int shard_capacity = total_frame_num / shard_num;
+
+  replacer_type_ = replacer_type;
+  shards_.clear();
+  for (int i = 0; i < shard_num; i++) {
+    auto shard      = make_unique<Shard>();
+    shard->replacer = FrameReplacer::create(replacer_type, shard_capacity);
+    shard->free_frames.reserve(shard_capacity + 1);
+    shards_.push_back(std::move(shard));
+  }
+
+  // 页面内存一次性申请并且对齐，这样可以直接使用 O_DIRECT 读写
+  RC rc = page_arena_.init(total_frame_num, huge_page);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("failed to allocate page memory. frame num=%d, rc=%s", total_frame_num, strrc(rc));
+    allocator_.cleanup();
+    return rc;
+  }
+
+  // 内存池中的页帧在这里一次性取出来，平均分配到各个分片的空闲链表中
+  for (int i = 0; i < total_frame_num; i++) {
+    Frame *frame = allocator_.alloc();
+    ASSERT(frame != nullptr, "failed to alloc frame from memory pool. index=%d", i);
+    frame->set_page(page_arena_.pages() + i);
+    shards_[i % shard_num]->free_frames.push_back(frame);
+  }
+
+  LOG_INFO("frame manager init. frame num=%d, shard num=%d, replacer=%s",
+           total_frame_num, shard_num, frame_replacer_type_name(replacer_type));
+  return RC::SUCCESS;
 }
 
 RC BPFrameManager::cleanup()
 {
-  if (frames_.count() > 0) {
+  if (frame_num() > 0) {
     return RC::INTERNAL;
   }
 
-  frames_.destroy();
+  for (unique_ptr<Shard> &shard : shards_) {
+    for (Frame *frame : shard->free_frames) {
+      allocator_.free(frame);
+    }
+    shard->free_frames.clear();
+  }
   return RC::SUCCESS;
 }
 
-int BPFrameManager::purge_frames(int count, function<RC(Frame *frame)> purger)
+void BPFrameManager::pick_purge_frames(Shard &shard, int count, vector<Frame *> &frames)
 {
-  lock_guard<mutex> lock_guard(lock_);
-
-  vector<Frame *> frames_can_purge;
-  if (count <= 0) {
-    count = 1;
-  }
-  frames_can_purge.reserve(count);
-
-  auto purge_finder = [&frames_can_purge, count](const FrameId &frame_id, Frame *const frame) {
+  auto purge_finder = [&frames, count](Frame *frame) {
     if (frame->can_purge()) {
       frame->pin();
-      frames_can_purge.push_back(frame);
-      if (frames_can_purge.size() >= static_cast<size_t>(count)) {
+      frames.push_back(frame);
+      if (frames.size() >= static_cast<size_t>(count)) {
         return false;  // false to break the progress
       }
     }
     return true;  // true continue to look up
   };
 
-  frames_.foreach_reverse(purge_finder);
+  lock_guard<mutex> lock_guard(shard.lock);
+  shard.replacer->foreach_victim(purge_finder);
+}
+
+int BPFrameManager::purge_frames(int count, function<RC(Frame *frame)> purger)
+{
+  vector<Frame *> frames_can_purge;
+  if (count <= 0) {
+    count = 1;
+  }
+  frames_can_purge.reserve(count);
+
+  const size_t start = purge_cursor_.fetch_add(1) % shards_.size();
+  for (size_t i = 0; i < shards_.size() && frames_can_purge.size() < static_cast<size_t>(count); i++) {
+    pick_purge_frames(*shards_[(start + i) % shards_.size()], count, frames_can_purge);
+  }
   LOG_INFO("purge frames find %ld pages total", frames_can_purge.size());
 
-  /// 当前还在frameManager的锁内，而 purger 是一个非常耗时的操作
-  /// 他需要把脏页数据刷新到磁盘上去，所以这里会极大地降低并发度
+  /// purger 需要把脏页数据刷新到磁盘上去，是一个非常耗时的操作，所以在分片锁外面执行。
+  /// 页面已经被pin住，不会被其它线程淘汰，但是其它线程还可以访问它，所以刷盘时要加读锁，
+  /// 释放页帧之前还要确认在这期间没有其它线程使用这个页面。
   int freed_count = 0;
   for (Frame *frame : frames_can_purge) {
-    RC rc = purger(frame);
-    if (RC::SUCCESS == rc) {
-      free_internal(frame->frame_id(), frame);
-      freed_count++;
+    RC rc = RC::SUCCESS;
+    if (!frame->try_read_latch()) {
+      rc = RC::LOCKED_CONCURRENCY_CONFLICT;
     } else {
-      frame->unpin();
-      LOG_WARN("failed to purge frame. frame_id=%s, rc=%s", 
-               frame->frame_id().to_string().c_str(), strrc(rc));
+      rc = purger(frame);
+      frame->read_unlatch();
+    }
+
+    if (OB_SUCC(rc)) {
+      const FrameId frame_id = frame->frame_id();
+      Shard        &shard    = shard_of(frame_id);
+
+      lock_guard<mutex> lock_guard(shard.lock);
+      if (frame->pin_count() == 1 && !frame->dirty()) {
+        free_internal(shard, frame_id, frame);
+        freed_count++;
+        continue;
+      }
+      rc = RC::LOCKED_CONCURRENCY_CONFLICT;
+    }
+
+    // 其它线程正在使用这个页面，不算是错误
+    if (rc == RC::LOCKED_CONCURRENCY_CONFLICT) {
+      LOG_DEBUG("skip purging frame in use. frame=%s", frame->to_string().c_str());
+    } else {
+      LOG_WARN("failed to purge frame. frame_id=%s, rc=%s", frame->frame_id().to_string().c_str(), strrc(rc));
     }
+    frame->unpin();
   }
   LOG_INFO("purge frame done. number=%d", freed_count);
   return freed_count;
 }
 
-Frame *BPFrameManager::get(int buffer_pool_id, PageNum page_num)
+Frame *BPFrameManager::get(int buffer_pool_id, PageNum page_num, bool access /* = true */)
 {
-  FrameId                     frame_id(buffer_pool_id, page_num);
+  FrameId frame_id(buffer_pool_id, page_num);
+  Shard  &shard = shard_of(frame_id);
 
-  lock_guard<mutex> lock_guard(lock_);
-  return get_internal(frame_id);
+  lock_guard<mutex> lock_guard(shard.lock);
+  return get_internal(shard, frame_id, access);
 }
 
-Frame *BPFrameManager::get_internal(const FrameId &frame_id)
+Frame *BPFrameManager::get_internal(Shard &shard, const FrameId &frame_id, bool access /* = true */)
 {
-  Frame *frame = nullptr;
-  (void)frames_.get(frame_id, frame);
-  if (frame != nullptr) {
-    frame->pin();
-    LOG_DEBUG("got a frame. frame=%s", frame->to_string().c_str());
+  auto iter = shard.frames.find(frame_id);
+  if (iter == shard.frames.end()) {
+    return nullptr;
+  }
+
+  Frame *frame = iter->second;
+  if (access) {
+    shard.replacer->access(frame);
   }
+  frame->pin();
+  LOG_DEBUG("got a frame. frame=%s", frame->to_string().c_str());
   return frame;
 }
 
-Frame *BPFrameManager::alloc(int buffer_pool_id, PageNum page_num)
+Frame *BPFrameManager::alloc_free_frame(Shard &home)
+{
+  if (!home.free_frames.empty()) {
+    Frame *frame = home.free_frames.back();
+    home.free_frames.pop_back();
+    return frame;
+  }
+
+  // 当前分片没有空闲页帧了，从其它分片借一个。
+  // 调用方持有home分片的锁，这里对其它分片只使用try_lock，避免两个分片互相借用时死锁。
+  for (unique_ptr<Shard> &shard : shards_) {
+    if (shard.get() == &home || !shard->lock.try_lock()) {
+      continue;
+    }
+
+    Frame *frame = nullptr;
+    if (!shard->free_frames.empty()) {
+      frame = shard->free_frames.back();
+      shard->free_frames.pop_back();
+    }
+    shard->lock.unlock();
+
+    if (frame != nullptr) {
+      return frame;
+    }
+  }
+  return nullptr;
+}
+
+bool BPFrameManager::contains(int buffer_pool_id, PageNum page_num)
 {
   FrameId frame_id(buffer_pool_id, page_num);
+  Shard  &shard = shard_of(frame_id);
 
-  lock_guard<mutex> lock_guard(lock_);
+  lock_guard<mutex> lock_guard(shard.lock);
+  return shard.frames.find(frame_id) != shard.frames.end();
+}
 
-  Frame                      *frame = get_internal(frame_id);
+Frame *BPFrameManager::alloc(int buffer_pool_id, PageNum page_num, bool latch_new_frame /* = false */)
+{
+  FrameId frame_id(buffer_pool_id, page_num);
+  Shard  &shard = shard_of(frame_id);
+
+  lock_guard<mutex> lock_guard(shard.lock);
+
+  Frame *frame = get_internal(shard, frame_id);
   if (frame != nullptr) {
     return frame;
   }
 
-  frame = allocator_.alloc();
+  frame = alloc_free_frame(shard);
   if (frame != nullptr) {
     ASSERT(frame->pin_count() == 0, "got an invalid frame that pin count is not 0. frame=%s", 
            frame->to_string().c_str());
+    frame->reinit();
     frame->set_buffer_pool_id(buffer_pool_id);
     frame->set_page_num(page_num);
     frame->pin();
-    frames_.put(frame_id, frame);
+    if (latch_new_frame) {
+      frame->write_latch();
+    }
+    shard.frames.emplace(frame_id, frame);
+    shard.replacer->insert(frame);
     LOG_DEBUG("allocate a new frame. frame=%s", frame->to_string().c_str());
   }
   return frame;
@@ -147,70 +270,129 @@ Frame *BPFrameManager::alloc(int buffer_pool_id, PageNum page_num)
 RC BPFrameManager::free(int buffer_pool_id, PageNum page_num, Frame *frame)
 {
   FrameId frame_id(buffer_pool_id, page_num);
+  Shard  &shard = shard_of(frame_id);
+
+  lock_guard<mutex> lock_guard(shard.lock);
+  return free_internal(shard, frame_id, frame);
+}
+
+RC BPFrameManager::try_free(int buffer_pool_id, PageNum page_num, Frame *frame)
+{
+  FrameId frame_id(buffer_pool_id, page_num);
+  Shard  &shard = shard_of(frame_id);
 
-  lock_guard<mutex> lock_guard(lock_);
-  return free_internal(frame_id, frame);
+  // 其它线程只有在持有分片锁时才能pin住页帧，所以这里看到的pin count不会再增加
+  lock_guard<mutex> lock_guard(shard.lock);
+  if (frame->pin_count() > 1) {
+    frame->unpin();
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+  return free_internal(shard, frame_id, frame);
 }
 
-RC BPFrameManager::free_internal(const FrameId &frame_id, Frame *frame)
+RC BPFrameManager::free_internal(Shard &shard, const FrameId &frame_id, Frame *frame)
 {
-  Frame                *frame_source = nullptr;
-  [[maybe_unused]] bool found        = frames_.get(frame_id, frame_source);
+  auto                  iter         = shard.frames.find(frame_id);
+  [[maybe_unused]] bool found        = iter != shard.frames.end();
+  [[maybe_unused]] auto frame_source = found ? iter->second : nullptr;
   ASSERT(found && frame == frame_source && frame->pin_count() == 1,
       "failed to free frame. found=%d, frameId=%s, frame_source=%p, frame=%p, pinCount=%d, lbt=%s",
       found, frame_id.to_string().c_str(), frame_source, frame, frame->pin_count(), lbt());
 
+  shard.replacer->remove(frame);
+  shard.frames.erase(iter);
   frame->set_page_num(-1);
   frame->unpin();
-  frames_.remove(frame_id);
-  allocator_.free(frame);
+  frame->reset();
+  shard.free_frames.push_back(frame);
   return RC::SUCCESS;
 }
 
 list<Frame *> BPFrameManager::find_list(int buffer_pool_id)
 {
-  lock_guard<mutex> lock_guard(lock_);
-
   list<Frame *> frames;
-  auto               fetcher = [&frames, buffer_pool_id](const FrameId &frame_id, Frame *const frame) -> bool {
-    if (buffer_pool_id == frame_id.buffer_pool_id()) {
-      frame->pin();
-      frames.push_back(frame);
+  for (unique_ptr<Shard> &shard : shards_) {
+    lock_guard<mutex> lock_guard(shard->lock);
+    for (auto &[frame_id, frame] : shard->frames) {
+      if (buffer_pool_id == frame_id.buffer_pool_id()) {
+        frame->pin();
+        frames.push_back(frame);
+      }
     }
-    return true;
-  };
-  frames_.foreach (fetcher);
+  }
   return frames;
 }
 
+void BPFrameManager::find_dirty_list(vector<pair<LSN, FrameId>> &dirty_frames) const
+{
+  for (const unique_ptr<Shard> &shard : shards_) {
+    lock_guard<mutex> lock_guard(shard->lock);
+    for (const auto &[frame_id, frame] : shard->frames) {
+      if (frame->dirty()) {
+        dirty_frames.emplace_back(frame->recovery_lsn(), frame_id);
+      }
+    }
+  }
+}
+
+size_t BPFrameManager::frame_num() const
+{
+  size_t num = 0;
+  for (const unique_ptr<Shard> &shard : shards_) {
+    lock_guard<mutex> lock_guard(shard->lock);
+    num += shard->frames.size();
+  }
+  return num;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 BufferPoolIterator::BufferPoolIterator() {}
 BufferPoolIterator::~BufferPoolIterator() {}
-RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */)
+RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */, bool read_ahead /* = false */)
 {
-  bitmap_.init(bp.file_header_->bitmap, bp.file_header_->page_count);
   if (start_page <= 0) {
     current_page_num_ = -1;
   } else {
     current_page_num_ = start_page - 1;
   }
+
+  end_page_num_   = bp.file_header_->page_count;
+  buffer_pool_    = &bp;
+  read_ahead_num_ = read_ahead ? bp.read_ahead_page_num() : 0;
+  read_ahead_end_ = -1;
   return RC::SUCCESS;
 }
 
-bool BufferPoolIterator::has_next() { return bitmap_.next_setted_bit(current_page_num_ + 1) != -1; }
+bool BufferPoolIterator::has_next()
+{
+  PageNum next_page = buffer_pool_->next_allocated_page(current_page_num_ + 1);
+  return next_page != -1 && next_page < end_page_num_;
+}
 
 PageNum BufferPoolIterator::next()
 {
-  PageNum next_page = bitmap_.next_setted_bit(current_page_num_ + 1);
+  PageNum next_page = buffer_pool_->next_allocated_page(current_page_num_ + 1);
+  if (next_page >= end_page_num_) {
+    next_page = -1;
+  }
   if (next_page != -1) {
     current_page_num_ = next_page;
   }
+
+  // 已经消费了一半预读的页面，就开始预读下一批，让后台加载和扫描重叠起来。
+  // 当前页面马上就会被调用方自己读取，所以从下一个页面开始预读
+  if (next_page != -1 && read_ahead_num_ > 0 && next_page + read_ahead_num_ / 2 >= read_ahead_end_) {
+    PageNum start_page = max(next_page + 1, read_ahead_end_);
+    (void)buffer_pool_->prefetch_pages(start_page, read_ahead_num_);
+    read_ahead_end_ = start_page + read_ahead_num_;
+  }
   return next_page;
 }
 
 RC BufferPoolIterator::reset()
 {
   current_page_num_ = 0;
+  read_ahead_end_   = -1;
   return RC::SUCCESS;
 }
 
@@ -228,18 +410,26 @@ DiskBufferPool::~DiskBufferPool()
 
 RC DiskBufferPool::open_file(const char *file_name)
 {
-  int fd = open(file_name, O_RDWR);
+  direct_io_ = bp_manager_.direct_io();
+
+  int fd = open(file_name, O_RDWR | (direct_io_ ? O_DIRECT : 0));
+  if (fd < 0 && direct_io_ && errno == EINVAL) {
+    // 有些文件系统不支持 O_DIRECT，比如 tmpfs
+    LOG_WARN("File system does not support O_DIRECT, use buffered io instead. file=%s", file_name);
+    direct_io_ = false;
+    fd         = open(file_name, O_RDWR);
+  }
   if (fd < 0) {
     LOG_ERROR("Failed to open file %s, because %s.", file_name, strerror(errno));
     return RC::IOERR_ACCESS;
   }
-  LOG_INFO("Successfully open buffer pool file %s.", file_name);
+  LOG_INFO("Successfully open buffer pool file %s. direct io=%d", file_name, direct_io_);
 
   file_name_ = file_name;
   file_desc_ = fd;
 
   Page header_page;
-  int ret = readn(file_desc_, &header_page, sizeof(header_page));
+  int ret = preadn(file_desc_, &header_page, sizeof(header_page), 0 /*offset*/, io_alignment());
   if (ret != 0) {
     LOG_ERROR("Failed to read first page of %s, due to %s.", file_name, strerror(errno));
     close(fd);
@@ -271,6 +461,14 @@ RC DiskBufferPool::open_file(const char *file_name)
 
   file_header_ = (BPFileHeader *)hdr_frame_->data();
 
+  first_group_free_pages_ = 0;
+  Bitmap first_group_bitmap(file_header_->bitmap, BPFileHeader::FIRST_GROUP_PAGE_NUM);
+  for (int i = 0, exist_pages = group_exist_pages(0); i < exist_pages; i++) {
+    if (!first_group_bitmap.get_bit(i)) {
+      first_group_free_pages_++;
+    }
+  }
+
   LOG_INFO("Successfully open %s. file_desc=%d, hdr_frame=%p, file header=%s",
            file_name, file_desc_, hdr_frame_, file_header_->to_string().c_str());
   return RC::SUCCESS;
@@ -283,6 +481,11 @@ RC DiskBufferPool::close_file()
     return rc;
   }
 
+  // 预读任务会访问文件和页帧，要等它们都结束
+  while (pending_prefetch_.load() > 0) {
+    this_thread::sleep_for(chrono::milliseconds(1));
+  }
+
   hdr_frame_->unpin();
 
   // TODO: 理论上是在回放时回滚未提交事务，但目前没有undo log，因此不下刷数据page，只通过redo log回放
@@ -313,22 +516,41 @@ RC DiskBufferPool::close_file()
 
 RC DiskBufferPool::get_this_page(PageNum page_num, Frame **frame)
 {
-  RC rc  = RC::SUCCESS;
   *frame = nullptr;
 
   Frame *used_match_frame = frame_manager_.get(id(), page_num);
   if (used_match_frame != nullptr) {
     used_match_frame->access();
+    stat_.add(BufferPoolStatType::PAGE_HIT);
     *frame = used_match_frame;
     return RC::SUCCESS;
   }
 
   scoped_lock lock_guard(lock_);  // 直接加了一把大锁，其实可以根据访问的页面来细化提高并行度
+  return get_this_page_internal(page_num, frame);
+}
+
+RC DiskBufferPool::get_this_page_internal(PageNum page_num, Frame **frame)
+{
+  RC rc  = RC::SUCCESS;
+  *frame = nullptr;
+
+  // 在等待锁的时候，页面可能已经被其它线程或者预读加载了
+  Frame *used_match_frame = frame_manager_.get(id(), page_num);
+  if (used_match_frame != nullptr) {
+    used_match_frame->access();
+    stat_.add(BufferPoolStatType::PAGE_HIT);
+    *frame = used_match_frame;
+    return RC::SUCCESS;
+  }
+
+  stat_.add(BufferPoolStatType::PAGE_MISS);
 
   // Allocate one page and load the data into this page
+  // 页帧加着写锁放入页帧表，其它线程在数据加载完成之前拿到这个页帧会阻塞在页帧锁上
   Frame *allocated_frame = nullptr;
 
-  rc = allocate_frame(page_num, &allocated_frame);
+  rc = allocate_frame(page_num, &allocated_frame, true /*latch_new_frame*/);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to alloc frame %s:%d, due to failed to alloc page.", file_name_.c_str(), page_num);
     return rc;
@@ -338,7 +560,9 @@ RC DiskBufferPool::get_this_page(PageNum page_num, Frame **frame)
   // allocated_frame->pin(); // pined in manager::get
   allocated_frame->access();
 
-  if ((rc = load_page(page_num, allocated_frame)) != RC::SUCCESS) {
+  rc = load_page(page_num, allocated_frame);
+  allocated_frame->write_unlatch();
+  if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to load page %s:%d", file_name_.c_str(), page_num);
     purge_frame(page_num, allocated_frame);
     return rc;
@@ -354,35 +578,61 @@ RC DiskBufferPool::allocate_page(Frame **frame)
 
   lock_.lock();
 
-  int byte = 0, bit = 0;
-  if ((file_header_->allocated_pages) < (file_header_->page_count)) {
-    // There is one free page
-    for (int i = 0; i < file_header_->page_count; i++) {
-      byte = i / 8;
-      bit  = i % 8;
-      if (((file_header_->bitmap[byte]) & (1 << bit)) == 0) {
-        (file_header_->allocated_pages)++;
-        file_header_->bitmap[byte] |= (1 << bit);
-        // TODO,  do we need clean the loaded page's data?
-        hdr_frame_->mark_dirty();
-        LSN lsn = 0;
-        rc = log_handler_.allocate_page(i, lsn);
-        if (OB_FAIL(rc)) {
-          LOG_ERROR("Failed to log allocate page %d, rc=%s", i, strrc(rc));
-          // 忽略了错误
-        }
-
-        hdr_frame_->set_lsn(lsn);
-
-        LOG_DEBUG("allocate a new page without extend buffer pool. page num=%d, buffer pool=%d", i, id());
-
-        lock_.unlock();
-        return get_this_page(i, frame);
-      }
+  // 根据每组的空闲页面个数找到有空闲页面的组，只需要在这一组的位图中查找
+  for (int group = 0, group_num = group_count(); group < group_num; group++) {
+    if (group_free_pages(group) <= 0) {
+      continue;
     }
+
+    Frame *bitmap_frame = nullptr;
+    Bitmap bitmap;
+    rc = get_group_bitmap(group, bitmap_frame, bitmap);
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to get bitmap of group %d. file=%s, rc=%s", group, file_name_.c_str(), strrc(rc));
+      lock_.unlock();
+      return rc;
+    }
+
+    int index = bitmap.next_unsetted_bit(0);
+    if (index < 0) {
+      LOG_WARN("no free page in group %d, but the free page number is %d. file=%s",
+               group, group_free_pages(group), file_name_.c_str());
+      put_group_bitmap(group, bitmap_frame);
+      continue;
+    }
+
+    PageNum page_num = group_start_page(group) + index;
+    LSN     lsn      = 0;
+    rc = log_handler_.allocate_page(page_num, lsn);
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to log allocate page %d, rc=%s", page_num, strrc(rc));
+      // 忽略了错误
+    }
+
+    // TODO,  do we need clean the loaded page's data?
+    bitmap.set_bit(index);
+    bitmap_frame->set_lsn(lsn);
+    bitmap_frame->mark_dirty();
+    put_group_bitmap(group, bitmap_frame);
+
+    file_header_->allocated_pages++;
+    add_group_free_pages(group, -1);
+    hdr_frame_->set_lsn(lsn);
+    hdr_frame_->mark_dirty();
+
+    LOG_DEBUG("allocate a new page without extend buffer pool. page num=%d, buffer pool=%d", page_num, id());
+
+    lock_.unlock();
+    return get_this_page(page_num, frame);
+  }
+
+  // 扩展文件。如果下一个页面是新的一组的位图页，就先创建这一组
+  PageNum page_num = file_header_->page_count;
+  if (is_bitmap_page(page_num)) {
+    page_num++;
   }
 
-  if (file_header_->page_count >= BPFileHeader::MAX_PAGE_NUM) {
+  if (page_num >= BPFileHeader::MAX_PAGE_NUM) {
     LOG_WARN("file buffer pool is full. page count %d, max page count %d",
         file_header_->page_count, BPFileHeader::MAX_PAGE_NUM);
     lock_.unlock();
@@ -390,17 +640,32 @@ RC DiskBufferPool::allocate_page(Frame **frame)
   }
 
   LSN lsn = 0;
-  rc = log_handler_.allocate_page(file_header_->page_count, lsn);
+  rc = log_handler_.allocate_page(page_num, lsn);
   if (OB_FAIL(rc)) {
-    LOG_ERROR("Failed to log allocate page %d, rc=%s", file_header_->page_count, strrc(rc));
+    LOG_ERROR("Failed to log allocate page %d, rc=%s", page_num, strrc(rc));
     // 忽略了错误
   }
   hdr_frame_->set_lsn(lsn);
 
-  PageNum page_num        = file_header_->page_count;
-  Frame  *allocated_frame = nullptr;
+  const int group = page_group(page_num);
+  if (page_num != file_header_->page_count && OB_FAIL(rc = create_group(group, lsn))) {
+    LOG_ERROR("Failed to create page group %d. file=%s, rc=%s", group, file_name_.c_str(), strrc(rc));
+    lock_.unlock();
+    return rc;
+  }
+
+  Frame *bitmap_frame = nullptr;
+  Bitmap bitmap;
+  if (OB_FAIL(rc = get_group_bitmap(group, bitmap_frame, bitmap))) {
+    LOG_ERROR("Failed to get bitmap of group %d. file=%s, rc=%s", group, file_name_.c_str(), strrc(rc));
+    lock_.unlock();
+    return rc;
+  }
+
+  Frame *allocated_frame = nullptr;
   if ((rc = allocate_frame(page_num, &allocated_frame)) != RC::SUCCESS) {
     LOG_ERROR("Failed to allocate frame %s, due to no free page.", file_name_.c_str());
+    put_group_bitmap(group, bitmap_frame);
     lock_.unlock();
     return rc;
   }
@@ -410,16 +675,17 @@ RC DiskBufferPool::allocate_page(Frame **frame)
 
   file_header_->allocated_pages++;
   file_header_->page_count++;
-
-  byte = page_num / 8;
-  bit  = page_num % 8;
-  file_header_->bitmap[byte] |= (1 << bit);
   hdr_frame_->mark_dirty();
 
+  bitmap.set_bit(page_num - group_start_page(group));
+  bitmap_frame->set_lsn(lsn);
+  bitmap_frame->mark_dirty();
+  put_group_bitmap(group, bitmap_frame);
+
   allocated_frame->set_buffer_pool_id(id());
   allocated_frame->access();
   allocated_frame->clear_page();
-  allocated_frame->set_page_num(file_header_->page_count - 1);
+  allocated_frame->set_page_num(page_num);
 
   // Use flush operation to extension file
   if ((rc = flush_page_internal(*allocated_frame)) != RC::SUCCESS) {
@@ -436,32 +702,54 @@ RC DiskBufferPool::allocate_page(Frame **frame)
 
 RC DiskBufferPool::dispose_page(PageNum page_num)
 {
-  if (page_num == 0) {
-    LOG_ERROR("Failed to dispose page %d, because it is the first page. filename=%s", page_num, file_name_.c_str());
+  if (page_num == 0 || is_bitmap_page(page_num)) {
+    LOG_ERROR("Failed to dispose page %d, because it is the header or a bitmap page. filename=%s",
+              page_num, file_name_.c_str());
     return RC::INTERNAL;
   }
   
   scoped_lock lock_guard(lock_);
+  if (page_num >= file_header_->page_count) {
+    LOG_ERROR("Failed to dispose page %d, because it does not exist. filename=%s, page count=%d",
+              page_num, file_name_.c_str(), file_header_->page_count);
+    return RC::BUFFERPOOL_INVALID_PAGE_NUM;
+  }
+
   Frame           *used_frame = frame_manager_.get(id(), page_num);
   if (used_frame != nullptr) {
-    ASSERT("the page try to dispose is in use. frame:%s", used_frame->to_string().c_str());
-    frame_manager_.free(id(), page_num, used_frame);
+    // B+树的乐观读可能还pin着这个页面，读者校验版本号时会发现页面已经变了
+    if (frame_manager_.try_free(id(), page_num, used_frame) != RC::SUCCESS) {
+      LOG_DEBUG("page is still pinned while disposing it. frame=%s", used_frame->to_string().c_str());
+    }
   } else {
     LOG_DEBUG("page not found in memory while disposing it. pageNum=%d", page_num);
   }
 
+  const int group        = page_group(page_num);
+  Frame    *bitmap_frame = nullptr;
+  Bitmap    bitmap;
+  RC        rc = get_group_bitmap(group, bitmap_frame, bitmap);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to get bitmap of group %d. file=%s, rc=%s", group, file_name_.c_str(), strrc(rc));
+    return rc;
+  }
+
   LSN lsn = 0;
-  RC rc = log_handler_.deallocate_page(page_num, lsn);
+  rc = log_handler_.deallocate_page(page_num, lsn);
   if (OB_FAIL(rc)) {
     LOG_ERROR("Failed to log deallocate page %d, rc=%s", page_num, strrc(rc));
     // ignore error handle
   }
 
+  bitmap.clear_bit(page_num - group_start_page(group));
+  bitmap_frame->set_lsn(lsn);
+  bitmap_frame->mark_dirty();
+  put_group_bitmap(group, bitmap_frame);
+
   hdr_frame_->set_lsn(lsn);
   hdr_frame_->mark_dirty();
   file_header_->allocated_pages--;
-  char tmp = 1 << (page_num % 8);
-  file_header_->bitmap[page_num / 8] &= ~tmp;
+  add_group_free_pages(group, 1);
   return RC::SUCCESS;
 }
 
@@ -553,7 +841,7 @@ RC DiskBufferPool::flush_page_internal(Frame &frame)
     // ignore error handle
   }
 
-  frame.set_check_sum(crc32(frame.page().data, BP_PAGE_DATA_SIZE));
+  frame.set_check_sum(page_check_sum(frame.page()));
 
   rc = dblwr_manager_.add_page(this, frame.page_num(), frame.page());
   if (OB_FAIL(rc)) {
@@ -561,6 +849,7 @@ RC DiskBufferPool::flush_page_internal(Frame &frame)
   }
 
   frame.clear_dirty();
+  stat_.add(BufferPoolStatType::DIRTY_FLUSH);
   LOG_DEBUG("Flush block. file desc=%d, frame=%s", file_desc_, frame.to_string().c_str());
 
   return RC::SUCCESS;
@@ -580,118 +869,356 @@ RC DiskBufferPool::flush_all_pages()
   return RC::SUCCESS;
 }
 
-RC DiskBufferPool::recover_page(PageNum page_num)
+RC DiskBufferPool::flush_dirty_pages(LSN &min_recovery_lsn)
+{
+  RC            rc   = RC::SUCCESS;
+  list<Frame *> used = frame_manager_.find_list(id());
+  for (Frame *frame : used) {
+    if (OB_SUCC(rc) && frame->dirty()) {
+      // 加读锁，避免刷新到一半的时候页面被修改，导致修改丢失
+      frame->read_latch();
+      if (frame->dirty()) {
+        rc = flush_page(*frame);
+      }
+      frame->read_unlatch();
+    }
+  }
+
+  // 刷新的时候其它线程仍然可能修改页面
+  for (Frame *frame : used) {
+    LSN recovery_lsn = frame->recovery_lsn();
+    if (frame->dirty() && recovery_lsn > 0 && (min_recovery_lsn == 0 || recovery_lsn < min_recovery_lsn)) {
+      min_recovery_lsn = recovery_lsn;
+    }
+    frame->unpin();
+  }
+
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to flush dirty pages. file=%s, rc=%s", file_name_.c_str(), strrc(rc));
+  }
+  return rc;
+}
+
+RC DiskBufferPool::sync_file()
 {
-  int byte = 0, bit = 0;
-  byte = page_num / 8;
-  bit  = page_num % 8;
+  if (fdatasync(file_desc_) != 0) {
+    LOG_ERROR("Failed to sync file %s due to %s.", file_name_.c_str(), strerror(errno));
+    return RC::IOERR_SYNC;
+  }
+  return RC::SUCCESS;
+}
 
+RC DiskBufferPool::recover_page(PageNum page_num)
+{
   scoped_lock lock_guard(lock_);
-  if (!(file_header_->bitmap[byte] & (1 << bit))) {
-    file_header_->bitmap[byte] |= (1 << bit);
+  if (page_num >= file_header_->page_count || is_bitmap_page(page_num)) {
+    LOG_WARN("cannot recover page %d. file=%s, page count=%d", page_num, file_name_.c_str(), file_header_->page_count);
+    return RC::BUFFERPOOL_INVALID_PAGE_NUM;
+  }
+
+  const int group        = page_group(page_num);
+  Frame    *bitmap_frame = nullptr;
+  Bitmap    bitmap;
+  RC        rc = get_group_bitmap(group, bitmap_frame, bitmap);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  const int index = page_num - group_start_page(group);
+  if (!bitmap.get_bit(index)) {
+    bitmap.set_bit(index);
+    bitmap_frame->mark_dirty();
     file_header_->allocated_pages++;
-    file_header_->page_count++;
+    add_group_free_pages(group, -1);
     hdr_frame_->mark_dirty();
   }
+  put_group_bitmap(group, bitmap_frame);
   return RC::SUCCESS;
 }
 
 RC DiskBufferPool::write_page(PageNum page_num, Page &page)
 {
-  scoped_lock lock_guard(wr_lock_);
-  int64_t     offset = ((int64_t)page_num) * sizeof(Page);
-  if (lseek(file_desc_, offset, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to write page %lld of %d due to failed to seek %s.", offset, file_desc_, strerror(errno));
-    return RC::IOERR_SEEK;
-  }
-
-  if (writen(file_desc_, &page, sizeof(Page)) != 0) {
+  // double write buffer 中的页面没有对齐，直接IO时由 pwriten 复制到对齐的内存中再写入
+  int64_t offset = ((int64_t)page_num) * sizeof(Page);
+  if (pwriten(file_desc_, &page, sizeof(Page), offset, io_alignment()) != 0) {
     LOG_ERROR("Failed to write page %lld of %d due to %s.", offset, file_desc_, strerror(errno));
     return RC::IOERR_WRITE;
   }
 
+  stat_.add(BufferPoolStatType::PAGE_WRITE);
   LOG_TRACE("write_page: buffer_pool_id:%d, page_num:%d, lsn=%d, check_sum=%d", id(), page_num, page.lsn, page.check_sum);
   return RC::SUCCESS;
 }
 
 RC DiskBufferPool::redo_allocate_page(LSN lsn, PageNum page_num)
 {
-  if (hdr_frame_->lsn() >= lsn) {
-    return RC::SUCCESS;
+  if (page_num <= 0 || page_num >= BPFileHeader::MAX_PAGE_NUM || is_bitmap_page(page_num)) {
+    LOG_WARN("invalid page %d to allocate. file=%s", page_num, file_name_.c_str());
+    return RC::INTERNAL;
   }
 
-  // scoped_lock lock_guard(lock_); // redo 过程中可以不加锁
-  if (page_num < file_header_->page_count) {
-    Bitmap bitmap(file_header_->bitmap, file_header_->page_count);
-    if (bitmap.get_bit(page_num)) {
-      LOG_WARN("page %d has been allocated. file=%s", page_num, file_name_.c_str());
-      return RC::SUCCESS;
+  // 并行回放时其它线程会同时加载数据页面
+  scoped_lock lock_guard(lock_);
+
+  // 文件头页和位图页分别写入磁盘，各自根据自己的LSN判断是否需要重做
+  const int group = page_group(page_num);
+  if (hdr_frame_->lsn() < lsn) {
+    const PageNum page_count = file_header_->page_count;
+    if (page_num < page_count) {
+      add_group_free_pages(group, -1);
+    } else {
+      // 扩展文件时，只有新的一组的位图页会被跳过
+      const PageNum expect_page_num = is_bitmap_page(page_count) ? page_count + 1 : page_count;
+      if (page_num != expect_page_num) {
+        LOG_WARN("page %d is not continuous. file=%s, page_count=%d", page_num, file_name_.c_str(), page_count);
+        return RC::INTERNAL;
+      }
+
+      if (page_num != page_count) {
+        file_header_->allocated_pages++;
+        file_header_->group_free_pages[group - 1] = 0;
+      }
+      // TODO 应该检查文件是否足够大，包含了当前新分配的页面
+      file_header_->page_count = page_num + 1;
     }
 
-    bitmap.set_bit(page_num);
     file_header_->allocated_pages++;
+    if (group == 0) {
+      Bitmap(file_header_->bitmap, BPFileHeader::FIRST_GROUP_PAGE_NUM).set_bit(page_num);
+    }
+    hdr_frame_->set_lsn(lsn);
     hdr_frame_->mark_dirty();
+  }
+
+  if (group == 0) {
+    LOG_TRACE("[redo] allocate page. file=%s, pageNum=%d", file_name_.c_str(), page_num);
     return RC::SUCCESS;
   }
 
-  if (page_num > file_header_->page_count) {
-    LOG_WARN("page %d is not continuous. file=%s, page_count=%d",
-             page_num, file_name_.c_str(), file_header_->page_count);
+  Frame *bitmap_frame = nullptr;
+  Bitmap bitmap;
+  RC     rc = get_group_bitmap(group, bitmap_frame, bitmap, true /*create*/);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get bitmap of group %d. file=%s, rc=%s", group, file_name_.c_str(), strrc(rc));
+    return rc;
+  }
+
+  if (bitmap_frame->lsn() < lsn) {
+    bitmap.set_bit(page_num - group_start_page(group));
+    bitmap_frame->set_lsn(lsn);
+    bitmap_frame->mark_dirty();
+  }
+  put_group_bitmap(group, bitmap_frame);
+  LOG_TRACE("[redo] allocate page. file=%s, pageNum=%d", file_name_.c_str(), page_num);
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::redo_deallocate_page(LSN lsn, PageNum page_num)
+{
+  if (page_num <= 0 || is_bitmap_page(page_num)) {
+    LOG_WARN("invalid page %d to deallocate. file=%s", page_num, file_name_.c_str());
     return RC::INTERNAL;
   }
 
-  // page_num == file_header_->page_count
-  if (file_header_->page_count >= BPFileHeader::MAX_PAGE_NUM) {
-    LOG_WARN("file buffer pool is full. page count %d, max page count %d",
-        file_header_->page_count, BPFileHeader::MAX_PAGE_NUM);
+  scoped_lock lock_guard(lock_);
+  if (page_num >= file_header_->page_count) {
+    LOG_WARN("page %d is not exist. file=%s", page_num, file_name_.c_str());
     return RC::INTERNAL;
   }
 
-  file_header_->allocated_pages++;
-  file_header_->page_count++;
-  hdr_frame_->set_lsn(lsn);
-  hdr_frame_->mark_dirty();
-  
-  // TODO 应该检查文件是否足够大，包含了当前新分配的页面
+  const int group = page_group(page_num);
+  if (hdr_frame_->lsn() < lsn) {
+    if (group == 0) {
+      Bitmap bitmap(file_header_->bitmap, BPFileHeader::FIRST_GROUP_PAGE_NUM);
+      if (!bitmap.get_bit(page_num)) {
+        LOG_WARN("page %d has been deallocated. file=%s", page_num, file_name_.c_str());
+        return RC::INTERNAL;
+      }
+      bitmap.clear_bit(page_num);
+    }
+
+    file_header_->allocated_pages--;
+    add_group_free_pages(group, 1);
+    hdr_frame_->set_lsn(lsn);
+    hdr_frame_->mark_dirty();
+  }
+
+  if (group != 0) {
+    Frame *bitmap_frame = nullptr;
+    Bitmap bitmap;
+    RC     rc = get_group_bitmap(group, bitmap_frame, bitmap, true /*create*/);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get bitmap of group %d. file=%s, rc=%s", group, file_name_.c_str(), strrc(rc));
+      return rc;
+    }
+
+    if (bitmap_frame->lsn() < lsn) {
+      bitmap.clear_bit(page_num - group_start_page(group));
+      bitmap_frame->set_lsn(lsn);
+      bitmap_frame->mark_dirty();
+    }
+    put_group_bitmap(group, bitmap_frame);
+  }
 
-  Bitmap bitmap(file_header_->bitmap, file_header_->page_count);
-  bitmap.set_bit(page_num);
-  LOG_TRACE("[redo] allocate new page. file=%s, pageNum=%d", file_name_.c_str(), page_num);
+  LOG_TRACE("[redo] deallocate page. file=%s, pageNum=%d", file_name_.c_str(), page_num);
   return RC::SUCCESS;
 }
 
-RC DiskBufferPool::redo_deallocate_page(LSN lsn, PageNum page_num)
+PageNum DiskBufferPool::next_allocated_page(PageNum start_page)
+{
+  scoped_lock lock_guard(lock_);
+  return next_allocated_page_internal(start_page);
+}
+
+PageNum DiskBufferPool::next_allocated_page_internal(PageNum start_page)
+{
+  start_page = max(start_page, 0);
+  for (int group = page_group(start_page), group_num = group_count(); group < group_num; group++) {
+    Frame *bitmap_frame = nullptr;
+    Bitmap bitmap;
+    RC     rc = get_group_bitmap(group, bitmap_frame, bitmap);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get bitmap of group %d. file=%s, rc=%s", group, file_name_.c_str(), strrc(rc));
+      return -1;
+    }
+
+    // 位图页自己对应的位总是1，要跳过
+    const PageNum start_in_group = max(start_page - group_start_page(group), group == 0 ? 0 : 1);
+    const int     index          = bitmap.next_setted_bit(start_in_group);
+    put_group_bitmap(group, bitmap_frame);
+    if (index >= 0) {
+      return group_start_page(group) + index;
+    }
+  }
+  return -1;
+}
+
+bool DiskBufferPool::is_bitmap_page(PageNum page_num)
+{
+  return page_num >= BPFileHeader::FIRST_GROUP_PAGE_NUM &&
+         (page_num - BPFileHeader::FIRST_GROUP_PAGE_NUM) % BPFileHeader::GROUP_PAGE_NUM == 0;
+}
+
+int DiskBufferPool::page_group(PageNum page_num)
+{
+  if (page_num < BPFileHeader::FIRST_GROUP_PAGE_NUM) {
+    return 0;
+  }
+  return 1 + (page_num - BPFileHeader::FIRST_GROUP_PAGE_NUM) / BPFileHeader::GROUP_PAGE_NUM;
+}
+
+PageNum DiskBufferPool::group_start_page(int group)
 {
-  if (hdr_frame_->lsn() >= lsn) {
+  if (group == 0) {
+    return 0;
+  }
+  return BPFileHeader::FIRST_GROUP_PAGE_NUM + (group - 1) * BPFileHeader::GROUP_PAGE_NUM;
+}
+
+int DiskBufferPool::group_count() const { return page_group(file_header_->page_count - 1) + 1; }
+
+int DiskBufferPool::group_exist_pages(int group) const
+{
+  const int group_page_num = group == 0 ? BPFileHeader::FIRST_GROUP_PAGE_NUM : BPFileHeader::GROUP_PAGE_NUM;
+  return max(min(group_page_num, file_header_->page_count - group_start_page(group)), 0);
+}
+
+int DiskBufferPool::group_free_pages(int group) const
+{
+  return group == 0 ? first_group_free_pages_ : file_header_->group_free_pages[group - 1];
+}
+
+void DiskBufferPool::add_group_free_pages(int group, int delta)
+{
+  if (group == 0) {
+    first_group_free_pages_ += delta;
+  } else {
+    file_header_->group_free_pages[group - 1] += delta;
+  }
+}
+
+RC DiskBufferPool::get_group_bitmap(int group, Frame *&frame, Bitmap &bitmap, bool create /* = false */)
+{
+  if (group == 0) {
+    frame = hdr_frame_;
+    bitmap.init(file_header_->bitmap, group_exist_pages(group));
     return RC::SUCCESS;
   }
 
-  if (page_num >= file_header_->page_count) {
-    LOG_WARN("page %d is not exist. file=%s", page_num, file_name_.c_str());
-    return RC::INTERNAL;
+  const PageNum page_num = group_start_page(group);
+
+  // 回放日志时，文件头中已经有了这一组，但是位图页可能还没有写到文件中
+  struct stat st;
+  if (create && frame_manager_.contains(id(), page_num) == false && fstat(file_desc_, &st) == 0 &&
+      st.st_size < static_cast<off_t>(page_num + 1) * BP_PAGE_SIZE) {
+    RC rc = allocate_frame(page_num, &frame);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    frame->set_buffer_pool_id(id());
+    frame->clear_page();
+  } else {
+    RC rc = get_this_page_internal(page_num, &frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get bitmap page %d. file=%s, rc=%s", page_num, file_name_.c_str(), strrc(rc));
+      return rc;
+    }
   }
 
-  Bitmap bitmap(file_header_->bitmap, file_header_->page_count);
-  if (!bitmap.get_bit(page_num)) {
-    LOG_WARN("page %d has been deallocated. file=%s", page_num, file_name_.c_str());
-    return RC::INTERNAL;
+  bitmap.init(frame->data(), group_exist_pages(group));
+  if (!bitmap.get_bit(0)) {
+    // 新创建的位图页，或者文件中还没有写入的空洞
+    ASSERT(create, "bitmap page is invalid. file=%s, page num=%d", file_name_.c_str(), page_num);
+    bitmap.set_bit(0);
+    frame->mark_dirty();
   }
+  return RC::SUCCESS;
+}
 
-  bitmap.clear_bit(page_num);
-  file_header_->allocated_pages--;
-  hdr_frame_->set_lsn(lsn);
+void DiskBufferPool::put_group_bitmap(int group, Frame *frame)
+{
+  if (group != 0) {
+    frame->unpin();
+  }
+}
+
+RC DiskBufferPool::create_group(int group, LSN lsn)
+{
+  const PageNum page_num = group_start_page(group);
+  ASSERT(page_num == file_header_->page_count, "group should be created at the end of file. group=%d, page count=%d",
+         group, file_header_->page_count);
+
+  Frame *frame = nullptr;
+  RC     rc    = allocate_frame(page_num, &frame);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  frame->set_buffer_pool_id(id());
+  frame->clear_page();
+  Bitmap(frame->data(), 1).set_bit(0);
+  frame->set_lsn(lsn);
+  frame->mark_dirty();
+  frame->unpin();
+
+  file_header_->page_count++;
+  file_header_->allocated_pages++;
+  file_header_->group_free_pages[group - 1] = 0;
   hdr_frame_->mark_dirty();
-  LOG_TRACE("[redo] deallocate page. file=%s, pageNum=%d", file_name_.c_str(), page_num);
+  LOG_INFO("create page group %d. file=%s, bitmap page=%d", group, file_name_.c_str(), page_num);
   return RC::SUCCESS;
 }
 
-RC DiskBufferPool::allocate_frame(PageNum page_num, Frame **buffer)
+RC DiskBufferPool::allocate_frame(PageNum page_num, Frame **buffer, bool latch_new_frame /* = false */)
 {
   auto purger = [this](Frame *frame) {
     if (!frame->dirty()) {
       return RC::SUCCESS;
     }
 
+    // 前台线程不得不自己刷脏页，说明清理线程跟不上了
+    bp_manager_.wakeup_page_cleaner();
+
     RC rc = RC::SUCCESS;
     if (frame->buffer_pool_id() == id()) {
       rc = this->flush_page_internal(*frame);
@@ -706,7 +1233,7 @@ RC DiskBufferPool::allocate_frame(PageNum page_num, Frame **buffer)
   };
 
   while (true) {
-    Frame *frame = frame_manager_.alloc(id(), page_num);
+    Frame *frame = frame_manager_.alloc(id(), page_num, latch_new_frame);
     if (frame != nullptr) {
       *buffer = frame;
       LOG_DEBUG("allocate frame %p, page num %d, frame=%s", frame, page_num, frame->to_string().c_str());
@@ -714,18 +1241,23 @@ RC DiskBufferPool::allocate_frame(PageNum page_num, Frame **buffer)
     }
 
     LOG_TRACE("frames are all allocated, so we should purge some frames to get one free frame");
-    (void)frame_manager_.purge_frames(1 /*count*/, purger);
+    int purged_count = frame_manager_.purge_frames(1 /*count*/, purger);
+    if (purged_count > 0) {
+      stat_.add(BufferPoolStatType::EVICT, purged_count);
+    } else {
+      stat_.add(BufferPoolStatType::PIN_WAIT);
+    }
   }
   return RC::BUFFERPOOL_NOBUF;
 }
 
 RC DiskBufferPool::check_page_num(PageNum page_num)
 {
-  if (page_num >= file_header_->page_count) {
+  if (page_num >= file_header_->page_count || is_bitmap_page(page_num)) {
     LOG_ERROR("Invalid pageNum:%d, file's name:%s", page_num, file_name_.c_str());
     return RC::BUFFERPOOL_INVALID_PAGE_NUM;
   }
-  if ((file_header_->bitmap[page_num / 8] & (1 << (page_num % 8))) == 0) {
+  if (next_allocated_page_internal(page_num) != page_num) {
     LOG_ERROR("Invalid pageNum:%d, file's name:%s", page_num, file_name_.c_str());
     return RC::BUFFERPOOL_INVALID_PAGE_NUM;
   }
@@ -740,21 +1272,21 @@ RC DiskBufferPool::load_page(PageNum page_num, Frame *frame)
     return rc;
   }
 
-  scoped_lock lock_guard(wr_lock_);
-  int64_t          offset = ((int64_t)page_num) * BP_PAGE_SIZE;
-  if (lseek(file_desc_, offset, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to load page %s:%d, due to failed to lseek:%s.", file_name_.c_str(), page_num, strerror(errno));
-
-    return RC::IOERR_SEEK;
-  }
+  const auto start_time = chrono::steady_clock::now();
 
-  int ret = readn(file_desc_, &page, BP_PAGE_SIZE);
+  int64_t offset = ((int64_t)page_num) * BP_PAGE_SIZE;
+  int     ret    = preadn(file_desc_, &page, BP_PAGE_SIZE, offset, io_alignment());
+  record_read(1, start_time);
   if (ret != 0) {
     LOG_ERROR("Failed to load page %s, file_desc:%d, page num:%d, due to failed to read data:%s, ret=%d, page count=%d",
               file_name_.c_str(), file_desc_, page_num, strerror(errno), ret, file_header_->allocated_pages);
     return RC::IOERR_READ;
   }
 
+  if (!verify_page(page_num, page)) {
+    return RC::BUFFERPOOL_PAGE_CORRUPTED;
+  }
+
   frame->set_page_num(page_num);
 
   LOG_DEBUG("Load page %s:%d, file_desc:%d, frame=%s",
@@ -762,22 +1294,201 @@ RC DiskBufferPool::load_page(PageNum page_num, Frame *frame)
   return RC::SUCCESS;
 }
 
+bool DiskBufferPool::verify_page(PageNum page_num, const Page &page) const
+{
+  if (!bp_manager_.verify_checksum() || page_check_sum_valid(page)) {
+    return true;
+  }
+
+  LOG_ERROR("Page is corrupted or partially written. file=%s, page num=%d, lsn=%ld, check sum=%u, expect=%u",
+            file_name_.c_str(), page_num, page.lsn, page.check_sum, page_check_sum(page));
+  return false;
+}
+
+RC DiskBufferPool::load_pages(span<Frame *> frames)
+{
+  vector<iovec> iovs(frames.size());
+  for (size_t i = 0; i < frames.size(); i++) {
+    iovs[i].iov_base = &frames[i]->page();
+    iovs[i].iov_len  = BP_PAGE_SIZE;
+  }
+
+  const PageNum start_page = frames.front()->page_num();
+  const int64_t offset     = static_cast<int64_t>(start_page) * BP_PAGE_SIZE;
+  const ssize_t expect     = static_cast<ssize_t>(frames.size()) * BP_PAGE_SIZE;
+
+  // 页帧中的页面内存都是对齐的，直接IO时也可以使用 preadv
+  const auto start_time = chrono::steady_clock::now();
+  ssize_t    ret        = preadv(file_desc_, iovs.data(), static_cast<int>(iovs.size()), offset);
+  record_read(static_cast<int>(frames.size()), start_time);
+  if (ret != expect) {
+    LOG_WARN("failed to read pages. file=%s, start page=%d, page num=%d, ret=%ld, error=%s",
+             file_name_.c_str(), start_page, static_cast<int>(frames.size()), ret, strerror(errno));
+    return RC::IOERR_READ;
+  }
+
+  LOG_DEBUG("load pages %s:[%d, %d)", file_name_.c_str(), start_page, start_page + static_cast<int>(frames.size()));
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::prefetch_pages(PageNum start_page, int page_count)
+{
+  ThreadPoolExecutor *executor = bp_manager_.get_prefetch_executor();
+  if (executor == nullptr || page_count <= 0) {
+    return RC::SUCCESS;
+  }
+
+  pending_prefetch_.fetch_add(1);
+  int ret = executor->execute([this, start_page, page_count]() {
+    do_prefetch(start_page, page_count);
+    pending_prefetch_.fetch_sub(1);
+  });
+  if (ret != 0) {
+    pending_prefetch_.fetch_sub(1);
+    LOG_WARN("failed to submit prefetch task. file=%s, start page=%d, ret=%d", file_name_.c_str(), start_page, ret);
+    return RC::INTERNAL;
+  }
+  return RC::SUCCESS;
+}
+
+int DiskBufferPool::read_ahead_page_num() const
+{
+  return bp_manager_.get_prefetch_executor() == nullptr ? 0 : bp_manager_.read_ahead_page_num();
+}
+
+RC DiskBufferPool::clean_page(PageNum page_num, bool &flushed)
+{
+  flushed = false;
+
+  // 持有 lock_ 时 pin 住页帧，不会和 dispose_page、purge_page 冲突
+  scoped_lock lock_guard(lock_);
+  Frame *frame = frame_manager_.get(id(), page_num, false /*access*/);
+  if (frame == nullptr) {
+    return RC::SUCCESS;
+  }
+
+  RC rc = RC::SUCCESS;
+  if (frame->dirty() && frame->try_read_latch()) {
+    if (frame->dirty()) {
+      rc      = flush_page_internal(*frame);
+      flushed = OB_SUCC(rc);
+    }
+    frame->read_unlatch();
+  }
+  frame->unpin();
+  return rc;
+}
+
+void DiskBufferPool::do_prefetch(PageNum start_page, int page_count)
+{
+  // 预读的页面在加载完成之前一直是pin住的，不能占用太多页帧，否则正常的读取就没有页帧可以用了
+  page_count = min(page_count, max(static_cast<int>(frame_manager_.total_frame_num() / 4), 1));
+
+  vector<Frame *> frames;
+  {
+    scoped_lock lock_guard(lock_);
+
+    const PageNum end_page = min(start_page + page_count, file_header_->page_count);
+    for (PageNum page_num = next_allocated_page_internal(start_page); page_num >= 0 && page_num < end_page;
+         page_num = next_allocated_page_internal(page_num + 1)) {
+      if (frame_manager_.contains(id(), page_num)) {
+        continue;
+      }
+
+      Frame *frame = nullptr;
+      if (OB_FAIL(allocate_frame(page_num, &frame, true /*latch_new_frame*/))) {
+        break;
+      }
+      frame->set_buffer_pool_id(id());
+      frames.push_back(frame);
+    }
+  }
+
+  // 页面可能还在 double write buffer 中没有写到磁盘，要先从这里读。
+  // 先检查 double write buffer 再读磁盘：页面不在内存中，它最新的数据要么在 double write buffer 中，要么已经在磁盘上
+  vector<bool> loaded(frames.size(), false);
+  for (size_t i = 0; i < frames.size(); i++) {
+    loaded[i] = OB_SUCC(dblwr_manager_.read_page(this, frames[i]->page_num(), frames[i]->page()));
+  }
+
+  // 连续的页面使用一次系统调用读取，失败时再一个页面一个页面地读
+  for (size_t begin = 0; begin < frames.size();) {
+    if (loaded[begin]) {
+      begin++;
+      continue;
+    }
+
+    size_t end = begin + 1;
+    while (end < frames.size() && !loaded[end] && frames[end]->page_num() == frames[end - 1]->page_num() + 1) {
+      end++;
+    }
+
+    span<Frame *> run(frames.data() + begin, end - begin);
+    if (OB_SUCC(load_pages(run))) {
+      // 校验失败的页面不放在缓存中，正常读取时会再次读取并报告错误
+      for (size_t i = begin; i < end; i++) {
+        loaded[i] = verify_page(frames[i]->page_num(), frames[i]->page());
+      }
+    } else {
+      for (size_t i = begin; i < end; i++) {
+        loaded[i] = OB_SUCC(load_page(frames[i]->page_num(), frames[i]));
+      }
+    }
+    begin = end;
+  }
+
+  int failed_count = 0;
+  for (size_t i = 0; i < frames.size(); i++) {
+    Frame *frame = frames[i];
+    frame->write_unlatch();
+    if (loaded[i]) {
+      frame->unpin();
+      continue;
+    }
+
+    failed_count++;
+    scoped_lock lock_guard(lock_);
+    if (OB_FAIL(purge_frame(frame->page_num(), frame))) {
+      frame->unpin();
+    }
+  }
+
+  stat_.add(BufferPoolStatType::PREFETCH, frames.size() - failed_count);
+  LOG_DEBUG("prefetch pages done. file=%s, start page=%d, page count=%d, loaded=%d, failed=%d",
+            file_name_.c_str(), start_page, page_count, static_cast<int>(frames.size()) - failed_count, failed_count);
+}
+
+void DiskBufferPool::record_read(int page_count, chrono::steady_clock::time_point start_time)
+{
+  auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start_time);
+  stat_.add(BufferPoolStatType::PAGE_READ, page_count);
+  stat_.add(BufferPoolStatType::READ_TIME_US, elapsed.count());
+}
+
 int DiskBufferPool::file_desc() const { return file_desc_; }
 
 ////////////////////////////////////////////////////////////////////////////////
-BufferPoolManager::BufferPoolManager(int memory_size /* = 0 */)
+BufferPoolManager::BufferPoolManager(
+    int64_t memory_size /* = 0 */, FrameReplacerType replacer_type /* = LRU */, bool huge_page /* = false */)
 {
   if (memory_size <= 0) {
-    memory_size = MEM_POOL_ITEM_NUM * DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE;
+    memory_size = static_cast<int64_t>(MEM_POOL_ITEM_NUM) * DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE;
   }
-  const int pool_num = max(memory_size / BP_PAGE_SIZE / DEFAULT_ITEM_NUM_PER_POOL, 1);
-  frame_manager_.init(pool_num);
-  LOG_INFO("buffer pool manager init with memory size %d, page num: %d, pool num: %d",
-           memory_size, pool_num * DEFAULT_ITEM_NUM_PER_POOL, pool_num);
+  const int pool_num = static_cast<int>(max<int64_t>(memory_size / BP_PAGE_SIZE / DEFAULT_ITEM_NUM_PER_POOL, 1));
+  frame_manager_.init(pool_num, 0 /*shard_num*/, replacer_type, huge_page);
+  LOG_INFO("buffer pool manager init with memory size %ld, page num: %d, pool num: %d, replacer: %s, huge page: %d",
+           memory_size, pool_num * DEFAULT_ITEM_NUM_PER_POOL, pool_num, frame_replacer_type_name(replacer_type), huge_page);
 }
 
 BufferPoolManager::~BufferPoolManager()
 {
+  stop_page_cleaner();
+
+  if (prefetch_executor_) {
+    prefetch_executor_->shutdown();
+    prefetch_executor_->await_termination();
+  }
+
   unordered_map<string, DiskBufferPool *> tmp_bps;
   tmp_bps.swap(buffer_pools_);
 
@@ -792,6 +1503,26 @@ RC BufferPoolManager::init(unique_ptr<DoubleWriteBuffer> dblwr_buffer)
   return RC::SUCCESS;
 }
 
+RC BufferPoolManager::init_prefetch(int thread_num, int read_ahead_page_num)
+{
+  if (thread_num <= 0 || read_ahead_page_num <= 0) {
+    LOG_INFO("page prefetch is disabled. thread num=%d, read ahead page num=%d", thread_num, read_ahead_page_num);
+    return RC::SUCCESS;
+  }
+
+  auto executor = make_unique<ThreadPoolExecutor>();
+  int  ret      = executor->init("BPPrefetch", thread_num, thread_num, 60 * 1000 /*keep_alive_time_ms*/);
+  if (ret != 0) {
+    LOG_ERROR("failed to init prefetch thread pool. ret=%d", ret);
+    return RC::INTERNAL;
+  }
+
+  prefetch_executor_   = std::move(executor);
+  read_ahead_page_num_ = min(read_ahead_page_num, IOV_MAX);
+  LOG_INFO("page prefetch is enabled. thread num=%d, read ahead page num=%d", thread_num, read_ahead_page_num_);
+  return RC::SUCCESS;
+}
+
 RC BufferPoolManager::create_file(const char *file_name)
 {
   int fd = open(file_name, O_RDWR | O_CREAT | O_EXCL, S_IREAD | S_IWRITE);
@@ -821,6 +1552,7 @@ RC BufferPoolManager::create_file(const char *file_name)
 
   char *bitmap = file_header->bitmap;
   bitmap[0] |= 0x01;
+  page.check_sum = page_check_sum(page);
   if (lseek(fd, 0, SEEK_SET) == -1) {
     LOG_ERROR("Failed to seek file %s to position 0, due to %s .", file_name, strerror(errno));
     close(fd);
@@ -886,10 +1618,43 @@ RC BufferPoolManager::close_file(const char *_file_name)
   buffer_pools_.erase(iter);
   lock_.unlock();
 
+  // 页面清理线程可能正在使用这个缓冲池
+  lock_guard<mutex> clean_guard(clean_lock_);
   delete bp;
   return RC::SUCCESS;
 }
 
+RC BufferPoolManager::flush_dirty_pages(LSN &min_recovery_lsn)
+{
+  vector<DiskBufferPool *> buffer_pools;
+  lock_.lock();
+  for (auto &[id, buffer_pool] : id_to_buffer_pools_) {
+    buffer_pools.push_back(buffer_pool);
+  }
+  lock_.unlock();
+
+  min_recovery_lsn = 0;
+  for (DiskBufferPool *buffer_pool : buffer_pools) {
+    RC rc = buffer_pool->flush_dirty_pages(min_recovery_lsn);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC BufferPoolManager::sync_files()
+{
+  scoped_lock lock_guard(lock_);
+  for (auto &[id, buffer_pool] : id_to_buffer_pools_) {
+    RC rc = buffer_pool->sync_file();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
 RC BufferPoolManager::flush_page(Frame &frame)
 {
   int buffer_pool_id = frame.buffer_pool_id();
@@ -905,6 +1670,141 @@ RC BufferPoolManager::flush_page(Frame &frame)
   return bp->flush_page(frame);
 }
 
+RC BufferPoolManager::start_page_cleaner(int high_watermark, int low_watermark, chrono::milliseconds interval)
+{
+  if (interval.count() <= 0) {
+    LOG_INFO("page cleaner is disabled");
+    return RC::SUCCESS;
+  }
+
+  if (low_watermark < 0 || high_watermark > 100 || low_watermark > high_watermark) {
+    LOG_WARN("invalid dirty page watermarks. high=%d, low=%d", high_watermark, low_watermark);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  if (page_cleaner_) {
+    LOG_WARN("page cleaner has been started");
+    return RC::INTERNAL;
+  }
+
+  dirty_high_watermark_ = high_watermark;
+  dirty_low_watermark_  = low_watermark;
+  page_cleaner_running_ = true;
+  page_cleaner_         = make_unique<thread>([this, interval]() {
+    unique_lock<mutex> lock(page_cleaner_mutex_);
+    while (page_cleaner_running_) {
+      page_cleaner_cond_.wait_for(
+          lock, interval, [this]() { return !page_cleaner_running_ || page_cleaner_wakeup_; });
+      if (!page_cleaner_running_) {
+        break;
+      }
+
+      page_cleaner_wakeup_ = false;
+      lock.unlock();
+      page_cleaner_round();
+      lock.lock();
+    }
+  });
+
+  LOG_INFO("page cleaner started. high watermark=%d%%, low watermark=%d%%, interval=%ldms",
+           high_watermark, low_watermark, static_cast<long>(interval.count()));
+  return RC::SUCCESS;
+}
+
+void BufferPoolManager::stop_page_cleaner()
+{
+  if (!page_cleaner_) {
+    return;
+  }
+
+  {
+    lock_guard<mutex> lock(page_cleaner_mutex_);
+    page_cleaner_running_ = false;
+  }
+  page_cleaner_cond_.notify_all();
+  page_cleaner_->join();
+  page_cleaner_.reset();
+  LOG_INFO("page cleaner stopped");
+}
+
+void BufferPoolManager::wakeup_page_cleaner()
+{
+  if (!page_cleaner_) {
+    return;
+  }
+
+  {
+    lock_guard<mutex> lock(page_cleaner_mutex_);
+    page_cleaner_wakeup_ = true;
+  }
+  page_cleaner_cond_.notify_one();
+}
+
+void BufferPoolManager::page_cleaner_round()
+{
+  vector<pair<LSN, FrameId>> dirty_frames;
+  frame_manager_.find_dirty_list(dirty_frames);
+
+  const int total_num  = static_cast<int>(frame_manager_.total_frame_num());
+  const int dirty_num  = static_cast<int>(dirty_frames.size());
+  const int high_limit = total_num * dirty_high_watermark_ / 100;
+  const int low_limit  = total_num * dirty_low_watermark_ / 100;
+  if (dirty_num <= low_limit) {
+    return;
+  }
+
+  // 超过高水位时一直刷到低水位，否则只刷一批，避免和前台抢占IO
+  int count = dirty_num - low_limit;
+  if (dirty_num <= high_limit) {
+    count = min(count, PAGE_CLEANER_BATCH_SIZE);
+  }
+
+  int flushed_count = clean_pages(count);
+  LOG_DEBUG("page cleaner round done. total frames=%d, dirty frames=%d, flushed=%d",
+            total_num, dirty_num, flushed_count);
+}
+
+int BufferPoolManager::clean_pages(int count)
+{
+  vector<pair<LSN, FrameId>> dirty_frames;
+  frame_manager_.find_dirty_list(dirty_frames);
+
+  // recovery LSN 最小的页面最先刷新，这样检查点也能尽快推进
+  auto lsn_less = [](const pair<LSN, FrameId> &a, const pair<LSN, FrameId> &b) { return a.first < b.first; };
+  if (count < static_cast<int>(dirty_frames.size())) {
+    partial_sort(dirty_frames.begin(), dirty_frames.begin() + count, dirty_frames.end(), lsn_less);
+    dirty_frames.resize(count);
+  } else {
+    sort(dirty_frames.begin(), dirty_frames.end(), lsn_less);
+  }
+
+  lock_guard<mutex> clean_guard(clean_lock_);
+
+  unordered_map<int32_t, DiskBufferPool *> buffer_pools;
+  lock_.lock();
+  buffer_pools = id_to_buffer_pools_;
+  lock_.unlock();
+
+  int flushed_count = 0;
+  for (const auto &[recovery_lsn, frame_id] : dirty_frames) {
+    auto iter = buffer_pools.find(frame_id.buffer_pool_id());
+    if (iter == buffer_pools.end()) {
+      continue;
+    }
+
+    bool flushed = false;
+    RC   rc      = iter->second->clean_page(frame_id.page_num(), flushed);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to clean page. frame id=%s, rc=%s", frame_id.to_string().c_str(), strrc(rc));
+      break;
+    }
+    if (flushed) {
+      flushed_count++;
+    }
+  }
+  return flushed_count;
+}
+
 RC BufferPoolManager::get_buffer_pool(int32_t id, DiskBufferPool *&bp)
 {
   bp = nullptr;
@@ -921,3 +1821,16 @@ RC BufferPoolManager::get_buffer_pool(int32_t id, DiskBufferPool *&bp)
   return RC::SUCCESS;
 }
 
+void BufferPoolManager::collect_stats(vector<pair<string, BufferPoolStat::Values>> &stats)
+{
+  stats.clear();
+
+  scoped_lock lock_guard(lock_);
+  for (auto &[file_name, bp] : buffer_pools_) {
+    BufferPoolStat::Values values{};
+    bp->stat().collect(values);
+    stats.emplace_back(file_name, values);
+  }
+  sort(stats.begin(), stats.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+}
+
@@ -25,16 +25,25 @@ See the Mulan PSL v2 for more details. */
 #include <time.h>
 #include <optional>
 
+#include "common/lang/atomic.h"
 #include "common/lang/bitmap.h"
-#include "common/lang/lru_cache.h"
+#include "common/lang/chrono.h"
 #include "common/lang/mutex.h"
 #include "common/lang/memory.h"
+#include "common/lang/span.h"
+#include "common/lang/thread.h"
 #include "common/lang/unordered_map.h"
+#include "common/lang/utility.h"
+#include "common/lang/vector.h"
 #include "common/mm/mem_pool.h"
 #include "common/sys/rc.h"
+#include "common/thread/thread_pool_executor.h"
 #include "common/types.h"
+#include "storage/buffer/buffer_pool_stat.h"
 #include "storage/buffer/frame.h"
+#include "storage/buffer/frame_replacer.h"
 #include "storage/buffer/page.h"
+#include "storage/buffer/page_arena.h"
 #include "storage/buffer/buffer_pool_log.h"
 
 class BufferPoolManager;
@@ -53,29 +62,39 @@ class BufferPoolLogHandler;
 /**
  * @brief BufferPool的文件第一个页面，存放一些元数据信息，包括了后面每页的分配信息。
  * @ingroup BufferPool
- * @details
- * @code
- * TODO 1. 当前的做法，只能分配比较少的页面，你可以扩展一下，支持更多的页面或无限多的页面吗？
- *         可以参考Linux ext(n)和Windows NTFS等文件系统
- *      2. 当前使用bitmap存放页面分配情况，但是这种方法在页面非常多的时候，查找空闲页面的
- *         效率非常低，你有办法优化吗？
- * @endcode
+ * @details 页面分配图分为两级，参考 ext4 的块组。文件中的页面按顺序划分成多个组：
+ * 第0组的分配位图直接放在文件头页中，第0个页面(就是当前页面)，总是1；
+ * 其它组的第一个页面是这一组的位图页，位图页自己对应的位总是1。
+ * 文件头中记录了第1组开始每组还有多少个空闲页面，分配页面时先根据它找到有空闲页面的组，
+ * 不用扫描所有的位图。第0组的位置和大小与原来的单个位图兼容，小文件的格式没有变化。
  */
 struct BPFileHeader
 {
+  /// 第0组位图的字节数
+  static constexpr int FIRST_GROUP_BITMAP_SIZE = 4096;
+  /// 第0组的页面个数
+  static constexpr int FIRST_GROUP_PAGE_NUM = FIRST_GROUP_BITMAP_SIZE * 8;
+  /// 第1组开始每组的页面个数，包括位图页
+  static constexpr int GROUP_PAGE_NUM = BP_PAGE_DATA_SIZE * 8;
+  /// 最多可以有多少组，文件头页剩下的空间用来记录每组的空闲页面个数
+  static constexpr int MAX_GROUP_NUM = 1 + (BP_PAGE_DATA_SIZE - 3 * sizeof(int32_t) - FIRST_GROUP_BITMAP_SIZE) / sizeof(int32_t);
+
   int32_t buffer_pool_id;   //! buffer pool id
-  int32_t page_count;       //! 当前文件一共有多少个页面
-  int32_t allocated_pages;  //! 已经分配了多少个页面
-  char    bitmap[0];        //! 页面分配位图, 第0个页面(就是当前页面)，总是1
+  int32_t page_count;       //! 当前文件一共有多少个页面，包括位图页
+  int32_t allocated_pages;  //! 已经分配了多少个页面，包括文件头页和位图页
+  char    bitmap[FIRST_GROUP_BITMAP_SIZE];         //! 第0组的页面分配位图
+  int32_t group_free_pages[MAX_GROUP_NUM - 1];  //! 第1组开始，每组已经存在的页面中还有多少个没有分配
 
   /**
-   * 能够分配的最大的页面个数，即bitmap的字节数 乘以8
+   * 能够分配的最大的页面个数
    */
-  static const int MAX_PAGE_NUM = (BP_PAGE_DATA_SIZE - sizeof(page_count) - sizeof(allocated_pages)) * 8;
+  static constexpr int MAX_PAGE_NUM = FIRST_GROUP_PAGE_NUM + (MAX_GROUP_NUM - 1) * GROUP_PAGE_NUM;
 
   string to_string() const;
 };
 
+static_assert(sizeof(BPFileHeader) <= BP_PAGE_DATA_SIZE, "file header should fit in one page");
+
 /**
  * @brief 管理页面Frame
  * @ingroup BufferPool
@@ -83,13 +102,23 @@ struct BPFileHeader
  * 当内存中的页帧不够用时，需要从内存中淘汰一些页帧，以便为新的页帧腾出空间。
  * 这个管理器负责为所有的BufferPool提供页帧管理服务，也就是所有的BufferPool磁盘文件
  * 在访问时都使用这个管理器映射到内存。
+ * 页帧按照 FrameId 的哈希值划分到多个分片中，每个分片有自己的锁、置换策略和空闲链表，
+ * 访问不同分片的页面不会互相阻塞。某个分片没有空闲页帧时，可以从其它分片的空闲链表中借用。
+ * 淘汰页面的顺序由置换策略 FrameReplacer 决定，参考 FrameReplacerType。
  */
 class BPFrameManager
 {
 public:
   BPFrameManager(const char *tag);
 
-  RC init(int pool_num);
+  /**
+   * @param pool_num 页帧内存池的个数，每个内存池有 DEFAULT_ITEM_NUM_PER_POOL 个页帧
+   * @param shard_num 分片个数，小于等于0时根据页帧个数自动计算
+   * @param replacer_type 页面置换策略
+   * @param huge_page 页面内存是否尝试使用大页，参考 PageArena
+   */
+  RC init(int pool_num, int shard_num = 0, FrameReplacerType replacer_type = FrameReplacerType::LRU,
+      bool huge_page = false);
   RC cleanup();
 
   /**
@@ -97,9 +126,15 @@ public:
    *
    * @param buffer_pool_id buffer Pool标识
    * @param page_num  页面号
+   * @param access 是否算作一次访问。后台任务访问页面时不应该影响置换策略
    * @return Frame* 页帧指针
    */
-  Frame *get(int buffer_pool_id, PageNum page_num);
+  Frame *get(int buffer_pool_id, PageNum page_num, bool access = true);
+
+  /**
+   * @brief 页面是否在内存中。不会pin住页帧，也不算作一次访问
+   */
+  bool contains(int buffer_pool_id, PageNum page_num);
 
   /**
    * @brief 列出所有指定文件的页面
@@ -109,14 +144,22 @@ public:
    */
   list<Frame *> find_list(int buffer_pool_id);
 
+  /**
+   * @brief 列出所有的脏页和它们的 recovery LSN
+   * @details 不会pin住页帧，拿到的 FrameId 在使用时可能已经被淘汰了
+   */
+  void find_dirty_list(vector<pair<LSN, FrameId>> &dirty_frames) const;
+
   /**
    * @brief 分配一个新的页面
    *
    * @param buffer_pool_id buffer Pool标识
    * @param page_num 页面编号
+   * @param latch_new_frame 新分配的页帧在放入页帧表之前先加上写锁。用来加载页面数据，
+   * 其它线程在数据加载完成之前拿到这个页帧，也会阻塞在页帧锁上
    * @return Frame* 页帧指针
    */
-  Frame *alloc(int buffer_pool_id, PageNum page_num);
+  Frame *alloc(int buffer_pool_id, PageNum page_num, bool latch_new_frame = false);
 
   /**
    * 尽管frame中已经包含了buffer_pool_id和page_num，但是依然要求
@@ -124,26 +167,38 @@ public:
    */
   RC free(int buffer_pool_id, PageNum page_num, Frame *frame);
 
+  /**
+   * @brief 释放页帧，但是页帧还被别人pin住时不释放
+   * @details 调用者持有一个pin。B+树的乐观读只pin住页面不加锁，删除页面时可能还有读者pin着这个页面，
+   * 这时只释放调用者的pin，页帧留在内存中等待淘汰，返回 RC::LOCKED_CONCURRENCY_CONFLICT。
+   */
+  RC try_free(int buffer_pool_id, PageNum page_num, Frame *frame);
+
   /**
    * 如果不能从空闲链表中分配新的页面，就使用这个接口，
    * 尝试从pin count=0的页面中淘汰一些
+   * @details 在分片锁内挑选并pin住要淘汰的页面，然后在锁外调用purger刷盘，最后再加锁释放页帧。
+   * 各个分片轮流作为淘汰的起点，当前分片找不到足够的页面时继续查找下一个分片。
    * @param count 想要purge多少个页面
    * @param purger 需要在释放frame之前，对页面做些什么操作。当前是刷新脏数据到磁盘
    * @return 返回本次清理了多少个页面
    */
   int purge_frames(int count, function<RC(Frame *frame)> purger);
 
-  size_t frame_num() const { return frames_.count(); }
+  size_t frame_num() const;
+
+  /**
+   * @brief 分片个数，测试使用
+   */
+  int shard_num() const { return static_cast<int>(shards_.size()); }
+
+  FrameReplacerType replacer_type() const { return replacer_type_; }
 
   /**
    * 测试使用。返回已经从内存申请的个数
    */
   size_t total_frame_num() const { return allocator_.get_size(); }
 
-private:
-  Frame *get_internal(const FrameId &frame_id);
-  RC     free_internal(const FrameId &frame_id, Frame *frame);
-
 private:
   class BPFrameIdHasher
   {
@@ -151,12 +206,41 @@ private:
     size_t operator()(const FrameId &frame_id) const { return frame_id.hash(); }
   };
 
-  using FrameLruCache  = common::LruCache<FrameId, Frame *, BPFrameIdHasher>;
   using FrameAllocator = common::MemPoolSimple<Frame>;
 
-  mutex          lock_;
-  FrameLruCache  frames_;
-  FrameAllocator allocator_;
+  /**
+   * @brief 页帧表的一个分片
+   * @details 分片内的页帧表、置换策略和空闲链表都由分片自己的锁保护
+   */
+  struct Shard
+  {
+    mutable mutex                                    lock;
+    unordered_map<FrameId, Frame *, BPFrameIdHasher> frames;
+    unique_ptr<FrameReplacer>                        replacer;
+    vector<Frame *>                                  free_frames;
+  };
+
+  Shard &shard_of(const FrameId &frame_id) { return *shards_[frame_id.hash() % shards_.size()]; }
+
+  Frame *get_internal(Shard &shard, const FrameId &frame_id, bool access = true);
+  RC     free_internal(Shard &shard, const FrameId &frame_id, Frame *frame);
+
+  /**
+   * @brief 在指定的分片中挑选可以淘汰的页面并pin住它们，直到frames中有count个页面
+   */
+  void pick_purge_frames(Shard &shard, int count, vector<Frame *> &frames);
+
+  /**
+   * @brief 从空闲链表中取一个页帧，优先使用home分片的空闲链表
+   */
+  Frame *alloc_free_frame(Shard &home);
+
+private:
+  vector<unique_ptr<Shard>> shards_;
+  FrameReplacerType         replacer_type_ = FrameReplacerType::LRU;
+  atomic<size_t>            purge_cursor_{0};  /// 下一次淘汰从哪个分片开始查找
+  FrameAllocator            allocator_;        /// 所有页帧的内存都从这里申请
+  PageArena                 page_arena_;       /// 所有页帧的页面内存
 };
 
 /**
@@ -169,14 +253,21 @@ public:
   BufferPoolIterator();
   ~BufferPoolIterator();
 
-  RC      init(DiskBufferPool &bp, PageNum start_page = 0);
+  /**
+   * @param read_ahead 是否预读。顺序扫描时开启，遍历到的页面快要超出已经预读的范围时，
+   * 就让 DiskBufferPool 在后台预读后面的页面
+   */
+  RC      init(DiskBufferPool &bp, PageNum start_page = 0, bool read_ahead = false);
   bool    has_next();
   PageNum next();
   RC      reset();
 
 private:
-  common::Bitmap bitmap_;
-  PageNum        current_page_num_ = -1;
+  PageNum         current_page_num_ = -1;
+  PageNum         end_page_num_     = 0;  /// 初始化时文件的页面个数，之后扩展出来的页面不再遍历
+  DiskBufferPool *buffer_pool_      = nullptr;
+  int             read_ahead_num_   = 0;   /// 每次预读的页面个数，0表示不预读
+  PageNum         read_ahead_end_   = -1;  /// 已经预读过的页面范围的结尾（不包含）
 };
 
 /**
@@ -255,6 +346,19 @@ public:
    */
   RC flush_all_pages();
 
+  /**
+   * @brief 把所有脏页刷新到double write buffer
+   * @details 模糊检查点使用。每次只对一个页面加读锁，刷新期间其它线程可以继续修改别的页面。
+   * @param[in,out] min_recovery_lsn 刷新后仍然是脏页（刷新期间又被修改）的页面中最小的recovery LSN，
+   * 如果比传入的值小或者传入的值是0，就更新它
+   */
+  RC flush_dirty_pages(LSN &min_recovery_lsn);
+
+  /**
+   * @brief 把已经写入文件的数据同步到磁盘
+   */
+  RC sync_file();
+
   /**
    * 回放日志时处理page0中已被认定为不存在的page
    */
@@ -268,13 +372,59 @@ public:
   RC redo_allocate_page(LSN lsn, PageNum page_num);
   RC redo_deallocate_page(LSN lsn, PageNum page_num);
 
+  /**
+   * @brief 查找从 start_page 开始(包含)的下一个已经分配的页面，会跳过位图页
+   * @return 没有找到时返回 -1
+   */
+  PageNum next_allocated_page(PageNum start_page);
+
+  /**
+   * @brief 是否是某一组的位图页。位图页由 DiskBufferPool 自己管理，不能释放
+   */
+  static bool is_bitmap_page(PageNum page_num);
+
+  /**
+   * @brief 异步预读页面
+   * @details 把 [start_page, start_page + page_count) 中已经分配、但是还不在内存中的页面交给后台线程加载，
+   * 连续的页面使用一次 preadv 读取。不等待加载完成，预读失败也不影响之后正常地读取页面。
+   * BufferPoolManager 没有开启预读时什么都不做。
+   */
+  RC prefetch_pages(PageNum start_page, int page_count);
+
+  /**
+   * @brief 顺序扫描时每次预读多少个页面，0表示不预读
+   */
+  int read_ahead_page_num() const;
+
+  /**
+   * @brief 页面清理线程刷新一个脏页
+   * @details 页面不在内存中、已经不是脏页或者正在被修改（拿不到读锁）时跳过。
+   * 刷新时会等待页面对应的日志写到磁盘上。
+   * @param flushed 是否真的刷新了页面
+   */
+  RC clean_page(PageNum page_num, bool &flushed);
+
 public:
   int32_t id() const { return buffer_pool_id_; }
 
   const char *filename() const { return file_name_.c_str(); }
 
+  /**
+   * @brief 这个文件的访问统计
+   */
+  BufferPoolStat       &stat() { return stat_; }
+  const BufferPoolStat &stat() const { return stat_; }
+
 protected:
-  RC allocate_frame(PageNum page_num, Frame **buf);
+  /**
+   * @brief 持有 lock_ 时获取页面，参考 get_this_page
+   */
+  RC get_this_page_internal(PageNum page_num, Frame **frame);
+
+  /**
+   * @param latch_new_frame 参考 BPFrameManager::alloc
+   */
+  RC allocate_frame(PageNum page_num, Frame **buf, bool latch_new_frame = false);
 
   /**
    * 刷新指定页面到磁盘(flush)，并且释放关联的Frame
@@ -287,28 +437,83 @@ protected:
    */
   RC load_page(PageNum page_num, Frame *frame);
 
+  /**
+   * @brief 读写文件时内存地址的对齐要求，只有直接IO时才需要对齐
+   */
+  int io_alignment() const { return direct_io_ ? BP_PAGE_ALIGN : 0; }
+
+  /**
+   * @brief 开启了加载页面时的校验时，检查从磁盘读到的页面的校验和
+   * @return 校验失败时记录错误日志并返回false
+   */
+  bool verify_page(PageNum page_num, const Page &page) const;
+
+  /**
+   * @brief 记录从磁盘读取页面的个数和花费的时间
+   */
+  void record_read(int page_count, chrono::steady_clock::time_point start_time);
+
+  /**
+   * @brief 在后台线程中执行预读
+   */
+  void do_prefetch(PageNum start_page, int page_count);
+
+  /**
+   * @brief 使用一次 preadv 把连续的多个页面读到页帧中，frames 按照页面编号排序并且连续
+   */
+  RC load_pages(span<Frame *> frames);
+
   /**
    * 如果页面是脏的，就将数据刷新到磁盘
    */
   RC flush_page_internal(Frame &frame);
 
+  /// 页面分配图的辅助函数，都需要持有 lock_
+  static int     page_group(PageNum page_num);
+  static PageNum group_start_page(int group);
+  int            group_count() const;
+  int            group_exist_pages(int group) const;  ///< 这一组中已经存在（没有超过文件大小）的页面个数
+  int            group_free_pages(int group) const;
+  void           add_group_free_pages(int group, int delta);
+
+  PageNum next_allocated_page_internal(PageNum start_page);
+
+  /**
+   * @brief 获取一组的分配位图
+   * @details 第0组的位图在文件头页中，frame 就是 hdr_frame_。其它组的位图页会被pin住，
+   * 使用完后调用 put_group_bitmap。
+   * @param create 回放日志时位图页可能还没有写到文件中，这时创建一个新的位图页
+   */
+  RC   get_group_bitmap(int group, Frame *&frame, common::Bitmap &bitmap, bool create = false);
+  void put_group_bitmap(int group, Frame *frame);
+
+  /**
+   * @brief 扩展文件时创建新的一组，新的位图页就是当前文件的最后一个页面
+   */
+  RC create_group(int group, LSN lsn);
+
 private:
   BufferPoolManager   &bp_manager_;     /// BufferPool 管理器
   BPFrameManager      &frame_manager_;  /// Frame 管理器
   DoubleWriteBuffer   &dblwr_manager_;  /// Double Write Buffer 管理器
   BufferPoolLogHandler log_handler_;    /// BufferPool 日志处理器
 
-  int file_desc_ = -1;  /// 文件描述符
+  int  file_desc_ = -1;     /// 文件描述符
+  bool direct_io_ = false;  /// 是否使用 O_DIRECT 打开了文件
   /// 由于在最开始打开文件时，没有正确的buffer pool id不能加载header frame，所以单独从文件中读取此标识
   int32_t       buffer_pool_id_ = -1;
   Frame        *hdr_frame_      = nullptr;  /// 文件头页面
   BPFileHeader *file_header_    = nullptr;  /// 文件头
   set<PageNum>  disposed_pages_;            /// 已经释放的页面
+  int first_group_free_pages_ = 0;  /// 第0组的空闲页面个数，文件头中没有记录，打开文件时根据位图计算
 
   string file_name_;  /// 文件名
 
   common::Mutex lock_;
-  common::Mutex wr_lock_;
+
+  atomic<int> pending_prefetch_{0};  /// 还没有执行完的预读任务个数，关闭文件时要等待它们结束
+
+  BufferPoolStat stat_;
 
 private:
   friend class BufferPoolIterator;
@@ -321,7 +526,13 @@ private:
 class BufferPoolManager final
 {
 public:
-  BufferPoolManager(int memory_size = 0);
+  /**
+   * @param memory_size 页帧使用的内存大小，单位是字节，小于等于0时使用默认值
+   * @param replacer_type 页面置换策略
+   * @param huge_page 页帧内存是否尝试使用大页
+   */
+  BufferPoolManager(
+      int64_t memory_size = 0, FrameReplacerType replacer_type = FrameReplacerType::LRU, bool huge_page = false);
   ~BufferPoolManager();
 
   RC init(unique_ptr<DoubleWriteBuffer> dblwr_buffer);
@@ -332,8 +543,67 @@ public:
 
   RC flush_page(Frame &frame);
 
-  BPFrameManager    &get_frame_manager() { return frame_manager_; }
-  DoubleWriteBuffer *get_dblwr_buffer() { return dblwr_buffer_.get(); }
+  /**
+   * @brief 把所有buffer pool中的脏页刷新到double write buffer
+   * @details 模糊检查点使用，参考 DiskBufferPool::flush_dirty_pages
+   * @param[out] min_recovery_lsn 刷新完成后仍然是脏页的页面中最小的recovery LSN，没有脏页时是0
+   */
+  RC flush_dirty_pages(LSN &min_recovery_lsn);
+
+  /**
+   * @brief 把所有buffer pool文件的数据同步到磁盘
+   */
+  RC sync_files();
+
+  /**
+   * @brief 开启页面预读
+   * @param thread_num 后台加载页面的线程个数，小于等于0时不开启预读
+   * @param read_ahead_page_num 顺序扫描时每次预读的页面个数
+   */
+  RC init_prefetch(int thread_num, int read_ahead_page_num);
+
+  /**
+   * @brief 启动后台页面清理线程
+   * @details 清理线程定期检查脏页的比例。超过 high_watermark 时，按照 recovery LSN 从小到大刷新脏页，
+   * 直到脏页比例降到 low_watermark；在两个水位之间时每次只刷新一批。
+   * 这样前台淘汰页面时几乎总能找到干净的页面，不用自己刷脏页。
+   * @param high_watermark 脏页比例的高水位，百分比
+   * @param low_watermark 脏页比例的低水位，百分比
+   * @param interval 检查的时间间隔，小于等于0时不启动
+   */
+  RC start_page_cleaner(int high_watermark, int low_watermark, chrono::milliseconds interval);
+
+  void stop_page_cleaner();
+
+  /**
+   * @brief 前台淘汰页面时遇到了脏页，唤醒清理线程
+   */
+  void wakeup_page_cleaner();
+
+  /**
+   * @brief 按照 recovery LSN 从小到大刷新最多 count 个脏页
+   * @return 实际刷新的页面个数
+   */
+  int clean_pages(int count);
+
+  BPFrameManager             &get_frame_manager() { return frame_manager_; }
+  DoubleWriteBuffer          *get_dblwr_buffer() { return dblwr_buffer_.get(); }
+  common::ThreadPoolExecutor *get_prefetch_executor() { return prefetch_executor_.get(); }
+  int                         read_ahead_page_num() const { return read_ahead_page_num_; }
+
+  /**
+   * @brief 使用 O_DIRECT 读写 buffer pool 文件，绕过操作系统的页缓存
+   * @details 页面只在 buffer pool 中缓存一份，不会同时占用操作系统的内存。
+   * 只对之后打开的文件生效，文件系统不支持时退回到普通的读写方式
+   */
+  void set_direct_io(bool direct_io) { direct_io_ = direct_io; }
+  bool direct_io() const { return direct_io_; }
+
+  /**
+   * @brief 从磁盘加载页面时校验页面的校验和，尽早发现写了一半或者损坏的页面
+   */
+  void set_verify_checksum(bool verify) { verify_checksum_ = verify; }
+  bool verify_checksum() const { return verify_checksum_; }
 
   /**
    * @brief 根据ID获取对应的BufferPool对象
@@ -343,11 +613,41 @@ public:
    */
   RC get_buffer_pool(int32_t id, DiskBufferPool *&bp);
 
+  /**
+   * @brief 获取所有打开的buffer pool文件的访问统计
+   * @param[out] stats 文件名和对应的统计，按照文件名排序
+   */
+  void collect_stats(vector<pair<string, BufferPoolStat::Values>> &stats);
+
+private:
+  /**
+   * @brief 页面清理线程的一轮检查，根据脏页比例决定刷新多少个页面
+   */
+  void page_cleaner_round();
+
 private:
   BPFrameManager frame_manager_{"BufPool"};
 
   unique_ptr<DoubleWriteBuffer> dblwr_buffer_;
 
+  unique_ptr<common::ThreadPoolExecutor> prefetch_executor_;  /// 预读页面的后台线程
+  int                                    read_ahead_page_num_ = 0;
+
+  bool direct_io_       = false;
+  bool verify_checksum_ = false;
+
+  /// 脏页比例在两个水位之间时，页面清理线程每次刷新的页面个数
+  static constexpr int PAGE_CLEANER_BATCH_SIZE = 64;
+
+  int                dirty_high_watermark_ = 0;  ///< 百分比
+  int                dirty_low_watermark_  = 0;  ///< 百分比
+  mutex              clean_lock_;                ///< 清理页面和关闭文件互斥，清理时缓冲池不会被释放
+  mutex              page_cleaner_mutex_;        ///< 与page_cleaner_cond_一起使用
+  condition_variable page_cleaner_cond_;
+  bool               page_cleaner_running_ = false;
+  bool               page_cleaner_wakeup_  = false;
+  unique_ptr<thread> page_cleaner_;
+
   common::Mutex                            lock_;
   unordered_map<string, DiskBufferPool *>  buffer_pools_;
   unordered_map<int32_t, DiskBufferPool *> id_to_buffer_pools_;
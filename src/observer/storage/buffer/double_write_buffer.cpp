@@ -12,12 +12,15 @@ See the Mulan PSL v2 for more details. */
 // Created by Wenbin1002 on 2024/04/16
 //
 #include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
 #include "storage/buffer/double_write_buffer.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "common/io/io.h"
+#include "common/lang/algorithm.h"
 #include "common/log/log.h"
-#include "common/math/crc.h"
 
 using namespace common;
 
@@ -74,22 +77,66 @@ RC DiskDoubleWriteBuffer::open_file(const char *filename)
 
 RC DiskDoubleWriteBuffer::flush_page()
 {
-  sync();
+  scoped_lock lock_guard(lock_);
+  return flush_page_internal();
+}
 
+RC DiskDoubleWriteBuffer::flush_page_internal()
+{
+  if (dblwr_pages_.empty()) {
+    return RC::SUCCESS;
+  }
+
+  vector<DoubleWritePage *> pages;
+  pages.reserve(dblwr_pages_.size());
   for (const auto &pair : dblwr_pages_) {
-    RC rc = write_page(pair.second);
-    if (rc != RC::SUCCESS) {
+    pages.push_back(pair.second);
+  }
+
+  // 先把整批页面顺序写入 double write buffer 文件并落盘，之后写数据文件时出现部分写入也可以恢复
+  sort(pages.begin(), pages.end(), [](DoubleWritePage *a, DoubleWritePage *b) { return a->page_index < b->page_index; });
+  RC rc = write_pages_internal(pages);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to write pages into double write buffer file. page count=%d, rc=%s", pages.size(), strrc(rc));
+    return rc;
+  }
+
+  // 按照文件和页面编号排序写回，尽量顺序写，每个文件写完以后只落盘一次
+  sort(pages.begin(), pages.end(), [](DoubleWritePage *a, DoubleWritePage *b) {
+    if (a->key.buffer_pool_id != b->key.buffer_pool_id) {
+      return a->key.buffer_pool_id < b->key.buffer_pool_id;
+    }
+    return a->key.page_num < b->key.page_num;
+  });
+
+  for (size_t i = 0; i < pages.size(); i++) {
+    rc = write_page(pages[i]);
+    if (OB_FAIL(rc)) {
       return rc;
     }
-    pair.second->valid = false;
-    write_page_internal(pair.second);
-    delete pair.second;
+
+    const bool last_page_of_file =
+        i + 1 == pages.size() || pages[i + 1]->key.buffer_pool_id != pages[i]->key.buffer_pool_id;
+    if (last_page_of_file) {
+      DiskBufferPool *disk_buffer = nullptr;
+      rc = bp_manager_.get_buffer_pool(pages[i]->key.buffer_pool_id, disk_buffer);
+      if (OB_SUCC(rc)) {
+        rc = disk_buffer->sync_file();
+      }
+      if (OB_FAIL(rc)) {
+        LOG_ERROR("Failed to sync buffer pool file. buffer_pool_id=%d, rc=%s", pages[i]->key.buffer_pool_id, strrc(rc));
+        return rc;
+      }
+    }
   }
 
+  for (DoubleWritePage *page : pages) {
+    delete page;
+  }
   dblwr_pages_.clear();
-  header_.page_cnt = 0;
 
-  return RC::SUCCESS;
+  LOG_TRACE("flush pages in double write buffer. page count=%d", pages.size());
+  return reset_file_header();
 }
 
 RC DiskDoubleWriteBuffer::add_page(DiskBufferPool *bp, PageNum page_num, Page &page)
@@ -101,37 +148,18 @@ RC DiskDoubleWriteBuffer::add_page(DiskBufferPool *bp, PageNum page_num, Page &p
     iter->second->page = page;
     LOG_TRACE("[cache hit]add page into double write buffer. buffer_pool_id:%d,page_num:%d,lsn=%d, dwb size=%d",
               bp->id(), page_num, page.lsn, static_cast<int>(dblwr_pages_.size()));
-    return write_page_internal(iter->second);
+    return RC::SUCCESS;
   }
 
-  int64_t          page_cnt   = dblwr_pages_.size();
+  int32_t          page_cnt   = static_cast<int32_t>(dblwr_pages_.size());
   DoubleWritePage *dblwr_page = new DoubleWritePage(bp->id(), page_num, page_cnt, page);
   dblwr_pages_.insert(pair<DoubleWritePageKey, DoubleWritePage *>(key, dblwr_page));
+  bp->stat().add(BufferPoolStatType::DBLWR_WRITE);
   LOG_TRACE("insert page into double write buffer. buffer_pool_id:%d,page_num:%d,lsn=%d, dwb size:%d",
             bp->id(), page_num, page.lsn, static_cast<int>(dblwr_pages_.size()));
 
-  RC rc = write_page_internal(dblwr_page);
-  if (OB_FAIL(rc)) {
-    LOG_WARN("failed to write page into double write buffer. rc=%s buffer_pool_id:%d,page_num:%d,lsn=%d.",
-        strrc(rc), bp->id(), page_num, page.lsn);
-    return rc;
-  }
-
-  if (page_cnt + 1 > header_.page_cnt) {
-    header_.page_cnt = page_cnt + 1;
-    if (lseek(file_desc_, 0, SEEK_SET) == -1) {
-      LOG_ERROR("Failed to add page header due to failed to seek %s.", strerror(errno));
-      return RC::IOERR_SEEK;
-    }
-
-    if (writen(file_desc_, &header_, sizeof(header_)) != 0) {
-      LOG_ERROR("Failed to add page header due to %s.", strerror(errno));
-      return RC::IOERR_WRITE;
-    }
-  }
-
   if (static_cast<int>(dblwr_pages_.size()) >= max_pages_) {
-    RC rc = flush_page();
+    RC rc = flush_page_internal();
     if (rc != RC::SUCCESS) {
       LOG_ERROR("Failed to flush pages in double write buffer");
       return rc;
@@ -141,20 +169,58 @@ RC DiskDoubleWriteBuffer::add_page(DiskBufferPool *bp, PageNum page_num, Page &p
   return RC::SUCCESS;
 }
 
-RC DiskDoubleWriteBuffer::write_page_internal(DoubleWritePage *page)
+int DiskDoubleWriteBuffer::page_count()
 {
-  int32_t page_index = page->page_index;
-  int64_t offset = page_index * DoubleWritePage::SIZE + DoubleWriteBufferHeader::SIZE;
-  if (lseek(file_desc_, offset, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to add page %lld of %d due to failed to seek %s.", offset, file_desc_, strerror(errno));
+  scoped_lock lock_guard(lock_);
+  return static_cast<int>(dblwr_pages_.size());
+}
+
+RC DiskDoubleWriteBuffer::write_pages_internal(const vector<DoubleWritePage *> &pages)
+{
+  header_.page_cnt = static_cast<int32_t>(pages.size());
+
+  vector<struct iovec> iovs;
+  iovs.reserve(pages.size() + 1);
+  iovs.push_back({&header_, static_cast<size_t>(DoubleWriteBufferHeader::SIZE)});
+  for (DoubleWritePage *page : pages) {
+    page->valid = true;
+    iovs.push_back({page, static_cast<size_t>(DoubleWritePage::SIZE)});
+  }
+
+  if (lseek(file_desc_, 0, SEEK_SET) == -1) {
+    LOG_ERROR("Failed to write pages due to failed to seek %s.", strerror(errno));
     return RC::IOERR_SEEK;
   }
 
-  if (writen(file_desc_, page, DoubleWritePage::SIZE) != 0) {
-    LOG_ERROR("Failed to add page %lld of %d due to %s.", offset, file_desc_, strerror(errno));
-    return RC::IOERR_WRITE;
+  // writevn 每次最多写 IOV_MAX 段数据
+  for (size_t start = 0; start < iovs.size(); start += IOV_MAX) {
+    const int iovcnt = static_cast<int>(min(iovs.size() - start, static_cast<size_t>(IOV_MAX)));
+    if (writevn(file_desc_, iovs.data() + start, iovcnt) != 0) {
+      LOG_ERROR("Failed to write pages of %d due to %s.", file_desc_, strerror(errno));
+      return RC::IOERR_WRITE;
+    }
   }
 
+  if (fdatasync(file_desc_) != 0) {
+    LOG_ERROR("Failed to sync double write buffer file due to %s.", strerror(errno));
+    return RC::IOERR_SYNC;
+  }
+
+  // 页面在内存中的布局没有对齐，不能使用 O_DIRECT。已经落盘的数据只在恢复时读取，从页缓存中丢掉
+  if (bp_manager_.direct_io()) {
+    (void)posix_fadvise(file_desc_, 0, 0, POSIX_FADV_DONTNEED);
+  }
+  return RC::SUCCESS;
+}
+
+RC DiskDoubleWriteBuffer::reset_file_header()
+{
+  // 不需要落盘。如果没有写到磁盘上，重启时会把已经写回的页面再写一次，页面内容是一样的
+  header_.page_cnt = 0;
+  if (pwrite(file_desc_, &header_, sizeof(header_), 0) != static_cast<ssize_t>(sizeof(header_))) {
+    LOG_ERROR("Failed to reset double write buffer header due to %s.", strerror(errno));
+    return RC::IOERR_WRITE;
+  }
   return RC::SUCCESS;
 }
 
@@ -223,8 +289,6 @@ RC DiskDoubleWriteBuffer::clear_pages(DiskBufferPool *buffer_pool)
                buffer_pool->filename(), dbl_page->key.page_num, strrc(rc));
       break;
     }
-    dbl_page->valid = false;
-    write_page_internal(dbl_page);
   }
 
   for_each(spec_pages.begin(), spec_pages.end(), [](DoubleWritePage *dbl_page) { delete dbl_page; });
@@ -275,12 +339,11 @@ RC DiskDoubleWriteBuffer::load_pages()
       return RC::IOERR_READ;
     }
 
-    const CheckSum check_sum = crc32(page.data, BP_PAGE_DATA_SIZE);
-    if (check_sum == page.check_sum) {
+    if (page_check_sum_valid(page)) {
       DoubleWritePageKey key = dblwr_page->key;
       dblwr_pages_.insert(pair<DoubleWritePageKey, DoubleWritePage *>(key, dblwr_page.release()));
     } else {
-      LOG_TRACE("got a page with an invalid checksum. on disk:%d, in memory:%d", page.check_sum, check_sum);
+      LOG_TRACE("got a page with an invalid checksum. on disk:%u, in memory:%u", page.check_sum, page_check_sum(page));
     }
   }
 
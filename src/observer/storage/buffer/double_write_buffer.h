@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/lang/mutex.h"
 #include "common/lang/unordered_map.h"
+#include "common/lang/vector.h"
 #include "common/types.h"
 #include "common/sys/rc.h"
 #include "storage/buffer/page.h"
@@ -80,7 +81,11 @@ struct DoubleWritePageKeyHash
  * 当我们从磁盘中读取页面时，会校验页面的checksum，如果校验失败，则说明页面写入不完整，这时候可以从
  * DoubleWriteBuffer中读取数据。
  *
- * @note 每次都要保证，不管在内存中还是在文件中，这里的数据都是最新的，都比Buffer pool中的数据要新
+ * 页面先攒在内存中，攒够一批后一次性顺序写入共享文件并落盘，然后按照文件和页面编号排序写回各自的位置，
+ * 每个数据文件只落盘一次。还没有写到磁盘上的页面，在检查点时会通过 flush_page 写下去，
+ * 在这之前即使丢失也可以通过重做日志恢复。
+ *
+ * @note 每次都要保证这里的数据都是最新的，都比Buffer pool文件中的数据要新
  */
 class DiskDoubleWriteBuffer : public DoubleWriteBuffer
 {
@@ -89,7 +94,7 @@ public:
    * @brief 构造函数
    *
    * @param bp_manager 关联的buffer pool manager
-   * @param max_pages  内存中保存的最大页面数
+   * @param max_pages  内存中保存的最大页面数，也就是一批写入的页面数
    */
   DiskDoubleWriteBuffer(BufferPoolManager &bp_manager, int max_pages = 16);
   virtual ~DiskDoubleWriteBuffer();
@@ -101,12 +106,11 @@ public:
 
   /**
    * 将buffer中的页全部写入磁盘，并且清空buffer
-   * TODO 目前的解决方案是等buffer装满后再刷盘，可能会导致程序卡住一段时间
    */
   RC flush_page();
 
   /**
-   * 将页面加入buffer，并且写入磁盘中的共享表空间
+   * 将页面加入buffer，buffer满了以后整批写入磁盘
    */
   RC add_page(DiskBufferPool *bp, PageNum page_num, Page &page) override;
 
@@ -122,6 +126,11 @@ public:
    */
   RC recover();
 
+  /**
+   * @brief 内存中还没有写入磁盘的页面个数
+   */
+  int page_count();
+
 private:
   /**
    * 将buffer中的页面写入对应的磁盘
@@ -129,11 +138,19 @@ private:
   RC write_page(DoubleWritePage *page);
 
   /**
-   * 将页面写到当前double write buffer文件中
-   * @details 每次页面更新都应该写入到磁盘中。保证double write buffer
-   * 内存和文件中的数据都是最新的。
+   * @brief 使用一次 writev 把一批页面连续地写到 double write buffer 文件中，并落盘
+   */
+  RC write_pages_internal(const vector<DoubleWritePage *> &pages);
+
+  /**
+   * @brief 页面都已经写回数据文件后，将文件中的页面个数清零，重启时不需要再恢复这些页面
+   */
+  RC reset_file_header();
+
+  /**
+   * @brief 与 flush_page 相同，但是调用者需要持有锁
    */
-  RC write_page_internal(DoubleWritePage *page);
+  RC flush_page_internal();
 
   /**
    * @brief 将磁盘文件中的内容加载到内存中。在启动时调用
@@ -76,9 +76,12 @@ void Frame::write_latch(intptr_t xid)
 
   lock_.lock();
 
+  if (write_recursive_count_++ == 0) {
+    version_.fetch_add(1);
+  }
+
 #ifdef DEBUG
   write_locker_ = xid;
-  ++write_recursive_count_;
   TRACE("frame write lock success."
         "this=%p, pin=%d, frameId=%s, write locker=%lx(recursive=%d), xid=%lx, lbt=%s",
         this, pin_count_.load(), frame_id_.to_string().c_str(), write_locker_, write_recursive_count_, xid, lbt());
@@ -107,6 +110,7 @@ void Frame::write_unlatch(intptr_t xid)
 
   if (--write_recursive_count_ == 0) {
     write_locker_ = 0;
+    version_.fetch_add(1);
   }
   debug_lock_.unlock();
 
@@ -78,7 +78,7 @@ public:
   void reinit() {}
   void reset() {}
 
-  void clear_page() { memset(&page_, 0, sizeof(page_)); }
+  void clear_page() { memset(page_, 0, sizeof(Page)); }
 
   int  buffer_pool_id() const { return frame_id_.buffer_pool_id(); }
   void set_buffer_pool_id(int id) { frame_id_.set_buffer_pool_id(id); }
@@ -87,8 +87,11 @@ public:
    * @brief 在磁盘和内存中内容完全一致的数据页
    * @details 磁盘文件划分为一个个页面，每次从磁盘加载到内存中，也是一个页面，就是 Page。
    * frame 是为了管理这些页面而维护的一个数据结构。
+   * 页面的内存不在Frame中，而是由 BPFrameManager 从一块按照 BP_PAGE_ALIGN 对齐的内存中统一分配，
+   * 这样可以使用 O_DIRECT 直接读写。
    */
-  Page &page() { return page_; }
+  Page &page() { return *page_; }
+  void  set_page(Page *page) { page_ = page; }
 
   /**
    * @brief 每个页面都有一个编号
@@ -103,15 +106,28 @@ public:
    * @details 如果当前页面从磁盘中加载出来时，它的日志序列号比当前WAL(Write-Ahead-Logging)中的一些
    * 序列号要小，那就可以从日志中读取这些更大序列号的日志，做重做操作，将页面恢复到最新状态，也就是redo。
    */
-  LSN  lsn() const { return page_.lsn; }
-  void set_lsn(LSN lsn) { page_.lsn = lsn; }
+  LSN  lsn() const { return page_->lsn; }
+  void set_lsn(LSN lsn)
+  {
+    page_->lsn = lsn;
+    if (recovery_lsn_.load(memory_order_relaxed) == 0) {
+      recovery_lsn_.store(lsn, memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief 页面变脏之后第一次修改时的日志序列号
+   * @details 从这个LSN开始重做日志，就可以恢复出页面在内存中的修改。页面刷盘之后会重置为0。
+   * 所有脏页中最小的recovery LSN决定了检查点最多能推进到哪里。
+   */
+  LSN recovery_lsn() const { return recovery_lsn_.load(memory_order_relaxed); }
 
   /**
    * @brief 页面校验和
    * @details 用于校验页面完整性。如果页面写入一半时出现异常，可以通过校验和检测出来。
    */
-  CheckSum check_sum() const { return page_.check_sum; }
-  void     set_check_sum(CheckSum check_sum) { page_.check_sum = check_sum; }
+  CheckSum check_sum() const { return page_->check_sum; }
+  void     set_check_sum(CheckSum check_sum) { page_->check_sum = check_sum; }
 
   /**
    * @brief 刷新当前内存页面的访问时间
@@ -132,10 +148,14 @@ public:
    * @brief 重置“脏”标记
    * @details 如果页面已经被写入磁盘文件，则应调用此函数。
    */
-  void clear_dirty() { dirty_ = false; }
+  void clear_dirty()
+  {
+    dirty_ = false;
+    recovery_lsn_.store(0, memory_order_relaxed);
+  }
   bool dirty() const { return dirty_; }
 
-  char *data() { return page_.data; }
+  char *data() { return page_->data; }
 
   bool can_purge() { return pin_count_.load() == 0; }
 
@@ -166,6 +186,24 @@ public:
   void read_unlatch();
   void read_unlatch(intptr_t xid);
 
+  /**
+   * @brief 页面的版本号，用于乐观读
+   * @details 加上和释放最外层的写锁时版本号都会加1，所以版本号是奇数时表示有人正在修改页面。
+   * 乐观读不加读锁，读取页面之前记下版本号，读完以后再用 validate_version 校验，
+   * 版本号没有变化并且不是奇数，读到的内容才是一致的。读取之前需要pin住页面，防止页帧被换成别的页面。
+   */
+  uint64_t version() const { return version_.load(memory_order_acquire); }
+
+  /// 读取页面之后，检查版本号是否还是之前获取的 version
+  bool validate_version(uint64_t version) const
+  {
+    atomic_thread_fence(memory_order_acquire);
+    return version_.load(memory_order_relaxed) == version;
+  }
+
+  /// 版本号是否表示页面正在被修改
+  static bool is_writing_version(uint64_t version) { return (version & 1) != 0; }
+
   string to_string() const;
 
 private:
@@ -173,17 +211,21 @@ private:
 
   bool          dirty_ = false;
   atomic<int>   pin_count_{0};
+  atomic<LSN>   recovery_lsn_{0};
   unsigned long acc_time_ = 0;
   FrameId       frame_id_;
-  Page          page_;
+  Page         *page_ = nullptr;
 
   /// 在非并发编译时，加锁解锁动作将什么都不做
   common::RecursiveSharedMutex lock_;
 
+  /// 参考 version()。只在持有写锁时修改
+  atomic<uint64_t> version_{0};
+
   /// 使用一些手段来做测试，提前检测出头疼的死锁问题
   /// 如果编译时没有增加调试选项，这些代码什么都不做
   common::DebugMutex           debug_lock_;
   intptr_t                     write_locker_          = 0;
-  int                          write_recursive_count_ = 0;
+  int                          write_recursive_count_ = 0;  /// 写锁是可重入的，只有最外层的写锁才修改版本号
   unordered_map<intptr_t, int> read_lockers_;
 };
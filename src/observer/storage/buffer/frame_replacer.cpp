@@ -0,0 +1,239 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <strings.h>
+
+#include "storage/buffer/frame_replacer.h"
+#include "common/lang/algorithm.h"
+#include "common/log/log.h"
+
+const char *frame_replacer_type_name(FrameReplacerType type)
+{
+  switch (type) {
+    case FrameReplacerType::LRU: return "lru";
+    case FrameReplacerType::LRU_K: return "lru-k";
+    case FrameReplacerType::TWO_Q: return "2q";
+  }
+  return "unknown";
+}
+
+RC frame_replacer_type_from_string(const char *name, FrameReplacerType &type)
+{
+  for (FrameReplacerType item : {FrameReplacerType::LRU, FrameReplacerType::LRU_K, FrameReplacerType::TWO_Q}) {
+    if (0 == strcasecmp(name, frame_replacer_type_name(item))) {
+      type = item;
+      return RC::SUCCESS;
+    }
+  }
+  return RC::INVALID_ARGUMENT;
+}
+
+unique_ptr<FrameReplacer> FrameReplacer::create(FrameReplacerType type, int capacity)
+{
+  switch (type) {
+    case FrameReplacerType::LRU: return make_unique<LruFrameReplacer>();
+    case FrameReplacerType::LRU_K: return make_unique<LruKFrameReplacer>();
+    case FrameReplacerType::TWO_Q: return make_unique<TwoQFrameReplacer>(capacity);
+  }
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void LruFrameReplacer::insert(Frame *frame)
+{
+  lru_list_.push_front(frame);
+  positions_[frame] = lru_list_.begin();
+}
+
+void LruFrameReplacer::access(Frame *frame)
+{
+  auto iter = positions_.find(frame);
+  if (iter != positions_.end()) {
+    lru_list_.splice(lru_list_.begin(), lru_list_, iter->second);
+  }
+}
+
+void LruFrameReplacer::remove(Frame *frame)
+{
+  auto iter = positions_.find(frame);
+  if (iter != positions_.end()) {
+    lru_list_.erase(iter->second);
+    positions_.erase(iter);
+  }
+}
+
+void LruFrameReplacer::foreach_victim(const function<bool(Frame *)> &visitor)
+{
+  for (auto iter = lru_list_.rbegin(); iter != lru_list_.rend(); ++iter) {
+    if (!visitor(*iter)) {
+      break;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+LruKFrameReplacer::LruKFrameReplacer(int k /* = 2 */) : k_(max(k, 1)) {}
+
+void LruKFrameReplacer::record(Node &node)
+{
+  node.history.push_back(++clock_);
+  if (node.history.size() > k_) {
+    node.history.erase(node.history.begin());
+  }
+}
+
+void LruKFrameReplacer::insert(Frame *frame)
+{
+  Node &node = nodes_[frame];
+  node.history.clear();
+  record(node);
+
+  if (node.history.size() >= k_) {
+    cache_set_.emplace(node.history.front(), frame);
+  } else {
+    history_list_.push_front(frame);
+    node.history_pos = history_list_.begin();
+  }
+}
+
+void LruKFrameReplacer::access(Frame *frame)
+{
+  auto iter = nodes_.find(frame);
+  if (iter == nodes_.end()) {
+    return;
+  }
+
+  Node &node = iter->second;
+  if (node.history.size() >= k_) {
+    cache_set_.erase(CacheKey(node.history.front(), frame));
+  }
+
+  const bool in_history_list = node.history.size() < k_;
+  record(node);
+
+  if (node.history.size() >= k_) {
+    if (in_history_list) {
+      history_list_.erase(node.history_pos);
+    }
+    cache_set_.emplace(node.history.front(), frame);
+  }
+}
+
+void LruKFrameReplacer::remove(Frame *frame)
+{
+  auto iter = nodes_.find(frame);
+  if (iter == nodes_.end()) {
+    return;
+  }
+
+  Node &node = iter->second;
+  if (node.history.size() >= k_) {
+    cache_set_.erase(CacheKey(node.history.front(), frame));
+  } else {
+    history_list_.erase(node.history_pos);
+  }
+  nodes_.erase(iter);
+}
+
+void LruKFrameReplacer::foreach_victim(const function<bool(Frame *)> &visitor)
+{
+  for (auto iter = history_list_.rbegin(); iter != history_list_.rend(); ++iter) {
+    if (!visitor(*iter)) {
+      return;
+    }
+  }
+
+  for (const CacheKey &key : cache_set_) {
+    if (!visitor(key.second)) {
+      return;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TwoQFrameReplacer::TwoQFrameReplacer(int capacity)
+    : a1in_limit_(max(capacity / 4, 1)), a1out_limit_(max(capacity / 2, 1))
+{}
+
+void TwoQFrameReplacer::insert(Frame *frame)
+{
+  Node &node = nodes_[frame];
+
+  auto ghost_iter = a1out_positions_.find(frame->frame_id());
+  if (ghost_iter != a1out_positions_.end()) {
+    a1out_.erase(ghost_iter->second);
+    a1out_positions_.erase(ghost_iter);
+
+    am_.push_front(frame);
+    node.in_am = true;
+    node.pos   = am_.begin();
+  } else {
+    a1in_.push_front(frame);
+    node.in_am = false;
+    node.pos   = a1in_.begin();
+  }
+}
+
+void TwoQFrameReplacer::access(Frame *frame)
+{
+  auto iter = nodes_.find(frame);
+  if (iter == nodes_.end()) {
+    return;
+  }
+
+  // A1in 中的页面再次访问不做处理，短时间内的多次访问通常是同一个操作引起的
+  Node &node = iter->second;
+  if (node.in_am) {
+    am_.splice(am_.begin(), am_, node.pos);
+  }
+}
+
+void TwoQFrameReplacer::remove(Frame *frame)
+{
+  auto iter = nodes_.find(frame);
+  if (iter == nodes_.end()) {
+    return;
+  }
+
+  Node &node = iter->second;
+  if (node.in_am) {
+    am_.erase(node.pos);
+  } else {
+    a1in_.erase(node.pos);
+
+    const FrameId &frame_id = frame->frame_id();
+    if (a1out_positions_.find(frame_id) == a1out_positions_.end()) {
+      a1out_.push_front(frame_id);
+      a1out_positions_[frame_id] = a1out_.begin();
+      if (a1out_.size() > a1out_limit_) {
+        a1out_positions_.erase(a1out_.back());
+        a1out_.pop_back();
+      }
+    }
+  }
+  nodes_.erase(iter);
+}
+
+void TwoQFrameReplacer::foreach_victim(const function<bool(Frame *)> &visitor)
+{
+  list<Frame *> *first  = &a1in_;
+  list<Frame *> *second = &am_;
+  if (a1in_.size() <= a1in_limit_) {
+    swap(first, second);
+  }
+
+  for (list<Frame *> *queue : {first, second}) {
+    for (auto iter = queue->rbegin(); iter != queue->rend(); ++iter) {
+      if (!visitor(*iter)) {
+        return;
+      }
+    }
+  }
+}
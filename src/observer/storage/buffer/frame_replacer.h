@@ -0,0 +1,185 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/functional.h"
+#include "common/lang/list.h"
+#include "common/lang/memory.h"
+#include "common/lang/set.h"
+#include "common/lang/unordered_map.h"
+#include "common/lang/utility.h"
+#include "common/lang/vector.h"
+#include "common/sys/rc.h"
+#include "storage/buffer/frame.h"
+
+/**
+ * @brief 页面置换策略
+ * @ingroup BufferPool
+ */
+enum class FrameReplacerType
+{
+  LRU,    ///< 淘汰最久没有访问的页面。一次大的扫描就会把所有热点页面挤出去
+  LRU_K,  ///< 按照倒数第K次访问的时间淘汰，只访问过一次的页面最先被淘汰
+  TWO_Q,  ///< 2Q 算法。第一次访问的页面先放在FIFO队列中，再次访问才进入LRU队列
+};
+
+const char *frame_replacer_type_name(FrameReplacerType type);
+
+/**
+ * @brief 根据名字获取置换策略，名字不区分大小写
+ * @return 不认识的名字返回 RC::INVALID_ARGUMENT
+ */
+RC frame_replacer_type_from_string(const char *name, FrameReplacerType &type);
+
+/**
+ * @brief 页面置换策略的接口
+ * @ingroup BufferPool
+ * @details 记录缓存中页帧的访问情况，在需要淘汰页面时给出淘汰的先后顺序。
+ * 不是线程安全的，由 BPFrameManager 在分片锁内调用。
+ * 是否能够淘汰（比如页面是否被pin住）由调用方判断，置换策略只负责排序。
+ */
+class FrameReplacer
+{
+public:
+  virtual ~FrameReplacer() = default;
+
+  virtual FrameReplacerType type() const = 0;
+
+  /**
+   * @brief 页帧刚加入缓存，这也是这个页面的第一次访问
+   */
+  virtual void insert(Frame *frame) = 0;
+
+  /**
+   * @brief 缓存中的页帧被访问了一次
+   */
+  virtual void access(Frame *frame) = 0;
+
+  /**
+   * @brief 页帧从缓存中移除。调用时页帧的 FrameId 还是有效的
+   */
+  virtual void remove(Frame *frame) = 0;
+
+  /**
+   * @brief 按照淘汰的优先顺序遍历页帧，最应该被淘汰的在最前面
+   * @param visitor 返回false时停止遍历
+   */
+  virtual void foreach_victim(const function<bool(Frame *)> &visitor) = 0;
+
+  /**
+   * @brief 创建置换策略
+   * @param capacity 预计缓存的页帧个数，有些策略根据它决定各个队列的长度
+   */
+  static unique_ptr<FrameReplacer> create(FrameReplacerType type, int capacity);
+};
+
+/**
+ * @brief 最近最少使用
+ * @ingroup BufferPool
+ */
+class LruFrameReplacer : public FrameReplacer
+{
+public:
+  FrameReplacerType type() const override { return FrameReplacerType::LRU; }
+
+  void insert(Frame *frame) override;
+  void access(Frame *frame) override;
+  void remove(Frame *frame) override;
+  void foreach_victim(const function<bool(Frame *)> &visitor) override;
+
+private:
+  list<Frame *>                                   lru_list_;  /// 最近访问的在前面
+  unordered_map<Frame *, list<Frame *>::iterator> positions_;
+};
+
+/**
+ * @brief LRU-K 置换策略
+ * @ingroup BufferPool
+ * @details 参考 The LRU-K Page Replacement Algorithm For Database Disk Buffering。
+ * 每个页帧记录最近K次访问的逻辑时间，淘汰倒数第K次访问最早的页面。
+ * 访问次数不足K次的页面认为倒数第K次访问的时间是无穷远，最先被淘汰，它们之间按照第一次访问的先后顺序淘汰。
+ * 所以全表扫描只访问一次的页面不会把多次访问的B+树内部节点挤出去。
+ */
+class LruKFrameReplacer : public FrameReplacer
+{
+public:
+  explicit LruKFrameReplacer(int k = 2);
+
+  FrameReplacerType type() const override { return FrameReplacerType::LRU_K; }
+
+  void insert(Frame *frame) override;
+  void access(Frame *frame) override;
+  void remove(Frame *frame) override;
+  void foreach_victim(const function<bool(Frame *)> &visitor) override;
+
+private:
+  struct Node
+  {
+    vector<uint64_t>        history;      /// 最近K次访问的时间，最早的在前面
+    list<Frame *>::iterator history_pos;  /// 在 history_list_ 中的位置
+  };
+
+  using CacheKey = pair<uint64_t, Frame *>;  /// 倒数第K次访问的时间
+
+  void record(Node &node);
+
+private:
+  const size_t                 k_;
+  uint64_t                     clock_ = 0;     /// 逻辑时钟，每次访问加1
+  list<Frame *>                history_list_;  /// 访问次数不足K次的页帧，最早加入的在后面
+  set<CacheKey>                cache_set_;     /// 访问了K次及以上的页帧
+  unordered_map<Frame *, Node> nodes_;
+};
+
+/**
+ * @brief 2Q 置换策略
+ * @ingroup BufferPool
+ * @details 参考 2Q: A Low Overhead High Performance Buffer Management Replacement Algorithm。
+ * 新加入的页面放在 A1in FIFO 队列中，在 A1in 中再次访问不会改变它的位置。
+ * 从 A1in 淘汰的页面会记录在 A1out 中（只记录 FrameId，不占用页帧），
+ * 如果页面在 A1out 中时被再次读入，说明它是热点页面，直接放到 Am LRU 队列中。
+ * A1in 的长度超过容量的1/4时优先淘汰 A1in 中的页面，否则淘汰 Am 中的页面。
+ */
+class TwoQFrameReplacer : public FrameReplacer
+{
+public:
+  explicit TwoQFrameReplacer(int capacity);
+
+  FrameReplacerType type() const override { return FrameReplacerType::TWO_Q; }
+
+  void insert(Frame *frame) override;
+  void access(Frame *frame) override;
+  void remove(Frame *frame) override;
+  void foreach_victim(const function<bool(Frame *)> &visitor) override;
+
+private:
+  class FrameIdHasher
+  {
+  public:
+    size_t operator()(const FrameId &frame_id) const { return frame_id.hash(); }
+  };
+
+  struct Node
+  {
+    bool                    in_am;
+    list<Frame *>::iterator pos;
+  };
+
+private:
+  const size_t  a1in_limit_;   /// Kin
+  const size_t  a1out_limit_;  /// Kout
+  list<Frame *> a1in_;         /// 新加入的在前面
+  list<Frame *> am_;           /// 最近访问的在前面
+  list<FrameId> a1out_;        /// 新加入的在前面
+
+  unordered_map<Frame *, Node>                                   nodes_;
+  unordered_map<FrameId, list<FrameId>::iterator, FrameIdHasher> a1out_positions_;
+};
@@ -0,0 +1,28 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/buffer/page.h"
+#include "common/lang/algorithm.h"
+
+bool page_check_sum_valid(const Page &page)
+{
+  if (page.check_sum == page_check_sum(page)) {
+    return true;
+  }
+
+  if (page.check_sum == crc32(page.data, BP_PAGE_DATA_SIZE)) {
+    return true;
+  }
+
+  if (page.lsn == 0 && page.check_sum == 0) {
+    return all_of(page.data, page.data + BP_PAGE_DATA_SIZE, [](char c) { return c == 0; });
+  }
+  return false;
+}
@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/math/crc.h"
 #include "common/types.h"
 #include <stdint.h>
 
@@ -36,3 +37,26 @@ struct Page
   CheckSum check_sum;
   char     data[BP_PAGE_DATA_SIZE];
 };
+
+/**
+ * @brief 页面内存的对齐大小
+ * @details 使用 O_DIRECT 读写文件时，内存地址、文件偏移和读写的长度都需要按照磁盘的逻辑块大小对齐，
+ * 这里统一按照4K对齐。页面大小是它的整数倍，所以连续分配的页面也都是对齐的。
+ */
+static constexpr const int BP_PAGE_ALIGN = 4096;
+
+static_assert(sizeof(Page) == BP_PAGE_SIZE, "page size should be BP_PAGE_SIZE");
+static_assert(BP_PAGE_SIZE % BP_PAGE_ALIGN == 0, "page size should be a multiple of BP_PAGE_ALIGN");
+
+/**
+ * @brief 计算页面的校验和
+ * @details 只计算页面数据部分，LSN 和校验和本身不在计算范围内
+ */
+inline CheckSum page_check_sum(const Page &page) { return crc32c(page.data, BP_PAGE_DATA_SIZE); }
+
+/**
+ * @brief 检查页面的校验和，用来发现写了一半的页面或者损坏的页面
+ * @details 之前的版本使用 crc32 计算校验和，这里兼容旧的校验和。
+ * 从来没有写过的页面（比如文件中的空洞）全部是0，也认为是有效的
+ */
+bool page_check_sum_valid(const Page &page);
@@ -0,0 +1,75 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "storage/buffer/page_arena.h"
+#include "common/log/log.h"
+
+/// x86-64 和 aarch64 上默认的大页大小
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+PageArena::~PageArena()
+{
+  if (pages_ != nullptr) {
+    munmap(pages_, mapped_size_);
+    pages_ = nullptr;
+  }
+}
+
+RC PageArena::init(size_t page_num, bool huge_page)
+{
+  if (pages_ != nullptr) {
+    LOG_WARN("page arena has been initialized");
+    return RC::INTERNAL;
+  }
+
+  const size_t size = page_num * sizeof(Page);
+  void        *addr = MAP_FAILED;
+
+  size_t mapped_size = size;
+  if (huge_page) {
+    // 使用大页时，长度需要是大页大小的整数倍
+    mapped_size = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    addr        = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (addr != MAP_FAILED) {
+      memory_type_ = PageArenaMemory::HUGETLB;
+    } else {
+      LOG_WARN("failed to mmap huge pages, fallback to transparent huge pages. size=%ld, error=%s",
+               mapped_size, strerror(errno));
+    }
+  }
+
+  if (addr == MAP_FAILED) {
+    addr = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) {
+      LOG_ERROR("failed to mmap page arena. size=%ld, error=%s", mapped_size, strerror(errno));
+      return RC::NOMEM;
+    }
+
+    memory_type_ = PageArenaMemory::NORMAL;
+    if (huge_page) {
+      if (madvise(addr, mapped_size, MADV_HUGEPAGE) == 0) {
+        memory_type_ = PageArenaMemory::TRANSPARENT;
+      } else {
+        LOG_WARN("failed to enable transparent huge pages, use normal pages. error=%s", strerror(errno));
+      }
+    }
+  }
+
+  pages_       = static_cast<Page *>(addr);
+  page_num_    = page_num;
+  mapped_size_ = mapped_size;
+  LOG_INFO("page arena init. page num=%ld, mapped size=%ld, memory type=%d",
+           page_num, mapped_size, static_cast<int>(memory_type_));
+  return RC::SUCCESS;
+}
@@ -0,0 +1,60 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stddef.h>
+
+#include "common/sys/rc.h"
+#include "storage/buffer/page.h"
+
+/**
+ * @brief 页面内存使用的系统内存页
+ * @ingroup BufferPool
+ */
+enum class PageArenaMemory
+{
+  NORMAL,       ///< 普通的4K内存页
+  TRANSPARENT,  ///< 透明大页，由内核在后台合并，不保证一定是大页
+  HUGETLB,      ///< 预留的大页（MAP_HUGETLB），需要系统预先配置 vm.nr_hugepages
+};
+
+/**
+ * @brief 所有页帧的页面内存
+ * @ingroup BufferPool
+ * @details 使用一次 mmap 申请一整块连续的内存，按照系统页对齐，可以直接使用 O_DIRECT 读写。
+ * 页帧很多时随机访问页面会有大量的TLB miss，可以使用大页减少TLB miss：
+ * 先尝试 MAP_HUGETLB，失败时使用普通的内存页并通过 madvise 开启透明大页，都不支持时就是普通的内存页。
+ */
+class PageArena
+{
+public:
+  PageArena() = default;
+  ~PageArena();
+
+  PageArena(const PageArena &)            = delete;
+  PageArena &operator=(const PageArena &) = delete;
+
+  /**
+   * @param page_num 页面个数
+   * @param huge_page 是否尝试使用大页
+   */
+  RC init(size_t page_num, bool huge_page);
+
+  Page           *pages() const { return pages_; }
+  size_t          page_num() const { return page_num_; }
+  PageArenaMemory memory_type() const { return memory_type_; }
+
+private:
+  Page           *pages_       = nullptr;
+  size_t          page_num_    = 0;
+  size_t          mapped_size_ = 0;
+  PageArenaMemory memory_type_ = PageArenaMemory::NORMAL;
+};
@@ -17,6 +17,7 @@ See the Mulan PSL v2 for more details. */
 #include "storage/clog/log_file.h"
 #include "storage/clog/log_replayer.h"
 #include "common/lang/chrono.h"
+#include "common/conf/ini.h"
 
 using namespace common;
 
@@ -26,7 +27,39 @@ using namespace common;
 RC DiskLogHandler::init(const char *path)
 {
   const int max_entry_number_per_file = 1000;
-  return file_manager_.init(path, max_entry_number_per_file);
+  RC rc = file_manager_.init(path, max_entry_number_per_file);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  const string section = "CLOG";
+  Ini         *config  = get_properties();
+
+  string sync_policy = config->get("SYNC_POLICY", log_sync_policy_name(file_manager_.sync_policy()), section);
+  LogSyncPolicy policy;
+  rc = log_sync_policy_from_string(sync_policy.c_str(), policy);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("invalid clog sync policy: %s", sync_policy.c_str());
+    return rc;
+  }
+  set_sync_policy(policy);
+
+  string batch_size = config->get("FLUSH_BATCH_SIZE", "", section);
+  if (!batch_size.empty()) {
+    set_flush_batch_size(atoi(batch_size.c_str()));
+  }
+  string max_wait_us = config->get("FLUSH_MAX_WAIT_US", "", section);
+  if (!max_wait_us.empty()) {
+    set_flush_max_wait(chrono::microseconds(atol(max_wait_us.c_str())));
+  }
+  string archive_directory = config->get("ARCHIVE_DIRECTORY", "", section);
+  if (!archive_directory.empty()) {
+    file_manager_.set_archive_directory(archive_directory.c_str());
+  }
+
+  LOG_INFO("init disk log handler. path=%s, sync policy=%s, flush batch size=%d, flush max wait=%ldus",
+           path, log_sync_policy_name(policy), flush_batch_size_, (long)flush_max_wait_.count());
+  return RC::SUCCESS;
 }
 
 RC DiskLogHandler::start()
@@ -49,7 +82,12 @@ RC DiskLogHandler::stop()
     return RC::INTERNAL;
   }
 
-  running_.store(false);
+  {
+    lock_guard guard(mutex_);
+    running_.store(false);
+  }
+  append_cond_.notify_all();
+  flush_cond_.notify_all();
 
   LOG_INFO("log handler stopped");
   return RC::SUCCESS;
@@ -144,14 +182,20 @@ RC DiskLogHandler::_append(LSN &lsn, LogModule module, vector<char> &&data)
     return rc;
   }
 
+  // 只有刷新线程在等待时才需要加锁通知，避免追加日志时竞争同一把锁。
+  // 刷新线程先设置等待标识再检查缓冲区，这里先追加日志再检查标识，所以不会错过通知
+  if (flusher_waiting_.load()) {
+    lock_guard guard(mutex_);
+    append_cond_.notify_one();
+  }
   return RC::SUCCESS;
 }
 
 RC DiskLogHandler::wait_lsn(LSN lsn)
 {
-  // 直接强制等待。在生产系统中，我们可能会使用条件变量来等待。
-  while (running_.load() && current_flushed_lsn() < lsn) {
-    this_thread::sleep_for(chrono::milliseconds(100));
+  if (current_flushed_lsn() < lsn) {
+    unique_lock lock(mutex_);
+    flush_cond_.wait(lock, [this, lsn]() { return !running_.load() || current_flushed_lsn() >= lsn; });
   }
 
   if (current_flushed_lsn() >= lsn) {
@@ -164,9 +208,8 @@ RC DiskLogHandler::wait_lsn(LSN lsn)
 void DiskLogHandler::thread_func()
 {
   /*
-  这个线程一直不停的循环，检查日志缓冲区中是否有日志在内存中，如果在内存中就刷新到磁盘。
-  这种做法很粗暴简单，与生产数据库的做法不同。生产数据库通常会在内存达到一定量，或者一定时间
-  之后，会刷新一下磁盘。这样做的好处是减少磁盘的IO次数，提高性能。
+  这个线程在缓冲区为空时等待新日志的通知，被唤醒后把缓冲区中等待的日志作为一批写入磁盘，每批只做一次sync。
+  在上一批日志sync期间追加的日志会自然地合并到下一批中，这样并发提交的事务可以共享一次IO。
   */
   thread_set_name("LogHandler");
   LOG_INFO("log handler thread started");
@@ -192,17 +235,42 @@ void DiskLogHandler::thread_func()
       LOG_INFO("open log file success. file=%s", file_writer.to_string().c_str());
     }
 
+    wait_for_entries();
+
     int flush_count = 0;
-    rc = entry_buffer_.flush(file_writer, flush_count);
+    rc = entry_buffer_.flush(file_writer, flush_count, flush_batch_size_);
     if (OB_FAIL(rc) && RC::LOG_FILE_FULL != rc) {
       LOG_WARN("failed to flush log entry buffer. rc=%s", strrc(rc));
     }
 
-    if (flush_count == 0 && rc == RC::SUCCESS) {
-      this_thread::sleep_for(chrono::milliseconds(100));
-      continue;
+    if (flush_count > 0) {
+      lock_guard guard(mutex_);
+      flush_cond_.notify_all();
+    } else if (OB_SUCC(rc)) {
+      // 空闲时也要按照持久化策略同步一下，比如PER_SECOND策略下最后写入的日志
+      rc = file_writer.sync();
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to sync log file. rc=%s", strrc(rc));
+      }
     }
   }
 
   LOG_INFO("log handler thread stopped");
 }
+
+void DiskLogHandler::wait_for_entries()
+{
+  unique_lock lock(mutex_);
+  flusher_waiting_.store(true);
+  // 不能一直等待，PER_SECOND 策略需要定期醒来同步已经写入的日志
+  append_cond_.wait_for(
+      lock, chrono::seconds(1), [this]() { return !running_.load() || entry_buffer_.entry_number() > 0; });
+
+  if (flush_max_wait_.count() > 0 && running_.load() &&
+      (flush_batch_size_ <= 0 || entry_buffer_.entry_number() < flush_batch_size_)) {
+    append_cond_.wait_for(lock, flush_max_wait_, [this]() {
+      return !running_.load() || (flush_batch_size_ > 0 && entry_buffer_.entry_number() >= flush_batch_size_);
+    });
+  }
+  flusher_waiting_.store(false);
+}
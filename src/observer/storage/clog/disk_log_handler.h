@@ -20,6 +20,8 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/deque.h"
 #include "common/lang/memory.h"
 #include "common/lang/thread.h"
+#include "common/lang/mutex.h"
+#include "common/lang/chrono.h"
 #include "storage/clog/log_module.h"
 #include "storage/clog/log_file.h"
 #include "storage/clog/log_buffer.h"
@@ -31,7 +33,9 @@ class LogReplayer;
  * @brief 对外提供服务的CLog模块
  * @ingroup CLog
  * @details 该模块负责日志的写入、读取、回放等功能。
- * 会在后台开启一个线程，一直尝试刷新内存中的日志到磁盘。
+ * 会在后台开启一个线程，负责刷新内存中的日志到磁盘。
+ * 刷新使用组提交(group commit)的方式：追加日志时会唤醒刷新线程，刷新线程把缓冲区中等待的日志
+ * 合并成一次写入，并且每批日志只做一次sync。等待日志落盘的事务通过条件变量等待对应的LSN。
  * 所有的CLog日志文件都存放在指定的目录下，每个日志文件按照日志条数来划分。
  * 调用的顺序应该是：
  * @code {.cpp}
@@ -53,7 +57,7 @@ public:
 
   /**
    * @brief 初始化日志模块
-   *
+   * @details 会从配置文件的 [CLOG] 中读取持久化策略和组提交参数，没有配置就使用默认值。
    * @param path 日志文件存放的目录
    */
   RC init(const char *path) override;
@@ -102,6 +106,30 @@ public:
   /// @brief 当前刷新到哪个日志
   LSN current_flushed_lsn() const { return entry_buffer_.flushed_lsn(); }
 
+  /**
+   * @brief 删除或归档所有日志都小于lsn的日志文件
+   */
+  RC truncate(LSN lsn) override { return file_manager_.remove_files_before(lsn); }
+
+  /**
+   * @brief 设置一批最多刷新多少条日志
+   * @details 等待中的日志达到这个数量时，刷新线程不再等待更多的日志，立即刷盘。
+   * 0 表示不限制每批的日志条数。
+   */
+  void set_flush_batch_size(int32_t batch_size) { flush_batch_size_ = batch_size; }
+  /**
+   * @brief 设置刷新线程被唤醒后，最多等待多长时间来凑够一批日志
+   * @details 稍微等待一下可以让更多并发提交的事务共享一次sync，但是会增加单个事务的提交延迟。
+   * 0 表示被唤醒后立即刷盘。
+   */
+  void set_flush_max_wait(chrono::microseconds max_wait) { flush_max_wait_ = max_wait; }
+  /**
+   * @brief 设置日志文件的持久化策略
+   * @details PER_SECOND 和 NONE 策略下，日志写入文件后就认为已经刷新，wait_lsn 不再等待磁盘同步。
+   * 需要在 start 之前设置。
+   */
+  void set_sync_policy(LogSyncPolicy policy) { file_manager_.set_sync_policy(policy); }
+
 private:
   /**
    * @brief 在缓存中增加一条日志
@@ -118,6 +146,13 @@ private:
    */
   void thread_func();
 
+  /**
+   * @brief 刷新线程等待新的日志
+   * @details 缓冲区为空时一直等待，直到有新的日志或者停止运行。
+   * 有日志但是不够一批时，最多再等待flush_max_wait_。
+   */
+  void wait_for_entries();
+
 private:
   unique_ptr<thread> thread_;          /// 刷新日志的线程
   atomic_bool        running_{false};  /// 是否还要继续运行
@@ -125,5 +160,13 @@ private:
   LogFileManager file_manager_;  /// 管理所有的日志文件
   LogEntryBuffer entry_buffer_;  /// 缓存日志
 
+  mutex              mutex_;                   /// 保护下面两个条件变量
+  condition_variable append_cond_;             /// 追加日志时通知刷新线程
+  condition_variable flush_cond_;              /// 刷新日志后通知等待的事务
+  atomic_bool        flusher_waiting_{false};  /// 刷新线程是否在等待新的日志
+
+  int32_t              flush_batch_size_ = 1024;                      /// 一批最多刷新多少条日志
+  chrono::microseconds flush_max_wait_   = chrono::microseconds(0);  /// 凑够一批日志最多等待多长时间
+
   string path_;  /// 日志文件存放的目录
 };
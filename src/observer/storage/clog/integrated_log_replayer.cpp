@@ -13,8 +13,99 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "storage/clog/integrated_log_replayer.h"
+#include "common/lang/deque.h"
+#include "common/lang/functional.h"
+#include "common/lang/mutex.h"
+#include "common/lang/thread.h"
+#include "common/log/log.h"
 #include "storage/clog/log_entry.h"
 
+/**
+ * @brief 并行回放页面日志的线程
+ * @details 每个线程有自己的日志队列，分发线程按照LSN顺序把日志放到队列中，回放线程按照队列顺序回放。
+ * 队列的长度有上限，避免回放跟不上读取日志的速度时占用过多内存。
+ */
+class LogReplayWorker
+{
+public:
+  LogReplayWorker(IntegratedLogReplayer &replayer, atomic<RC> &first_error)
+      : replayer_(replayer), first_error_(first_error)
+  {}
+
+  ~LogReplayWorker() { stop(); }
+
+  void start() { thread_ = thread(&LogReplayWorker::run, this); }
+
+  /**
+   * @brief 把一条日志放到回放队列中，如果队列满了就等待
+   */
+  void push(LogEntry &&entry)
+  {
+    unique_lock<mutex> lock(mutex_);
+    not_full_.wait(lock, [this]() { return queue_.size() < MAX_QUEUE_SIZE; });
+    queue_.push_back(std::move(entry));
+    not_empty_.notify_one();
+  }
+
+  /**
+   * @brief 回放完队列中所有的日志后退出
+   */
+  void stop()
+  {
+    {
+      lock_guard<mutex> lock(mutex_);
+      stopping_ = true;
+      not_empty_.notify_one();
+    }
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+private:
+  void run()
+  {
+    while (true) {
+      LogEntry entry;
+      {
+        unique_lock<mutex> lock(mutex_);
+        not_empty_.wait(lock, [this]() { return !queue_.empty() || stopping_; });
+        if (queue_.empty()) {
+          break;
+        }
+        entry = std::move(queue_.front());
+        queue_.pop_front();
+        not_full_.notify_one();
+      }
+
+      // 出错之后不再回放，但是仍然要消费队列，不让分发线程阻塞
+      if (first_error_.load() != RC::SUCCESS) {
+        continue;
+      }
+
+      RC rc = replayer_.replay_page_entry(entry);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to replay log entry. entry=%s, rc=%s", entry.to_string().c_str(), strrc(rc));
+        RC expected = RC::SUCCESS;
+        first_error_.compare_exchange_strong(expected, rc);
+      }
+    }
+  }
+
+private:
+  static constexpr size_t MAX_QUEUE_SIZE = 4096;
+
+  IntegratedLogReplayer &replayer_;
+  atomic<RC>            &first_error_;
+
+  mutex              mutex_;
+  condition_variable not_empty_;
+  condition_variable not_full_;
+  deque<LogEntry>    queue_;
+  bool               stopping_ = false;
+  thread             thread_;
+};
+
 IntegratedLogReplayer::IntegratedLogReplayer(BufferPoolManager &bpm)
     : buffer_pool_log_replayer_(bpm),
       record_log_replayer_(bpm),
@@ -29,20 +120,118 @@ IntegratedLogReplayer::IntegratedLogReplayer(BufferPoolManager &bpm, unique_ptr<
       trx_log_replayer_(std::move(trx_log_replayer))
 {}
 
+IntegratedLogReplayer::~IntegratedLogReplayer() { stop_workers(); }
+
+RC IntegratedLogReplayer::set_worker_num(int worker_num)
+{
+  if (!workers_.empty()) {
+    LOG_WARN("log replay workers have been started");
+    return RC::INTERNAL;
+  }
+
+  if (worker_num <= 1) {
+    return RC::SUCCESS;
+  }
+
+  for (int i = 0; i < worker_num; i++) {
+    workers_.emplace_back(make_unique<LogReplayWorker>(*this, worker_rc_));
+    workers_.back()->start();
+  }
+  LOG_INFO("start %d log replay workers", worker_num);
+  return RC::SUCCESS;
+}
+
 RC IntegratedLogReplayer::replay(const LogEntry &entry)
+{
+  switch (entry.module().id()) {
+    case LogModule::Id::BUFFER_POOL:
+    case LogModule::Id::RECORD_MANAGER:
+    case LogModule::Id::BPLUS_TREE: {
+      if (workers_.empty()) {
+        return replay_page_entry(entry);
+      }
+
+      RC rc = worker_rc_.load();
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+
+      // 读取日志时 entry 会被复用，所以这里要复制一份
+      LogEntry copied_entry;
+      rc = copied_entry.init(
+          entry.lsn(), entry.module(), vector<char>(entry.data(), entry.data() + entry.payload_size()));
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to copy log entry. rc=%s", strrc(rc));
+        return rc;
+      }
+      workers_[partition(entry)]->push(std::move(copied_entry));
+      return RC::SUCCESS;
+    }
+    // 事务日志只是在内存中记录事务的操作，不会访问页面，真正的回滚在 on_done 中，那时页面日志都已经回放完成
+    case LogModule::Id::TRANSACTION: return trx_log_replayer_->replay(entry);
+    default: return RC::INVALID_ARGUMENT;
+  }
+}
+
+RC IntegratedLogReplayer::replay_page_entry(const LogEntry &entry)
 {
   switch (entry.module().id()) {
     case LogModule::Id::BUFFER_POOL: return buffer_pool_log_replayer_.replay(entry);
     case LogModule::Id::RECORD_MANAGER: return record_log_replayer_.replay(entry);
     case LogModule::Id::BPLUS_TREE: return bplus_tree_log_replayer_.replay(entry);
-    case LogModule::Id::TRANSACTION: return trx_log_replayer_->replay(entry);
     default: return RC::INVALID_ARGUMENT;
   }
 }
 
+int IntegratedLogReplayer::partition(const LogEntry &entry) const
+{
+  // 长度不对的日志交给回放器报错就可以了
+  if (entry.payload_size() < static_cast<int32_t>(sizeof(BufferPoolLogEntry))) {
+    return 0;
+  }
+
+  int32_t buffer_pool_id = -1;
+  PageNum page_num       = -1;
+  switch (entry.module().id()) {
+    case LogModule::Id::BUFFER_POOL: {
+      // buffer pool 日志修改的是文件头页中的页面分配信息
+      auto log = reinterpret_cast<const BufferPoolLogEntry *>(entry.data());
+      buffer_pool_id = log->buffer_pool_id;
+      page_num       = BP_HEADER_PAGE;
+    } break;
+    case LogModule::Id::RECORD_MANAGER: {
+      auto log = reinterpret_cast<const RecordLogHeader *>(entry.data());
+      buffer_pool_id = log->buffer_pool_id;
+      page_num       = log->page_num;
+    } break;
+    default: {
+      // B+树日志的开头是 buffer pool id
+      memcpy(&buffer_pool_id, entry.data(), sizeof(buffer_pool_id));
+    } break;
+  }
+
+  size_t hash_val = hash<int32_t>()(buffer_pool_id) * 31 + hash<PageNum>()(page_num);
+  return static_cast<int>(hash_val % workers_.size());
+}
+
+RC IntegratedLogReplayer::stop_workers()
+{
+  for (auto &worker : workers_) {
+    worker->stop();
+  }
+  workers_.clear();
+  return worker_rc_.load();
+}
+
 RC IntegratedLogReplayer::on_done()
 {
-  RC rc = buffer_pool_log_replayer_.on_done();
+  RC rc = stop_workers();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to replay page logs. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rc = buffer_pool_log_replayer_.on_done();
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to do buffer pool log replay. rc=%s", strrc(rc));
     return rc;
@@ -59,10 +248,12 @@ RC IntegratedLogReplayer::on_done()
     return rc;
   }
 
-  rc = trx_log_replayer_->on_done();
-  if (OB_FAIL(rc)) {
-    LOG_WARN("failed to do mvcc trx log replay. rc=%s", strrc(rc));
-    return rc;
+  if (trx_log_replayer_) {
+    rc = trx_log_replayer_->on_done();
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to do mvcc trx log replay. rc=%s", strrc(rc));
+      return rc;
+    }
   }
 
   return RC::SUCCESS;
@@ -14,6 +14,9 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/atomic.h"
+#include "common/lang/memory.h"
+#include "common/lang/vector.h"
 #include "storage/clog/log_replayer.h"
 #include "storage/buffer/buffer_pool_log.h"
 #include "storage/record/record_log.h"
@@ -21,11 +24,14 @@ See the Mulan PSL v2 for more details. */
 #include "storage/trx/mvcc_trx_log.h"
 
 class BufferPoolManager;
+class LogReplayWorker;
 
 /**
  * @brief 整体日志回放类
  * @ingroup Clog
- * @details 负责回放所有日志，是其它各模块日志回放的分发器
+ * @details 负责回放所有日志，是其它各模块日志回放的分发器。
+ * 可以指定多个回放线程并行回放页面相关的日志（buffer pool、record、B+树），分发规则见 partition。
+ * 同一个页面的日志总是交给同一个线程，按照LSN顺序回放；事务日志仍然在调用线程上顺序回放。
  */
 class IntegratedLogReplayer : public LogReplayer
 {
@@ -44,7 +50,13 @@ public:
    * 区别于另一个构造函数，这个构造函数可以指定不同的事务日志回放器。比如进程启动时可以指定选择使用VacuousTrx还是MvccTrx。
    */
   IntegratedLogReplayer(BufferPoolManager &bpm, unique_ptr<LogReplayer> trx_log_replayer);
-  virtual ~IntegratedLogReplayer() = default;
+  virtual ~IntegratedLogReplayer();
+
+  /**
+   * @brief 设置并行回放的线程数
+   * @details 需要在回放第一条日志之前调用。线程数不大于1时，所有日志都在调用线程上回放。
+   */
+  RC set_worker_num(int worker_num);
 
   //! @copydoc LogReplayer::replay
   RC replay(const LogEntry &entry) override;
@@ -52,9 +64,32 @@ public:
   //! @copydoc LogReplayer::on_done
   RC on_done() override;
 
+  /**
+   * @brief 回放页面相关的日志
+   * @details 由回放线程调用，也可能在调用线程上直接调用
+   */
+  RC replay_page_entry(const LogEntry &entry);
+
+private:
+  /**
+   * @brief 计算一条页面日志应该交给哪个回放线程
+   * @details buffer pool 日志只修改文件头页，record 日志只修改一个数据页，按照 (buffer_pool_id, page_num) 分发。
+   * B+树的一条日志会修改多个页面，并且回放时需要读取树的头页，所以同一个索引文件的B+树日志都交给同一个线程。
+   */
+  int partition(const LogEntry &entry) const;
+
+  /**
+   * @brief 等待所有回放线程处理完所有的日志并退出
+   * @return 回放线程遇到的第一个错误
+   */
+  RC stop_workers();
+
 private:
   BufferPoolLogReplayer   buffer_pool_log_replayer_;  ///< 缓冲池日志回放器
   RecordLogReplayer       record_log_replayer_;       ///< record manager 日志回放器
   BplusTreeLogReplayer    bplus_tree_log_replayer_;   ///< bplus tree 日志回放器
   unique_ptr<LogReplayer> trx_log_replayer_;          ///< trx 日志回放器
+
+  vector<unique_ptr<LogReplayWorker>> workers_;                  ///< 并行回放页面日志的线程
+  atomic<RC>                          worker_rc_{RC::SUCCESS};  ///< 回放线程遇到的第一个错误
 };
\ No newline at end of file
@@ -15,17 +15,34 @@ See the Mulan PSL v2 for more details. */
 #include "storage/clog/log_buffer.h"
 #include "storage/clog/log_file.h"
 #include "common/lang/chrono.h"
+#include "common/lang/thread.h"
+#include "common/log/log.h"
 
 using namespace common;
 
+/// 没有经过日志回放（init）的缓冲区也可以直接追加日志，LSN 从 0 开始
+LogEntryBuffer::LogEntryBuffer() { init(0); }
+
 RC LogEntryBuffer::init(LSN lsn, int32_t max_bytes /*= 0*/)
 {
-  current_lsn_.store(lsn);
-  flushed_lsn_.store(lsn);
-
   if (max_bytes > 0) {
     max_bytes_ = max_bytes;
   }
+
+  slot_count_ = 1;
+  while (slot_count_ * SLOT_RESERVE_BYTES < max_bytes_) {
+    slot_count_ <<= 1;
+  }
+  slot_mask_ = slot_count_ - 1;
+
+  slots_ = make_unique<Slot[]>(slot_count_);
+  for (int64_t i = 0; i < slot_count_; i++) {
+    slots_[i].entry.reserve(SLOT_RESERVE_BYTES);
+  }
+
+  current_lsn_.store(lsn);
+  released_lsn_.store(lsn);
+  flushed_lsn_.store(lsn);
   return RC::SUCCESS;
 }
 
@@ -36,71 +53,98 @@ RC LogEntryBuffer::append(LSN &lsn, LogModule::Id module_id, vector<char> &&data
 
 RC LogEntryBuffer::append(LSN &lsn, LogModule module, vector<char> &&data)
 {
-  /// 控制当前buffer使用的内存
-  /// 简单粗暴，强制原地等待
-  /// 但是如果当前想要新插入的日志比较大，不会做控制。所以理论上容纳的最大buffer内存是2*max_bytes_
-  while (bytes_.load() >= max_bytes_) {
-    this_thread::sleep_for(chrono::milliseconds(10));
+  ASSERT(slots_ != nullptr, "log entry buffer is not initialized");
+  if (static_cast<int32_t>(data.size()) > LogEntry::max_payload_size()) {
+    LOG_WARN("log entry size is too large. size=%d, max_payload_size=%d", data.size(), LogEntry::max_payload_size());
+    return RC::INVALID_ARGUMENT;
   }
 
-  LogEntry entry;
-  RC rc = entry.init(lsn, module, std::move(data));
-  if (OB_FAIL(rc)) {
-    LOG_WARN("failed to init log entry. rc=%s", strrc(rc));
-    return rc;
+  lsn = current_lsn_.fetch_add(1) + 1;
+
+  /// 槽位还没有被刷盘线程释放，说明缓冲区满了，需要等待
+  /// 先让出CPU重试几次，刷盘比较慢时再睡眠等待
+  for (int i = 0; lsn - released_lsn_.load(memory_order_acquire) > slot_count_; i++) {
+    if (i < 64) {
+      this_thread::yield();
+    } else {
+      this_thread::sleep_for(chrono::microseconds(100));
+    }
   }
 
-  lock_guard guard(mutex_);
-  lsn = ++current_lsn_;
-  entry.set_lsn(lsn);
+  Slot &s = slot(lsn);
+  RC    rc = s.entry.reuse_init(lsn, module, std::move(data));
+  ASSERT(OB_SUCC(rc), "failed to init log entry. rc=%s", strrc(rc));
 
-  entries_.push_back(std::move(entry));
-  bytes_ += entry.total_size();
-  return RC::SUCCESS;
+  s.lsn.store(lsn, memory_order_release);
+  return rc;
 }
 
-RC LogEntryBuffer::flush(LogFileWriter &writer, int &count)
+RC LogEntryBuffer::flush(LogFileWriter &writer, int &count, int32_t max_count /*= 0*/)
 {
   count = 0;
 
-  while (entry_number() > 0) {
-    LogEntry entry;
-    {
-      lock_guard guard(mutex_);
-      if (entries_.empty()) {
-        break;
-      }
-
-      LogEntry &front_entry = entries_.front();
-      ASSERT(front_entry.lsn() > 0 && front_entry.payload_size() > 0, "invalid log entry");
-      entry = std::move(entries_.front());
-      ASSERT(entry.payload_size() > 0 && entry.lsn() > 0, "invalid log entry");
-      entries_.pop_front();
-      bytes_ -= entry.total_size();
+  const LSN start_lsn = released_lsn_.load(memory_order_relaxed) + 1;
+  const LSN end_lsn   = current_lsn_.load(memory_order_acquire);
+
+  flush_batch_.clear();
+  for (LSN lsn = start_lsn; lsn <= end_lsn; lsn++) {
+    if (max_count > 0 && static_cast<int32_t>(flush_batch_.size()) >= max_count) {
+      break;
     }
-    
-    RC rc = writer.write(entry);
-    if (OB_FAIL(rc)) {
-      lock_guard guard(mutex_);
-      entries_.emplace_front(std::move(entry));
-      LogEntry &front_entry = entries_.front();
-      ASSERT(front_entry.lsn() > 0 && front_entry.payload_size() > 0, "invalid log entry");
-      return rc;
-    } else {
-      ++count;
-      flushed_lsn_ = entry.lsn();
+
+    // 只能刷连续的已经写好的日志
+    Slot &s = slot(lsn);
+    if (s.lsn.load(memory_order_acquire) != lsn) {
+      break;
     }
+    flush_batch_.push_back(&s.entry);
   }
-  
-  return RC::SUCCESS;
+
+  if (flush_batch_.empty()) {
+    return RC::SUCCESS;
+  }
+
+  RC rc = writer.write_batch(flush_batch_, count);
+  if (count == 0) {
+    return rc;
+  }
+
+  // 日志已经写入文件，槽位可以给追加日志的线程使用了。
+  // 特别大的日志会让槽位占用过多内存，写完就释放掉
+  const LSN last_lsn = start_lsn + count - 1;
+  for (LSN lsn = start_lsn; lsn <= last_lsn; lsn++) {
+    LogEntry &entry = slot(lsn).entry;
+    if (entry.capacity() > SLOT_RESERVE_BYTES * 16) {
+      entry.release();
+      entry.reserve(SLOT_RESERVE_BYTES);
+    }
+  }
+  released_lsn_.store(last_lsn, memory_order_release);
+
+  RC sync_rc = writer.sync();
+  if (OB_FAIL(sync_rc)) {
+    LOG_WARN("failed to sync log file. rc=%s", strrc(sync_rc));
+    return sync_rc;
+  }
+  flushed_lsn_.store(last_lsn);
+
+  return rc;
 }
 
 int64_t LogEntryBuffer::bytes() const
 {
-  return bytes_.load();
+  int64_t   bytes   = 0;
+  const LSN end_lsn = current_lsn_.load();
+  for (LSN lsn = released_lsn_.load() + 1; lsn <= end_lsn; lsn++) {
+    const Slot &s = slots_[lsn & slot_mask_];
+    if (s.lsn.load(memory_order_acquire) == lsn) {
+      bytes += s.entry.total_size();
+    }
+  }
+  return bytes;
 }
 
 int32_t LogEntryBuffer::entry_number() const
 {
-  return entries_.size();
+  return static_cast<int32_t>(current_lsn_.load() - released_lsn_.load());
 }
@@ -16,10 +16,9 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/sys/rc.h"
 #include "common/types.h"
-#include "common/lang/mutex.h"
 #include "common/lang/vector.h"
-#include "common/lang/deque.h"
 #include "common/lang/atomic.h"
+#include "common/lang/memory.h"
 #include "storage/clog/log_module.h"
 #include "storage/clog/log_entry.h"
 
@@ -29,15 +28,25 @@ class LogFileWriter;
  * @brief 日志数据缓冲区
  * @ingroup CLog
  * @details 缓存一部分日志在内存中而不是直接写入磁盘。
- * 这里的缓存没有考虑高性能操作，比如使用预分配内存、环形缓冲池等。
- * 在生产数据库中，通常会使用预分配内存形式的缓存来提高性能，并且可以减少内存碎片。
+ * 缓冲区是一个预先分配好的环形数组，每个槽位存放一条日志，槽位的下标就是 LSN 对环形数组大小取模。
+ * 追加日志时不需要加锁：通过一次原子 fetch_add 分配 LSN，也就分配到了对应的槽位，
+ * 然后把日志数据拷贝到槽位预先分配的内存中，最后标记这个槽位已经写好。
+ * 刷盘线程按照 LSN 顺序收集连续的已经写好的槽位，批量写入文件后释放这些槽位。
+ * 如果环形数组满了，追加日志的线程需要等待刷盘线程释放槽位。
+ * @note 只能有一个线程调用flush
  */
 class LogEntryBuffer
 {
 public:
-  LogEntryBuffer()  = default;
+  LogEntryBuffer();
   ~LogEntryBuffer() = default;
 
+  /**
+   * @brief 初始化
+   *
+   * @param lsn 当前最大的LSN，新的日志从lsn + 1开始
+   * @param max_bytes 缓冲区预先分配的内存大小，决定了环形数组有多少个槽位
+   */
   RC init(LSN lsn, int32_t max_bytes = 0);
 
   /**
@@ -48,19 +57,23 @@ public:
 
   /**
    * @brief 刷新缓冲区中的日志到磁盘
-   *
+   * @details 一次取出缓冲区中的一批日志，合并写入文件后只做一次sync，即组提交(group commit)。
+   * 只有sync成功后才会推进flushed_lsn。没有写入文件的日志会留在缓冲区中。
    * @param file_handle 使用它来写文件
    * @param count 刷了多少条日志
+   * @param max_count 一批最多刷多少条日志，0表示不限制
    */
-  RC flush(LogFileWriter &file_writer, int &count);
+  RC flush(LogFileWriter &file_writer, int &count, int32_t max_count = 0);
 
   /**
    * @brief 当前缓冲区中有多少字节的日志
+   * @details 需要遍历缓冲区，仅用于调试和测试
    */
   int64_t bytes() const;
 
   /**
    * @brief 当前缓冲区中有多少条日志
+   * @details 包括已经分配了LSN但是还没有写好数据的日志
    */
   int32_t entry_number() const;
 
@@ -68,12 +81,30 @@ public:
   LSN flushed_lsn() const { return flushed_lsn_.load(); }
 
 private:
-  mutex           mutex_;  /// 当前数据结构一定会在多线程中访问，所以强制使用有效的锁，而不是有条件生效的common::Mutex
-  deque<LogEntry> entries_;  /// 日志缓冲区
-  atomic<int64_t> bytes_;    /// 当前缓冲区中的日志数据大小
+  /**
+   * @brief 环形数组中的一个槽位
+   * @details 对齐到缓存行，避免多个线程写相邻的槽位时互相干扰
+   */
+  struct alignas(64) Slot
+  {
+    atomic<LSN> lsn{0};  /// 槽位中已经写好的日志的LSN，等于期望的LSN时才可以刷盘
+    LogEntry    entry;
+  };
+
+  Slot &slot(LSN lsn) { return slots_[lsn & slot_mask_]; }
+
+private:
+  unique_ptr<Slot[]> slots_;          /// 环形数组
+  int64_t            slot_count_ = 0;  /// 槽位的个数，是2的幂
+  int64_t            slot_mask_  = 0;
+
+  atomic<LSN> current_lsn_{0};   /// 已经分配出去的最大LSN
+  atomic<LSN> released_lsn_{0};  /// 已经写入文件并释放槽位的最大LSN
+  atomic<LSN> flushed_lsn_{0};   /// 已经刷新到磁盘的最大LSN
+
+  vector<const LogEntry *> flush_batch_;  /// 刷盘时收集的一批日志，只在刷盘线程中使用
 
-  atomic<LSN> current_lsn_{0};
-  atomic<LSN> flushed_lsn_{0};
+  int32_t max_bytes_ = 4 * 1024 * 1024;  /// 缓冲区预先分配的内存大小
 
-  int32_t max_bytes_ = 4 * 1024 * 1024;  /// 缓冲区最大字节数
+  static constexpr int32_t SLOT_RESERVE_BYTES = 256;  /// 每个槽位预先分配的日志数据内存
 };
@@ -81,6 +81,24 @@ RC LogEntry::init(LSN lsn, LogModule module, vector<char> &&data)
   return RC::SUCCESS;
 }
 
+RC LogEntry::reuse_init(LSN lsn, LogModule module, vector<char> &&data)
+{
+  if (data.size() > data_.capacity()) {
+    return init(lsn, module, std::move(data));
+  }
+
+  if (static_cast<int32_t>(data.size()) > max_payload_size()) {
+    LOG_DEBUG("log entry size is too large. size=%d, max_payload_size=%d", data.size(), max_payload_size());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  header_.lsn       = lsn;
+  header_.module_id = module.index();
+  header_.size      = static_cast<int32_t>(data.size());
+  data_.assign(data.begin(), data.end());
+  return RC::SUCCESS;
+}
+
 string LogEntry::to_string() const
 {
   return header_.to_string();
@@ -70,6 +70,24 @@ public:
   RC init(LSN lsn, LogModule::Id module_id, vector<char> &&data);
   RC init(LSN lsn, LogModule module, vector<char> &&data);
 
+  /**
+   * @brief 与init相同，但是会尽量复用当前已经分配的内存
+   * @details 如果当前的内存足够存放日志数据，就把数据拷贝过来，否则直接接管data的内存。
+   * 用于日志缓冲区中循环使用的日志对象，避免每条日志都分配一次内存。
+   */
+  RC reuse_init(LSN lsn, LogModule module, vector<char> &&data);
+
+  /// @brief 预先分配存放日志数据的内存
+  void reserve(int32_t size) { data_.reserve(size); }
+  /// @brief 释放日志数据占用的内存
+  void release()
+  {
+    header_.size = 0;
+    vector<char>().swap(data_);
+  }
+  /// @brief 已经分配的存放日志数据的内存大小
+  int32_t capacity() const { return static_cast<int32_t>(data_.capacity()); }
+
   const LogHeader &header() const { return header_; }
   const char      *data() const { return data_.data(); }
   int32_t          payload_size() const { return header_.size; }
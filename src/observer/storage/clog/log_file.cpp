@@ -13,6 +13,10 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
 #include "common/lang/string_view.h"
 #include "common/lang/charconv.h"
@@ -23,6 +27,29 @@ See the Mulan PSL v2 for more details. */
 
 using namespace common;
 
+const char *log_sync_policy_name(LogSyncPolicy policy)
+{
+  switch (policy) {
+    case LogSyncPolicy::PER_COMMIT: return "per-commit";
+    case LogSyncPolicy::PER_BATCH: return "per-batch";
+    case LogSyncPolicy::PER_SECOND: return "per-second";
+    case LogSyncPolicy::NONE: return "none";
+  }
+  return "unknown";
+}
+
+RC log_sync_policy_from_string(const char *name, LogSyncPolicy &policy)
+{
+  for (LogSyncPolicy item :
+      {LogSyncPolicy::PER_COMMIT, LogSyncPolicy::PER_BATCH, LogSyncPolicy::PER_SECOND, LogSyncPolicy::NONE}) {
+    if (0 == strcasecmp(name, log_sync_policy_name(item))) {
+      policy = item;
+      return RC::SUCCESS;
+    }
+  }
+  return RC::INVALID_ARGUMENT;
+}
+
 RC LogFileReader::open(const char *filename)
 {
   filename_ = filename;
@@ -146,22 +173,40 @@ LogFileWriter::~LogFileWriter()
   (void)this->close();
 }
 
-RC LogFileWriter::open(const char *filename, int end_lsn)
+RC LogFileWriter::open(const char *filename, int end_lsn, LogSyncPolicy sync_policy /*= LogSyncPolicy::PER_BATCH*/)
 {
   if (fd_ >= 0) {
     return RC::FILE_OPEN;
   }
 
-  filename_ = filename;
-  end_lsn_ = end_lsn;
+  filename_       = filename;
+  end_lsn_        = end_lsn;
+  sync_policy_    = sync_policy;
+  dirty_          = false;
+  last_sync_time_ = chrono::steady_clock::now();
+
+  int flags = O_WRONLY | O_APPEND | O_CREAT;
+  if (sync_policy_ == LogSyncPolicy::PER_COMMIT) {
+    flags |= O_DSYNC;
+  }
 
-  fd_ = ::open(filename, O_WRONLY | O_APPEND | O_CREAT | O_SYNC, 0644);
+  fd_ = ::open(filename, flags, 0644);
   if (fd_ < 0) {
     LOG_WARN("open file failed. filename=%s, error=%s", filename, strerror(errno));
     return RC::FILE_OPEN;
   }
 
-  LOG_INFO("open file success. filename=%s, fd=%d", filename, fd_);
+#ifdef FALLOC_FL_KEEP_SIZE
+  // 新的日志文件预先分配磁盘空间。使用KEEP_SIZE不改变文件大小，读取日志时不会读到预分配的空间
+  struct stat st;
+  if (0 == fstat(fd_, &st) && st.st_size == 0) {
+    if (0 != fallocate(fd_, FALLOC_FL_KEEP_SIZE, 0, preallocate_bytes_)) {
+      LOG_INFO("failed to preallocate log file. filename=%s, error=%s", filename, strerror(errno));
+    }
+  }
+#endif
+
+  LOG_INFO("open file success. filename=%s, fd=%d, sync policy=%s", filename, fd_, log_sync_policy_name(sync_policy_));
   return RC::SUCCESS;
 }
 
@@ -171,46 +216,116 @@ RC LogFileWriter::close()
     return RC::FILE_NOT_OPENED;
   }
 
+  RC rc = RC::SUCCESS;
+  if (dirty_ && sync_policy_ != LogSyncPolicy::NONE) {
+    if (0 != ::fdatasync(fd_)) {
+      LOG_WARN("sync log file failed. filename=%s, error=%s", filename_.c_str(), strerror(errno));
+      rc = RC::IOERR_SYNC;
+    }
+  }
+
   ::close(fd_);
-  fd_ = -1;
-  return RC::SUCCESS;
+  fd_    = -1;
+  dirty_ = false;
+  return rc;
 }
 
 RC LogFileWriter::write(LogEntry &entry)
 {
-  // 一个日志文件写的日志条数是有限制的
-  if (entry.lsn() > end_lsn_) {
-    return RC::LOG_FILE_FULL;
+  const LogEntry *entries[] = {&entry};
+  int             count     = 0;
+  return write_batch(entries, count);
+}
+
+RC LogFileWriter::write_batch(span<const LogEntry *const> entries, int &count)
+{
+  count = 0;
+  if (fd_ < 0) {
+    return RC::FILE_NOT_OPENED;
   }
 
+  // 每条日志需要两个iovec，分别是日志头和日志数据。
+  // PER_COMMIT 策略下每条日志都要单独写入并持久化
+  const int    max_iov_entries      = IOV_MAX / 2;
+  const int    max_entries_per_call = sync_policy_ == LogSyncPolicy::PER_COMMIT ? 1 : max_iov_entries;
+  struct iovec iov[max_iov_entries * 2];
+
+  LSN last_lsn = last_lsn_;
+  while (count < static_cast<int>(entries.size())) {
+    int iovcnt      = 0;
+    int batch_count = 0;
+    for (size_t i = count; i < entries.size() && batch_count < max_entries_per_call; i++) {
+      const LogEntry &entry = *entries[i];
+      // 一个日志文件写的日志条数是有限制的
+      if (entry.lsn() > end_lsn_) {
+        break;
+      }
+
+      if (entry.lsn() <= last_lsn) {
+        LOG_WARN("write log entry failed. lsn is too small. filename=%s, last_lsn=%ld, entry=%s", 
+                 filename_.c_str(), last_lsn, entry.to_string().c_str());
+        return RC::INVALID_ARGUMENT;
+      }
+
+      iov[iovcnt].iov_base  = const_cast<LogHeader *>(&entry.header());
+      iov[iovcnt++].iov_len = LogHeader::SIZE;
+      iov[iovcnt].iov_base  = const_cast<char *>(entry.data());
+      iov[iovcnt++].iov_len = entry.payload_size();
+
+      last_lsn = entry.lsn();
+      batch_count++;
+    }
+
+    if (batch_count == 0) {
+      return RC::LOG_FILE_FULL;
+    }
+
+    /// WARNING 与单条写入相同，这里也没有处理日志写一半的情况
+    int ret = writevn(fd_, iov, iovcnt);
+    if (0 != ret) {
+      LOG_WARN("write log entries failed. filename=%s, ret = %d, error=%s, first lsn=%ld, count=%d", 
+               filename_.c_str(), ret, strerror(ret), entries[count]->lsn(), batch_count);
+      return RC::IOERR_WRITE;
+    }
+
+    count += batch_count;
+    last_lsn_ = last_lsn;
+    dirty_    = sync_policy_ != LogSyncPolicy::PER_COMMIT;
+  }
+
+  LOG_TRACE("write log entries success. filename=%s, count=%d, last_lsn=%ld", filename_.c_str(), count, last_lsn_);
+  return RC::SUCCESS;
+}
+
+RC LogFileWriter::sync()
+{
   if (fd_ < 0) {
     return RC::FILE_NOT_OPENED;
   }
 
-  if (entry.lsn() <= last_lsn_) {
-    LOG_WARN("write log entry failed. lsn is too small. filename=%s, last_lsn=%ld, entry=%s", 
-             filename_.c_str(), last_lsn_, entry.to_string().c_str());
-    return RC::INVALID_ARGUMENT;
+  if (!dirty_) {
+    return RC::SUCCESS;
   }
 
-  /// WARNING 这里需要处理日志写一半的情况
-  /// 日志只写成功一部分到文件中非常难处理
-  int ret = writen(fd_, reinterpret_cast<const char *>(&entry.header()), LogHeader::SIZE);
-  if (0 != ret) {
-    LOG_WARN("write log entry header failed. filename=%s, ret = %d, error=%s, entry=%s", 
-             filename_.c_str(), ret, strerror(errno), entry.to_string().c_str());
-    return RC::IOERR_WRITE;
+  auto now = chrono::steady_clock::now();
+  switch (sync_policy_) {
+    case LogSyncPolicy::PER_COMMIT:
+    case LogSyncPolicy::NONE: return RC::SUCCESS;
+    case LogSyncPolicy::PER_SECOND: {
+      if (now - last_sync_time_ < chrono::seconds(1)) {
+        return RC::SUCCESS;
+      }
+    } break;
+    case LogSyncPolicy::PER_BATCH: break;
   }
 
-  ret = writen(fd_, entry.data(), entry.payload_size());
-  if (0 != ret) {
-    LOG_WARN("write log entry payload failed. filename=%s, ret = %d, error=%s, entry=%s", 
-             filename_.c_str(), ret, strerror(errno), entry.to_string().c_str());
-    return RC::IOERR_WRITE;
+  if (0 != ::fdatasync(fd_)) {
+    LOG_WARN("sync log file failed. filename=%s, error=%s", filename_.c_str(), strerror(errno));
+    return RC::IOERR_SYNC;
   }
 
-  last_lsn_ = entry.lsn();
-  LOG_TRACE("write log entry success. filename=%s, entry=%s", filename_.c_str(), entry.to_string().c_str());
+  dirty_          = false;
+  last_sync_time_ = now;
   return RC::SUCCESS;
 }
 
@@ -298,6 +413,8 @@ RC LogFileManager::list_files(vector<string> &files, LSN start_lsn)
 {
   files.clear();
 
+  lock_guard<mutex> guard(lock_);
+
   // 这里的代码是AI自动生成的
   // 其实写的不好，我们只需要找到比start_lsn相等或者小的第一个日志文件就可以了
   for (auto &file : log_files_) {
@@ -311,7 +428,9 @@ RC LogFileManager::list_files(vector<string> &files, LSN start_lsn)
 
 RC LogFileManager::last_file(LogFileWriter &file_writer)
 {
+  unique_lock<mutex> guard(lock_);
   if (log_files_.empty()) {
+    guard.unlock();
     return next_file(file_writer);
   }
 
@@ -319,13 +438,16 @@ RC LogFileManager::last_file(LogFileWriter &file_writer)
 
   auto last_file_item = log_files_.rbegin();
   return file_writer.open(last_file_item->second.c_str(), 
-                          last_file_item->first + max_entry_number_per_file_ - 1);
+                          last_file_item->first + max_entry_number_per_file_ - 1,
+                          sync_policy_);
 }
 
 RC LogFileManager::next_file(LogFileWriter &file_writer)
 {
   file_writer.close();
 
+  lock_guard<mutex> guard(lock_);
+
   LSN lsn = 0;
   if (!log_files_.empty()) {
     lsn = log_files_.rbegin()->first + max_entry_number_per_file_;
@@ -335,5 +457,43 @@ RC LogFileManager::next_file(LogFileWriter &file_writer)
   filesystem::path file_path = directory_ / filename;
   log_files_.emplace(lsn, file_path);
 
-  return file_writer.open(file_path.c_str(), lsn + max_entry_number_per_file_ - 1);
+  return file_writer.open(file_path.c_str(), lsn + max_entry_number_per_file_ - 1, sync_policy_);
+}
+
+RC LogFileManager::remove_files_before(LSN lsn)
+{
+  lock_guard<mutex> guard(lock_);
+
+  if (!archive_directory_.empty() && !filesystem::is_directory(archive_directory_)) {
+    error_code ec;
+    if (!filesystem::create_directories(archive_directory_, ec)) {
+      LOG_WARN("failed to create archive directory. directory=%s, error=%s",
+               archive_directory_.c_str(), ec.message().c_str());
+      return RC::FILE_CREATE;
+    }
+  }
+
+  while (log_files_.size() > 1) {
+    auto iter = log_files_.begin();
+    // 文件中最大的LSN也比lsn小，整个文件都不再需要
+    if (iter->first + max_entry_number_per_file_ - 1 >= lsn) {
+      break;
+    }
+
+    error_code ec;
+    if (archive_directory_.empty()) {
+      filesystem::remove(iter->second, ec);
+    } else {
+      filesystem::rename(iter->second, archive_directory_ / iter->second.filename(), ec);
+    }
+    if (ec) {
+      LOG_WARN("failed to remove log file. file=%s, error=%s", iter->second.c_str(), ec.message().c_str());
+      return RC::IOERR_DELETE;
+    }
+
+    LOG_INFO("log file is no longer needed. file=%s, archived=%d, checkpoint lsn=%ld",
+             iter->second.c_str(), !archive_directory_.empty(), lsn);
+    log_files_.erase(iter);
+  }
+  return RC::SUCCESS;
 }
@@ -21,9 +21,33 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/filesystem.h"
 #include "common/lang/fstream.h"
 #include "common/lang/string.h"
+#include "common/lang/span.h"
+#include "common/lang/chrono.h"
+#include "common/lang/mutex.h"
 
 class LogEntry;
 
+/**
+ * @brief 日志文件的持久化策略
+ * @ingroup CLog
+ * @details 决定日志写入文件后什么时候同步到磁盘，以及事务提交等待的日志是否真正持久化了。
+ */
+enum class LogSyncPolicy
+{
+  PER_COMMIT,  ///< 使用O_DSYNC打开文件，每条日志单独写入并持久化
+  PER_BATCH,   ///< 每批日志写入后做一次fdatasync，即组提交
+  PER_SECOND,  ///< 最多每秒做一次fdatasync，进程崩溃不丢数据，但是机器宕机可能丢失最近一秒的日志
+  NONE,        ///< 从不主动持久化，由操作系统决定什么时候写回磁盘
+};
+
+const char *log_sync_policy_name(LogSyncPolicy policy);
+
+/**
+ * @brief 从字符串解析持久化策略
+ * @details 可以使用 per-commit, per-batch, per-second, none，不区分大小写
+ */
+RC log_sync_policy_from_string(const char *name, LogSyncPolicy &policy);
+
 /**
  * @brief 负责处理一个日志文件，包括读取和写入
  * @ingroup CLog
@@ -67,15 +91,35 @@ public:
    * @brief 打开一个日志文件
    * @param filename 日志文件名
    * @param end_lsn 当前日志文件允许的最大LSN（包含）
+   * @param sync_policy 日志文件的持久化策略
    */
-  RC open(const char *filename, int end_lsn);
+  RC open(const char *filename, int end_lsn, LogSyncPolicy sync_policy = LogSyncPolicy::PER_BATCH);
 
-  /// @brief 关闭当前文件
+  /// @brief 关闭当前文件。除了NONE策略，关闭前会把没有持久化的数据同步到磁盘
   RC close();
 
-  /// @brief 写入一条日志
+  /// @brief 写入一条日志。日志头和日志数据使用一次系统调用写入
   RC write(LogEntry &entry);
 
+  /**
+   * @brief 批量写入日志
+   * @details 使用writev把多条日志合并成尽量少的系统调用写入文件。
+   * 如果当前文件容纳不下所有的日志，会写入能容纳的部分，然后返回LOG_FILE_FULL。
+   * 除了PER_COMMIT策略，写入的日志并不保证已经持久化，需要再调用sync。
+   * @param entries 要写入的日志，LSN必须是递增的
+   * @param[out] count 成功写入了多少条日志
+   */
+  RC write_batch(span<const LogEntry *const> entries, int &count);
+
+  /**
+   * @brief 按照持久化策略把已经写入的日志同步到磁盘
+   * @details PER_BATCH 每次调用都会同步，PER_SECOND 距离上次同步超过一秒才会同步，
+   * PER_COMMIT 和 NONE 什么都不做。
+   */
+  RC sync();
+
+  LogSyncPolicy sync_policy() const { return sync_policy_; }
+
   /**
    * @brief 当前文件是否已经打开
    */
@@ -95,6 +139,13 @@ private:
   int    fd_       = -1;  /// 日志文件描述符
   int    last_lsn_ = 0;   /// 写入的最后一条日志LSN
   int    end_lsn_  = 0;   /// 当前日志文件中允许写入的最大的LSN，包括这条日志
+
+  LogSyncPolicy                    sync_policy_ = LogSyncPolicy::PER_BATCH;  /// 持久化策略
+  bool                             dirty_       = false;  /// 是否有写入的数据还没有同步到磁盘
+  chrono::steady_clock::time_point last_sync_time_;       /// 上次同步到磁盘的时间
+
+  /// 新建日志文件时预先分配的磁盘空间，避免追加写入时频繁分配磁盘块
+  static constexpr int64_t preallocate_bytes_ = 1 * 1024 * 1024;
 };
 
 /**
@@ -117,6 +168,10 @@ public:
    */
   RC init(const char *directory, int max_entry_number_per_file);
 
+  /// @brief 设置打开日志文件时使用的持久化策略
+  void          set_sync_policy(LogSyncPolicy policy) { sync_policy_ = policy; }
+  LogSyncPolicy sync_policy() const { return sync_policy_; }
+
   /**
    * @brief 列出所有的日志文件，第一个日志文件包含大于等于start_lsn最小的日志
    *
@@ -137,6 +192,19 @@ public:
    */
   RC next_file(LogFileWriter &file_writer);
 
+  /**
+   * @brief 设置归档目录
+   * @details 设置了归档目录时，不再需要的日志文件会移动到这个目录中，否则直接删除
+   */
+  void set_archive_directory(const char *directory) { archive_directory_ = directory; }
+
+  /**
+   * @brief 删除或归档所有的日志都小于lsn的日志文件
+   * @details 检查点推进之后调用，这些日志在恢复时不再需要。最后一个日志文件正在写入，永远不会删除。
+   * @param lsn 恢复时开始重做的LSN
+   */
+  RC remove_files_before(LSN lsn);
+
 private:
   /**
    * @brief 从文件名称中获取LSN
@@ -150,6 +218,10 @@ private:
 
   filesystem::path directory_;                  /// 日志文件存放的目录
   int              max_entry_number_per_file_;  /// 一个文件最大允许存放多少条日志
+  LogSyncPolicy    sync_policy_ = LogSyncPolicy::PER_BATCH;  /// 日志文件的持久化策略
+
+  filesystem::path archive_directory_;  /// 日志文件归档目录，为空时直接删除
 
+  mutex                      lock_;       /// 保护log_files_，刷新日志和推进检查点在不同的线程中
   map<LSN, filesystem::path> log_files_;  /// 日志文件名和第一个LSN的映射
 };
@@ -96,6 +96,12 @@ public:
 
   virtual LSN current_lsn() const = 0;
 
+  /**
+   * @brief 检查点推进之后，清理恢复时不再需要的日志
+   * @param lsn 恢复时开始重做的LSN，比它小的日志都不再需要
+   */
+  virtual RC truncate(LSN lsn) = 0;
+
   static RC create(const char *name, LogHandler *&handler);
 
 private:
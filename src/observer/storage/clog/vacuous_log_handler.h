@@ -38,6 +38,8 @@ public:
 
   LSN current_lsn() const override { return 0; }
 
+  RC truncate(LSN lsn) override { return RC::SUCCESS; }
+
 private:
   RC _append(LSN &lsn, LogModule module, vector<char> &&) override
   {
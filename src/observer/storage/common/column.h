@@ -73,9 +73,17 @@ public:
    */
   void reference(const Column &column);
 
+  /**
+   * @brief 引用外部的一段内存（比如页面上的列数据），不复制数据，保留当前的列属性
+   * @param data 列数据的起始地址
+   * @param count 列值的个数
+   */
+  void reference(char *data, int count);
+
   void set_column_type(Type column_type) { column_type_ = column_type; }
   void set_count(int count) { count_ = count; }
 
+  bool     own_memory() const { return own_; }
   int      count() const { return count_; }
   int      capacity() const { return capacity_; }
   AttrType attr_type() const { return attr_type_; }
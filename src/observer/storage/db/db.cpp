@@ -17,7 +17,9 @@ See the Mulan PSL v2 for more details. */
 #include <fcntl.h>
 #include <sys/stat.h>
 
+#include "common/conf/ini.h"
 #include "common/lang/string.h"
+#include "common/lang/thread.h"
 #include "common/log/log.h"
 #include "common/os/path.h"
 #include "common/global_context.h"
@@ -32,6 +34,11 @@ using namespace common;
 
 Db::~Db()
 {
+  stop_checkpointer();
+  if (buffer_pool_manager_) {
+    buffer_pool_manager_->stop_page_cleaner();
+  }
+
   for (auto &iter : opened_tables_) {
     delete iter.second;
   }
@@ -67,8 +74,33 @@ RC Db::init(const char *name, const char *dbpath, const char *trx_kit_name, cons
 
   trx_kit_.reset(trx_kit);
 
-  buffer_pool_manager_ = make_unique<BufferPoolManager>();
-  auto dblwr_buffer    = make_unique<DiskDoubleWriteBuffer>(*buffer_pool_manager_);
+  string            replacer_name = get_properties()->get("REPLACEMENT_POLICY", "lru", "BUFFER_POOL");
+  FrameReplacerType replacer_type = FrameReplacerType::LRU;
+  rc                              = frame_replacer_type_from_string(replacer_name.c_str(), replacer_type);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Invalid buffer pool replacement policy: %s", replacer_name.c_str());
+    return rc;
+  }
+
+  string dblwr_pages = get_properties()->get("DOUBLE_WRITE_BUFFER_PAGES", "64", "BUFFER_POOL");
+  if (atoi(dblwr_pages.c_str()) <= 0) {
+    LOG_ERROR("Invalid double write buffer pages: %s", dblwr_pages.c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  string  memory_size_str = get_properties()->get("MEMORY_SIZE", "0", "BUFFER_POOL");
+  int64_t memory_size     = 0;
+  if (!common::str_to_bytes(memory_size_str, memory_size)) {
+    LOG_ERROR("Invalid buffer pool memory size: %s", memory_size_str.c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  const bool huge_page = atoi(get_properties()->get("HUGE_PAGE", "0", "BUFFER_POOL").c_str()) != 0;
+  buffer_pool_manager_ = make_unique<BufferPoolManager>(memory_size, replacer_type, huge_page);
+  buffer_pool_manager_->set_direct_io(atoi(get_properties()->get("DIRECT_IO", "0", "BUFFER_POOL").c_str()) != 0);
+  buffer_pool_manager_->set_verify_checksum(
+      atoi(get_properties()->get("VERIFY_PAGE_CHECKSUM", "0", "BUFFER_POOL").c_str()) != 0);
+  auto dblwr_buffer    = make_unique<DiskDoubleWriteBuffer>(*buffer_pool_manager_, atoi(dblwr_pages.c_str()));
 
   const char      *double_write_buffer_filename  = "dblwr.db";
   filesystem::path double_write_buffer_file_path = filesystem::path(dbpath) / double_write_buffer_filename;
@@ -85,6 +117,14 @@ RC Db::init(const char *name, const char *dbpath, const char *trx_kit_name, cons
     return rc;
   }
 
+  string read_ahead_threads = get_properties()->get("READ_AHEAD_THREADS", "2", "BUFFER_POOL");
+  string read_ahead_pages   = get_properties()->get("READ_AHEAD_PAGES", "32", "BUFFER_POOL");
+  rc = buffer_pool_manager_->init_prefetch(atoi(read_ahead_threads.c_str()), atoi(read_ahead_pages.c_str()));
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init buffer pool prefetch. rc=%s", strrc(rc));
+    return rc;
+  }
+
   filesystem::path clog_path       = filesystem::path(dbpath) / "clog";
   LogHandler      *tmp_log_handler = nullptr;
   rc                               = LogHandler::create(log_handler_name, tmp_log_handler);
@@ -131,6 +171,24 @@ RC Db::init(const char *name, const char *dbpath, const char *trx_kit_name, cons
     return rc;
   }
 
+  // 恢复完成后再启动页面清理线程，让脏页比例保持在水位之间
+  string cleaner_interval_ms = get_properties()->get("PAGE_CLEANER_INTERVAL_MS", "100", "BUFFER_POOL");
+  string high_watermark      = get_properties()->get("DIRTY_PAGE_HIGH_WATERMARK", "50", "BUFFER_POOL");
+  string low_watermark       = get_properties()->get("DIRTY_PAGE_LOW_WATERMARK", "20", "BUFFER_POOL");
+  rc = buffer_pool_manager_->start_page_cleaner(atoi(high_watermark.c_str()),
+                                                atoi(low_watermark.c_str()),
+                                                chrono::milliseconds(atol(cleaner_interval_ms.c_str())));
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to start page cleaner. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  // 使用磁盘日志时，定期做模糊检查点，清理不再需要的日志
+  if (log_handler_name != nullptr && strcasecmp(log_handler_name, "disk") == 0) {
+    string interval_sec = get_properties()->get("CHECKPOINT_INTERVAL_SEC", "30", "CLOG");
+    start_checkpointer(chrono::seconds(atol(interval_sec.c_str())));
+  }
+
   return rc;
 }
 
@@ -160,6 +218,9 @@ RC Db::create_table(const char *table_name, span<const AttrInfoSqlNode> attribut
 }
 
 RC Db::drop_table(const char *table_name){
+  // 检查点会刷新所有buffer pool中的页面，不能同时关闭表的文件
+  lock_guard<mutex> checkpoint_guard(checkpoint_lock_);
+
   Table *table = find_table(table_name);
   if(table == nullptr){
     return RC::SCHEMA_TABLE_NOT_EXIST;
@@ -262,6 +323,8 @@ void Db::all_tables(vector<string> &table_names) const
 
 RC Db::sync()
 {
+  lock_guard<mutex> checkpoint_guard(checkpoint_lock_);
+
   RC rc = RC::SUCCESS;
   // 调用所有表的sync函数刷新数据到磁盘
   for (const auto &table_pair : opened_tables_) {
@@ -295,8 +358,118 @@ RC Db::sync()
     LOG_ERROR("Failed to flush meta. db=%s, rc=%d:%s", name_.c_str(), rc, strrc(rc));
     return rc;
   }
+
+  rc = log_handler_->truncate(check_point_lsn_);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Failed to truncate log. db=%s, rc=%s", name_.c_str(), strrc(rc));
+  }
   LOG_INFO("Successfully sync db. db=%s", name_.c_str());
-  return rc;
+  return RC::SUCCESS;
+}
+
+RC Db::fuzzy_checkpoint()
+{
+  lock_guard<mutex> checkpoint_guard(checkpoint_lock_);
+
+  // 写日志和设置页面的LSN不是原子操作，扫描脏页时，有些页面可能已经写了日志，但是还没有变脏。
+  // 这样的修改一定是在上一次检查点开始之后才开始的，所以检查点不能超过上一次开始时的LSN。
+  // 第一次执行时只记录开始的LSN。
+  LSN checkpoint_lsn         = last_checkpoint_start_lsn_;
+  last_checkpoint_start_lsn_ = log_handler_->current_lsn();
+
+  LSN min_recovery_lsn = 0;
+  RC  rc               = buffer_pool_manager_->flush_dirty_pages(min_recovery_lsn);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to flush dirty pages. db=%s, rc=%s", name_.c_str(), strrc(rc));
+    return rc;
+  }
+
+  // 刷新到double write buffer中的页面也要写到数据文件中并落盘
+  auto dblwr_buffer = static_cast<DiskDoubleWriteBuffer *>(buffer_pool_manager_->get_dblwr_buffer());
+  rc                = dblwr_buffer->flush_page();
+  if (OB_SUCC(rc)) {
+    rc = buffer_pool_manager_->sync_files();
+  }
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to write pages to disk. db=%s, rc=%s", name_.c_str(), strrc(rc));
+    return rc;
+  }
+
+  if (min_recovery_lsn > 0 && min_recovery_lsn < checkpoint_lsn) {
+    checkpoint_lsn = min_recovery_lsn;
+  }
+
+  LSN oldest_trx_lsn = trx_kit_->oldest_trx_lsn();
+  if (oldest_trx_lsn > 0 && oldest_trx_lsn < checkpoint_lsn) {
+    checkpoint_lsn = oldest_trx_lsn;
+  }
+
+  if (checkpoint_lsn <= check_point_lsn_) {
+    LOG_TRACE("checkpoint does not advance. db=%s, checkpoint lsn=%ld, candidate=%ld",
+              name_.c_str(), check_point_lsn_, checkpoint_lsn);
+    return RC::SUCCESS;
+  }
+
+  // 恢复时从检查点开始重做，检查点处的日志必须已经落盘
+  rc = log_handler_->wait_lsn(checkpoint_lsn);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to wait lsn. lsn=%ld, rc=%s", checkpoint_lsn, strrc(rc));
+    return rc;
+  }
+
+  check_point_lsn_ = checkpoint_lsn;
+  rc               = flush_meta();
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to flush meta. db=%s, rc=%d:%s", name_.c_str(), rc, strrc(rc));
+    return rc;
+  }
+
+  rc = log_handler_->truncate(check_point_lsn_);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Failed to truncate log. db=%s, rc=%s", name_.c_str(), strrc(rc));
+    return rc;
+  }
+
+  LOG_INFO("fuzzy checkpoint done. db=%s, checkpoint lsn=%ld, min recovery lsn=%ld, oldest trx lsn=%ld",
+           name_.c_str(), check_point_lsn_, min_recovery_lsn, oldest_trx_lsn);
+  return RC::SUCCESS;
+}
+
+void Db::start_checkpointer(chrono::seconds interval)
+{
+  if (interval.count() <= 0) {
+    LOG_INFO("fuzzy checkpoint is disabled. db=%s", name_.c_str());
+    return;
+  }
+
+  checkpointer_running_ = true;
+  checkpointer_         = make_unique<thread>([this, interval]() {
+    unique_lock<mutex> lock(checkpointer_mutex_);
+    while (!checkpointer_cond_.wait_for(lock, interval, [this]() { return !checkpointer_running_; })) {
+      lock.unlock();
+      RC rc = fuzzy_checkpoint();
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to do fuzzy checkpoint. db=%s, rc=%s", name_.c_str(), strrc(rc));
+      }
+      lock.lock();
+    }
+  });
+  LOG_INFO("checkpointer started. db=%s, interval=%lds", name_.c_str(), static_cast<long>(interval.count()));
+}
+
+void Db::stop_checkpointer()
+{
+  if (!checkpointer_) {
+    return;
+  }
+
+  {
+    lock_guard<mutex> lock(checkpointer_mutex_);
+    checkpointer_running_ = false;
+    checkpointer_cond_.notify_all();
+  }
+  checkpointer_->join();
+  checkpointer_.reset();
 }
 
 RC Db::recover()
@@ -310,7 +483,21 @@ RC Db::recover()
   }
 
   IntegratedLogReplayer log_replayer(*buffer_pool_manager_, unique_ptr<LogReplayer>(trx_log_replayer));
-  RC                    rc = log_handler_->replay(log_replayer, check_point_lsn_ /*start_lsn*/);
+
+  // 默认使用与CPU核数相同的线程并行回放页面日志
+  string replay_threads = get_properties()->get("REPLAY_THREADS", "", "CLOG");
+  int    worker_num     = static_cast<int>(thread::hardware_concurrency());
+  if (!replay_threads.empty()) {
+    worker_num = atoi(replay_threads.c_str());
+  }
+
+  RC rc = log_replayer.set_worker_num(worker_num);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to set log replay worker number. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rc = log_handler_->replay(log_replayer, check_point_lsn_ /*start_lsn*/);
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to replay log. rc=%s", strrc(rc));
     return rc;
@@ -362,10 +549,14 @@ RC Db::init_meta()
       return RC::IOERR_TOO_LONG;
     }
 
-    buffer[n]        = '\0';
-    check_point_lsn_ = atoll(buffer);  // 当前元数据就这一个数字
-    LOG_INFO("Successfully read db meta file. db=%s, file=%s, check_point_lsn=%ld", 
-             name_.c_str(), db_meta_file_path.c_str(), check_point_lsn_);
+    // 元数据是检查点LSN和已经分配过的最大事务号。检查点之前的事务日志会被删除，事务号需要从这里恢复
+    buffer[n]                = '\0';
+    char *trx_id_str         = nullptr;
+    check_point_lsn_         = strtoll(buffer, &trx_id_str, 10);
+    const int32_t max_trx_id = atoi(trx_id_str);
+    trx_kit_->recover_trx_id(max_trx_id);
+    LOG_INFO("Successfully read db meta file. db=%s, file=%s, check_point_lsn=%ld, max trx id=%d", 
+             name_.c_str(), db_meta_file_path.c_str(), check_point_lsn_, max_trx_id);
   }
   close(fd);
 
@@ -390,7 +581,8 @@ RC Db::flush_meta()
     return RC::IOERR_WRITE;
   }
 
-  string buffer = to_string(check_point_lsn_);
+  // 检查点之前提交的事务，事务号一定不会超过现在已经分配的事务号
+  string buffer = to_string(check_point_lsn_) + " " + to_string(trx_kit_->current_trx_id());
   int    n      = write(fd, buffer.c_str(), buffer.size());
   if (n < 0) {
     LOG_ERROR("Failed to write db meta file. db=%s, file=%s, errno=%s", 
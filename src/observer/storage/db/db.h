@@ -20,6 +20,9 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/unordered_map.h"
 #include "common/lang/memory.h"
 #include "common/lang/span.h"
+#include "common/lang/chrono.h"
+#include "common/lang/mutex.h"
+#include "common/lang/thread.h"
 #include "sql/parser/parse_defs.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/clog/disk_log_handler.h"
@@ -92,6 +95,15 @@ public:
    */
   RC sync();
 
+  /**
+   * @brief 执行一次模糊检查点
+   * @details 与sync不同，模糊检查点不要求没有正在进行的事务，也不会阻塞写入。
+   * 先把所有脏页刷到磁盘，然后根据还没有刷盘的页面和活跃事务计算出恢复时需要开始重做的LSN，
+   * 把它作为新的检查点写入元数据，并清理检查点之前的日志文件。
+   * 后台检查点线程会定期调用这个函数。
+   */
+  RC fuzzy_checkpoint();
+
   /// @brief 获取当前数据库的日志处理器
   LogHandler &log_handler();
 
@@ -115,6 +127,11 @@ private:
   /// @brief 初始化数据库的double buffer pool
   RC init_dblwr_buffer();
 
+  /// @brief 启动后台检查点线程。只有使用磁盘日志时才需要
+  void start_checkpointer(chrono::seconds interval);
+  /// @brief 停止后台检查点线程
+  void stop_checkpointer();
+
 private:
   string                         name_;                 ///< 数据库名称
   string                         path_;                 ///< 数据库文件存放的目录
@@ -127,4 +144,13 @@ private:
   int32_t next_table_id_ = 0;
 
   LSN check_point_lsn_ = 0;  ///< 当前数据库的检查点LSN。会记录到磁盘中。
+
+  /// 上一次模糊检查点开始时的LSN。写日志和设置页面LSN不是原子操作，检查点不能超过它，参考 fuzzy_checkpoint
+  LSN last_checkpoint_start_lsn_ = 0;
+
+  mutex              checkpoint_lock_;            ///< 检查点、sync和删除表互斥执行
+  mutex              checkpointer_mutex_;         ///< 与checkpointer_cond_一起使用
+  condition_variable checkpointer_cond_;          ///< 通知检查点线程退出
+  bool               checkpointer_running_ = false;
+  unique_ptr<thread> checkpointer_;               ///< 后台检查点线程
 };
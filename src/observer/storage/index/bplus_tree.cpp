@@ -14,7 +14,9 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "storage/index/bplus_tree.h"
+#include "common/lang/algorithm.h"
 #include "common/lang/lower_bound.h"
+#include "common/lang/limits.h"
 #include "common/log/log.h"
 #include "common/global_context.h"
 #include "sql/parser/parse_defs.h"
@@ -29,10 +31,13 @@ using namespace common;
  */
 #define FIRST_INDEX_PAGE 1
 
-int calc_internal_page_capacity(int attr_length)
+/**
+ * @brief 内部节点默认的最大元素个数
+ * @details 内部节点的键值是变长的，最短的时候只有一个slot，实际能存放多少个元素由页面空间决定
+ */
+int calc_internal_page_capacity()
 {
-  int item_size = attr_length + sizeof(RID) + sizeof(PageNum);
-  int capacity  = ((int)BP_PAGE_DATA_SIZE - InternalIndexNode::HEADER_SIZE) / item_size;
+  int capacity = ((int)BP_PAGE_DATA_SIZE - InternalIndexNode::HEADER_SIZE) / (int)sizeof(InternalIndexSlot);
   return capacity;
 }
 
@@ -54,6 +59,9 @@ void IndexNodeHandler::init_empty(bool leaf)
   node_->is_leaf = leaf;
   node_->key_num = 0;
   node_->parent  = BP_INVALID_PAGE_NUM;
+  if (!leaf) {
+    reinterpret_cast<InternalIndexNode *>(node_)->key_bytes = 0;
+  }
 }
 PageNum IndexNodeHandler::page_num() const { return frame_->page_num(); }
 
@@ -107,6 +115,9 @@ bool IndexNodeHandler::is_safe(BplusTreeOperationType op, bool is_root_node)
       return true;
     } break;
     case BplusTreeOperationType::INSERT: {
+      if (!node_->is_leaf) {
+        return size() < max_size() && internal_used_bytes() + internal_max_item_bytes() <= internal_capacity_bytes();
+      }
       return size() < max_size();
     } break;
     case BplusTreeOperationType::DELETE: {
@@ -118,6 +129,10 @@ bool IndexNodeHandler::is_safe(BplusTreeOperationType op, bool is_root_node)
         // 根节点还有子节点，但是如果删除一个子节点后，只剩一个子节点，就要把自己删除，把唯一的子节点变更为根节点
         return size() > 2;
       }
+      if (!node_->is_leaf) {
+        // 删除任意一个元素后都不会太空
+        return size() > min_size() || (internal_used_bytes() - internal_max_item_bytes()) * 2 >= internal_capacity_bytes();
+      }
       return size() > min_size();
     } break;
     default: {
@@ -129,6 +144,33 @@ bool IndexNodeHandler::is_safe(BplusTreeOperationType op, bool is_root_node)
   return false;
 }
 
+bool IndexNodeHandler::is_underflow() const
+{
+  if (size() >= min_size()) {
+    return false;
+  }
+  return is_leaf() || internal_used_bytes() * 2 < internal_capacity_bytes();
+}
+
+bool IndexNodeHandler::can_merge(const IndexNodeHandler &other) const
+{
+  if (size() + other.size() > max_size()) {
+    return false;
+  }
+  return is_leaf() || internal_used_bytes() + other.internal_used_bytes() <= internal_capacity_bytes();
+}
+
+int IndexNodeHandler::internal_used_bytes() const
+{
+  const InternalIndexNode *internal_node = reinterpret_cast<const InternalIndexNode *>(node_);
+  return size() * static_cast<int>(sizeof(InternalIndexSlot)) + internal_node->key_bytes;
+}
+
+int IndexNodeHandler::internal_max_item_bytes() const
+{
+  return static_cast<int>(sizeof(InternalIndexSlot)) + header_.key_length;
+}
+
 string to_string(const IndexNodeHandler &handler)
 {
   stringstream ss;
@@ -426,14 +468,16 @@ InternalIndexNodeHandler::InternalIndexNodeHandler(BplusTreeMiniTransaction &mtr
 
 string to_string(const InternalIndexNodeHandler &node, const KeyPrinter &printer)
 {
+  vector<char> key(node.key_size());
   stringstream ss;
-  ss << to_string((const IndexNodeHandler &)node);
-  ss << ",children:["
-     << "{key:" << printer(node.__key_at(0)) << ","
-     << "value:" << *(PageNum *)node.__value_at(0) << "}";
-
-  for (int i = 1; i < node.size(); i++) {
-    ss << ",{key:" << printer(node.__key_at(i)) << ",value:" << *(PageNum *)node.__value_at(i) << "}";
+  ss << to_string((const IndexNodeHandler &)node) << "key_bytes:" << node.internal_node_->key_bytes;
+  ss << ",children:[";
+  for (int i = 0; i < node.size(); i++) {
+    node.decode_key(i, key.data());
+    if (i > 0) {
+      ss << ",";
+    }
+    ss << "{key:" << printer(key.data()) << ",value:" << node.slot_at(i)->page_num << "}";
   }
   ss << "]";
   return ss.str();
@@ -455,12 +499,12 @@ RC InternalIndexNodeHandler::create_new_root(PageNum first_page_num, const char
     LOG_WARN("failed to log create new root. rc=%s", strrc(rc));
   }
 
-  memset(__key_at(0), 0, key_size());
-  memcpy(__value_at(0), &first_page_num, value_size());
-  memcpy(__item_at(1), key, key_size());
-  memcpy(__value_at(1), &page_num, value_size());
-  increase_size(2);
-  return RC::SUCCESS;
+  // 第一个键值全部是0，不占用键值区的空间
+  vector<char> items(2 * item_size(), 0);
+  memcpy(items.data() + key_size(), &first_page_num, value_size());
+  memcpy(items.data() + item_size(), key, key_size());
+  memcpy(items.data() + item_size() + key_size(), &page_num, value_size());
+  return recover_insert_items(0, items.data(), 2);
 }
 
 /**
@@ -472,6 +516,12 @@ RC InternalIndexNodeHandler::create_new_root(PageNum first_page_num, const char
  */
 RC InternalIndexNodeHandler::insert(const char *key, PageNum page_num, const KeyComparator &comparator)
 {
+  if (!can_insert(key)) {
+    LOG_WARN("no space left in internal node. page num=%d, size=%d, key bytes=%d",
+             this->page_num(), size(), internal_node_->key_bytes);
+    return RC::INTERNAL;
+  }
+
   int insert_position = -1;
   lookup(comparator, key, nullptr, &insert_position);
   vector<char> item(key_size() + sizeof(PageNum));
@@ -488,21 +538,31 @@ RC InternalIndexNodeHandler::insert(const char *key, PageNum page_num, const Key
 
 /**
  * @brief move half of the items to the other node ends
+ * @details 元素个数达到上限时按照个数平分，否则是键值区没有空间了，按照占用的空间平分
  */
 RC InternalIndexNodeHandler::move_half_to(InternalIndexNodeHandler &other)
 {
   const int size       = this->size();
-  const int move_index = size / 2;
-  const int move_num   = size - move_index;
-  RC        rc         = other.append(this->__item_at(move_index), size - move_index);
+  int       move_index = size / 2;
+  if (size < max_size()) {
+    const int half_bytes = internal_used_bytes() / 2;
+    int       bytes      = 0;
+    for (move_index = 0; move_index < size - 1 && bytes < half_bytes; move_index++) {
+      bytes += static_cast<int>(sizeof(InternalIndexSlot)) + slot_at(move_index)->key_length;
+    }
+    move_index = max(move_index, 1);
+  }
+
+  const int    move_num = size - move_index;
+  vector<char> items    = copy_items(move_index, move_num);
+  RC           rc       = other.append(items.data(), move_num);
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to copy item to new node. rc=%d:%s", rc, strrc(rc));
     return rc;
   }
 
-  mtr_.logger().node_remove_items(*this, move_index, span<const char>(__item_at(move_index), move_num * item_size()), move_num);
-  increase_size(-(size - move_index));
-  return rc;
+  mtr_.logger().node_remove_items(*this, move_index, items, move_num);
+  return recover_remove_items(move_index, move_num);
 }
 
 /**
@@ -524,44 +584,69 @@ int InternalIndexNodeHandler::lookup(const KeyComparator &comparator, const char
     return 0;
   }
 
-  common::BinaryIterator<char> iter_begin(item_size(), __key_at(1));
-  common::BinaryIterator<char> iter_end(item_size(), __key_at(size));
-  common::BinaryIterator<char> iter = lower_bound(iter_begin, iter_end, key, comparator, found);
-  int                          ret  = static_cast<int>(iter - iter_begin) + 1;
-  if (insert_position) {
-    *insert_position = ret;
+  // 第一个键值不参与比较。在 [1, size) 中查找第一个不小于 key 的位置
+  key_buffer_.resize(key_size());
+  char *item_key = key_buffer_.data();
+  int   left     = 1;
+  int   right    = size;
+  bool  equal    = false;
+  while (left < right) {
+    const int mid = left + (right - left) / 2;
+    decode_key(mid, item_key);
+    const int result = comparator(item_key, key);
+    if (result == 0) {
+      left  = mid;
+      equal = true;
+      break;
+    }
+
+    if (result < 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
   }
 
-  if (ret >= size || comparator(key, __key_at(ret)) < 0) {
-    return ret - 1;
+  if (found) {
+    *found = equal;
+  }
+  if (insert_position) {
+    *insert_position = left;
   }
-  return ret;
+  return equal ? left : left - 1;
 }
 
 char *InternalIndexNodeHandler::key_at(int index)
 {
   assert(index >= 0 && index < size());
-  return __key_at(index);
+  key_buffer_.resize(key_size());
+  decode_key(index, key_buffer_.data());
+  return key_buffer_.data();
 }
 
 void InternalIndexNodeHandler::set_key_at(int index, const char *key)
 {
   assert(index >= 0 && index < size());
 
-  mtr_.logger().internal_update_key(*this, index, span<const char>(key, key_size()), span<const char>(__key_at(index), key_size()));
-  memcpy(__key_at(index), key, key_size());
+  vector<char> old_key(key_size());
+  decode_key(index, old_key.data());
+  mtr_.logger().internal_update_key(*this, index, span<const char>(key, key_size()), old_key);
+
+  slot_at(index)->key_length = 0;
+  compact_keys();
+  put_key(index, key);
 }
 
 PageNum InternalIndexNodeHandler::value_at(int index)
 {
   assert(index >= 0 && index < size());
-  return *(PageNum *)__value_at(index);
+  return slot_at(index)->page_num;
 }
 
 int InternalIndexNodeHandler::value_index(PageNum page_num)
 {
   for (int i = 0; i < size(); i++) {
-    if (page_num == *(PageNum *)__value_at(i)) {
+    if (page_num == slot_at(i)->page_num) {
       return i;
     }
   }
@@ -573,7 +658,7 @@ void InternalIndexNodeHandler::remove(int index)
   assert(index >= 0 && index < size());
 
   BplusTreeLogger &logger = mtr_.logger();
-  RC rc = logger.node_remove_items(*this, index, span<const char>(__item_at(index), item_size()), 1);
+  RC rc = logger.node_remove_items(*this, index, copy_items(index, 1), 1);
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to log remove item. rc=%s. node=%s", strrc(rc), to_string(*this).c_str());
   }
@@ -581,15 +666,27 @@ void InternalIndexNodeHandler::remove(int index)
   recover_remove_items(index, 1);
 }
 
+bool InternalIndexNodeHandler::can_insert(const char *key) const
+{
+  const int item_bytes = static_cast<int>(sizeof(InternalIndexSlot)) + stored_key_length(key, key_size());
+  return size() < max_size() && item_bytes <= free_bytes();
+}
+
+bool InternalIndexNodeHandler::can_set_key_at(int index, const char *key) const
+{
+  return stored_key_length(key, key_size()) - slot_at(index)->key_length <= free_bytes();
+}
+
 RC InternalIndexNodeHandler::move_to(InternalIndexNodeHandler &other)
 {
-  RC rc = other.append(__item_at(0), size());
+  vector<char> items = copy_items(0, size());
+  RC           rc    = other.append(items.data(), size());
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to copy items to other node. rc=%d:%s", rc, strrc(rc));
     return rc;
   }
 
-  rc = mtr_.logger().node_remove_items(*this, 0, span<const char>(__item_at(0), size() * item_size()), size());
+  rc = mtr_.logger().node_remove_items(*this, 0, items, size());
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to log shrink internal node. rc=%d:%s", rc, strrc(rc));
     return rc;
@@ -600,7 +697,7 @@ RC InternalIndexNodeHandler::move_to(InternalIndexNodeHandler &other)
 
 RC InternalIndexNodeHandler::move_first_to_end(InternalIndexNodeHandler &other)
 {
-  RC rc = other.append(__item_at(0));
+  RC rc = other.append(copy_items(0, 1).data());
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to append item to others.");
     return rc;
@@ -612,23 +709,29 @@ RC InternalIndexNodeHandler::move_first_to_end(InternalIndexNodeHandler &other)
 
 RC InternalIndexNodeHandler::move_last_to_front(InternalIndexNodeHandler &other)
 {
-  RC rc = other.preappend(__item_at(size() - 1));
+  vector<char> item = copy_items(size() - 1, 1);
+  RC           rc   = other.preappend(item.data());
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to preappend to others");
     return rc;
   }
 
-  rc = mtr_.logger().node_remove_items(*this, size() - 1, span<const char>(__item_at(size() - 1), item_size()), 1);
+  rc = mtr_.logger().node_remove_items(*this, size() - 1, item, 1);
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to log shrink internal node. rc=%d:%s", rc, strrc(rc));
     return rc;
   }
-  increase_size(-1);
-  return rc;
+  return recover_remove_items(size() - 1, 1);
 }
 
 RC InternalIndexNodeHandler::insert_items(int index, const char *items, int num)
 {
+  if (items_bytes(items, num) > free_bytes()) {
+    LOG_WARN("no space left in internal node. page num=%d, size=%d, key bytes=%d, item num=%d",
+             page_num(), size(), internal_node_->key_bytes, num);
+    return RC::INTERNAL;
+  }
+
   RC rc = mtr_.logger().node_insert_items(*this, index, span<const char>(items, item_size() * num), num);
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to log insert item. rc=%s", strrc(rc));
@@ -674,7 +777,118 @@ RC InternalIndexNodeHandler::preappend(const char *item)
   return this->insert_items(0, item, 1);
 }
 
-char *InternalIndexNodeHandler::__item_at(int index) const { return internal_node_->array + (index * item_size()); }
+RC InternalIndexNodeHandler::recover_insert_items(int index, const char *items, int num)
+{
+  if (items_bytes(items, num) > free_bytes()) {
+    LOG_WARN("no space left in internal node. page num=%d, size=%d, key bytes=%d, item num=%d",
+             page_num(), size(), internal_node_->key_bytes, num);
+    return RC::INTERNAL;
+  }
+
+  const int size = this->size();
+  if (index < size) {
+    memmove(slot_at(index + num), slot_at(index), (static_cast<size_t>(size) - index) * sizeof(InternalIndexSlot));
+  }
+  increase_size(num);
+
+  for (int i = 0; i < num; i++) {
+    const char *item = items + i * item_size();
+    memcpy(&slot_at(index + i)->page_num, item + key_size(), sizeof(PageNum));
+    put_key(index + i, item);
+  }
+  return RC::SUCCESS;
+}
+
+RC InternalIndexNodeHandler::recover_remove_items(int index, int num)
+{
+  const int size = this->size();
+  if (index < size - num) {
+    memmove(slot_at(index), slot_at(index + num), (static_cast<size_t>(size) - index - num) * sizeof(InternalIndexSlot));
+  }
+  increase_size(-num);
+  compact_keys();
+  return RC::SUCCESS;
+}
+
+int InternalIndexNodeHandler::stored_key_length(const char *key, int key_length)
+{
+  int length = key_length;
+  while (length > 0 && key[length - 1] == 0) {
+    length--;
+  }
+  return length;
+}
+
+vector<char> InternalIndexNodeHandler::copy_items(int index, int num) const
+{
+  vector<char> items(static_cast<size_t>(num) * item_size());
+  for (int i = 0; i < num; i++) {
+    char *item = items.data() + i * item_size();
+    decode_key(index + i, item);
+    memcpy(item + key_size(), &slot_at(index + i)->page_num, sizeof(PageNum));
+  }
+  return items;
+}
+
+int InternalIndexNodeHandler::items_bytes(const char *items, int num) const
+{
+  int bytes = 0;
+  for (int i = 0; i < num; i++) {
+    bytes += static_cast<int>(sizeof(InternalIndexSlot)) + stored_key_length(items + i * item_size(), key_size());
+  }
+  return bytes;
+}
+
+InternalIndexSlot *InternalIndexNodeHandler::slot_at(int index) const
+{
+  return reinterpret_cast<InternalIndexSlot *>(internal_node_->array) + index;
+}
+
+void InternalIndexNodeHandler::decode_key(int index, char *key) const
+{
+  // 乐观地查找叶子节点时，页面可能正在被修改，读到的slot不一定有效，这里要保证不会越界
+  const InternalIndexSlot *slot   = slot_at(index);
+  const int                length = min<int>(slot->key_length, key_size());
+  const int                offset = min<int>(slot->key_offset, BP_PAGE_DATA_SIZE - length);
+  memcpy(key, frame_->data() + offset, length);
+  memset(key + length, 0, key_size() - length);
+}
+
+void InternalIndexNodeHandler::put_key(int index, const char *key)
+{
+  const int length = stored_key_length(key, key_size());
+  internal_node_->key_bytes += length;
+
+  InternalIndexSlot *slot = slot_at(index);
+  slot->key_offset        = static_cast<uint16_t>(BP_PAGE_DATA_SIZE - internal_node_->key_bytes);
+  slot->key_length        = static_cast<uint16_t>(length);
+  memcpy(frame_->data() + slot->key_offset, key, length);
+}
+
+void InternalIndexNodeHandler::compact_keys()
+{
+  char        *data = frame_->data();
+  vector<char> keys(internal_node_->key_bytes);
+  int          bytes = 0;
+  for (int i = 0; i < size(); i++) {
+    const InternalIndexSlot *slot = slot_at(i);
+    memcpy(keys.data() + bytes, data + slot->key_offset, slot->key_length);
+    bytes += slot->key_length;
+  }
+
+  int offset = BP_PAGE_DATA_SIZE;
+  bytes      = 0;
+  for (int i = 0; i < size(); i++) {
+    InternalIndexSlot *slot = slot_at(i);
+    offset -= slot->key_length;
+    memcpy(data + offset, keys.data() + bytes, slot->key_length);
+    slot->key_offset = static_cast<uint16_t>(offset);
+    bytes += slot->key_length;
+  }
+  internal_node_->key_bytes = BP_PAGE_DATA_SIZE - offset;
+}
+
+int InternalIndexNodeHandler::free_bytes() const { return internal_capacity_bytes() - internal_used_bytes(); }
 
 int InternalIndexNodeHandler::value_size() const { return sizeof(PageNum); }
 
@@ -688,8 +902,35 @@ bool InternalIndexNodeHandler::validate(const KeyComparator &comparator, DiskBuf
   }
 
   const int node_size = size();
+  if (internal_node_->key_bytes < 0 || internal_used_bytes() > internal_capacity_bytes()) {
+    LOG_WARN("page number = %d, invalid key bytes. size=%d, key bytes=%d",
+             page_num(), node_size, internal_node_->key_bytes);
+    return false;
+  }
+
+  int key_bytes = 0;
+  for (int i = 0; i < node_size; i++) {
+    const InternalIndexSlot *slot = slot_at(i);
+    key_bytes += slot->key_length;
+    if (slot->key_length > key_size() || slot->key_offset < BP_PAGE_DATA_SIZE - internal_node_->key_bytes ||
+        slot->key_offset + slot->key_length > BP_PAGE_DATA_SIZE) {
+      LOG_WARN("page number = %d, invalid key slot. index=%d, key offset=%d, key length=%d, key bytes=%d",
+               page_num(), i, slot->key_offset, slot->key_length, internal_node_->key_bytes);
+      return false;
+    }
+  }
+  if (key_bytes != internal_node_->key_bytes) {
+    LOG_WARN("page number = %d, key bytes mismatch. key bytes=%d, sum of key length=%d",
+             page_num(), internal_node_->key_bytes, key_bytes);
+    return false;
+  }
+
+  vector<char> prev_key(key_size());
+  vector<char> key(key_size());
   for (int i = 2; i < node_size; i++) {
-    if (comparator(__key_at(i - 1), __key_at(i)) >= 0) {
+    decode_key(i - 1, prev_key.data());
+    decode_key(i, key.data());
+    if (comparator(prev_key.data(), key.data()) >= 0) {
       LOG_WARN("page number = %d, invalid key order. id1=%d,id2=%d, this=%s",
           page_num(), i - 1, i, to_string(*this).c_str());
       return false;
@@ -697,7 +938,7 @@ bool InternalIndexNodeHandler::validate(const KeyComparator &comparator, DiskBuf
   }
 
   for (int i = 0; result && i < node_size; i++) {
-    PageNum page_num = *(PageNum *)__value_at(i);
+    PageNum page_num = slot_at(i)->page_num;
     if (page_num < 0) {
       LOG_WARN("this page num=%d, got invalid child page. page num=%d", this->page_num(), page_num);
     } else {
@@ -744,8 +985,9 @@ bool InternalIndexNodeHandler::validate(const KeyComparator &comparator, DiskBuf
     return false;
   }
 
-  if (0 != index_in_parent) {
-    int cmp_result = comparator(__key_at(1), parent_node.key_at(index_in_parent));
+  if (0 != index_in_parent && node_size > 1) {
+    decode_key(1, key.data());
+    int cmp_result = comparator(key.data(), parent_node.key_at(index_in_parent));
     if (cmp_result < 0) {
       LOG_WARN("invalid internal node. the second item should be greate than or equal to parent item. "
                "this page num=%d, parent page num=%d, index in parent=%d",
@@ -756,7 +998,8 @@ bool InternalIndexNodeHandler::validate(const KeyComparator &comparator, DiskBuf
   }
 
   if (index_in_parent < parent_node.size() - 1) {
-    int cmp_result = comparator(__key_at(size() - 1), parent_node.key_at(index_in_parent + 1));
+    decode_key(node_size - 1, key.data());
+    int cmp_result = comparator(key.data(), parent_node.key_at(index_in_parent + 1));
     if (cmp_result >= 0) {
       LOG_WARN("invalid internal node. last item should be less than the item at the first after item in parent."
                "this page num=%d, parent page num=%d, parent item to compare=%d",
@@ -799,6 +1042,29 @@ RC BplusTreeHandler::create(LogHandler &log_handler,
                             int attr_length, 
                             int internal_max_size /* = -1*/,
                             int leaf_max_size /* = -1 */)
+{
+  return this->create(log_handler, bpm, file_name, vector<AttrType>{attr_type}, vector<int>{attr_length},
+      internal_max_size, leaf_max_size);
+}
+
+RC BplusTreeHandler::create(LogHandler &log_handler,
+                            DiskBufferPool &buffer_pool,
+                            AttrType attr_type,
+                            int attr_length,
+                            int internal_max_size /* = -1 */,
+                            int leaf_max_size /* = -1 */)
+{
+  return this->create(log_handler, buffer_pool, vector<AttrType>{attr_type}, vector<int>{attr_length},
+      internal_max_size, leaf_max_size);
+}
+
+RC BplusTreeHandler::create(LogHandler &log_handler,
+                            BufferPoolManager &bpm,
+                            const char *file_name,
+                            const vector<AttrType> &attr_types,
+                            const vector<int> &attr_lengths,
+                            int internal_max_size /* = -1*/,
+                            int leaf_max_size /* = -1 */)
 {
   RC rc = bpm.create_file(file_name);
   if (OB_FAIL(rc)) {
@@ -816,7 +1082,7 @@ RC BplusTreeHandler::create(LogHandler &log_handler,
   }
   LOG_INFO("Successfully open index file %s.", file_name);
 
-  rc = this->create(log_handler, *bp, attr_type, attr_length, internal_max_size, leaf_max_size);
+  rc = this->create(log_handler, *bp, attr_types, attr_lengths, internal_max_size, leaf_max_size);
   if (OB_FAIL(rc)) {
     bpm.close_file(file_name);
     return rc;
@@ -828,13 +1094,31 @@ RC BplusTreeHandler::create(LogHandler &log_handler,
 
 RC BplusTreeHandler::create(LogHandler &log_handler,
             DiskBufferPool &buffer_pool,
-            AttrType attr_type,
-            int attr_length,
+            const vector<AttrType> &attr_types,
+            const vector<int> &attr_lengths,
             int internal_max_size /* = -1 */,
             int leaf_max_size /* = -1 */)
 {
-  if (internal_max_size < 0) {
-    internal_max_size = calc_internal_page_capacity(attr_length);
+  const int attr_num = static_cast<int>(attr_types.size());
+  if (attr_num == 0 || attr_num > IndexFileHeader::MAX_ATTR_NUM || attr_lengths.size() != attr_types.size()) {
+    LOG_WARN("invalid attr number for bplus tree. attr num=%d, max=%d", attr_num, IndexFileHeader::MAX_ATTR_NUM);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  int attr_length = 0;
+  for (int length : attr_lengths) {
+    attr_length += length;
+  }
+
+  if (internal_max_size < 0 || internal_max_size > calc_internal_page_capacity()) {
+    internal_max_size = calc_internal_page_capacity();
+  }
+
+  // 内部节点按照占用的空间分裂，分裂以后每个节点都要能再放下一个最长的元素
+  const int internal_max_item_bytes = static_cast<int>(sizeof(InternalIndexSlot) + attr_length + sizeof(RID));
+  if (internal_max_item_bytes * 4 > BP_PAGE_DATA_SIZE - InternalIndexNode::HEADER_SIZE) {
+    LOG_WARN("attr length is too long for bplus tree. attr length=%d", attr_length);
+    return RC::INVALID_ARGUMENT;
   }
   if (leaf_max_size < 0) {
     leaf_max_size = calc_leaf_page_capacity(attr_length);
@@ -865,10 +1149,16 @@ RC BplusTreeHandler::create(LogHandler &log_handler,
   IndexFileHeader *file_header   = (IndexFileHeader *)pdata;
   file_header->attr_length       = attr_length;
   file_header->key_length        = attr_length + sizeof(RID);
-  file_header->attr_type         = attr_type;
+  file_header->attr_type         = attr_types[0];
+  file_header->attr_num          = attr_num;
+  for (int i = 0; i < attr_num; i++) {
+    file_header->attr_types[i]   = attr_types[i];
+    file_header->attr_lengths[i] = attr_lengths[i];
+  }
   file_header->internal_max_size = internal_max_size;
   file_header->leaf_max_size     = leaf_max_size;
   file_header->root_page         = BP_INVALID_PAGE_NUM;
+  file_header->version           = IndexFileHeader::CURRENT_VERSION;
 
   // 取消记录日志的原因请参考下面的sync调用的地方。
   // mtr.logger().init_header_page(header_frame, *file_header);
@@ -885,8 +1175,7 @@ RC BplusTreeHandler::create(LogHandler &log_handler,
     return RC::NOMEM;
   }
 
-  key_comparator_.init(file_header->attr_type, file_header->attr_length);
-  key_printer_.init(file_header->attr_type, file_header->attr_length);
+  init_key_comparator();
 
   /*
   虽然我们针对B+树记录了WAL，但是我们记录的都是逻辑日志，并没有记录某个页面如何修改的物理日志。
@@ -943,6 +1232,17 @@ RC BplusTreeHandler::open(LogHandler &log_handler, DiskBufferPool &buffer_pool)
 
   char *pdata = frame->data();
   memcpy(&file_header_, pdata, sizeof(IndexFileHeader));
+  if (file_header_.version == 1) {
+    // 版本1只支持单个字段，没有记录每个字段的信息
+    file_header_.attr_num        = 1;
+    file_header_.attr_types[0]   = file_header_.attr_type;
+    file_header_.attr_lengths[0] = file_header_.attr_length;
+  } else if (file_header_.version != IndexFileHeader::CURRENT_VERSION) {
+    LOG_ERROR("unsupported index file version. version=%d, current version=%d, please rebuild the index",
+              file_header_.version, IndexFileHeader::CURRENT_VERSION);
+    buffer_pool.unpin_page(frame);
+    return RC::UNSUPPORTED;
+  }
   header_dirty_     = false;
   disk_buffer_pool_ = &buffer_pool;
   log_handler_      = &log_handler;
@@ -957,12 +1257,17 @@ RC BplusTreeHandler::open(LogHandler &log_handler, DiskBufferPool &buffer_pool)
   // close old page_handle
   buffer_pool.unpin_page(frame);
 
-  key_comparator_.init(file_header_.attr_type, file_header_.attr_length);
-  key_printer_.init(file_header_.attr_type, file_header_.attr_length);
+  init_key_comparator();
   LOG_INFO("Successfully open index");
   return RC::SUCCESS;
 }
 
+void BplusTreeHandler::init_key_comparator()
+{
+  key_comparator_.init(file_header_.attr_types, file_header_.attr_lengths, file_header_.attr_num);
+  key_printer_.init(file_header_.attr_types, file_header_.attr_lengths, file_header_.attr_num);
+}
+
 RC BplusTreeHandler::close()
 {
   if (disk_buffer_pool_ != nullptr) {
@@ -1203,6 +1508,14 @@ RC BplusTreeHandler::find_leaf_internal(BplusTreeMiniTransaction &mtr, BplusTree
 {
   LatchMemo &latch_memo = mtr.latch_memo();
 
+  if (op == BplusTreeOperationType::READ) {
+    RC rc = find_leaf_optimistic(mtr, child_page_getter, frame);
+    if (rc != RC::LOCKED_CONCURRENCY_CONFLICT) {
+      return rc;
+    }
+    LOG_TRACE("optimistic find leaf conflicted, retry with crabing protocol");
+  }
+
   // root locked
   if (op != BplusTreeOperationType::READ) {
     latch_memo.xlatch(&root_lock_);
@@ -1236,6 +1549,71 @@ RC BplusTreeHandler::find_leaf_internal(BplusTreeMiniTransaction &mtr, BplusTree
   return RC::SUCCESS;
 }
 
+RC BplusTreeHandler::find_leaf_optimistic(BplusTreeMiniTransaction &mtr,
+    const function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, Frame *&frame)
+{
+  LatchMemo &latch_memo = mtr.latch_memo();
+
+  // 不加锁读到的内容可能是不一致的，任何一步失败都交给 crabing protocol 去处理，包括空树
+  auto conflict = [&latch_memo, &frame]() {
+    latch_memo.release_to(latch_memo.memo_point());
+    frame = nullptr;
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  };
+
+  // 根节点变化时，旧的根节点一定加着写锁被修改过，所以校验根节点的版本号就够了
+  PageNum page_num = file_header_.root_page;
+  if (page_num == BP_INVALID_PAGE_NUM || OB_FAIL(latch_memo.get_page(page_num, frame))) {
+    return conflict();
+  }
+
+  uint64_t version = frame->version();
+  if (Frame::is_writing_version(version) || page_num != file_header_.root_page) {
+    return conflict();
+  }
+
+  while (true) {
+    IndexNodeHandler index_node(mtr, file_header_, frame);
+    const bool       is_leaf = index_node.is_leaf();
+    const int        size    = index_node.size();
+    if (!frame->validate_version(version)) {
+      return conflict();
+    }
+    if (is_leaf) {
+      break;
+    }
+
+    // 节点个数正常时才能在节点中查找，但是找到的子节点仍然需要校验
+    InternalIndexNodeHandler internal_node(mtr, file_header_, frame);
+    if (size <= 0 || size > file_header_.internal_max_size) {
+      return conflict();
+    }
+    PageNum child_page_num = child_page_getter(internal_node);
+    if (!frame->validate_version(version)) {
+      return conflict();
+    }
+
+    Frame *child_frame = nullptr;
+    if (OB_FAIL(latch_memo.get_page(child_page_num, child_frame))) {
+      return conflict();
+    }
+    uint64_t child_version = child_frame->version();
+    if (Frame::is_writing_version(child_version) || !frame->validate_version(version)) {
+      return conflict();
+    }
+
+    latch_memo.release_to(latch_memo.memo_point() - 1);  // 释放父节点的pin
+    frame   = child_frame;
+    version = child_version;
+  }
+
+  latch_memo.latch(frame, LatchMemoType::SHARED);
+  if (!frame->validate_version(version)) {
+    return conflict();
+  }
+  return RC::SUCCESS;
+}
+
 RC BplusTreeHandler::crabing_protocal_fetch_page(
     BplusTreeMiniTransaction &mtr, BplusTreeOperationType op, PageNum page_num, bool is_root_node, Frame *&frame)
 {
@@ -1293,7 +1671,38 @@ RC BplusTreeHandler::insert_entry_into_leaf_node(BplusTreeMiniTransaction &mtr,
     new_index_node.insert(insert_position - leaf_node.size(), key, (const char *)rid);
   }
 
-  return insert_entry_into_parent(mtr, frame, new_frame, new_index_node.key_at(0));
+  vector<char> separator(file_header_.key_length);
+  make_separator(leaf_node.key_at(leaf_node.size() - 1), new_index_node.key_at(0), separator.data());
+  return insert_entry_into_parent(mtr, frame, new_frame, separator.data());
+}
+
+void BplusTreeHandler::make_separator(const char *left_key, const char *right_key, char *separator) const
+{
+  const int             key_length      = file_header_.key_length;
+  const int             attr_length     = file_header_.attr_length;
+  const AttrComparator &attr_comparator = key_comparator_.attr_comparator();
+  if (attr_comparator(left_key, right_key) == 0) {
+    memcpy(separator, right_key, key_length);
+    return;
+  }
+
+  // 从第一个不同的字节开始尝试，取能把左右两边区分开的最短前缀
+  int prefix_length = 0;
+  while (prefix_length < attr_length && left_key[prefix_length] == right_key[prefix_length]) {
+    prefix_length++;
+  }
+
+  memset(separator, 0, key_length);
+  memcpy(separator, right_key, prefix_length);
+  for (; prefix_length < attr_length; prefix_length++) {
+    separator[prefix_length] = right_key[prefix_length];
+    if (attr_comparator(left_key, separator) < 0 && attr_comparator(separator, right_key) <= 0) {
+      return;
+    }
+  }
+
+  // 不应该走到这里。属性值与 right_key 相同，RID是最小值
+  memcpy(separator, right_key, attr_length);
 }
 
 RC BplusTreeHandler::insert_entry_into_parent(BplusTreeMiniTransaction &mtr, Frame *frame, Frame *new_frame, const char *key)
@@ -1348,7 +1757,7 @@ RC BplusTreeHandler::insert_entry_into_parent(BplusTreeMiniTransaction &mtr, Fra
     InternalIndexNodeHandler parent_node(mtr, file_header_, parent_frame);
 
     /// 当前这个父节点还没有满，直接将新节点数据插进入就行了
-    if (parent_node.size() < parent_node.max_size()) {
+    if (parent_node.can_insert(key)) {
       parent_node.insert(key, new_frame->page_num(), key_comparator_);
       new_node_handler.set_parent_page_num(parent_page_num);
 
@@ -1436,8 +1845,7 @@ RC BplusTreeHandler::recover_init_header_page(BplusTreeMiniTransaction &mtr, Fra
   header_dirty_ = false;
   frame->mark_dirty();
 
-  key_comparator_.init(file_header_.attr_type, file_header_.attr_length);
-  key_printer_.init(file_header_.attr_type, file_header_.attr_length);
+  init_key_comparator();
 
   return RC::SUCCESS;
 }
@@ -1542,6 +1950,175 @@ RC BplusTreeHandler::insert_entry(const char *user_key, const RID *rid)
   return RC::SUCCESS;
 }
 
+RC BplusTreeHandler::insert_entry(const char *user_key, const RID *rid, const UniqueChecker &unique_checker)
+{
+  if (user_key == nullptr || rid == nullptr) {
+    LOG_WARN("Invalid arguments, key is empty or rid is empty");
+    return RC::INVALID_ARGUMENT;
+  }
+
+  MemPoolItem::item_unique_ptr pkey = make_key(user_key, *rid);
+  if (pkey == nullptr) {
+    LOG_WARN("Failed to alloc memory for key.");
+    return RC::NOMEM;
+  }
+
+  const char *key            = static_cast<const char *>(pkey.get());
+  bool        need_lock_tree = false;
+  RC          rc             = RC::SUCCESS;
+  do {
+    unique_lock_.lock_shared();
+    rc = insert_unique_entry(key, rid, unique_checker, need_lock_tree);
+    unique_lock_.unlock_shared();
+  } while (rc == RC::LOCKED_NEED_WAIT);
+
+  if (OB_FAIL(rc) || !need_lock_tree) {
+    return rc;
+  }
+
+  // 属性值相同的索引项跨越了多个叶子节点，从最左边的一个开始检查。加着写锁，检查完以后不会有相同属性值的插入
+  LOG_TRACE("entries with the same attribute may be in the left leaf, check them before inserting");
+  unique_lock_.lock();
+  MemPoolItem::item_unique_ptr min_key = make_key(user_key, *RID::min());
+  do {
+    BplusTreeMiniTransaction mtr(*this);
+    Frame                   *frame = nullptr;
+    rc = find_leaf(mtr, BplusTreeOperationType::READ, static_cast<const char *>(min_key.get()), frame);
+    if (OB_SUCC(rc)) {
+      LeafIndexNodeHandler leaf_node(mtr, file_header_, frame);
+      const int            index = leaf_node.lookup(key_comparator_, static_cast<const char *>(min_key.get()));
+      rc = check_unique_entries(mtr, frame, index, key, unique_checker);
+    }
+  } while (rc == RC::LOCKED_NEED_WAIT);
+
+  if (OB_SUCC(rc) || rc == RC::EMPTY) {
+    rc = insert_entry(user_key, rid);
+  }
+  unique_lock_.unlock();
+  return rc;
+}
+
+RC BplusTreeHandler::insert_unique_entry(
+    const char *key, const RID *rid, const UniqueChecker &unique_checker, bool &need_lock_tree)
+{
+  RC rc = RC::SUCCESS;
+
+  BplusTreeMiniTransaction mtr(*this, &rc);
+
+  need_lock_tree = false;
+  if (is_empty()) {
+    root_lock_.lock();
+    if (is_empty()) {
+      rc = create_new_tree(mtr, key, rid);
+      root_lock_.unlock();
+      return rc;
+    }
+    root_lock_.unlock();
+  }
+
+  // 查找路径上叶子节点左右两边的分隔键值，叶子节点中的键值都在 [lower_fence, upper_fence) 中。为空表示没有边界
+  vector<char> lower_fence;
+  vector<char> upper_fence;
+  auto child_page_getter = [this, key, &lower_fence, &upper_fence](InternalIndexNodeHandler &internal_node) {
+    const int index = internal_node.lookup(key_comparator_, key);
+    if (index > 0) {
+      const char *fence = internal_node.key_at(index);
+      lower_fence.assign(fence, fence + file_header_.key_length);
+    }
+    if (index + 1 < internal_node.size()) {
+      const char *fence = internal_node.key_at(index + 1);
+      upper_fence.assign(fence, fence + file_header_.key_length);
+    }
+    return internal_node.value_at(index);
+  };
+
+  Frame *frame = nullptr;
+  rc           = find_leaf_internal(mtr, BplusTreeOperationType::INSERT, child_page_getter, frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Failed to find leaf %s. rc=%d:%s", rid->to_string().c_str(), rc, strrc(rc));
+    return rc;
+  }
+
+  // 左边的叶子节点都小于 lower_fence。它的RID不是最小值时，左边可能还有相同属性值的索引项
+  const AttrComparator &attr_comparator = key_comparator_.attr_comparator();
+  if (!lower_fence.empty() && attr_comparator(lower_fence.data(), key) == 0 &&
+      memcmp(lower_fence.data() + file_header_.attr_length, RID::min(), sizeof(RID)) != 0) {
+    need_lock_tree = true;
+    return rc;
+  }
+
+  LeafIndexNodeHandler leaf_node(mtr, file_header_, frame);
+  const int            insert_position = leaf_node.lookup(key_comparator_, key);
+  for (int i = insert_position - 1; i >= 0 && attr_comparator(leaf_node.key_at(i), key) == 0; i--) {
+    rc = unique_checker(*reinterpret_cast<const RID *>(leaf_node.value_at(i)));
+    if (OB_FAIL(rc)) {
+      LOG_TRACE("unique check failed. rid=%s, rc=%s", rid->to_string().c_str(), strrc(rc));
+      return rc;
+    }
+  }
+
+  // 右边的叶子节点都不小于 upper_fence，属性值不同时就不需要再往右检查了
+  if (upper_fence.empty() || attr_comparator(upper_fence.data(), key) != 0) {
+    for (int i = insert_position; i < leaf_node.size() && attr_comparator(leaf_node.key_at(i), key) == 0; i++) {
+      rc = unique_checker(*reinterpret_cast<const RID *>(leaf_node.value_at(i)));
+      if (OB_FAIL(rc)) {
+        LOG_TRACE("unique check failed. rid=%s, rc=%s", rid->to_string().c_str(), strrc(rc));
+        return rc;
+      }
+    }
+  } else {
+    rc = check_unique_entries(mtr, frame, insert_position, key, unique_checker);
+    if (OB_FAIL(rc)) {
+      LOG_TRACE("unique check failed. rid=%s, rc=%s", rid->to_string().c_str(), strrc(rc));
+      return rc;
+    }
+  }
+
+  rc = insert_entry_into_leaf_node(mtr, frame, key, rid);
+  if (OB_FAIL(rc)) {
+    LOG_TRACE("Failed to insert into leaf of index, rid:%s. rc=%s", rid->to_string().c_str(), strrc(rc));
+    return rc;
+  }
+  return rc;
+}
+
+RC BplusTreeHandler::check_unique_entries(
+    BplusTreeMiniTransaction &mtr, Frame *frame, int index, const char *key, const UniqueChecker &unique_checker)
+{
+  LatchMemo            &latch_memo      = mtr.latch_memo();
+  const AttrComparator &attr_comparator = key_comparator_.attr_comparator();
+  while (true) {
+    LeafIndexNodeHandler leaf_node(mtr, file_header_, frame);
+    for (; index < leaf_node.size(); index++) {
+      if (attr_comparator(leaf_node.key_at(index), key) != 0) {
+        return RC::SUCCESS;
+      }
+
+      RC rc = unique_checker(*reinterpret_cast<const RID *>(leaf_node.value_at(index)));
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+
+    PageNum next_page_num = leaf_node.next_page();
+    if (BP_INVALID_PAGE_NUM == next_page_num) {
+      return RC::SUCCESS;
+    }
+
+    RC rc = latch_memo.get_page(next_page_num, frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get next page. page num=%d, rc=%s", next_page_num, strrc(rc));
+      return rc;
+    }
+
+    // 与扫描器一样，往右加锁时可能与删除时的合并操作死锁，加锁失败就从头重试
+    if (!latch_memo.try_slatch(frame)) {
+      return RC::LOCKED_NEED_WAIT;
+    }
+    index = 0;
+  }
+}
+
 RC BplusTreeHandler::get_entry(const char *user_key, int key_len, list<RID> &rids)
 {
   BplusTreeScanner scanner(*this);
@@ -1612,7 +2189,7 @@ RC BplusTreeHandler::coalesce_or_redistribute(BplusTreeMiniTransaction &mtr, Fra
   LatchMemo &latch_memo = mtr.latch_memo();
 
   IndexNodeHandlerType index_node(mtr, file_header_, frame);
-  if (index_node.size() >= index_node.min_size()) {
+  if (!index_node.is_underflow()) {
     return RC::SUCCESS;
   }
 
@@ -1662,7 +2239,7 @@ RC BplusTreeHandler::coalesce_or_redistribute(BplusTreeMiniTransaction &mtr, Fra
   latch_memo.xlatch(neighbor_frame);
 
   IndexNodeHandlerType neighbor_node(mtr, file_header_, neighbor_frame);
-  if (index_node.size() + neighbor_node.size() > index_node.max_size()) {
+  if (!index_node.can_merge(neighbor_node)) {
     rc = redistribute<IndexNodeHandlerType>(mtr, neighbor_frame, frame, parent_frame, index);
   } else {
     rc = coalesce<IndexNodeHandlerType>(mtr, neighbor_frame, frame, parent_frame, index);
@@ -1735,24 +2312,43 @@ RC BplusTreeHandler::redistribute(BplusTreeMiniTransaction &mtr, Frame *neighbor
   InternalIndexNodeHandler parent_node(mtr, file_header_, parent_frame);
   IndexNodeHandlerType     neighbor_node(mtr, file_header_, neighbor_frame);
   IndexNodeHandlerType     node(mtr, file_header_, frame);
-  if (neighbor_node.size() < node.size()) {
+  if (neighbor_node.size() < 2) {
     LOG_ERROR("got invalid nodes. neighbor node size %d, this node size %d", neighbor_node.size(), node.size());
+    return RC::SUCCESS;
+  }
+
+  // 先算出父节点中新的键值。邻居节点在右边时移动它的第一个元素，否则移动它的最后一个元素
+  const int    key_length   = file_header_.key_length;
+  const int    parent_index = (index == 0) ? index + 1 : index;
+  const int    second_index = (index == 0) ? 1 : neighbor_node.size() - 1;
+  vector<char> parent_key(key_length);
+  if (neighbor_node.is_leaf()) {
+    vector<char> first_key(key_length);
+    memcpy(first_key.data(), neighbor_node.key_at(second_index - 1), key_length);
+    make_separator(first_key.data(), neighbor_node.key_at(second_index), parent_key.data());
+  } else {
+    memcpy(parent_key.data(), neighbor_node.key_at(second_index), key_length);
+  }
+
+  if (!parent_node.can_set_key_at(parent_index, parent_key.data())) {
+    // 父节点放不下新的键值就不调整了，当前节点只是比较空，不影响正确性
+    LOG_TRACE("no space left in parent node to redistribute. parent page num=%d", parent_node.page_num());
+    return RC::SUCCESS;
   }
+
+  RC rc = RC::SUCCESS;
   if (index == 0) {
     // the neighbor is at right
-    neighbor_node.move_first_to_end(node);
-    // neighbor_node.validate(key_comparator_, disk_buffer_pool_, file_id_);
-    // node.validate(key_comparator_, disk_buffer_pool_, file_id_);
-    parent_node.set_key_at(index + 1, neighbor_node.key_at(0));
-    // parent_node.validate(key_comparator_, disk_buffer_pool_, file_id_);
+    rc = neighbor_node.move_first_to_end(node);
   } else {
     // the neighbor is at left
-    neighbor_node.move_last_to_front(node);
-    // neighbor_node.validate(key_comparator_, disk_buffer_pool_, file_id_);
-    // node.validate(key_comparator_, disk_buffer_pool_, file_id_);
-    parent_node.set_key_at(index, node.key_at(0));
-    // parent_node.validate(key_comparator_, disk_buffer_pool_, file_id_);
+    rc = neighbor_node.move_last_to_front(node);
   }
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to move item from neighbor node. rc=%s", strrc(rc));
+    return rc;
+  }
+  parent_node.set_key_at(parent_index, parent_key.data());
 
   neighbor_frame->mark_dirty();
   frame->mark_dirty();
@@ -1817,6 +2413,255 @@ RC BplusTreeHandler::delete_entry(const char *user_key, const RID *rid)
   return rc;
 }
 
+/**
+ * @brief 批量构建时某一层需要的节点个数
+ * @details 先按照填充比例算出节点个数，元素再平均分到每个节点上。
+ * 最后一个节点不能太空，所以平均下来不足 min_size 时减少节点个数，但是也不能超过 max_size。
+ */
+static int64_t bulk_load_node_num(int64_t item_num, int max_size, int fill_factor)
+{
+  const int min_size = max_size - max_size / 2;
+  const int fill_num = max(max_size * fill_factor / 100, min_size);
+
+  int64_t node_num = (item_num + fill_num - 1) / fill_num;
+  while (node_num > 1 && item_num / node_num < min_size) {
+    node_num--;
+  }
+  while ((item_num + node_num - 1) / node_num > max_size) {
+    node_num++;
+  }
+  return node_num;
+}
+
+RC BplusTreeHandler::bulk_load(int64_t key_num, const function<RC(const char *&key)> &key_reader, int fill_factor)
+{
+  if (!is_empty()) {
+    LOG_WARN("cannot bulk load into a non-empty tree. root page=%d", file_header_.root_page);
+    return RC::INTERNAL;
+  }
+
+  if (key_num <= 0) {
+    return RC::SUCCESS;
+  }
+
+  fill_factor = clamp(fill_factor, 50, 100);
+
+  /// 一层节点的构建状态。每层同时只有一个正在填充的节点
+  struct Level
+  {
+    int64_t      item_num   = 0;        /// 这一层所有节点的元素个数
+    int64_t      node_num   = 0;        /// 这一层的节点个数
+    int64_t      node_index = -1;       /// 正在填充的节点是这一层的第几个
+    Frame       *frame      = nullptr;  /// 正在填充的节点
+    vector<char> first_key;             /// 正在填充的节点在父节点中的键值，不大于这个子树中最小的键值
+    vector<char> item;                  /// 拼装元素用的缓存
+
+    int node_size() const { return static_cast<int>(item_num / node_num + (node_index < item_num % node_num ? 1 : 0)); }
+  };
+
+  const int key_length = file_header_.key_length;
+  // 内部节点的键值是变长的，事先不知道每个节点能放多少个元素，这里按照键值都是最长的情况计算
+  const int internal_max_size = min(file_header_.internal_max_size,
+      (BP_PAGE_DATA_SIZE - InternalIndexNode::HEADER_SIZE) / static_cast<int>(sizeof(InternalIndexSlot) + key_length));
+
+  vector<Level> levels;
+  for (int64_t item_num = key_num; levels.empty() || levels.back().node_num > 1;) {
+    const bool leaf     = levels.empty();
+    const int  max_size = leaf ? file_header_.leaf_max_size : internal_max_size;
+
+    Level level;
+    level.item_num = item_num;
+    level.node_num = bulk_load_node_num(item_num, max_size, fill_factor);
+    level.first_key.resize(key_length);
+    level.item.resize(key_length + (leaf ? sizeof(RID) : sizeof(PageNum)));
+    item_num = level.node_num;
+    levels.push_back(std::move(level));
+  }
+
+  LOG_INFO("begin to bulk load bplus tree. key num=%ld, fill factor=%d, leaf num=%ld, height=%d",
+           key_num, fill_factor, levels.front().node_num, static_cast<int>(levels.size()));
+
+  // 填充节点时不记录日志，节点填满以后由 write_node 记录整个节点
+  BplusTreeMiniTransaction fill_mtr(*this);
+
+  Frame  *prev_leaf     = nullptr;  // 需要等到下一个叶子节点分配好，设置了兄弟节点以后才能写日志
+  PageNum root_page_num = BP_INVALID_PAGE_NUM;
+  vector<char> prev_key(key_length);  // 上一个键值，也就是前一个叶子节点最后的键值
+
+  auto write_node = [this](Frame *frame) -> RC {
+    BplusTreeMiniTransaction mtr(*this);
+    IndexNodeHandler         node(mtr, file_header_, frame);
+
+    int image_size = 0;
+    if (node.is_leaf()) {
+      image_size = LeafIndexNode::HEADER_SIZE + node.size() * (file_header_.key_length + sizeof(RID));
+    } else {
+      // 内部节点的键值存放在页面的末尾
+      image_size = BP_PAGE_DATA_SIZE;
+    }
+
+    RC rc = mtr.logger().node_image(node, span<const char>(frame->data(), image_size));
+    if (OB_SUCC(rc)) {
+      rc = mtr.commit();
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to log node image. page num=%d, rc=%s", frame->page_num(), strrc(rc));
+    }
+    frame->mark_dirty();
+    disk_buffer_pool_->unpin_page(frame);
+    return rc;
+  };
+
+  // 分配一个新的节点，如果上一层没有正在填充的节点，也分配一个，作为这个节点的父节点
+  function<RC(size_t)> open_node = [&](size_t level_index) -> RC {
+    Level &level = levels[level_index];
+    Frame *frame = nullptr;
+    RC     rc    = disk_buffer_pool_->allocate_page(&frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to allocate page while bulk loading. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    level.frame = frame;
+    level.node_index++;
+
+    IndexNodeHandler node(fill_mtr, file_header_, frame);
+    node.init_empty(level_index == 0);
+    if (level_index == 0) {
+      reinterpret_cast<LeafIndexNode *>(frame->data())->next_brother = BP_INVALID_PAGE_NUM;
+      if (prev_leaf != nullptr) {
+        reinterpret_cast<LeafIndexNode *>(prev_leaf->data())->next_brother = frame->page_num();
+        rc        = write_node(prev_leaf);
+        prev_leaf = nullptr;
+        if (OB_FAIL(rc)) {
+          return rc;
+        }
+      }
+    }
+
+    if (level_index + 1 < levels.size()) {
+      Level &parent = levels[level_index + 1];
+      if (parent.frame == nullptr) {
+        rc = open_node(level_index + 1);
+        if (OB_FAIL(rc)) {
+          return rc;
+        }
+      }
+      reinterpret_cast<IndexNode *>(frame->data())->parent = parent.frame->page_num();
+    }
+    return RC::SUCCESS;
+  };
+
+  // 在某一层正在填充的节点上追加一个元素，节点满了就把它加到父节点中
+  function<RC(size_t, const char *, const char *)> append_item = [&](size_t level_index,
+                                                                     const char *key,
+                                                                     const char *value) -> RC {
+    Level &level = levels[level_index];
+    RC     rc    = RC::SUCCESS;
+    if (level.frame == nullptr) {
+      rc = open_node(level_index);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+
+    Frame *frame     = level.frame;
+    int    node_size = 0;
+    if (level_index == 0) {
+      memcpy(level.item.data(), key, key_length);
+      memcpy(level.item.data() + key_length, value, sizeof(RID));
+
+      LeafIndexNodeHandler leaf_node(fill_mtr, file_header_, frame);
+      leaf_node.recover_insert_items(leaf_node.size(), level.item.data(), 1);
+      node_size = leaf_node.size();
+    } else {
+      // 查找时不使用第一个键值，但是合并或重新分配节点时会把它移到兄弟节点中，所以和分裂出来的节点一样记录父节点中的分隔键值
+      InternalIndexNodeHandler internal_node(fill_mtr, file_header_, frame);
+      memcpy(level.item.data(), key, key_length);
+      memcpy(level.item.data() + key_length, value, sizeof(PageNum));
+      internal_node.recover_insert_items(internal_node.size(), level.item.data(), 1);
+      node_size = internal_node.size();
+    }
+
+    if (node_size == 1) {
+      if (level_index == 0 && level.node_index > 0) {
+        // 叶子节点在父节点中使用与前一个叶子节点之间最短的分隔键值
+        make_separator(prev_key.data(), key, level.first_key.data());
+      } else {
+        memcpy(level.first_key.data(), key, key_length);
+      }
+    }
+
+    if (node_size < level.node_size()) {
+      return RC::SUCCESS;
+    }
+
+    level.frame = nullptr;
+
+    const PageNum page_num = frame->page_num();
+    if (level_index + 1 < levels.size()) {
+      rc = append_item(level_index + 1, level.first_key.data(), reinterpret_cast<const char *>(&page_num));
+    } else {
+      root_page_num = page_num;
+    }
+
+    if (level_index == 0) {
+      prev_leaf = frame;
+    } else if (OB_SUCC(rc)) {
+      rc = write_node(frame);
+    } else {
+      disk_buffer_pool_->unpin_page(frame);
+    }
+    return rc;
+  };
+
+  RC rc = RC::SUCCESS;
+  for (int64_t i = 0; OB_SUCC(rc) && i < key_num; i++) {
+    const char *key = nullptr;
+    rc              = key_reader(key);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to read key while bulk loading. read num=%ld, key num=%ld, rc=%s", i, key_num, strrc(rc));
+      break;
+    }
+
+    if (i > 0 && key_comparator_(prev_key.data(), key) >= 0) {
+      LOG_WARN("keys are not in ascending order while bulk loading. key=%s", key_printer_(key).c_str());
+      rc = RC::INVALID_ARGUMENT;
+      break;
+    }
+
+    rc = append_item(0, key, key + file_header_.attr_length);
+    memcpy(prev_key.data(), key, key_length);
+  }
+
+  if (prev_leaf != nullptr) {
+    if (OB_SUCC(rc)) {
+      rc = write_node(prev_leaf);
+    } else {
+      disk_buffer_pool_->unpin_page(prev_leaf);
+    }
+  }
+
+  for (Level &level : levels) {
+    if (level.frame != nullptr) {
+      ASSERT(OB_FAIL(rc), "all nodes should be filled after bulk loading");
+      disk_buffer_pool_->unpin_page(level.frame);
+    }
+  }
+
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  BplusTreeMiniTransaction mtr(*this, &rc);
+  root_lock_.lock();
+  update_root_page_num_locked(mtr, root_page_num);
+  root_lock_.unlock();
+
+  LOG_INFO("bulk load bplus tree done. key num=%ld, root page=%d", key_num, root_page_num);
+  return rc;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 BplusTreeScanner::BplusTreeScanner(BplusTreeHandler &tree_handler)
@@ -1839,8 +2684,9 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
 
   LatchMemo &latch_memo = mtr_.latch_memo();
 
-  // 校验输入的键值是否是合法范围
-  if (left_user_key && right_user_key) {
+  // 校验输入的键值是否是合法范围。组合索引的边界可能只包含前面几个字段，不能直接比较
+  const bool composite = tree_handler_.file_header_.attr_num > 1;
+  if (left_user_key && right_user_key && !composite) {
     const auto &attr_comparator = tree_handler_.key_comparator_.attr_comparator();
     const int   result          = attr_comparator(left_user_key, right_user_key);
     if (result > 0 ||  // left < right
@@ -1866,7 +2712,13 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
   } else {
 
     char *fixed_left_key = const_cast<char *>(left_user_key);
-    if (tree_handler_.file_header_.attr_type == AttrType::CHARS) {
+    if (composite) {
+      rc = fix_prefix_key(left_user_key, left_len, !left_inclusive /*fill_max*/, &fixed_left_key);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to fix left prefix key. rc=%s", strrc(rc));
+        return rc;
+      }
+    } else if (tree_handler_.file_header_.attr_type == AttrType::CHARS) {
       bool should_inclusive_after_fix = false;
       rc = fix_user_key(left_user_key, left_len, true /*greater*/, &fixed_left_key, &should_inclusive_after_fix);
       if (OB_FAIL(rc)) {
@@ -1933,7 +2785,13 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
 
     char *fixed_right_key          = const_cast<char *>(right_user_key);
     bool  should_include_after_fix = false;
-    if (tree_handler_.file_header_.attr_type == AttrType::CHARS) {
+    if (composite) {
+      rc = fix_prefix_key(right_user_key, right_len, right_inclusive /*fill_max*/, &fixed_right_key);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to fix right prefix key. rc=%s", strrc(rc));
+        return rc;
+      }
+    } else if (tree_handler_.file_header_.attr_type == AttrType::CHARS) {
       rc = fix_user_key(right_user_key, right_len, false /*want_greater*/, &fixed_right_key, &should_include_after_fix);
       if (OB_FAIL(rc)) {
         LOG_WARN("failed to fix right user key. rc=%s", strrc(rc));
@@ -2093,3 +2951,47 @@ RC BplusTreeScanner::fix_user_key(
   *fixed_key = key_buf;
   return RC::SUCCESS;
 }
+
+RC BplusTreeScanner::fix_prefix_key(const char *user_key, int key_len, bool fill_max, char **fixed_key)
+{
+  const AttrComparator &attr_comparator = tree_handler_.key_comparator_.attr_comparator();
+  const int             attr_num        = attr_comparator.attr_num();
+  const int             attr_length     = attr_comparator.attr_length();
+
+  // 边界必须刚好包含前面的若干个完整字段
+  int prefix_num = 1;
+  while (prefix_num < attr_num && attr_comparator.attr_offset(prefix_num) < key_len) {
+    prefix_num++;
+  }
+  const int prefix_length = prefix_num < attr_num ? attr_comparator.attr_offset(prefix_num) : attr_length;
+  if (key_len != prefix_length) {
+    LOG_WARN("key length is not a prefix of the composite key. key len=%d, attr length=%d", key_len, attr_length);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  char *key_buf = new char[attr_length];
+  memcpy(key_buf, user_key, key_len);
+
+  // 剩下的字段填充最小值或最大值，这样前缀相同的键值都在边界的同一侧
+  for (int i = prefix_num; i < attr_num; i++) {
+    char     *column = key_buf + attr_comparator.attr_offset(i);
+    const int length = attr_comparator.attr_length(i);
+    switch (attr_comparator.attr_type(i)) {
+      case AttrType::INTS: {
+        int value = fill_max ? numeric_limits<int>::max() : numeric_limits<int>::min();
+        memcpy(column, &value, sizeof(value));
+      } break;
+      case AttrType::FLOATS: {
+        float value = fill_max ? numeric_limits<float>::max() : numeric_limits<float>::lowest();
+        memcpy(column, &value, sizeof(value));
+      } break;
+      default: {
+        // 字符串按照无符号字节比较，日期按照无符号整数比较
+        memset(column, fill_max ? 0xff : 0, length);
+      } break;
+    }
+  }
+
+  *fixed_key = key_buf;
+  return RC::SUCCESS;
+}
@@ -23,6 +23,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/memory.h"
 #include "common/lang/sstream.h"
 #include "common/lang/functional.h"
+#include "common/lang/vector.h"
 #include "common/log/log.h"
 #include "sql/parser/parse_defs.h"
 #include "storage/buffer/disk_buffer_pool.h"
@@ -52,37 +53,69 @@ enum class BplusTreeOperationType
 /**
  * @brief 属性比较(BplusTree)
  * @ingroup BPlusTree
+ * @details 组合索引的属性值是各个字段的值依次拼接起来的，按照字段的顺序逐个比较。
+ * 单个字段的索引就是只有一个字段的情况。
  */
 class AttrComparator
 {
 public:
-  void init(AttrType type, int length)
+  void init(AttrType type, int length) { init(&type, &length, 1); }
+
+  void init(const AttrType *types, const int *lengths, int attr_num)
   {
-    attr_type_   = type;
-    attr_length_ = length;
+    columns_.clear();
+    attr_length_ = 0;
+    for (int i = 0; i < attr_num; i++) {
+      columns_.push_back(Column{types[i], attr_length_, lengths[i]});
+      attr_length_ += lengths[i];
+    }
   }
 
   int attr_length() const { return attr_length_; }
+  int attr_num() const { return static_cast<int>(columns_.size()); }
+
+  AttrType attr_type(int i) const { return columns_[i].type; }
+  int      attr_offset(int i) const { return columns_[i].offset; }
+  int      attr_length(int i) const { return columns_[i].length; }
 
   int operator()(const char *v1, const char *v2) const
   {
-    
-    if(attr_type_!=AttrType::DATES){
-    Value left;
-    left.set_type(attr_type_);
-    left.set_data(v1, attr_length_ - 1);
-    Value right;
-    right.set_type(attr_type_);
-    right.set_data(v2, attr_length_ - 1);
-    return DataType::type_instance(attr_type_)->compare(left, right);}
-    else{
+    for (const Column &column : columns_) {
+      int result = compare(column, v1 + column.offset, v2 + column.offset);
+      if (result != 0) {
+        return result;
+      }
+    }
+    return 0;
+  }
+
+private:
+  struct Column
+  {
+    AttrType type;
+    int      offset;  ///< 在属性值中的偏移
+    int      length;
+  };
+
+  static int compare(const Column &column, const char *v1, const char *v2)
+  {
+    if (column.type == AttrType::DATES) {
       return common::compare_date((void *)v1, (void *)v2);
     }
+
+    // 索引中不存放空值，这里的数据都不是NULL，没有空值标记位
+    Value left;
+    left.set_type(column.type);
+    left.set_data(const_cast<char *>(v1), column.length, true /*is_not_null*/);
+    Value right;
+    right.set_type(column.type);
+    right.set_data(const_cast<char *>(v2), column.length, true /*is_not_null*/);
+    return DataType::type_instance(column.type)->compare(left, right);
   }
 
 private:
-  AttrType attr_type_;
-  int      attr_length_;
+  vector<Column> columns_;
+  int            attr_length_ = 0;
 };
 
 /**
@@ -94,6 +127,7 @@ class KeyComparator
 {
 public:
   void init(AttrType type, int length) { attr_comparator_.init(type, length); }
+  void init(const AttrType *types, const int *lengths, int attr_num) { attr_comparator_.init(types, lengths, attr_num); }
 
   const AttrComparator &attr_comparator() const { return attr_comparator_; }
 
@@ -120,23 +154,43 @@ private:
 class AttrPrinter
 {
 public:
-  void init(AttrType type, int length)
+  void init(AttrType type, int length) { init(&type, &length, 1); }
+
+  void init(const AttrType *types, const int *lengths, int attr_num)
   {
-    attr_type_   = type;
-    attr_length_ = length;
+    attr_types_.assign(types, types + attr_num);
+    attr_lengths_.assign(lengths, lengths + attr_num);
+    attr_length_ = 0;
+    for (int i = 0; i < attr_num; i++) {
+      attr_length_ += lengths[i];
+    }
   }
 
   int attr_length() const { return attr_length_; }
 
   string operator()(const char *v) const
   {
-    Value value(attr_type_, const_cast<char *>(v), attr_length_);
-    return value.to_string();
+    if (attr_types_.size() == 1) {
+      Value value(attr_types_[0], const_cast<char *>(v), attr_lengths_[0]);
+      return value.to_string();
+    }
+
+    // 组合索引打印成 (v1,v2,...)
+    stringstream ss;
+    ss << "(";
+    for (size_t i = 0; i < attr_types_.size(); i++) {
+      Value value(attr_types_[i], const_cast<char *>(v), attr_lengths_[i]);
+      ss << (i == 0 ? "" : ",") << value.to_string();
+      v += attr_lengths_[i];
+    }
+    ss << ")";
+    return ss.str();
   }
 
 private:
-  AttrType attr_type_;
-  int      attr_length_;
+  vector<AttrType> attr_types_;
+  vector<int>      attr_lengths_;
+  int              attr_length_ = 0;
 };
 
 /**
@@ -147,6 +201,7 @@ class KeyPrinter
 {
 public:
   void init(AttrType type, int length) { attr_printer_.init(type, length); }
+  void init(const AttrType *types, const int *lengths, int attr_num) { attr_printer_.init(types, lengths, attr_num); }
 
   const AttrPrinter &attr_printer() const { return attr_printer_; }
 
@@ -168,7 +223,8 @@ private:
  * @brief the meta information of bplus tree
  * @ingroup BPlusTree
  * @details this is the first page of bplus tree.
- * only one field can be supported, can you extend it to multi-fields?
+ * 组合索引的属性值是多个字段拼接起来的，每个字段的类型和长度记录在 attr_types 和 attr_lengths 中，
+ * attr_type 是第一个字段的类型，attr_length 是所有字段的长度之和。
  */
 struct IndexFileHeader
 {
@@ -177,12 +233,23 @@ struct IndexFileHeader
     memset(this, 0, sizeof(IndexFileHeader));
     root_page = BP_INVALID_PAGE_NUM;
   }
+
+  /// 组合索引最多包含的字段个数
+  static constexpr int MAX_ATTR_NUM = 8;
+
   PageNum  root_page;          ///< 根节点在磁盘中的页号
   int32_t  internal_max_size;  ///< 内部节点最大的键值对数
   int32_t  leaf_max_size;      ///< 叶子节点最大的键值对数
   int32_t  attr_length;        ///< 键值的长度
   int32_t  key_length;         ///< attr length + sizeof(RID)
   AttrType attr_type;          ///< 键值的类型
+  int32_t  version;            ///< 索引文件的格式版本，参考 CURRENT_VERSION
+  int32_t  attr_num;           ///< 索引包含的字段个数
+  AttrType attr_types[MAX_ATTR_NUM];    ///< 每个字段的类型
+  int32_t  attr_lengths[MAX_ATTR_NUM];  ///< 每个字段的长度
+
+  /// 当前的格式版本。版本1开始内部节点使用变长的键值，版本2增加了组合索引的字段信息
+  static constexpr int32_t CURRENT_VERSION = 2;
 
   const string to_string() const
   {
@@ -191,9 +258,11 @@ struct IndexFileHeader
     ss << "attr_length:" << attr_length << ","
        << "key_length:" << key_length << ","
        << "attr_type:" << attr_type_to_string(attr_type) << ","
+       << "attr_num:" << attr_num << ","
        << "root_page:" << root_page << ","
        << "internal_max_size:" << internal_max_size << ","
-       << "leaf_max_size:" << leaf_max_size << ";";
+       << "leaf_max_size:" << leaf_max_size << ","
+       << "version:" << version << ";";
 
     return ss.str();
   }
@@ -245,22 +314,39 @@ struct LeafIndexNode : public IndexNode
  * @ingroup BPlusTree
  * @code
  * storage format:
- * | common header |
- * | key(0),page_id(0) | key(1), page_id(1) | ... | key(n), page_id(n) |
+ * | common header | key bytes |
+ * | slot(0) | slot(1) | ... | slot(n) | free space | key(n) ... key(1) key(0) |
  * @endcode
- * the first key is ignored(key0).
- * so it will waste space, can you fix this?
+ * 内部节点的键值只用来区分子节点，不需要是完整的键值。
+ * 分裂叶子节点时选择左右两个节点之间最短的分隔键值(suffix truncation)，并且键值末尾的0不存放在页面中，
+ * 所以每个键值的长度是不一样的。slot 按照顺序存放子节点的页号和键值的位置，键值从页面的末尾往前存放。
+ * 读取键值时末尾补0恢复成 key_length 长度，参考 InternalIndexNodeHandler::key_at。
+ * 与叶子节点不同，内部节点能存放多少个元素取决于键值占用的空间，而不仅仅是 internal_max_size。
+ * the first key is ignored(key0) while looking up.
  */
 struct InternalIndexNode : public IndexNode
 {
-  static constexpr int HEADER_SIZE = IndexNode::HEADER_SIZE;
+  static constexpr int HEADER_SIZE = IndexNode::HEADER_SIZE + 4;
+
+  int32_t key_bytes;  /// 页面末尾存放的键值一共占用多少字节
 
   /**
-   * internal node just store order -1 keys and order rids, the last rid is last right child.
+   * slots of children, the keys are stored at the end of the page.
    */
   char array[0];
 };
 
+/**
+ * @brief 内部节点中一个子节点的描述
+ * @ingroup BPlusTree
+ */
+struct InternalIndexSlot
+{
+  uint16_t key_offset;  /// 键值在页面中的偏移
+  uint16_t key_length;  /// 键值在页面中存放的长度，不包括末尾省略的0
+  PageNum  page_num;    /// 子节点的页号
+};
+
 /**
  * @brief IndexNode 仅作为数据在内存或磁盘中的表示
  * @ingroup BPlusTree
@@ -303,6 +389,17 @@ public:
    */
   bool is_safe(BplusTreeOperationType op, bool is_root_node);
 
+  /**
+   * @brief 删除元素后节点是否太空，需要与兄弟节点合并或者重新分配
+   * @details 叶子节点按照元素个数判断。内部节点的键值是变长的，元素个数少于 min_size 并且使用的空间不足一半时才算太空
+   */
+  bool is_underflow() const;
+
+  /**
+   * @brief 当前节点与兄弟节点的元素能否放到一个节点中
+   */
+  bool can_merge(const IndexNodeHandler &other) const;
+
   /**
    * @brief 验证当前节点是否有问题
    */
@@ -312,8 +409,20 @@ public:
 
   friend string to_string(const IndexNodeHandler &handler);
 
-  RC recover_insert_items(int index, const char *items, int num);
-  RC recover_remove_items(int index, int num);
+  /**
+   * @brief 在指定位置插入元素，不记录日志
+   * @param items 元素的格式是固定长度的键值加上值，内部节点的值是子节点页号
+   */
+  virtual RC recover_insert_items(int index, const char *items, int num);
+  virtual RC recover_remove_items(int index, int num);
+
+protected:
+  /// 内部节点页面上可以存放slot和键值的空间
+  static constexpr int internal_capacity_bytes() { return BP_PAGE_DATA_SIZE - InternalIndexNode::HEADER_SIZE; }
+  /// 内部节点的slot和键值已经使用的空间
+  int internal_used_bytes() const;
+  /// 内部节点一个元素最多使用的空间
+  int internal_max_item_bytes() const;
 
 protected:
   /**
@@ -394,7 +503,12 @@ public:
   RC init_empty();
   RC create_new_root(PageNum first_page_num, const char *key, PageNum page_num);
 
-  RC      insert(const char *key, PageNum page_num, const KeyComparator &comparator);
+  RC insert(const char *key, PageNum page_num, const KeyComparator &comparator);
+
+  /**
+   * @brief 返回完整长度的键值
+   * @details 键值在页面中是压缩存放的，这里复制到当前对象的缓存中，下次调用 key_at 之前有效
+   */
   char   *key_at(int index);
   PageNum value_at(int index);
 
@@ -405,6 +519,15 @@ public:
   void set_key_at(int index, const char *key);
   void remove(int index);
 
+  /**
+   * @brief 当前节点是否可以插入这个键值
+   */
+  bool can_insert(const char *key) const;
+  /**
+   * @brief 把指定位置的键值替换成 key 以后，节点的空间是否足够
+   */
+  bool can_set_key_at(int index, const char *key) const;
+
   /**
    * 与Leaf节点不同，lookup返回指定key应该属于哪个子节点，返回这个子节点在当前节点中的索引
    * 如果想要返回插入位置，就提供 `insert_position` 参数
@@ -430,20 +553,43 @@ public:
 
   friend string to_string(const InternalIndexNodeHandler &handler, const KeyPrinter &printer);
 
+  RC recover_insert_items(int index, const char *items, int num) override;
+  RC recover_remove_items(int index, int num) override;
+
+  /**
+   * @brief 键值在内部节点中存放的长度，也就是去掉末尾的0以后的长度
+   */
+  static int stored_key_length(const char *key, int key_length);
+
 private:
   RC insert_items(int index, const char *items, int num);
   RC append(const char *items, int num);
   RC append(const char *item);
   RC preappend(const char *item);
 
+  /**
+   * @brief 按照固定长度的格式复制 [index, index + num) 的元素，用于记录日志和移动到其它节点
+   */
+  vector<char> copy_items(int index, int num) const;
+  /// 按照固定长度格式存放的元素在当前节点中需要占用的空间
+  int items_bytes(const char *items, int num) const;
+
 private:
-  char *__item_at(int index) const override;
+  InternalIndexSlot *slot_at(int index) const;
+  /// 把页面中的键值恢复成完整的长度
+  void decode_key(int index, char *key) const;
+  /// 把键值放到页面末尾的键值区，slot 需要已经存在
+  void put_key(int index, const char *key);
+  /// 按照slot的顺序重新存放键值，去掉删除元素留下的空洞
+  void compact_keys();
+  int  free_bytes() const;
 
   int value_size() const override;
   int item_size() const override;
 
 private:
-  InternalIndexNode *internal_node_ = nullptr;
+  InternalIndexNode   *internal_node_ = nullptr;
+  mutable vector<char> key_buffer_;  /// key_at 和 lookup 使用的缓存
 };
 
 /**
@@ -452,6 +598,14 @@ private:
  */
 class BplusTreeHandler
 {
+public:
+  /**
+   * @brief 唯一索引插入时检查冲突的函数
+   * @details 参数是索引中属性值与插入的键值相同的一个已有索引项的RID。
+   * 返回 RC::SUCCESS 表示不冲突，比如对应的记录已经被删除并提交了，其它返回值会终止插入
+   */
+  using UniqueChecker = function<RC(const RID &rid)>;
+
 public:
   /**
    * @brief 创建一个B+树
@@ -468,6 +622,17 @@ public:
   RC create(LogHandler &log_handler, DiskBufferPool &buffer_pool, AttrType attr_type, int attr_length,
       int internal_max_size = -1, int leaf_max_size = -1);
 
+  /**
+   * @brief 创建一个组合索引的B+树
+   * @details 属性值是各个字段的值依次拼接起来的，按照字段的顺序比较
+   * @param attr_types 每个字段的类型
+   * @param attr_lengths 每个字段的长度
+   */
+  RC create(LogHandler &log_handler, BufferPoolManager &bpm, const char *file_name, const vector<AttrType> &attr_types,
+      const vector<int> &attr_lengths, int internal_max_size = -1, int leaf_max_size = -1);
+  RC create(LogHandler &log_handler, DiskBufferPool &buffer_pool, const vector<AttrType> &attr_types,
+      const vector<int> &attr_lengths, int internal_max_size = -1, int leaf_max_size = -1);
+
   /**
    * @brief 打开一个B+树
    * @param log_handler 记录日志
@@ -490,6 +655,16 @@ public:
    */
   RC insert_entry(const char *user_key, const RID *rid);
 
+  /**
+   * @brief 向唯一索引中插入一个索引项
+   * @details 冲突检查与插入使用同一次查找：叶子节点加着写锁时，对属性值相同的每个已有索引项调用 unique_checker，
+   * 都不冲突时再插入到这个叶子节点中。同一个属性值的插入都会落在同一个叶子节点上，因此不会同时插入两个相同的键值。
+   * 查找路径上的分隔键值就是叶子节点的边界，属性值相同的索引项延伸到右边的叶子节点时，按照从左到右的顺序加锁检查。
+   * 延伸到左边的叶子节点时(同一个属性值有很多已经删除的旧版本)，不能往回加锁，改成在整棵树的唯一性检查锁下先查询再插入。
+   * @return RC::SUCCESS 插入成功，其它是 unique_checker 返回的冲突或者插入时的错误
+   */
+  RC insert_entry(const char *user_key, const RID *rid, const UniqueChecker &unique_checker);
+
   /**
    * @brief 从IndexHandle句柄对应的索引中删除一个值为（user_key，rid）的索引项
    * @return RECORD_INVALID_KEY 指定值不存在
@@ -497,6 +672,17 @@ public:
    */
   RC delete_entry(const char *user_key, const RID *rid);
 
+  /**
+   * @brief 从下往上批量构建B+树，只能在空树上调用
+   * @details 键值必须从小到大给出并且不能重复。叶子节点从左到右依次填充，一个节点填满后把它与前一个节点的分隔键值加到上一层的节点中，
+   * 各层的节点个数根据键值个数事先算好，除了根节点，每个节点的元素个数都在 [min_size, max_size] 之间，内部节点的 max_size 按照键值都是最长的情况计算。
+   * 每个节点填满后只记录一条日志，内容是整个节点，而不是每个键值一条日志。
+   * @param key_num 键值的个数
+   * @param key_reader 每次返回下一个键值，包括属性值和RID，长度是 key_length。返回的内存在下次调用前有效
+   * @param fill_factor 节点的填充比例，百分比。不在 [50, 100] 之间时会被调整到这个范围内
+   */
+  RC bulk_load(int64_t key_num, const function<RC(const char *&key)> &key_reader, int fill_factor);
+
   bool is_empty() const;
 
   /**
@@ -519,6 +705,7 @@ public:
   const IndexFileHeader &file_header() const { return file_header_; }
   DiskBufferPool        &buffer_pool() const { return *disk_buffer_pool_; }
   LogHandler            &log_handler() const { return *log_handler_; }
+  const KeyComparator   &key_comparator() const { return key_comparator_; }
 
 public:
   /**
@@ -572,6 +759,16 @@ protected:
   RC find_leaf_internal(BplusTreeMiniTransaction &mtr, BplusTreeOperationType op,
       const function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, Frame *&frame);
 
+  /**
+   * @brief 乐观地查找叶子节点，只用于读操作
+   * @details 从根节点往下查找时不加锁，只pin住页面，读取节点前后校验页帧的版本号(Frame::version)，
+   * 确认子节点的页面pin住以后才释放父节点，最后只在叶子节点上加读锁。
+   * 这样并发读时不会在根节点的锁上竞争。读取的过程中有节点被修改时返回 RC::LOCKED_CONCURRENCY_CONFLICT，
+   * 调用者再使用 crabing protocol 重新查找。
+   */
+  RC find_leaf_optimistic(BplusTreeMiniTransaction &mtr,
+      const function<PageNum(InternalIndexNodeHandler &)> &child_page_getter, Frame *&frame);
+
   /**
    * @brief 使用crabing protocol 获取页面
    */
@@ -611,6 +808,16 @@ protected:
   template <typename IndexNodeHandlerType>
   RC redistribute(BplusTreeMiniTransaction &mtr, Frame *neighbor_frame, Frame *frame, Frame *parent_frame, int index);
 
+  /**
+   * @brief 计算左右两个节点之间最短的分隔键值
+   * @details 满足 left_key < separator <= right_key。属性值不同时只保留 right_key 属性值的一个前缀，剩余部分和RID都是0，
+   * 这样在内部节点中存放时末尾的0都可以省略掉。
+   * @param left_key 左边节点最大的键值
+   * @param right_key 右边节点最小的键值
+   * @param[out] separator 分隔键值，长度是 key_length
+   */
+  void make_separator(const char *left_key, const char *right_key, char *separator) const;
+
   /**
    * @brief 在父节点插入一个元素
    */
@@ -621,6 +828,21 @@ protected:
    */
   RC insert_entry_into_leaf_node(BplusTreeMiniTransaction &mtr, Frame *frame, const char *pkey, const RID *rid);
 
+  /**
+   * @brief 在一次查找中完成唯一索引的冲突检查和插入
+   * @param[out] need_lock_tree 属性值相同的索引项可能在左边的叶子节点中，需要加唯一性检查锁重新处理，这时什么都没有做
+   * @return RC::LOCKED_NEED_WAIT 右边的叶子节点加锁失败，需要重试
+   */
+  RC insert_unique_entry(const char *key, const RID *rid, const UniqueChecker &unique_checker, bool &need_lock_tree);
+
+  /**
+   * @brief 从叶子节点的指定位置开始往右检查属性值与 key 相同的索引项，直到遇到不同的属性值
+   * @details 右边的叶子节点使用 try latch 加读锁，与扫描器一样，避免与删除时的合并操作死锁
+   * @return RC::LOCKED_NEED_WAIT 叶子节点加锁失败
+   */
+  RC check_unique_entries(BplusTreeMiniTransaction &mtr, Frame *frame, int index, const char *key,
+      const UniqueChecker &unique_checker);
+
   /**
    * @brief 创建一个新的B+树
    */
@@ -639,6 +861,11 @@ protected:
 private:
   common::MemPoolItem::item_unique_ptr make_key(const char *user_key, const RID &rid);
 
+  /**
+   * @brief 根据文件头中记录的字段信息初始化键值比较器和打印器
+   */
+  void init_key_comparator();
+
 protected:
   LogHandler     *log_handler_      = nullptr;  /// 日志处理器
   DiskBufferPool *disk_buffer_pool_ = nullptr;  /// 磁盘缓冲池
@@ -649,6 +876,9 @@ protected:
   // 这个锁可以使用递归读写锁，但是这里偷懒先不改
   common::SharedMutex root_lock_;
 
+  // 唯一索引插入时的检查锁。在一个叶子节点中就能完成检查的插入加读锁，需要先查询再插入的加写锁
+  common::SharedMutex unique_lock_;
+
   KeyComparator key_comparator_;
   KeyPrinter    key_printer_;
 
@@ -705,6 +935,13 @@ private:
    */
   RC fix_user_key(const char *user_key, int key_len, bool want_greater, char **fixed_key, bool *should_inclusive);
 
+  /**
+   * @brief 组合索引的边界可以只包含前面几个字段，把剩下的字段填充成最小值或最大值
+   * @param key_len 边界的长度，必须是前面若干个字段的长度之和
+   * @param fill_max 剩下的字段填充最大值还是最小值
+   */
+  RC fix_prefix_key(const char *user_key, int key_len, bool fill_max, char **fixed_key);
+
   void fetch_item(RID &rid);
 
   /**
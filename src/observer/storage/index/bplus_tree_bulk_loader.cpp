@@ -0,0 +1,263 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/index/bplus_tree_bulk_loader.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/filesystem.h"
+#include "common/lang/queue.h"
+#include "common/log/log.h"
+#include "storage/index/bplus_tree.h"
+
+/**
+ * @brief 顺序读取一个有序段文件
+ */
+class BplusTreeBulkLoader::RunReader
+{
+public:
+  RunReader(int key_length, int64_t buffer_keys)
+      : key_length_(key_length), buffer_(static_cast<size_t>(key_length) * buffer_keys)
+  {}
+
+  RC open(const string &file_name)
+  {
+    file_.open(file_name, ios::in | ios::binary);
+    if (!file_.is_open()) {
+      LOG_WARN("failed to open sort run file. file=%s, error=%s", file_name.c_str(), strerror(errno));
+      return RC::IOERR_OPEN;
+    }
+    return fill();
+  }
+
+  /// 当前是否还有键值。读完以后返回false
+  bool        valid() const { return pos_ < size_; }
+  const char *current() const { return buffer_.data() + pos_; }
+
+  RC next()
+  {
+    pos_ += key_length_;
+    if (pos_ < size_) {
+      return RC::SUCCESS;
+    }
+    return fill();
+  }
+
+private:
+  RC fill()
+  {
+    file_.read(buffer_.data(), buffer_.size());
+    if (file_.bad()) {
+      LOG_WARN("failed to read sort run file. error=%s", strerror(errno));
+      return RC::IOERR_READ;
+    }
+
+    pos_  = 0;
+    size_ = file_.gcount();
+    if (size_ % key_length_ != 0) {
+      LOG_WARN("sort run file is truncated. read bytes=%ld, key length=%d", size_, key_length_);
+      return RC::IOERR_READ;
+    }
+    return RC::SUCCESS;
+  }
+
+private:
+  const int    key_length_;
+  ifstream     file_;
+  vector<char> buffer_;
+  int64_t      size_ = 0;  /// buffer_ 中有效数据的字节数
+  int64_t      pos_  = 0;  /// 当前键值在 buffer_ 中的位置
+};
+
+BplusTreeBulkLoader::BplusTreeBulkLoader(
+    BplusTreeHandler &tree_handler, int64_t sort_memory, int fill_factor, bool unique /* = false */)
+    : tree_handler_(tree_handler),
+      fill_factor_(fill_factor),
+      unique_(unique),
+      key_length_(tree_handler.file_header().key_length),
+      sort_memory_(sort_memory)
+{
+  // 每个键值还有一个排序用的指针
+  buffer_capacity_ = max<int64_t>(1, sort_memory_ / static_cast<int64_t>(key_length_ + sizeof(char *)));
+  last_key_.resize(tree_handler.file_header().attr_length);
+}
+
+BplusTreeBulkLoader::~BplusTreeBulkLoader() { remove_run_files(); }
+
+RC BplusTreeBulkLoader::add(const char *user_key, const RID &rid)
+{
+  if (static_cast<int64_t>(buffer_.size() / key_length_) >= buffer_capacity_) {
+    RC rc = spill();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  const int    attr_length = tree_handler_.file_header().attr_length;
+  const size_t offset      = buffer_.size();
+  buffer_.resize(offset + key_length_);
+  memcpy(buffer_.data() + offset, user_key, attr_length);
+  memcpy(buffer_.data() + offset + attr_length, &rid, sizeof(rid));
+  key_num_++;
+  return RC::SUCCESS;
+}
+
+void BplusTreeBulkLoader::sort_buffer()
+{
+  sorted_keys_.clear();
+  sorted_keys_.reserve(buffer_.size() / key_length_);
+  for (size_t offset = 0; offset < buffer_.size(); offset += key_length_) {
+    sorted_keys_.push_back(buffer_.data() + offset);
+  }
+
+  const KeyComparator &comparator = tree_handler_.key_comparator();
+  sort(sorted_keys_.begin(), sorted_keys_.end(), [&comparator](const char *key1, const char *key2) {
+    return comparator(key1, key2) < 0;
+  });
+}
+
+RC BplusTreeBulkLoader::spill()
+{
+  if (buffer_.empty()) {
+    return RC::SUCCESS;
+  }
+
+  sort_buffer();
+
+  string   file_name = string(tree_handler_.buffer_pool().filename()) + ".sort." + std::to_string(run_files_.size());
+  ofstream file(file_name, ios::out | ios::binary | ios::trunc);
+  if (!file.is_open()) {
+    LOG_WARN("failed to create sort run file. file=%s, error=%s", file_name.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+  run_files_.push_back(file_name);
+  run_num_++;
+
+  for (const char *key : sorted_keys_) {
+    file.write(key, key_length_);
+  }
+  file.close();
+  if (file.fail()) {
+    LOG_WARN("failed to write sort run file. file=%s, error=%s", file_name.c_str(), strerror(errno));
+    return RC::IOERR_WRITE;
+  }
+
+  LOG_INFO("spill sorted keys to file. file=%s, key num=%ld",
+           file_name.c_str(), static_cast<long>(sorted_keys_.size()));
+  buffer_.clear();
+  sorted_keys_.clear();
+  return RC::SUCCESS;
+}
+
+RC BplusTreeBulkLoader::finish()
+{
+  RC rc = RC::SUCCESS;
+  if (run_files_.empty()) {
+    sort_buffer();
+
+    size_t index      = 0;
+    auto   key_reader = [this, &index](const char *&key) -> RC {
+      key = sorted_keys_[index++];
+      return check_unique(key);
+    };
+    rc = tree_handler_.bulk_load(key_num_, key_reader, fill_factor_);
+  } else {
+    rc = spill();
+    if (OB_SUCC(rc)) {
+      // 归并时只需要每个有序段的读缓存
+      vector<char>().swap(buffer_);
+      vector<char *>().swap(sorted_keys_);
+      rc = merge_runs();
+    }
+  }
+
+  remove_run_files();
+  return rc;
+}
+
+RC BplusTreeBulkLoader::merge_runs()
+{
+  // 排序使用的内存平分给每个有序段做读缓存
+  const int64_t buffer_keys = max<int64_t>(1, sort_memory_ / key_length_ / static_cast<int64_t>(run_files_.size()));
+
+  vector<unique_ptr<RunReader>> readers;
+  for (const string &file_name : run_files_) {
+    auto reader = make_unique<RunReader>(key_length_, buffer_keys);
+    RC   rc     = reader->open(file_name);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    readers.push_back(std::move(reader));
+  }
+
+  const KeyComparator &comparator = tree_handler_.key_comparator();
+  auto                 greater    = [&comparator](const RunReader *reader1, const RunReader *reader2) {
+    return comparator(reader1->current(), reader2->current()) > 0;
+  };
+  priority_queue<RunReader *, vector<RunReader *>, decltype(greater)> heap(greater);
+  for (auto &reader : readers) {
+    if (reader->valid()) {
+      heap.push(reader.get());
+    }
+  }
+
+  // 返回的键值在 last_reader 的缓存中，下一次读取时才能移动 last_reader
+  RunReader *last_reader = nullptr;
+  auto       key_reader  = [&heap, &last_reader, this](const char *&key) -> RC {
+    if (last_reader != nullptr) {
+      RC rc = last_reader->next();
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+      if (last_reader->valid()) {
+        heap.push(last_reader);
+      }
+      last_reader = nullptr;
+    }
+
+    if (heap.empty()) {
+      return RC::RECORD_EOF;
+    }
+
+    last_reader = heap.top();
+    heap.pop();
+    key = last_reader->current();
+    return check_unique(key);
+  };
+
+  LOG_INFO("begin to merge sort runs. run num=%d, key num=%ld", run_num_, key_num_);
+  return tree_handler_.bulk_load(key_num_, key_reader, fill_factor_);
+}
+
+RC BplusTreeBulkLoader::check_unique(const char *key)
+{
+  if (!unique_) {
+    return RC::SUCCESS;
+  }
+
+  const AttrComparator &attr_comparator = tree_handler_.key_comparator().attr_comparator();
+  if (has_last_key_ && attr_comparator(last_key_.data(), key) == 0) {
+    LOG_WARN("duplicate key found while building unique index");
+    return RC::UNIQUE_INDEX_EXIST;
+  }
+
+  memcpy(last_key_.data(), key, last_key_.size());
+  has_last_key_ = true;
+  return RC::SUCCESS;
+}
+
+void BplusTreeBulkLoader::remove_run_files()
+{
+  for (const string &file_name : run_files_) {
+    error_code ec;
+    if (!filesystem::remove(file_name, ec)) {
+      LOG_WARN("failed to remove sort run file. file=%s, error=%s", file_name.c_str(), ec.message().c_str());
+    }
+  }
+  run_files_.clear();
+}
@@ -0,0 +1,89 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/fstream.h"
+#include "common/lang/ios.h"
+#include "common/lang/memory.h"
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "common/sys/rc.h"
+#include "storage/record/record.h"
+
+class BplusTreeHandler;
+
+/**
+ * @brief 创建索引时批量构建B+树
+ * @ingroup BPlusTree
+ * @details 先收集所有的键值（属性值+RID），排好序以后交给 BplusTreeHandler::bulk_load 从下往上构建B+树，
+ * 比逐条插入少了很多次查找和节点分裂，日志也是按照页面记录的。
+ * 排序使用外部归并排序：缓存的键值超过内存限制时，排好序写到一个临时文件中作为一个有序段，
+ * 最后对所有的有序段做多路归并。所有的键值都能放在内存中时不会产生临时文件。
+ * 临时文件放在索引文件所在的目录，对象销毁时删除。
+ */
+class BplusTreeBulkLoader
+{
+public:
+  /**
+   * @param tree_handler 刚创建的空B+树
+   * @param sort_memory 排序使用的内存，单位字节
+   * @param fill_factor 节点的填充比例，参考 BplusTreeHandler::bulk_load
+   * @param unique 是否唯一索引。唯一索引遇到相同的属性值时返回 RC::UNIQUE_INDEX_EXIST
+   */
+  BplusTreeBulkLoader(BplusTreeHandler &tree_handler, int64_t sort_memory, int fill_factor, bool unique = false);
+  ~BplusTreeBulkLoader();
+
+  /**
+   * @brief 添加一个键值
+   * @param user_key 属性值，长度是 attr_length
+   */
+  RC add(const char *user_key, const RID &rid);
+
+  /**
+   * @brief 所有键值都添加完成，排序并构建B+树
+   */
+  RC finish();
+
+  int64_t key_num() const { return key_num_; }
+  /// 写到临时文件中的有序段个数
+  int run_num() const { return run_num_; }
+
+private:
+  /// 对内存中缓存的键值排序，排序的是指向键值的指针
+  void sort_buffer();
+  /// 把内存中的键值排好序写到一个新的临时文件中
+  RC spill();
+  /// 对所有的有序段做多路归并，依次交给B+树
+  RC merge_runs();
+  /// 删除所有的临时文件
+  void remove_run_files();
+
+  RC check_unique(const char *key);
+
+private:
+  class RunReader;
+
+  BplusTreeHandler &tree_handler_;
+  const int         fill_factor_;
+  const bool        unique_;
+  const int         key_length_;
+  int64_t           sort_memory_     = 0;
+  int64_t           buffer_capacity_ = 0;  /// 内存中最多缓存的键值个数
+
+  int64_t        key_num_ = 0;
+  vector<char>   buffer_;       /// 内存中缓存的键值
+  vector<char *> sorted_keys_;  /// 排好序的键值，指向 buffer_
+  vector<string> run_files_;    /// 临时文件
+  int            run_num_ = 0;
+
+  bool         has_last_key_ = false;
+  vector<char> last_key_;  /// 唯一索引检查时使用，上一个交给B+树的键值
+};
@@ -14,12 +14,15 @@ See the Mulan PSL v2 for more details. */
 
 #include "storage/index/bplus_tree_index.h"
 #include "common/log/log.h"
+#include "storage/index/bplus_tree_bulk_loader.h"
 #include "storage/table/table.h"
 #include "storage/db/db.h"
+#include "storage/trx/trx.h"
 
 BplusTreeIndex::~BplusTreeIndex() noexcept { close(); }
 
-RC BplusTreeIndex::create(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+RC BplusTreeIndex::create(
+    Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
 {
   if (inited_) {
     LOG_WARN("Failed to create index due to the index has been created before. file_name:%s, index:%s, field:%s",
@@ -27,10 +30,18 @@ RC BplusTreeIndex::create(Table *table, const char *file_name, const IndexMeta &
     return RC::RECORD_OPENNED;
   }
 
-  Index::init(index_meta, field_meta);
+  Index::init(index_meta, field_metas);
+
+  // 组合索引的属性值是各个字段依次拼接起来的
+  vector<AttrType> attr_types;
+  vector<int>      attr_lengths;
+  for (const FieldMeta &field_meta : field_metas) {
+    attr_types.push_back(field_meta.type());
+    attr_lengths.push_back(field_meta.len() - 1);  // -1 for null marker, see FieldMeta::init
+  }
 
   BufferPoolManager &bpm = table->db()->buffer_pool_manager();
-  RC rc = index_handler_.create(table->db()->log_handler(), bpm, file_name, field_meta.type(), field_meta.len() - 1); // -1 for null marker, see FieldMeta::init
+  RC rc = index_handler_.create(table->db()->log_handler(), bpm, file_name, attr_types, attr_lengths);
   if (RC::SUCCESS != rc) {
     LOG_WARN("Failed to create index_handler, file_name:%s, index:%s, field:%s, rc:%s",
         file_name, index_meta.name(), index_meta.field(), strrc(rc));
@@ -44,7 +55,8 @@ RC BplusTreeIndex::create(Table *table, const char *file_name, const IndexMeta &
   return RC::SUCCESS;
 }
 
-RC BplusTreeIndex::open(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+RC BplusTreeIndex::open(
+    Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
 {
   if (inited_) {
     LOG_WARN("Failed to open index due to the index has been initedd before. file_name:%s, index:%s, field:%s",
@@ -52,7 +64,7 @@ RC BplusTreeIndex::open(Table *table, const char *file_name, const IndexMeta &in
     return RC::RECORD_OPENNED;
   }
 
-  Index::init(index_meta, field_meta);
+  Index::init(index_meta, field_metas);
 
   BufferPoolManager &bpm = table->db()->buffer_pool_manager();
   RC rc = index_handler_.open(table->db()->log_handler(), bpm, file_name);
@@ -80,30 +92,92 @@ RC BplusTreeIndex::close()
   return RC::SUCCESS;
 }
 
+const char *BplusTreeIndex::make_user_key(const char *record, vector<char> &key_buffer) const
+{
+  if (field_metas_.size() == 1) {
+    return record + field_metas_[0].offset();
+  }
+
+  key_buffer.clear();
+  for (const FieldMeta &field_meta : field_metas_) {
+    const char *data = record + field_meta.offset();
+    key_buffer.insert(key_buffer.end(), data, data + field_meta.len() - 1);
+  }
+  return key_buffer.data();
+}
+
 RC BplusTreeIndex::insert_entry(const char *record, const RID *rid)
 {
-  if (index_meta_.type() == IndexMeta::IndexType::INDEX_TYPE_UNIQUE) {
-    // unique index
-    list<RID> tmp_rid;
-    RC rc = index_handler_.get_entry(record + field_meta_.offset(), field_meta_.len() - 1, tmp_rid);
-    if (rc == RC::SUCCESS) {
-      if (!tmp_rid.empty()) {
-        LOG_WARN("Failed to insert existing entry into unique index . index:%s, field:%s, rc:%s",
-            index_meta_.name(), field_meta_.name(), strrc(RC::UNIQUE_INDEX_EXIST));
-        return RC::UNIQUE_INDEX_EXIST;
-      }
-    } else if (rc != RC::SUCCESS) {
-      LOG_WARN("Failed to check if the entry is unique. index:%s, field:%s, rc:%s",
-          index_meta_.name(), field_meta_.name(), strrc(rc));
-      return rc;
-    }
+  vector<char> key_buffer;
+  const char  *user_key = make_user_key(record, key_buffer);
+  if (index_meta_.type() != IndexMeta::IndexType::INDEX_TYPE_UNIQUE) {
+    return index_handler_.insert_entry(user_key, rid);
+  }
+
+  // 在插入时查找到的叶子节点上检查冲突，不需要先单独查询一次
+  auto unique_checker = [this, record](const RID &existing_rid) {
+    return check_unique_conflict(record, existing_rid);
+  };
+  RC rc = index_handler_.insert_entry(user_key, rid, unique_checker);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Failed to insert entry into unique index. index:%s, field:%s, rc:%s",
+        index_meta_.name(), index_meta_.field(), strrc(rc));
   }
-  return index_handler_.insert_entry(record + field_meta_.offset(), rid);
+  return rc;
+}
+
+RC BplusTreeIndex::check_unique_conflict(const char *record, const RID &existing_rid) const
+{
+  Record existing_record;
+  RC     rc = table_->get_record(existing_rid, existing_record);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get record of unique index entry. index:%s, rid:%s, rc:%s",
+        index_meta_.name(), existing_rid.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  return table_->db()->trx_kit().check_unique_conflict(table_, record, existing_record.data());
 }
 
 RC BplusTreeIndex::delete_entry(const char *record, const RID *rid)
 {
-  return index_handler_.delete_entry(record + field_meta_.offset(), rid);
+  vector<char> key_buffer;
+  return index_handler_.delete_entry(make_user_key(record, key_buffer), rid);
+}
+
+RC BplusTreeIndex::bulk_load(const function<RC(Record &)> &record_reader, int64_t sort_memory, int fill_factor)
+{
+  const bool          unique = index_meta_.type() == IndexMeta::IndexType::INDEX_TYPE_UNIQUE;
+  BplusTreeBulkLoader loader(index_handler_, sort_memory, fill_factor, unique);
+
+  RC           rc = RC::SUCCESS;
+  Record       record;
+  vector<char> key_buffer;
+  while (OB_SUCC(rc = record_reader(record))) {
+    if (has_null_field(record.data())) {  // don't insert null value into index
+      continue;
+    }
+    rc = loader.add(make_user_key(record.data(), key_buffer), record.rid());
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to add key to bulk loader. index:%s, rc:%s", index_meta_.name(), strrc(rc));
+      return rc;
+    }
+  }
+
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to read record while bulk loading index. index:%s, rc:%s", index_meta_.name(), strrc(rc));
+    return rc;
+  }
+
+  rc = loader.finish();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to bulk load index. index:%s, rc:%s", index_meta_.name(), strrc(rc));
+    return rc;
+  }
+
+  LOG_INFO("bulk loaded index. index:%s, key num:%ld, sort runs:%d",
+      index_meta_.name(), loader.key_num(), loader.run_num());
+  return RC::SUCCESS;
 }
 
 IndexScanner *BplusTreeIndex::create_scanner(
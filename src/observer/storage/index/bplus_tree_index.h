@@ -27,13 +27,24 @@ public:
   BplusTreeIndex() = default;
   virtual ~BplusTreeIndex() noexcept;
 
-  RC create(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta) override;
-  RC open(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta) override;
+  RC create(Table *table, const char *file_name, const IndexMeta &index_meta,
+      const vector<FieldMeta> &field_metas) override;
+  RC open(Table *table, const char *file_name, const IndexMeta &index_meta,
+      const vector<FieldMeta> &field_metas) override;
   RC close();
 
   RC insert_entry(const char *record, const RID *rid) override;
   RC delete_entry(const char *record, const RID *rid) override;
 
+  /**
+   * @brief 把表中已有的数据批量插入到刚创建的索引中
+   * @details 所有键值排好序后从下往上构建B+树，参考 BplusTreeBulkLoader。空值不会插入到索引中
+   * @param record_reader 依次返回表中的记录，没有更多记录时返回 RC::RECORD_EOF
+   * @param sort_memory 排序使用的内存，超过以后会使用临时文件
+   * @param fill_factor 节点的填充比例，百分比
+   */
+  RC bulk_load(const function<RC(Record &)> &record_reader, int64_t sort_memory, int fill_factor);
+
   /**
    * 扫描指定范围的数据
    */
@@ -42,6 +53,19 @@ public:
 
   RC sync() override;
 
+private:
+  /**
+   * @brief 从记录中取出索引的属性值
+   * @details 单个字段的索引直接返回记录中的数据，组合索引把各个字段拼接到 key_buffer 中
+   */
+  const char *make_user_key(const char *record, vector<char> &key_buffer) const;
+
+  /**
+   * @brief 唯一索引插入时，检查索引中属性值相同的一条记录是否与新插入的记录冲突
+   * @details 由事务模型根据已有记录判断，参考 TrxKit::check_unique_conflict
+   */
+  RC check_unique_conflict(const char *record, const RID &existing_rid) const;
+
 private:
   bool             inited_ = false;
   Table           *table_  = nullptr;
@@ -90,6 +90,11 @@ RC BplusTreeLogger::set_parent_page(IndexNodeHandler &node_handler, PageNum page
   return append_log_entry(make_unique<SetParentPageLogEntryHandler>(node_handler.frame(), page_num, old_page_num));
 }
 
+RC BplusTreeLogger::node_image(IndexNodeHandler &node_handler, span<const char> image)
+{
+  return append_log_entry(make_unique<NodeImageLogEntryHandler>(node_handler.frame(), image));
+}
+
 RC BplusTreeLogger::append_log_entry(unique_ptr<bplus_tree::LogEntryHandler> entry)
 {
   if (!need_log_) {
@@ -127,6 +127,12 @@ public:
    */
   RC set_parent_page(IndexNodeHandler &node_handler, PageNum page_num, PageNum old_page_num);
 
+  /**
+   * @brief 记录整个节点的内容
+   * @param image 节点头和所有的元素
+   */
+  RC node_image(IndexNodeHandler &node_handler, span<const char> image);
+
   /**
    * @brief 提交。表示整个操作成功
    */
@@ -34,6 +34,7 @@ string LogOperation::to_string() const
     case Type::INTERNAL_UPDATE_KEY: ss << "INTERNAL_UPDATE_KEY"; break;
     case Type::NODE_INSERT: ss << "NODE_INSERT"; break;
     case Type::NODE_REMOVE: ss << "NODE_REMOVE"; break;
+    case Type::NODE_IMAGE: ss << "NODE_IMAGE"; break;
     default: ss << "INVALID"; break;
   }
   return ss.str();
@@ -172,6 +173,10 @@ RC LogEntryHandler::from_buffer(
       rc = NormalOperationLogEntryHandler::deserialize(frame, operation, buffer, handler);
     } break;
 
+    case LogOperation::Type::NODE_IMAGE: {
+      rc = NodeImageLogEntryHandler::deserialize(frame, buffer, handler);
+    } break;
+
     default: {
       LOG_ERROR("unknown log operation. operation=%d:%s", operation.index(), operation.to_string().c_str());
       return RC::INTERNAL;
@@ -328,11 +333,18 @@ RC NormalOperationLogEntryHandler::rollback(BplusTreeMiniTransaction &mtr, Bplus
   if (nullptr == frame()) {
     return RC::INTERNAL;
   }
-  IndexNodeHandler node_handler(mtr, tree_handler.file_header(), frame());
+  InternalIndexNodeHandler internal_node(mtr, tree_handler.file_header(), frame());
+  LeafIndexNodeHandler     leaf_node(mtr, tree_handler.file_header(), frame());
+  IndexNodeHandler        *real_handler = nullptr;
+  if (leaf_node.is_leaf()) {
+    real_handler = &leaf_node;
+  } else {
+    real_handler = &internal_node;
+  }
   if (operation_type().type() == LogOperation::Type::NODE_INSERT) {
-    return node_handler.recover_remove_items(index_, item_num_);
+    return real_handler->recover_remove_items(index_, item_num_);
   } else {  // should be NODE_REMOVE
-    return node_handler.recover_insert_items(index_, items_.data(), item_num_);
+    return real_handler->recover_insert_items(index_, items_.data(), item_num_);
   }
 }
 
@@ -605,4 +617,47 @@ RC UpdateRootPageLogEntryHandler::redo(BplusTreeMiniTransaction &mtr, BplusTreeH
   return tree_handler.recover_update_root_page(mtr, root_page_num_);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// NodeImageLogEntryHandler
+NodeImageLogEntryHandler::NodeImageLogEntryHandler(Frame *frame, span<const char> image)
+    : NodeLogEntryHandler(LogOperation::Type::NODE_IMAGE, frame), image_(image.begin(), image.end())
+{}
+
+RC NodeImageLogEntryHandler::serialize_body(Serializer &buffer) const
+{
+  if (buffer.write_int32(image_bytes()) < 0 || buffer.write(image_) < 0) {
+    return RC::INTERNAL;
+  }
+  return RC::SUCCESS;
+}
+
+string NodeImageLogEntryHandler::to_string() const
+{
+  stringstream ss;
+  ss << LogEntryHandler::to_string() << ", image_bytes=" << image_bytes();
+  return ss.str();
+}
+
+RC NodeImageLogEntryHandler::deserialize(Frame *frame, Deserializer &buffer, unique_ptr<LogEntryHandler> &handler)
+{
+  int32_t image_bytes = -1;
+  if (buffer.read_int32(image_bytes) < 0 || image_bytes < 0 || image_bytes > static_cast<int32_t>(BP_PAGE_DATA_SIZE)) {
+    return RC::INTERNAL;
+  }
+
+  vector<char> image(image_bytes);
+  if (buffer.read(image) < 0) {
+    return RC::INTERNAL;
+  }
+
+  handler = make_unique<NodeImageLogEntryHandler>(frame, image);
+  return RC::SUCCESS;
+}
+
+RC NodeImageLogEntryHandler::redo(BplusTreeMiniTransaction &mtr, BplusTreeHandler &tree_handler)
+{
+  memcpy(frame()->data(), image_.data(), image_.size());
+  return RC::SUCCESS;
+}
+
 }  // namespace bplus_tree
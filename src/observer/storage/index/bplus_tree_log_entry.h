@@ -50,6 +50,7 @@ public:
     INTERNAL_UPDATE_KEY,       /// 更新内部节点的key
     NODE_INSERT,               /// 在节点中间(也可能是末尾)插入一些元素
     NODE_REMOVE,               /// 在节点中间(也可能是末尾)删除一些元素
+    NODE_IMAGE,                /// 整个节点的内容，批量构建B+树时使用
 
     MAX_TYPE,
   };
@@ -376,4 +377,31 @@ private:
   vector<char> old_key_;
 };
 
+/**
+ * @brief 节点整页内容日志处理类
+ * @ingroup CLog
+ * @details 批量构建B+树时，每个节点只写一次，直接记录节点头和所有元素，不再逐个元素记录日志。
+ * 只用于新分配的页面，构建失败时整个索引文件都会丢弃，所以不需要回滚。
+ */
+class NodeImageLogEntryHandler : public NodeLogEntryHandler
+{
+public:
+  NodeImageLogEntryHandler(Frame *frame, span<const char> image);
+  virtual ~NodeImageLogEntryHandler() = default;
+
+  RC serialize_body(common::Serializer &buffer) const override;
+  RC rollback(BplusTreeMiniTransaction &mtr, BplusTreeHandler &tree_handler) override { return RC::SUCCESS; }
+  RC redo(BplusTreeMiniTransaction &mtr, BplusTreeHandler &tree_handler) override;
+
+  string to_string() const override;
+
+  static RC deserialize(Frame *frame, common::Deserializer &buffer, unique_ptr<LogEntryHandler> &handler);
+
+  const char *image() const { return image_.data(); }
+  int32_t     image_bytes() const { return static_cast<int32_t>(image_.size()); }
+
+private:
+  vector<char> image_;
+};
+
 }  // namespace bplus_tree
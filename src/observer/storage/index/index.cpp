@@ -14,9 +14,19 @@ See the Mulan PSL v2 for more details. */
 
 #include "storage/index/index.h"
 
-RC Index::init(const IndexMeta &index_meta, const FieldMeta &field_meta)
+RC Index::init(const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
 {
-  index_meta_ = index_meta;
-  field_meta_ = field_meta;
+  index_meta_  = index_meta;
+  field_metas_ = field_metas;
   return RC::SUCCESS;
 }
+
+bool Index::has_null_field(const char *record) const
+{
+  for (const FieldMeta &field_meta : field_metas_) {
+    if (field_meta.check_null_marker(record)) {
+      return true;
+    }
+  }
+  return false;
+}
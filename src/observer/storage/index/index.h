@@ -15,7 +15,8 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include <stddef.h>
-#include <vector>
+
+#include "common/lang/vector.h"
 
 #include "common/sys/rc.h"
 #include "storage/field/field_meta.h"
@@ -40,11 +41,15 @@ public:
   Index()          = default;
   virtual ~Index() = default;
 
-  virtual RC create(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+  /**
+   * @brief 创建索引
+   * @param field_metas 索引包含的字段，顺序与 index_meta 中的字段相同
+   */
+  virtual RC create(Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
   {
     return RC::UNSUPPORTED;
   }
-  virtual RC open(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta)
+  virtual RC open(Table *table, const char *file_name, const IndexMeta &index_meta, const vector<FieldMeta> &field_metas)
   {
     return RC::UNSUPPORTED;
   }
@@ -53,6 +58,13 @@ public:
 
   const IndexMeta &index_meta() const { return index_meta_; }
 
+  const vector<FieldMeta> &field_metas() const { return field_metas_; }
+
+  /**
+   * @brief 记录中是否有索引字段是NULL。有空值的记录不会插入到索引中
+   */
+  bool has_null_field(const char *record) const;
+
   /**
    * @brief 插入一条数据
    *
@@ -89,11 +101,11 @@ public:
   virtual RC sync() = 0;
 
 protected:
-  RC init(const IndexMeta &index_meta, const FieldMeta &field_meta);
+  RC init(const IndexMeta &index_meta, const vector<FieldMeta> &field_metas);
 
 protected:
-  IndexMeta index_meta_;  ///< 索引的元数据
-  FieldMeta field_meta_;  ///< 当前实现仅考虑一个字段的索引
+  IndexMeta         index_meta_;   ///< 索引的元数据
+  vector<FieldMeta> field_metas_;  ///< 索引包含的字段，按照在索引中的顺序
 };
 
 /**
@@ -21,33 +21,54 @@ See the Mulan PSL v2 for more details. */
 
 const static Json::StaticString FIELD_NAME("name");
 const static Json::StaticString FIELD_FIELD_NAME("field_name");
+const static Json::StaticString FIELD_FIELD_NAMES("field_names");
 const static Json::StaticString FIELD_TYPE("index_type");
 
 RC IndexMeta::init(const char *name, const FieldMeta &field, const IndexMeta::IndexType &index_type)
+{
+  return init(name, vector<const FieldMeta *>{&field}, index_type);
+}
+
+RC IndexMeta::init(const char *name, const vector<const FieldMeta *> &fields, const IndexMeta::IndexType &index_type)
 {
   if (common::is_blank(name)) {
     LOG_ERROR("Failed to init index, name is empty.");
     return RC::INVALID_ARGUMENT;
   }
 
-  name_  = name;
-  field_ = field.name();
-  type_  = index_type;
+  if (fields.empty()) {
+    LOG_ERROR("Failed to init index, no field. name=%s", name);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  name_ = name;
+  fields_.clear();
+  for (const FieldMeta *field : fields) {
+    fields_.push_back(field->name());
+  }
+  type_ = index_type;
   return RC::SUCCESS;
 }
 
 void IndexMeta::to_json(Json::Value &json_value) const
 {
   json_value[FIELD_NAME]       = name_;
-  json_value[FIELD_FIELD_NAME] = field_;
+  json_value[FIELD_FIELD_NAME] = fields_[0];  // 兼容只有一个字段的旧格式
   json_value[FIELD_TYPE]       = type_; // default index type
+
+  Json::Value fields_value(Json::arrayValue);
+  for (const string &field : fields_) {
+    fields_value.append(field);
+  }
+  json_value[FIELD_FIELD_NAMES] = std::move(fields_value);
 }
 
 RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value, IndexMeta &index)
 {
-  const Json::Value &name_value  = json_value[FIELD_NAME];
-  const Json::Value &field_value = json_value[FIELD_FIELD_NAME];
-  const Json::Value &type_value  = json_value[FIELD_TYPE];
+  const Json::Value &name_value   = json_value[FIELD_NAME];
+  const Json::Value &field_value  = json_value[FIELD_FIELD_NAME];
+  const Json::Value &fields_value = json_value[FIELD_FIELD_NAMES];
+  const Json::Value &type_value   = json_value[FIELD_TYPE];
   if (!name_value.isString()) {
     LOG_ERROR("Index name is not a string. json value=%s", name_value.toStyledString().c_str());
     return RC::INTERNAL;
@@ -65,19 +86,45 @@ RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value, I
     return RC::INTERNAL;
   }
 
-  const FieldMeta *field = table.field(field_value.asCString());
-  if (nullptr == field) {
-    LOG_ERROR("Deserialize index [%s]: no such field: %s", name_value.asCString(), field_value.asCString());
-    return RC::SCHEMA_FIELD_MISSING;
+  // 旧版本的元数据只有 field_name
+  vector<string> field_names;
+  if (fields_value.isArray()) {
+    for (int i = 0; i < static_cast<int>(fields_value.size()); i++) {
+      if (!fields_value[i].isString()) {
+        LOG_ERROR("Field name of index [%s] is not a string. json value=%s",
+            name_value.asCString(), fields_value.toStyledString().c_str());
+        return RC::INTERNAL;
+      }
+      field_names.push_back(fields_value[i].asString());
+    }
+  } else {
+    field_names.push_back(field_value.asString());
+  }
+
+  vector<const FieldMeta *> fields;
+  for (const string &field_name : field_names) {
+    const FieldMeta *field = table.field(field_name.c_str());
+    if (nullptr == field) {
+      LOG_ERROR("Deserialize index [%s]: no such field: %s", name_value.asCString(), field_name.c_str());
+      return RC::SCHEMA_FIELD_MISSING;
+    }
+    fields.push_back(field);
   }
 
-  return index.init(name_value.asCString(), *field, static_cast<IndexMeta::IndexType>(type_value.asInt()));
+  return index.init(name_value.asCString(), fields, static_cast<IndexMeta::IndexType>(type_value.asInt()));
 }
 
 const char *IndexMeta::name() const { return name_.c_str(); }
 
-const char *IndexMeta::field() const { return field_.c_str(); }
+const char *IndexMeta::field() const { return fields_.empty() ? "" : fields_[0].c_str(); }
 
 const IndexMeta::IndexType IndexMeta::type() const { return type_; }
 
-void IndexMeta::desc(ostream &os) const { os << "index name=" << name_ << ", field=" << field_ << ", type=" << static_cast<int>(type_); }
\ No newline at end of file
+void IndexMeta::desc(ostream &os) const
+{
+  os << "index name=" << name_ << ", field=";
+  for (size_t i = 0; i < fields_.size(); i++) {
+    os << (i == 0 ? "" : ",") << fields_[i];
+  }
+  os << ", type=" << static_cast<int>(type_);
+}
@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/sys/rc.h"
 #include "common/lang/string.h"
+#include "common/lang/vector.h"
 
 class TableMeta;
 class FieldMeta;
@@ -28,6 +29,7 @@ class Value;
  * @brief 描述一个索引
  * @ingroup Index
  * @details 一个索引包含了表的哪些字段，索引的名称等。
+ * 组合索引包含多个字段，字段的顺序就是创建索引时指定的顺序，查询时可以使用最左边的若干个字段。
  * 如果以后实现了多种类型的索引，还需要记录索引的类型，对应类型的一些元数据等
  */
 class IndexMeta
@@ -43,10 +45,14 @@ public:
   IndexMeta() = default;
 
  RC init(const char *name, const FieldMeta &field, const IndexMeta::IndexType &index_type);
+ RC init(const char *name, const vector<const FieldMeta *> &fields, const IndexMeta::IndexType &index_type);
 
 public:
   const char *name() const;
+  /// 索引的第一个字段
   const char *field() const;
+  const vector<string> &fields() const { return fields_; }
+  int                   field_num() const { return static_cast<int>(fields_.size()); }
   const IndexType type() const;
 
   void desc(ostream &os) const;
@@ -57,6 +63,6 @@ public:
 
 protected:
   string name_;   // index's name
-  string field_;  // field's name
+  vector<string> fields_;  // fields' name, in index order
   IndexType type_ = INDEX_TYPE_DEFAULT;
 };
@@ -12,8 +12,10 @@ See the Mulan PSL v2 for more details. */
 // Created by Meiyi & Longda on 2021/4/13.
 //
 #include "storage/record/record_manager.h"
+#include "common/lang/algorithm.h"
 #include "common/log/log.h"
 #include "storage/common/condition_filter.h"
+#include "sql/expr/expression.h"
 #include "storage/trx/trx.h"
 #include "storage/clog/log_handler.h"
 
@@ -192,8 +194,8 @@ RC RecordPageHandler::init_empty_page(
   memset(bitmap_, 0, page_bitmap_size(page_header_->record_capacity));
   // column_index[i] store the end offset of column `i` or the start offset of column `i+1`
   int *column_index = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
+  // 页面上的列与 TableMeta 中的字段一一对应，包括最前面的事务字段，所以用户字段的列编号是 sys_field_num + field_id
   for (int i = 0; i < column_num; ++i) {
-    ASSERT(i == table_meta->field(i)->field_id(), "i should be the col_id of fields[i]");
     if (i == 0) {
       column_index[i] = table_meta->field(i)->len() * page_header_->record_capacity;
     } else {
@@ -414,10 +416,77 @@ PageNum RecordPageHandler::get_page_num() const
 
 bool RecordPageHandler::is_full() const { return page_header_->record_num >= page_header_->record_capacity; }
 
+int RecordPageHandler::select_slots(vector<uint8_t> &select) const
+{
+  const int record_capacity = page_header_->record_capacity;
+  select.assign(record_capacity, 0);
+  if (page_header_->record_num == 0) {
+    return 0;
+  }
+
+  Bitmap bitmap(bitmap_, record_capacity);
+  int    count = 0;
+  for (int slot = bitmap.next_setted_bit(0); slot != -1 && slot < record_capacity;
+       slot      = bitmap.next_setted_bit(slot + 1)) {
+    select[slot] = 1;
+    count++;
+  }
+  return count;
+}
+
 RC PaxRecordPageHandler::insert_record(const char *data, RID *rid)
 {
-  // your code here
-  exit(-1);
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
+         "cannot insert record into page while the page is readonly");
+
+  if (page_header_->record_num == page_header_->record_capacity) {
+    LOG_WARN("Page is full, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
+    return RC::RECORD_NOMEM;
+  }
+
+  // 找到空闲位置
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  int    index = bitmap.next_unsetted_bit(0);
+  bitmap.set_bit(index);
+  page_header_->record_num++;
+
+  RC rc = log_handler_.insert_record(frame_, RID(get_page_num(), index), data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to insert record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+
+  // 按列拆分记录，写入各列所在的区域
+  set_record_fields(index, data);
+
+  frame_->mark_dirty();
+
+  if (rid) {
+    rid->page_num = get_page_num();
+    rid->slot_num = index;
+  }
+
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::recover_insert_record(const char *data, const RID &rid)
+{
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_WARN("slot_num illegal, slot_num(%d) > record_capacity(%d).", rid.slot_num, page_header_->record_capacity);
+    return RC::RECORD_INVALID_RID;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    bitmap.set_bit(rid.slot_num);
+    page_header_->record_num++;
+  }
+
+  set_record_fields(rid.slot_num, data);
+
+  frame_->mark_dirty();
+
+  return RC::SUCCESS;
 }
 
 RC PaxRecordPageHandler::delete_record(const RID *rid)
@@ -444,17 +513,157 @@ RC PaxRecordPageHandler::delete_record(const RID *rid)
   }
 }
 
+RC PaxRecordPageHandler::update_record(const RID &rid, const char *data)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot update record in page while the page is readonly");
+
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, frame=%s, page_header=%s",
+              rid.slot_num, frame_->to_string().c_str(), page_header_->to_string().c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  frame_->mark_dirty();
+  set_record_fields(rid.slot_num, data);
+
+  RC rc = log_handler_.update_record(frame_, rid, data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to update record. page_num %d:%d. rc=%s", 
+              disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+
+  return RC::SUCCESS;
+}
+
 RC PaxRecordPageHandler::get_record(const RID &rid, Record &record)
 {
-  // your code here
-  exit(-1);
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, frame=%s, page_header=%s",
+              rid.slot_num, frame_->to_string().c_str(), page_header_->to_string().c_str());
+    return RC::RECORD_INVALID_RID;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    LOG_ERROR("Invalid slot_num:%d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  // PAX 页面上一行的数据不是连续存放的，只能复制出来重新拼装
+  RC rc = record.new_record(page_header_->record_real_size);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  int offset = 0;
+  for (int col_id = 0; col_id < page_header_->column_num; col_id++) {
+    const int field_len = get_field_len(col_id);
+    memcpy(record.data() + offset, get_field_data(rid.slot_num, col_id), field_len);
+    offset += field_len;
+  }
+  record.set_rid(rid);
+  return RC::SUCCESS;
 }
 
-// TODO: specify the column_ids that chunk needed. currenly we get all columns
 RC PaxRecordPageHandler::get_chunk(Chunk &chunk)
 {
-  // your code here
-  exit(-1);
+  vector<uint8_t> select;
+  select_slots(select);
+  return get_chunk(chunk, select);
+}
+
+RC PaxRecordPageHandler::get_chunk(Chunk &chunk, const vector<uint8_t> &select)
+{
+  const int record_capacity = page_header_->record_capacity;
+  const int slot_num        = min(static_cast<int>(select.size()), record_capacity);
+
+  // 找出连续的被选中的槽位区间，每一列按区间整段复制。
+  // 如果只有一个从0号槽位开始的区间，就可以直接引用页面上的内存，不需要复制。
+  vector<pair<int, int>> ranges;  // [start, end)
+  int                    selected_num = 0;
+  for (int slot = 0; slot < slot_num;) {
+    if (select[slot] == 0) {
+      slot++;
+      continue;
+    }
+    int end = slot + 1;
+    while (end < slot_num && select[end] != 0) {
+      end++;
+    }
+    ranges.emplace_back(slot, end);
+    selected_num += end - slot;
+    slot = end;
+  }
+  const bool zero_copy = ranges.empty() || (ranges.size() == 1 && ranges[0].first == 0);
+
+  for (int i = 0; i < chunk.column_num(); i++) {
+    Column   &column = chunk.column(i);
+    const int col_id = chunk.column_ids(i);
+    RC        rc     = check_column(col_id, column);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    if (zero_copy) {
+      column.reference(get_field_data(0, col_id), selected_num);
+      continue;
+    }
+
+    if (!column.own_memory() || column.capacity() < selected_num) {
+      column.init(column.attr_type(), column.attr_len(), max(column.capacity(), record_capacity));
+    }
+
+    column.reset_data();
+    for (const auto &[start, end] : ranges) {
+      rc = column.append(get_field_data(start, col_id), end - start);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to append data to column. rc=%s", strrc(rc));
+        return rc;
+      }
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::reference_columns(Chunk &chunk)
+{
+  for (int i = 0; i < chunk.column_num(); i++) {
+    Column   &column = chunk.column(i);
+    const int col_id = chunk.column_ids(i);
+    RC        rc     = check_column(col_id, column);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    column.reference(get_field_data(0, col_id), page_header_->record_capacity);
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::check_column(int col_id, const Column &column)
+{
+  if (col_id < 0 || col_id >= page_header_->column_num || get_field_len(col_id) != column.attr_len()) {
+    LOG_WARN("column is not match with the page. col_id=%d, column_num=%d, attr_len=%d",
+             col_id, page_header_->column_num, column.attr_len());
+    return RC::INVALID_ARGUMENT;
+  }
+  return RC::SUCCESS;
+}
+
+void PaxRecordPageHandler::set_record_fields(SlotNum slot_num, const char *data)
+{
+  int offset = 0;
+  for (int col_id = 0; col_id < page_header_->column_num; col_id++) {
+    const int field_len = get_field_len(col_id);
+    memcpy(get_field_data(slot_num, col_id), data + offset, field_len);
+    offset += field_len;
+  }
 }
 
 char *PaxRecordPageHandler::get_field_data(SlotNum slot_num, int col_id)
@@ -517,7 +726,7 @@ RC RecordFileHandler::init_free_pages()
   RC rc = RC::SUCCESS;
 
   BufferPoolIterator bp_iterator;
-  bp_iterator.init(*disk_buffer_pool_, 1);
+  bp_iterator.init(*disk_buffer_pool_, 1, true /*read_ahead*/);
   unique_ptr<RecordPageHandler> record_page_handler(RecordPageHandler::create(storage_format_));
   PageNum                       current_page_num = 0;
 
@@ -715,7 +924,7 @@ RC RecordFileScanner::open_scan(Table *table, DiskBufferPool &buffer_pool, Trx *
   log_handler_      = &log_handler;
   rw_mode_          = mode;
 
-  RC rc = bp_iterator_.init(buffer_pool, 1);
+  RC rc = bp_iterator_.init(buffer_pool, 1, true /*read_ahead*/);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to init bp iterator. rc=%d:%s", rc, strrc(rc));
     return rc;
@@ -870,17 +1079,23 @@ RC ChunkFileScanner::close_scan()
   return RC::SUCCESS;
 }
 
-RC ChunkFileScanner::open_scan_chunk(
-    Table *table, DiskBufferPool &buffer_pool, LogHandler &log_handler, ReadWriteMode mode)
+RC ChunkFileScanner::open_scan_chunk(Table *table, DiskBufferPool &buffer_pool, Trx *trx, LogHandler &log_handler,
+    ReadWriteMode mode, const vector<Expression *> &predicates)
 {
   close_scan();
 
   table_            = table;
   disk_buffer_pool_ = &buffer_pool;
+  trx_              = trx;
   log_handler_      = &log_handler;
   rw_mode_          = mode;
+  predicates_       = predicates;
+
+  trx_chunk_.reset();
+  filter_chunk_.reset();
+  page_chunk_.reset();
 
-  RC rc = bp_iterator_.init(buffer_pool, 1);
+  RC rc = bp_iterator_.init(buffer_pool, 1, true /*read_ahead*/);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to init bp iterator. rc=%d:%s", rc, strrc(rc));
     return rc;
@@ -891,12 +1106,84 @@ RC ChunkFileScanner::open_scan_chunk(
     record_page_handler_ = new PaxRecordPageHandler();
   }
 
+  if (table != nullptr) {
+    const TableMeta &table_meta    = table->table_meta();
+    const int        sys_field_num = table_meta.sys_field_num();
+    if (trx_ != nullptr) {
+      for (int i = 0; i < sys_field_num; i++) {
+        trx_chunk_.add_column(make_unique<Column>(), i);
+        trx_chunk_.column(i).init(*table_meta.field(i), 0);
+      }
+    }
+
+    if (!predicates_.empty()) {
+      for (int i = sys_field_num; i < table_meta.field_num(); i++) {
+        filter_chunk_.add_column(make_unique<Column>(), i);
+        filter_chunk_.column(i - sys_field_num).init(*table_meta.field(i), 0);
+      }
+    }
+  }
+
   return rc;
 }
 
-RC ChunkFileScanner::next_chunk(Chunk &chunk)
+RC ChunkFileScanner::init_page_chunks(Chunk &chunk)
+{
+  if (page_chunk_.column_num() == chunk.column_num()) {
+    return RC::SUCCESS;
+  }
+
+  page_chunk_.reset();
+  const int sys_field_num = (table_ == nullptr) ? 0 : table_->table_meta().sys_field_num();
+  for (int i = 0; i < chunk.column_num(); i++) {
+    const Column &column = chunk.column(i);
+    page_chunk_.add_column(
+        make_unique<Column>(column.attr_type(), column.attr_len(), column.capacity()), sys_field_num + chunk.column_ids(i));
+  }
+  return RC::SUCCESS;
+}
+
+RC ChunkFileScanner::filter_page()
 {
   RC rc = RC::SUCCESS;
+  if (trx_chunk_.column_num() > 0) {
+    rc = record_page_handler_->reference_columns(trx_chunk_);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to reference trx columns. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    rc = trx_->visit_chunk(table_, trx_chunk_, rw_mode_, select_);
+    if (OB_FAIL(rc)) {
+      LOG_TRACE("failed to visit chunk. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  if (!predicates_.empty()) {
+    rc = record_page_handler_->reference_columns(filter_chunk_);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to reference columns for filter. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    for (Expression *predicate : predicates_) {
+      rc = predicate->eval(filter_chunk_, select_);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to eval predicate. rc=%s", strrc(rc));
+        return rc;
+      }
+    }
+  }
+  return rc;
+}
+
+RC ChunkFileScanner::next_chunk(Chunk &chunk)
+{
+  RC rc = init_page_chunks(chunk);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
 
   while (bp_iterator_.has_next()) {
     PageNum page_num = bp_iterator_.next();
@@ -906,15 +1193,31 @@ RC ChunkFileScanner::next_chunk(Chunk &chunk)
       LOG_WARN("failed to init record page handler. page_num=%d, rc=%s", page_num, strrc(rc));
       return rc;
     }
-    rc = record_page_handler_->get_chunk(chunk);
-    if (rc == RC::SUCCESS) {
+
+    // 先只看事务字段和过滤条件用到的列，确定需要的记录后再复制数据
+    if (record_page_handler_->select_slots(select_) == 0) {
+      continue;
+    }
+
+    rc = filter_page();
+    if (OB_FAIL(rc)) {
       return rc;
-    } else if (rc == RC::RECORD_EOF) {
-      break;
-    } else {
+    }
+
+    if (none_of(select_.begin(), select_.end(), [](uint8_t selected) { return selected != 0; })) {
+      continue;
+    }
+
+    rc = record_page_handler_->get_chunk(page_chunk_, select_);
+    if (OB_FAIL(rc)) {
       LOG_WARN("failed to get chunk from page. page_num=%d, rc=%s", page_num, strrc(rc));
       return rc;
     }
+
+    for (int i = 0; i < chunk.column_num(); i++) {
+      chunk.column(i).reference(page_chunk_.column(i));
+    }
+    return RC::SUCCESS;
   }
 
   record_page_handler_->cleanup();
@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/lang/bitmap.h"
 #include "common/lang/sstream.h"
+#include "common/lang/unordered_set.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/common/chunk.h"
 #include "storage/record/record.h"
@@ -28,6 +29,7 @@ class RecordPageHandler;
 class LogHandler;
 class Trx;
 class Table;
+class Expression;
 
 /**
  * @brief 这里负责管理在一个文件上表记录(行)的组织/管理
@@ -218,6 +220,30 @@ public:
    */
   virtual RC get_chunk(Chunk &chunk) { return RC::UNIMPLEMENTED; }
 
+  /**
+   * @brief 获取页面中被选中的记录的指定列
+   *
+   * @param chunk  由 chunk.column(i).col_id() 指定列。
+   * @param select 按槽位标记的选择向量，长度为 record_capacity，非0表示需要输出这个槽位上的记录
+   * 只需由 PaxRecordPageHandler 实现。
+   */
+  virtual RC get_chunk(Chunk &chunk, const vector<uint8_t> &select) { return RC::UNIMPLEMENTED; }
+
+  /**
+   * @brief 让 chunk 中的列直接引用页面上整列的数据，不做任何复制
+   * @details 每一列包含 record_capacity 个槽位，其中也包括没有被使用的槽位，需要结合 select_slots 使用。
+   * 只需由 PaxRecordPageHandler 实现。
+   */
+  virtual RC reference_columns(Chunk &chunk) { return RC::UNIMPLEMENTED; }
+
+  /**
+   * @brief 按照页面的 bitmap 生成选择向量，有记录的槽位为1，否则为0
+   *
+   * @param select 输出的选择向量，长度为 record_capacity
+   * @return 有效记录的个数
+   */
+  int select_slots(vector<uint8_t> &select) const;
+
   /**
    * @brief 返回该记录页的页号
    */
@@ -324,8 +350,12 @@ public:
    */
   virtual RC insert_record(const char *data, RID *rid) override;
 
+  virtual RC recover_insert_record(const char *data, const RID &rid) override;
+
   virtual RC delete_record(const RID *rid) override;
 
+  virtual RC update_record(const RID &rid, const char *data) override;
+
   /**
    * @brief 获取指定位置的记录数据
    *
@@ -339,10 +369,27 @@ public:
    * @brief 以 Chunk 格式获取整个页面中指定列的所有记录。
    *
    * @param chunk 由 chunk.column(i).col_id() 指定列。
+   * @details 如果页面上没有被删除的空洞，chunk 中的列会直接引用页面内存，调用者需要保证使用期间页面
+   * 不会被释放（与 RowRecordPageHandler::get_record 相同）；否则会按列把有效数据复制到 chunk 中。
    */
   virtual RC get_chunk(Chunk &chunk) override;
 
+  /**
+   * @brief 以 Chunk 格式获取页面中被选中的记录
+   * @details 如果被选中的记录恰好是从0号槽位开始的连续区间，chunk 中的列会直接引用页面内存；
+   * 否则按连续区间整段复制到 chunk 中。
+   */
+  virtual RC get_chunk(Chunk &chunk, const vector<uint8_t> &select) override;
+
+  virtual RC reference_columns(Chunk &chunk) override;
+
 private:
+  // check whether the column `col_id` of the page matches the `column`
+  RC check_column(int col_id, const Column &column);
+
+  // split the record `data` into columns and write them to the slot `slot_num`
+  void set_record_fields(SlotNum slot_num, const char *data);
+
   // get the field data by `slot_num` and `column id`
   char *get_field_data(SlotNum slot_num, int col_id);
 
@@ -491,8 +538,18 @@ public:
   ChunkFileScanner() = default;
   ~ChunkFileScanner();
 
-  // TODO: not support filter and transaction
-  RC open_scan_chunk(Table *table, DiskBufferPool &buffer_pool, LogHandler &log_handler, ReadWriteMode mode);
+  /**
+   * @brief 打开一个按页面批量读取的扫描器
+   *
+   * @param table       遍历的哪张表。chunk 中的列编号是用户字段的 field_id，不包含事务字段
+   * @param buffer_pool 访问的文件
+   * @param trx         当前事务。为空时不检查可见性
+   * @param log_handler 日志处理器
+   * @param mode        扫描出来的数据是否会被修改
+   * @param predicates  下推的过滤条件，会在复制数据之前按页面整列计算。表达式的生命周期由调用者保证
+   */
+  RC open_scan_chunk(Table *table, DiskBufferPool &buffer_pool, Trx *trx, LogHandler &log_handler,
+      ReadWriteMode mode, const vector<Expression *> &predicates = {});
 
   /**
    * @brief 关闭一个文件扫描，释放相应的资源
@@ -500,12 +557,19 @@ public:
   RC close_scan();
 
   /**
-   * @brief 每次调用获取一个页面中的所有记录。
+   * @brief 每次调用获取一个页面中对当前事务可见并且满足过滤条件的记录。
+   * @details 没有任何记录被选中的页面会被跳过。返回的列可能直接引用页面内存，在下次调用 next_chunk
+   * 或 close_scan 之前有效。
    */
   RC next_chunk(Chunk &chunk);
 
+private:
+  RC init_page_chunks(Chunk &chunk);
+  RC filter_page();
+
 private:
   Table *table_ = nullptr;  ///< 当前遍历的是哪张表。
+  Trx   *trx_   = nullptr;  ///< 当前是哪个事务在遍历
 
   DiskBufferPool *disk_buffer_pool_ = nullptr;  ///< 当前访问的文件
   LogHandler     *log_handler_      = nullptr;
@@ -513,4 +577,10 @@ private:
 
   BufferPoolIterator bp_iterator_;                    ///< 遍历buffer pool的所有页面
   RecordPageHandler *record_page_handler_ = nullptr;  ///< 处理文件某页面的记录
+
+  vector<Expression *> predicates_;    ///< 下推的过滤条件
+  vector<uint8_t>      select_;        ///< 当前页面的选择向量，按槽位编号
+  Chunk                trx_chunk_;     ///< 引用页面上的事务字段，用于判断可见性
+  Chunk                filter_chunk_;  ///< 按 field_id 引用页面上的用户字段，用于计算过滤条件
+  Chunk                page_chunk_;    ///< 与调用者的 chunk 对应，列编号是页面上的列编号
 };
@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 #include <string.h>
 
 #include "common/defs.h"
+#include "common/conf/ini.h"
 #include "common/lang/string.h"
 #include "common/lang/span.h"
 #include "common/lang/algorithm.h"
@@ -157,20 +158,24 @@ RC Table::open(Db *db, const char *meta_file, const char *base_dir)
 
   const int index_num = table_meta_.index_num();
   for (int i = 0; i < index_num; i++) {
-    const IndexMeta *index_meta = table_meta_.index(i);
-    const FieldMeta *field_meta = table_meta_.field(index_meta->field());
-    if (field_meta == nullptr) {
-      LOG_ERROR("Found invalid index meta info which has a non-exists field. table=%s, index=%s, field=%s",
-                name(), index_meta->name(), index_meta->field());
-      // skip cleanup
-      //  do all cleanup action in destructive Table function
-      return RC::INTERNAL;
+    const IndexMeta  *index_meta = table_meta_.index(i);
+    vector<FieldMeta> field_metas;
+    for (const string &field_name : index_meta->fields()) {
+      const FieldMeta *field_meta = table_meta_.field(field_name.c_str());
+      if (field_meta == nullptr) {
+        LOG_ERROR("Found invalid index meta info which has a non-exists field. table=%s, index=%s, field=%s",
+                  name(), index_meta->name(), field_name.c_str());
+        // skip cleanup
+        //  do all cleanup action in destructive Table function
+        return RC::INTERNAL;
+      }
+      field_metas.push_back(*field_meta);
     }
 
     BplusTreeIndex *index      = new BplusTreeIndex();
     string          index_file = table_index_file(base_dir, name(), index_meta->name());
 
-    rc = index->open(this, index_file.c_str(), *index_meta, *field_meta);
+    rc = index->open(this, index_file.c_str(), *index_meta, field_metas);
     if (rc != RC::SUCCESS) {
       delete index;
       LOG_ERROR("Failed to open index. table=%s, index=%s, file=%s, rc=%s",
@@ -406,43 +411,50 @@ RC Table::get_record_scanner(RecordFileScanner &scanner, Trx *trx, ReadWriteMode
   return rc;
 }
 
-RC Table::get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode)
+RC Table::get_chunk_scanner(
+    ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode, const vector<Expression *> &predicates)
 {
-  RC rc = scanner.open_scan_chunk(this, *data_buffer_pool_, db_->log_handler(), mode);
+  RC rc = scanner.open_scan_chunk(this, *data_buffer_pool_, trx, db_->log_handler(), mode, predicates);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("failed to open scanner. rc=%s", strrc(rc));
   }
   return rc;
 }
 
-RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name, const IndexMeta::IndexType &index_type)
+RC Table::create_index(
+    Trx *trx, const vector<const FieldMeta *> &field_metas, const char *index_name, const IndexMeta::IndexType &index_type)
 {
-    if (common::is_blank(index_name) || nullptr == field_meta) {
+    if (common::is_blank(index_name) || field_metas.empty()) {
     LOG_INFO("Invalid input arguments, table name is %s, index_name is blank or attribute_name is blank", name());
     return RC::INVALID_ARGUMENT;
   }
 
   IndexMeta new_index_meta;
 
-  RC rc = new_index_meta.init(index_name, *field_meta, index_type);
+  RC rc = new_index_meta.init(index_name, field_metas, index_type);
   if (rc != RC::SUCCESS) {
     LOG_INFO("Failed to init IndexMeta in table:%s, index_name:%s, field_name:%s", 
-             name(), index_name, field_meta->name());
+             name(), index_name, field_metas[0]->name());
     return rc;
   }
 
+  vector<FieldMeta> index_field_metas;
+  for (const FieldMeta *field_meta : field_metas) {
+    index_field_metas.push_back(*field_meta);
+  }
+
   // 创建索引相关数据
   BplusTreeIndex *index      = new BplusTreeIndex();
   string          index_file = table_index_file(base_dir_.c_str(), name(), index_name);
 
-  rc = index->create(this, index_file.c_str(), new_index_meta, *field_meta);
+  rc = index->create(this, index_file.c_str(), new_index_meta, index_field_metas);
   if (rc != RC::SUCCESS) {
     delete index;
     LOG_ERROR("Failed to create bplus tree index. file name=%s, rc=%d:%s", index_file.c_str(), rc, strrc(rc));
     return rc;
   }
 
-  // 遍历当前的所有数据，插入这个索引
+  // 遍历当前的所有数据，排好序后批量构建这个索引
   RecordFileScanner scanner;
   rc = get_record_scanner(scanner, trx, ReadWriteMode::READ_ONLY);
   if (rc != RC::SUCCESS) {
@@ -451,26 +463,30 @@ RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_
     return rc;
   }
 
-  Record record;
-  while (OB_SUCC(rc = scanner.next(record))) {
-    if (field_meta->check_null_marker(record.data())) { // don't insert null value into index
-      continue;
-    }
-    rc = index->insert_entry(record.data(), &record.rid());
-    if (rc != RC::SUCCESS) {
-      LOG_WARN("failed to insert record into index while creating index. table=%s, index=%s, rc=%s",
-               name(), index_name, strrc(rc));
-      return rc;
-    }
+  const string section         = "INDEX";
+  const string sort_memory_str = common::get_properties()->get("BULK_LOAD_SORT_MEMORY", "64M", section);
+  const int    fill_factor     = atoi(common::get_properties()->get("BULK_LOAD_FILL_FACTOR", "90", section).c_str());
+  int64_t      sort_memory     = 0;
+  if (!common::str_to_bytes(sort_memory_str, sort_memory) || sort_memory <= 0) {
+    LOG_WARN("invalid index bulk load sort memory: %s, use 64M", sort_memory_str.c_str());
+    sort_memory = 64 * 1024 * 1024;
   }
-  if (RC::RECORD_EOF == rc) {
-    rc = RC::SUCCESS;
-  } else {
-    LOG_WARN("failed to insert record into index while creating index. table=%s, index=%s, rc=%s",
+
+  auto record_reader = [&scanner](Record &record) { return scanner.next(record); };
+  rc = index->bulk_load(record_reader, sort_memory, fill_factor);
+  scanner.close_scan();
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to insert records into index while creating index. table=%s, index=%s, rc=%s",
              name(), index_name, strrc(rc));
+    // 关闭索引文件，否则这个文件的页面会一直留在缓冲池中
+    delete index;
+    db_->buffer_pool_manager().close_file(index_file.c_str());
+    // 删除索引文件，比如唯一索引遇到重复的数据，去掉重复数据以后还可以再创建同名的索引
+    if (remove(index_file.c_str()) != 0) {
+      LOG_WARN("failed to remove index file. file=%s, errno=%d:%s", index_file.c_str(), errno, strerror(errno));
+    }
     return rc;
   }
-  scanner.close_scan();
   LOG_INFO("inserted all records into new index. table=%s, index=%s", name(), index_name);
 
   indexes_.push_back(index);
@@ -532,7 +548,7 @@ RC Table::delete_record(const Record &record)
 {
   RC rc = RC::SUCCESS;
   for (Index *index : indexes_) {
-    if (table_meta_.field(index->index_meta().field())->check_null_marker(record.data())) {
+    if (index->has_null_field(record.data())) {
       // didn't insert null value into index, so we don't need to delete it
       continue;
     }
@@ -549,7 +565,7 @@ RC Table::insert_entry_of_indexes(const char *record, const RID &rid)
 {
   RC rc = RC::SUCCESS;
   for (Index *index : indexes_) {
-    if (table_meta_.field(index->index_meta().field())->check_null_marker(record)) {
+    if (index->has_null_field(record)) {
       // don't insert null value into index
       continue;
     }
@@ -565,15 +581,17 @@ RC Table::delete_entry_of_indexes(const char *record, const RID &rid, bool error
 {
   RC rc = RC::SUCCESS;
   for (Index *index : indexes_) {
-    if (table_meta_.field(index->index_meta().field())->check_null_marker(record)) {
+    if (index->has_null_field(record)) {
       // didn't insert null value into index, so we don't need to delete it
       continue;
     }
     rc = index->delete_entry(record, &rid);
     if (rc != RC::SUCCESS) {
-      if (rc != RC::RECORD_INVALID_KEY || !error_on_not_exists) {
+      // 插入索引失败时回滚，冲突的索引以及后面的索引都没有插入这条记录
+      if (rc != RC::RECORD_NOT_EXIST || error_on_not_exists) {
         break;
       }
+      rc = RC::SUCCESS;
     }
   }
   return rc;
@@ -32,6 +32,7 @@ class IndexScanner;
 class RecordDeleter;
 class Trx;
 class Db;
+class Expression;
 
 /**
  * @brief 表
@@ -84,11 +85,17 @@ public:
   RC recover_insert_record(Record &record);
 
   // TODO refactor
-  RC create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name, const IndexMeta::IndexType &index_type);
+  /**
+   * @brief 创建索引，已有的数据会批量插入到索引中
+   * @param field_metas 索引包含的字段，多个字段时是组合索引
+   */
+  RC create_index(
+      Trx *trx, const vector<const FieldMeta *> &field_metas, const char *index_name, const IndexMeta::IndexType &index_type);
 
   RC get_record_scanner(RecordFileScanner &scanner, Trx *trx, ReadWriteMode mode);
 
-  RC get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode);
+  RC get_chunk_scanner(
+      ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode, const vector<Expression *> &predicates = {});
 
   RecordFileHandler *record_handler() const { return record_handler_; }
 
@@ -123,6 +130,8 @@ public:
   Index *find_index(const char *index_name) const;
   Index *find_index_by_field(const char *field_name) const;
 
+  const vector<Index *> &indexes() const { return indexes_; }
+
 private:
   Db                *db_ = nullptr;
   string             base_dir_;
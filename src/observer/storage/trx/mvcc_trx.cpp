@@ -63,14 +63,52 @@ Trx *MvccTrxKit::create_trx(LogHandler &log_handler, int32_t trx_id)
   if (trx != nullptr) {
     lock_.lock();
     trxes_.push_back(trx);
-    if (current_trx_id_ < trx_id) {
-      current_trx_id_ = trx_id;
-    }
     lock_.unlock();
+    recover_trx_id(trx_id);
   }
   return trx;
 }
 
+void MvccTrxKit::recover_trx_id(int32_t trx_id)
+{
+  int32_t current = current_trx_id_.load();
+  while (current < trx_id && !current_trx_id_.compare_exchange_weak(current, trx_id)) {
+  }
+}
+
+RC MvccTrxKit::check_unique_conflict(Table *table, const char *record, const char *existing_record) const
+{
+  span<const FieldMeta> trx_fields = table->table_meta().trx_fields();
+  ASSERT(trx_fields.size() >= 2, "invalid trx fields number. %d", trx_fields.size());
+
+  auto get_xid = [](const char *data, const FieldMeta &field) {
+    int32_t xid = 0;
+    memcpy(&xid, data + field.offset(), sizeof(xid));
+    return xid;
+  };
+
+  // 新插入的记录还没有提交，begin xid 是 -trx_id
+  const int32_t trx_id    = -get_xid(record, trx_fields[0]);
+  const int32_t begin_xid = get_xid(existing_record, trx_fields[0]);
+  const int32_t end_xid   = get_xid(existing_record, trx_fields[1]);
+
+  if (end_xid < 0) {
+    // 正在被删除。当前事务删除的不算冲突，比如更新时先删除再插入；其它事务删除的可能会回滚
+    return (-end_xid == trx_id) ? RC::SUCCESS : RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+
+  if (end_xid != max_trx_id()) {
+    // 已经删除并提交了。在当前事务开始之后才提交的删除，当前事务还能看到这条记录
+    return (trx_id > end_xid) ? RC::SUCCESS : RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+
+  if (begin_xid < 0 && -begin_xid != trx_id) {
+    // 其它事务插入了还没有提交
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+  return RC::UNIQUE_INDEX_EXIST;
+}
+
 void MvccTrxKit::destroy_trx(Trx *trx)
 {
   lock_.lock();
@@ -111,6 +149,20 @@ LogReplayer *MvccTrxKit::create_log_replayer(Db &db, LogHandler &log_handler)
   return new MvccTrxLogReplayer(db, *this, log_handler);
 }
 
+LSN MvccTrxKit::oldest_trx_lsn()
+{
+  LSN oldest_lsn = 0;
+  lock_.lock();
+  for (Trx *trx : trxes_) {
+    LSN first_lsn = static_cast<MvccTrx *>(trx)->first_lsn();
+    if (first_lsn > 0 && (oldest_lsn == 0 || first_lsn < oldest_lsn)) {
+      oldest_lsn = first_lsn;
+    }
+  }
+  lock_.unlock();
+  return oldest_lsn;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 MvccTrx::MvccTrx(MvccTrxKit &kit, LogHandler &log_handler) : trx_kit_(kit), log_handler_(log_handler)
@@ -140,9 +192,13 @@ RC MvccTrx::insert_record(Table *table, Record &record)
     return rc;
   }
 
-  rc = log_handler_.insert_record(trx_id_, table, record.rid());
+  LSN lsn = 0;
+  rc = log_handler_.insert_record(trx_id_, table, record.rid(), lsn);
   ASSERT(rc == RC::SUCCESS, "failed to append insert record log. trx id=%d, table id=%d, rid=%s, record len=%d, rc=%s",
          trx_id_, table->table_id(), record.rid().to_string().c_str(), record.len(), strrc(rc));
+  if (first_lsn_.load() == 0) {
+    first_lsn_.store(lsn);
+  }
 
   operations_.push_back(Operation(Operation::Type::INSERT, table, record.rid()));
   return rc;
@@ -177,9 +233,13 @@ RC MvccTrx::delete_record(Table *table, Record &record)
     return delete_result;
   }
 
-  rc = log_handler_.delete_record(trx_id_, table, record.rid());
+  LSN lsn = 0;
+  rc = log_handler_.delete_record(trx_id_, table, record.rid(), lsn);
   ASSERT(rc == RC::SUCCESS, "failed to append delete record log. trx id=%d, table id=%d, rid=%s, record len=%d, rc=%s",
       trx_id_, table->table_id(), record.rid().to_string().c_str(), record.len(), strrc(rc));
+  if (first_lsn_.load() == 0) {
+    first_lsn_.store(lsn);
+  }
 
   operations_.push_back(Operation(Operation::Type::DELETE, table, record.rid()));
 
@@ -208,50 +268,73 @@ RC MvccTrx::visit_record(Table *table, Record &record, ReadWriteMode mode)
   int32_t begin_xid = begin_field.get_int(record);
   int32_t end_xid   = end_field.get_int(record);
 
-  RC rc = RC::SUCCESS;
-  if (begin_xid > 0 && end_xid > 0) {
-    if (trx_id_ >= begin_xid && trx_id_ <= end_xid) {
-      rc = RC::SUCCESS;
-    } else {
-      LOG_TRACE("record invisible. trx id=%d, begin xid=%d, end xid=%d", trx_id_, begin_xid, end_xid);
-      rc = RC::RECORD_INVISIBLE;
+  RC rc = check_visibility(begin_xid, end_xid, mode);
+  if (rc != RC::SUCCESS) {
+    LOG_TRACE("record invisible or conflict. trx id=%d, begin xid=%d, end xid=%d, rc=%s",
+              trx_id_, begin_xid, end_xid, strrc(rc));
+  }
+  return rc;
+}
+
+RC MvccTrx::visit_chunk(Table *table, Chunk &trx_chunk, ReadWriteMode mode, vector<uint8_t> &select)
+{
+  ASSERT(trx_chunk.column_num() >= 2, "invalid trx column number. %d", trx_chunk.column_num());
+
+  const Column &begin_column = trx_chunk.column(0);
+  const Column &end_column   = trx_chunk.column(1);
+  ASSERT(begin_column.attr_len() == sizeof(int32_t) && end_column.attr_len() == sizeof(int32_t),
+         "invalid trx column length");
+
+  const int32_t *begin_xids = reinterpret_cast<const int32_t *>(begin_column.data());
+  const int32_t *end_xids   = reinterpret_cast<const int32_t *>(end_column.data());
+  const int      count      = min(static_cast<int>(select.size()), begin_column.count());
+  for (int i = 0; i < count; i++) {
+    if (select[i] == 0) {
+      continue;
     }
-  } else if (begin_xid < 0) {
-    // begin xid 小于0说明是刚插入而且没有提交的数据
-    if (-begin_xid == trx_id_) {
-      rc = RC::SUCCESS;
-    } else {
-      LOG_TRACE("record invisible. someone is updating this record right now. trx id=%d, begin xid=%d, end xid=%d",
-                trx_id_, begin_xid, end_xid);
-      rc = RC::RECORD_INVISIBLE;
+
+    RC rc = check_visibility(begin_xids[i], end_xids[i], mode);
+    if (rc == RC::RECORD_INVISIBLE) {
+      select[i] = 0;
+    } else if (OB_FAIL(rc)) {
+      LOG_TRACE("concurrency conflict while visiting chunk. trx id=%d, begin xid=%d, end xid=%d, rc=%s",
+                trx_id_, begin_xids[i], end_xids[i], strrc(rc));
+      return rc;
     }
-  } else if (end_xid < 0) {
+  }
+  return RC::SUCCESS;
+}
+
+/**
+ * @brief 根据记录上的事务字段判断可见性
+ * @return RC - SUCCESS 可见
+ *            - RECORD_INVISIBLE 不可见
+ *            - LOCKED_CONCURRENCY_CONFLICT 与其它事务有冲突
+ */
+RC MvccTrx::check_visibility(int32_t begin_xid, int32_t end_xid, ReadWriteMode mode) const
+{
+  if (begin_xid > 0 && end_xid > 0) {
+    return (trx_id_ >= begin_xid && trx_id_ <= end_xid) ? RC::SUCCESS : RC::RECORD_INVISIBLE;
+  }
+
+  if (begin_xid < 0) {
+    // begin xid 小于0说明是刚插入而且没有提交的数据
+    return (-begin_xid == trx_id_) ? RC::SUCCESS : RC::RECORD_INVISIBLE;
+  }
+
+  if (end_xid < 0) {
     // end xid 小于0 说明是正在删除但是还没有提交的数据
-    if (mode == ReadWriteMode::READ_ONLY) {
-      // 如果 -end_xid 就是当前事务的事务号，说明是当前事务删除的
-      if (-end_xid != trx_id_) {
-        rc = RC::SUCCESS;
-      } else {
-        LOG_TRACE("record invisible. self has deleted this record. trx id=%d, begin xid=%d, end xid=%d",
-                  trx_id_, begin_xid, end_xid);
-        rc = RC::RECORD_INVISIBLE;
-      }
-    } else {
-      // 如果当前想要修改此条数据，并且不是当前事务删除的，简单的报错
-      // 这是事务并发处理的一种方式，非常简单粗暴。其它的并发处理方法，可以等待，或者让客户端重试
-      // 或者等事务结束后，再检测修改的数据是否有冲突
-      if (-end_xid != trx_id_) {
-        LOG_TRACE("concurrency conflit. someone is deleting this record right now. trx id=%d, begin xid=%d, end xid=%d",
-                  trx_id_, begin_xid, end_xid);
-        rc = RC::LOCKED_CONCURRENCY_CONFLICT;
-      } else {
-        LOG_TRACE("record invisible. self has deleted this record. trx id=%d, begin xid=%d, end xid=%d",
-                  trx_id_, begin_xid, end_xid);
-        rc = RC::RECORD_INVISIBLE;
-      }
+    // 如果 -end_xid 就是当前事务的事务号，说明是当前事务删除的
+    if (-end_xid == trx_id_) {
+      return RC::RECORD_INVISIBLE;
     }
+
+    // 如果当前想要修改此条数据，并且不是当前事务删除的，简单的报错
+    // 这是事务并发处理的一种方式，非常简单粗暴。其它的并发处理方法，可以等待，或者让客户端重试
+    // 或者等事务结束后，再检测修改的数据是否有冲突
+    return (mode == ReadWriteMode::READ_ONLY) ? RC::SUCCESS : RC::LOCKED_CONCURRENCY_CONFLICT;
   }
-  return rc;
+  return RC::SUCCESS;
 }
 
 /**
@@ -353,6 +436,7 @@ RC MvccTrx::commit_with_trx_id(int32_t commit_xid)
   }
 
   operations_.clear();
+  first_lsn_.store(0);
 
   LOG_TRACE("append trx commit log. trx id=%d, commit_xid=%d, rc=%s", trx_id_, commit_xid, strrc(rc));
   return rc;
@@ -384,7 +468,7 @@ RC MvccTrx::rollback()
           } else if (RC::RECORD_NOT_EXIST == rc) {
             continue;
           } else {
-            LOG_WARN("failed to get record while rollback. table=%s, rid=%s, rc=%s", 
+            LOG_WARN("failed to get record while rollback. table=%s, rid=%s, rc=%s",
                      table->name(), rid.to_string().c_str(), strrc(rc));
             return rc;
           }
@@ -432,6 +516,7 @@ RC MvccTrx::rollback()
   if (!recovering_) {
     rc = log_handler_.rollback(trx_id_);
   }
+  first_lsn_.store(0);
   LOG_TRACE("append trx rollback log. trx id=%d, rc=%s", trx_id_, strrc(rc));
   return rc;
 }
@@ -477,9 +562,10 @@ RC MvccTrx::redo(Db *db, const LogEntry &log_entry)
     } break;
 
     case MvccTrxLogOperation::Type::COMMIT: {
-      // auto *trx_log_record = reinterpret_cast<const MvccTrxCommitLogEntry *>(log_entry.data());
-      // commit_with_trx_id(trx_log_record->commit_trx_id);
       // 遇到了提交日志，说明前面的记录都已经提交成功了
+      // 提交事务号也分配过了，记录上可能已经写了这个事务号
+      auto *trx_log_record = reinterpret_cast<const MvccTrxCommitLogEntry *>(log_entry.data());
+      trx_kit_.recover_trx_id(trx_log_record->commit_trx_id);
     } break;
 
     case MvccTrxLogOperation::Type::ROLLBACK: {
@@ -44,6 +44,17 @@ public:
 
   LogReplayer *create_log_replayer(Db &db, LogHandler &log_handler) override;
 
+  LSN oldest_trx_lsn() override;
+
+  int32_t current_trx_id() const override { return current_trx_id_.load(); }
+  void    recover_trx_id(int32_t trx_id) override;
+
+  /**
+   * @details 根据已有记录上的事务字段判断。已经删除并且提交的记录，如果对插入的事务仍然可见也算冲突，
+   * 这样一个事务看到的同一个键值最多只有一条记录
+   */
+  RC check_unique_conflict(Table *table, const char *record, const char *existing_record) const override;
+
 public:
   int32_t next_trx_id();
 
@@ -100,6 +111,11 @@ public:
    */
   RC visit_record(Table *table, Record &record, ReadWriteMode mode) override;
 
+  /**
+   * @brief 批量判断可见性。与 visit_record 不同，这里直接读取事务字段所在的列，不需要逐条组装记录
+   */
+  RC visit_chunk(Table *table, Chunk &trx_chunk, ReadWriteMode mode, vector<uint8_t> &select) override;
+
   RC start_if_need() override;
   RC commit() override;
   RC rollback() override;
@@ -108,8 +124,12 @@ public:
 
   int32_t id() const override { return trx_id_; }
 
+  /// @brief 当前事务第一条日志的LSN，还没有写日志时是0
+  LSN first_lsn() const { return first_lsn_.load(); }
+
 private:
   RC   commit_with_trx_id(int32_t commit_id);
+  RC   check_visibility(int32_t begin_xid, int32_t end_xid, ReadWriteMode mode) const;
   void trx_fields(Table *table, Field &begin_xid_field, Field &end_xid_field) const;
 
 private:
@@ -125,4 +145,5 @@ private:
   bool              started_    = false;
   bool              recovering_ = false;
   OperationSet      operations_;
+  atomic<LSN>       first_lsn_{0};  ///< 检查点线程会读取
 };
@@ -68,7 +68,7 @@ MvccTrxLogHandler::MvccTrxLogHandler(LogHandler &log_handler) : log_handler_(log
 
 MvccTrxLogHandler::~MvccTrxLogHandler() {}
 
-RC MvccTrxLogHandler::insert_record(int32_t trx_id, Table *table, const RID &rid)
+RC MvccTrxLogHandler::insert_record(int32_t trx_id, Table *table, const RID &rid, LSN &lsn)
 {
   ASSERT(trx_id > 0, "invalid trx_id:%d", trx_id);
 
@@ -78,12 +78,11 @@ RC MvccTrxLogHandler::insert_record(int32_t trx_id, Table *table, const RID &rid
   log_entry.table_id              = table->table_id();
   log_entry.rid                   = rid;
 
-  LSN lsn = 0;
   return log_handler_.append(
       lsn, LogModule::Id::TRANSACTION, span<const char>(reinterpret_cast<const char *>(&log_entry), sizeof(log_entry)));
 }
 
-RC MvccTrxLogHandler::delete_record(int32_t trx_id, Table *table, const RID &rid)
+RC MvccTrxLogHandler::delete_record(int32_t trx_id, Table *table, const RID &rid, LSN &lsn)
 {
   ASSERT(trx_id > 0, "invalid trx_id:%d", trx_id);
 
@@ -93,7 +92,6 @@ RC MvccTrxLogHandler::delete_record(int32_t trx_id, Table *table, const RID &rid
   log_entry.table_id              = table->table_id();
   log_entry.rid                   = rid;
 
-  LSN lsn = 0;
   return log_handler_.append(
       lsn, LogModule::Id::TRANSACTION, span<const char>(reinterpret_cast<const char *>(&log_entry), sizeof(log_entry)));
 }
@@ -129,6 +129,35 @@ public:
 
   virtual LogReplayer *create_log_replayer(Db &db, LogHandler &log_handler) = 0;
 
+  /**
+   * @brief 所有活跃事务中最早的一条事务日志的LSN
+   * @details 检查点不能超过这个LSN，否则恢复时会缺少这个事务前面的操作，无法提交或回滚。
+   * 没有活跃事务写过日志时返回0。
+   */
+  virtual LSN oldest_trx_lsn() = 0;
+
+  /**
+   * @brief 已经分配出去的最大事务号
+   * @details 检查点时记录到数据库元数据中。检查点之前的日志会被删除，恢复时只靠重放日志无法知道用过的事务号。
+   */
+  virtual int32_t current_trx_id() const = 0;
+
+  /**
+   * @brief 恢复时告诉事务管理器这个事务号已经用过了，后面分配的事务号都比它大
+   */
+  virtual void recover_trx_id(int32_t trx_id) = 0;
+
+  /**
+   * @brief 唯一索引插入时，判断索引中属性值相同的一条已有记录是否与新插入的记录冲突
+   * @details 记录被删除以后索引项不一定马上删除，比如MVCC只是在记录上标记删除，这样的记录不算冲突
+   * @param table 记录所在的表
+   * @param record 新插入的记录
+   * @param existing_record 索引中属性值相同的已有记录
+   * @return RC::SUCCESS 不冲突；RC::UNIQUE_INDEX_EXIST 已有记录仍然有效；
+   * RC::LOCKED_CONCURRENCY_CONFLICT 已有记录正在被其它事务修改
+   */
+  virtual RC check_unique_conflict(Table *table, const char *record, const char *existing_record) const = 0;
+
 public:
   static TrxKit *create(const char *name);
 };
@@ -147,6 +176,16 @@ public:
   virtual RC delete_record(Table *table, Record &record)                    = 0;
   virtual RC visit_record(Table *table, Record &record, ReadWriteMode mode) = 0;
 
+  /**
+   * @brief 批量判断一批记录的可见性，规则与 visit_record 相同
+   *
+   * @param table     要访问的数据属于哪张表
+   * @param trx_chunk 这批记录的事务字段，列的顺序与 TableMeta::trx_fields 相同
+   * @param mode      是否只读访问
+   * @param select    输入时非0表示需要判断的记录，对当前事务不可见的记录会被置为0
+   */
+  virtual RC visit_chunk(Table *table, Chunk &trx_chunk, ReadWriteMode mode, vector<uint8_t> &select) = 0;
+
   virtual RC update_record(Table *table, Record &old_record, Record &new_record) = 0;
   virtual RC update_record(Table *table, Record &record, Value *values, FieldMeta *field_meta)     = 0;
 
@@ -38,6 +38,8 @@ RC VacuousTrx::delete_record(Table *table, Record &record) { return table->delet
 
 RC VacuousTrx::visit_record(Table *table, Record &record, ReadWriteMode) { return RC::SUCCESS; }
 
+RC VacuousTrx::visit_chunk(Table *, Chunk &, ReadWriteMode, vector<uint8_t> &) { return RC::SUCCESS; }
+
 RC VacuousTrx::update_record(Table *table, Record &old_record, Record &new_record) {
   RC rc = table->delete_record(old_record);
   if (rc != RC::SUCCESS) {
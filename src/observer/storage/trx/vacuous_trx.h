@@ -36,6 +36,17 @@ public:
   void destroy_trx(Trx *trx) override;
 
   LogReplayer *create_log_replayer(Db &db, LogHandler &log_handler) override;
+
+  LSN oldest_trx_lsn() override { return 0; }
+
+  int32_t current_trx_id() const override { return 0; }
+  void    recover_trx_id(int32_t /*trx_id*/) override {}
+
+  /// 删除记录时会同时删除索引项，索引中的记录都是有效的
+  RC check_unique_conflict(Table * /*table*/, const char * /*record*/, const char * /*existing_record*/) const override
+  {
+    return RC::UNIQUE_INDEX_EXIST;
+  }
 };
 
 class VacuousTrx : public Trx
@@ -47,6 +58,7 @@ public:
   RC insert_record(Table *table, Record &record) override;
   RC delete_record(Table *table, Record &record) override;
   RC visit_record(Table *table, Record &record, ReadWriteMode mode) override;
+  RC visit_chunk(Table *table, Chunk &trx_chunk, ReadWriteMode mode, vector<uint8_t> &select) override;
 
   /**
    * @details 用新记录替换旧记录
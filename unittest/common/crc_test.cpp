@@ -0,0 +1,64 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include "common/lang/random.h"
+#include "common/lang/vector.h"
+#include "common/math/crc.h"
+#include "gtest/gtest.h"
+
+TEST(crc32c, known_values)
+{
+  // RFC 3720 B.4 中的测试数据
+  char buffer[32];
+  memset(buffer, 0, sizeof(buffer));
+  ASSERT_EQ(0x8A9136AAu, crc32c(buffer, sizeof(buffer)));
+  ASSERT_EQ(0x8A9136AAu, crc32c_software(buffer, sizeof(buffer)));
+
+  memset(buffer, 0xff, sizeof(buffer));
+  ASSERT_EQ(0x62A8AB43u, crc32c(buffer, sizeof(buffer)));
+
+  for (int i = 0; i < 32; i++) {
+    buffer[i] = static_cast<char>(i);
+  }
+  ASSERT_EQ(0x46DD794Eu, crc32c(buffer, sizeof(buffer)));
+
+  const char *text = "123456789";
+  ASSERT_EQ(0xE3069283u, crc32c(text, strlen(text)));
+  ASSERT_EQ(0u, crc32c(text, 0));
+}
+
+TEST(crc32c, hardware_and_software)
+{
+  mt19937      random_engine(1);
+  vector<char> buffer(8192 + 13);
+  for (char &c : buffer) {
+    c = static_cast<char>(random_engine());
+  }
+
+  // 覆盖不同的起始地址和长度，包括不足8个字节的尾巴
+  for (unsigned int offset = 0; offset < 8; offset++) {
+    for (unsigned int size : {0u, 1u, 7u, 8u, 9u, 63u, 4096u, 8181u}) {
+      ASSERT_EQ(crc32c_software(buffer.data() + offset, size), crc32c(buffer.data() + offset, size));
+    }
+  }
+
+  // 分段计算的结果与一次计算相同
+  const unsigned int first = 1000;
+  const unsigned int crc   = crc32c(buffer.data(), first);
+  ASSERT_EQ(crc32c(buffer.data(), 8192), crc32c(buffer.data() + first, 8192 - first, crc));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
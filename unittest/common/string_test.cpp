@@ -0,0 +1,42 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "common/lang/string.h"
+#include "gtest/gtest.h"
+
+using namespace common;
+
+TEST(string, str_to_bytes)
+{
+  int64_t bytes = 0;
+  ASSERT_TRUE(str_to_bytes("4096", bytes));
+  ASSERT_EQ(4096, bytes);
+  ASSERT_TRUE(str_to_bytes(" 16k ", bytes));
+  ASSERT_EQ(16 * 1024, bytes);
+  ASSERT_TRUE(str_to_bytes("512MB", bytes));
+  ASSERT_EQ(512L * 1024 * 1024, bytes);
+  ASSERT_TRUE(str_to_bytes("64G", bytes));
+  ASSERT_EQ(64L * 1024 * 1024 * 1024, bytes);
+  ASSERT_TRUE(str_to_bytes("1T", bytes));
+  ASSERT_EQ(1L << 40, bytes);
+
+  ASSERT_FALSE(str_to_bytes("", bytes));
+  ASSERT_FALSE(str_to_bytes("M", bytes));
+  ASSERT_FALSE(str_to_bytes("-1G", bytes));
+  ASSERT_FALSE(str_to_bytes("1.5G", bytes));
+  ASSERT_FALSE(str_to_bytes("12X", bytes));
+  ASSERT_FALSE(str_to_bytes("99999999999T", bytes));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -12,6 +12,8 @@ See the Mulan PSL v2 for more details. */
 // Created by wangyunlai.wyl on 2021
 //
 
+#include "common/lang/thread.h"
+#include "common/lang/vector.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "gtest/gtest.h"
 
@@ -125,6 +127,107 @@ TEST(test_frame_manager, test_frame_manager_simple_lru)
   frame_manager.cleanup();
 }
 
+TEST(test_frame_manager, test_frame_manager_sharded)
+{
+  BPFrameManager frame_manager("Test");
+  frame_manager.init(2, 4);
+  ASSERT_EQ(4, frame_manager.shard_num());
+
+  test_get(frame_manager);
+
+  // 某个分片的空闲页帧用完后，会从其它分片借用，所以依然可以分配出所有的页帧
+  test_alloc(frame_manager);
+
+  frame_manager.cleanup();
+}
+
+TEST(test_frame_manager, test_frame_manager_replacers)
+{
+  for (FrameReplacerType type : {FrameReplacerType::LRU, FrameReplacerType::LRU_K, FrameReplacerType::TWO_Q}) {
+    BPFrameManager frame_manager("Test");
+    frame_manager.init(2, 2, type);
+    ASSERT_EQ(type, frame_manager.replacer_type());
+
+    test_get(frame_manager);
+    test_alloc(frame_manager);
+
+    frame_manager.cleanup();
+  }
+}
+
+TEST(test_frame_manager, test_page_arena)
+{
+  // 系统不一定配置了大页，这时会退回到透明大页或者普通的内存页
+  for (bool huge_page : {false, true}) {
+    PageArena arena;
+    ASSERT_EQ(RC::SUCCESS, arena.init(100, huge_page));
+    ASSERT_EQ(100, static_cast<int>(arena.page_num()));
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(arena.pages()) % BP_PAGE_ALIGN);
+    if (!huge_page) {
+      ASSERT_EQ(PageArenaMemory::NORMAL, arena.memory_type());
+    }
+
+    memset(arena.pages(), 1, 100 * sizeof(Page));
+    ASSERT_EQ(1, arena.pages()[99].data[BP_PAGE_DATA_SIZE - 1]);
+    ASSERT_NE(RC::SUCCESS, arena.init(100, huge_page));
+  }
+
+  BPFrameManager frame_manager("Test");
+  ASSERT_EQ(RC::SUCCESS, frame_manager.init(2, 0, FrameReplacerType::LRU, true /*huge_page*/));
+  Frame *frame = frame_manager.alloc(0, 1);
+  ASSERT_NE(frame, nullptr);
+  ASSERT_EQ(0, reinterpret_cast<uintptr_t>(&frame->page()) % BP_PAGE_ALIGN);
+  frame->clear_page();
+  ASSERT_EQ(RC::SUCCESS, frame_manager.free(0, 1, frame));
+  frame_manager.cleanup();
+}
+
+TEST(test_frame_manager, test_frame_manager_concurrent_purge)
+{
+  BPFrameManager frame_manager("Test");
+  frame_manager.init(1, 4);
+
+  const int buffer_pool_id = 0;
+  const int page_num_range = static_cast<int>(frame_manager.total_frame_num()) * 4;
+  const int thread_num     = 8;
+  const int loop_num       = 20000;
+
+  auto purger = [](Frame *frame) {
+    EXPECT_EQ(frame->pin_count() >= 1, true);
+    return RC::SUCCESS;
+  };
+
+  auto worker = [&](int index) {
+    for (int i = 0; i < loop_num; i++) {
+      PageNum page_num = (i * 7 + index * 13) % page_num_range;
+      Frame  *frame    = frame_manager.get(buffer_pool_id, page_num);
+      if (frame == nullptr) {
+        frame = frame_manager.alloc(buffer_pool_id, page_num);
+      }
+      if (frame == nullptr) {
+        frame_manager.purge_frames(2, purger);
+        continue;
+      }
+
+      EXPECT_EQ(page_num, frame->page_num());
+      frame->unpin();
+    }
+  };
+
+  vector<thread> threads;
+  for (int i = 0; i < thread_num; i++) {
+    threads.emplace_back(worker, i);
+  }
+  for (thread &t : threads) {
+    t.join();
+  }
+
+  ASSERT_LE(frame_manager.frame_num(), frame_manager.total_frame_num());
+  frame_manager.purge_frames(frame_manager.total_frame_num(), purger);
+  ASSERT_EQ(0, frame_manager.frame_num());
+  ASSERT_EQ(RC::SUCCESS, frame_manager.cleanup());
+}
+
 int main(int argc, char **argv)
 {
 
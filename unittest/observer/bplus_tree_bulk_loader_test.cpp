@@ -0,0 +1,271 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "common/lang/algorithm.h"
+#include "common/lang/filesystem.h"
+#include "common/lang/memory.h"
+#include "common/lang/random.h"
+#include "common/lang/vector.h"
+#include "common/log/log.h"
+#include "storage/buffer/double_write_buffer.h"
+#include "storage/clog/disk_log_handler.h"
+#include "storage/clog/integrated_log_replayer.h"
+#include "storage/clog/vacuous_log_handler.h"
+#include "storage/index/bplus_tree.h"
+#include "storage/index/bplus_tree_bulk_loader.h"
+#include "gtest/gtest.h"
+
+using namespace common;
+
+static vector<int> shuffled_keys(int num)
+{
+  vector<int> keys(num);
+  for (int i = 0; i < num; i++) {
+    keys[i] = i;
+  }
+  mt19937 generator(num);
+  shuffle(keys.begin(), keys.end(), generator);
+  return keys;
+}
+
+static RC list_all_values(BplusTreeHandler &tree_handler, vector<RID> &rids)
+{
+  BplusTreeScanner scanner(tree_handler);
+  RC               rc = scanner.open(nullptr, 0, true, nullptr, 0, true);
+  if (OB_SUCC(rc)) {
+    RID rid;
+    while (OB_SUCC(rc = scanner.next_entry(rid))) {
+      rids.push_back(rid);
+    }
+    if (rc == RC::RECORD_EOF) {
+      rc = scanner.close();
+    }
+  }
+  return rc;
+}
+
+class BplusTreeBulkLoaderTest : public testing::Test
+{
+protected:
+  void SetUp() override { reset_buffer_pool(); }
+
+  void TearDown() override
+  {
+    bpm_.reset();
+    filesystem::remove_all(test_directory_);
+  }
+
+  /// 重新创建一个空的文件
+  void reset_buffer_pool()
+  {
+    bpm_.reset();
+    filesystem::remove_all(test_directory_);
+    filesystem::create_directory(test_directory_);
+
+    bpm_ = make_unique<BufferPoolManager>();
+    ASSERT_EQ(RC::SUCCESS, bpm_->init(make_unique<VacuousDoubleWriteBuffer>()));
+    filesystem::path file_name = test_directory_ / "bulk.btree";
+    ASSERT_EQ(RC::SUCCESS, bpm_->create_file(file_name.c_str()));
+    ASSERT_EQ(RC::SUCCESS, bpm_->open_file(log_handler_, file_name.c_str(), buffer_pool_));
+  }
+
+  /// 批量构建以后检查B+树的结构和所有的数据
+  void check_tree(BplusTreeHandler &handler, int key_num)
+  {
+    ASSERT_TRUE(handler.validate_tree());
+
+    vector<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, list_all_values(handler, rids));
+    ASSERT_EQ(key_num, static_cast<int>(rids.size()));
+    for (int i = 0; i < key_num; i++) {
+      ASSERT_EQ(i, rids[i].page_num);
+      ASSERT_EQ(i, rids[i].slot_num);
+    }
+  }
+
+protected:
+  filesystem::path              test_directory_ = "bplus_tree_bulk_loader_test_dir";
+  VacuousLogHandler             log_handler_;
+  unique_ptr<BufferPoolManager> bpm_;
+  DiskBufferPool               *buffer_pool_ = nullptr;
+};
+
+TEST_F(BplusTreeBulkLoaderTest, in_memory)
+{
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(log_handler_, *buffer_pool_, AttrType::INTS, sizeof(int)));
+
+  const int           key_num = 20000;
+  BplusTreeBulkLoader loader(handler, 64 * 1024 * 1024, 100 /*fill_factor*/);
+  for (int key : shuffled_keys(key_num)) {
+    ASSERT_EQ(RC::SUCCESS, loader.add(reinterpret_cast<const char *>(&key), RID(key, key)));
+  }
+  ASSERT_EQ(RC::SUCCESS, loader.finish());
+  ASSERT_EQ(0, loader.run_num());
+  check_tree(handler, key_num);
+
+  // 批量构建出来的是一棵普通的B+树，可以继续插入和删除
+  for (int key = key_num; key < key_num + 1000; key++) {
+    RID rid(key, key);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry(reinterpret_cast<const char *>(&key), &rid));
+  }
+  for (int key = 0; key < key_num + 1000; key += 2) {
+    RID rid(key, key);
+    ASSERT_EQ(RC::SUCCESS, handler.delete_entry(reinterpret_cast<const char *>(&key), &rid));
+  }
+  ASSERT_TRUE(handler.validate_tree());
+
+  // 只能在空树上批量构建
+  const char *key = nullptr;
+  ASSERT_NE(RC::SUCCESS, handler.bulk_load(1, [&key](const char *&k) { k = key; return RC::SUCCESS; }, 90));
+}
+
+TEST_F(BplusTreeBulkLoaderTest, external_sort)
+{
+  for (int fill_factor : {50, 75, 100}) {
+    reset_buffer_pool();
+
+    // 节点很小，B+树有好几层
+    const int        order = 5;
+    BplusTreeHandler handler;
+    ASSERT_EQ(RC::SUCCESS, handler.create(log_handler_, *buffer_pool_, AttrType::INTS, sizeof(int), order, order));
+
+    const int           key_num = 3000;
+    BplusTreeBulkLoader loader(handler, 4096 /*sort_memory*/, fill_factor);
+    for (int key : shuffled_keys(key_num)) {
+      ASSERT_EQ(RC::SUCCESS, loader.add(reinterpret_cast<const char *>(&key), RID(key, key)));
+    }
+    ASSERT_EQ(RC::SUCCESS, loader.finish());
+    ASSERT_GT(loader.run_num(), 1);
+    check_tree(handler, key_num);
+
+    // 内部节点也会合并和重新分配
+    for (int key = 0; key < key_num; key++) {
+      if (key % 3 != 0) {
+        RID rid(key, key);
+        ASSERT_EQ(RC::SUCCESS, handler.delete_entry(reinterpret_cast<const char *>(&key), &rid));
+      }
+    }
+    ASSERT_TRUE(handler.validate_tree());
+
+    // 临时文件都删除了
+    for (const auto &entry : filesystem::directory_iterator(test_directory_)) {
+      ASSERT_EQ(string::npos, entry.path().string().find(".sort.")) << entry.path();
+    }
+  }
+}
+
+TEST_F(BplusTreeBulkLoaderTest, small_trees)
+{
+  // 只有一个叶子节点，或者最后一个节点的元素不够时，各层的节点都不能太空
+  for (int key_num : {1, 4, 5, 6, 9, 11, 26, 31}) {
+    reset_buffer_pool();
+
+    BplusTreeHandler handler;
+    ASSERT_EQ(RC::SUCCESS, handler.create(log_handler_, *buffer_pool_, AttrType::INTS, sizeof(int), 4, 5));
+
+    BplusTreeBulkLoader loader(handler, 1024 * 1024, 90);
+    for (int key : shuffled_keys(key_num)) {
+      ASSERT_EQ(RC::SUCCESS, loader.add(reinterpret_cast<const char *>(&key), RID(key, key)));
+    }
+    ASSERT_EQ(RC::SUCCESS, loader.finish());
+    check_tree(handler, key_num);
+  }
+}
+
+TEST_F(BplusTreeBulkLoaderTest, unique)
+{
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(log_handler_, *buffer_pool_, AttrType::INTS, sizeof(int)));
+
+  BplusTreeBulkLoader loader(handler, 64, 90, true /*unique*/);
+  for (int i = 0; i < 100; i++) {
+    int key = i == 99 ? 50 : i;
+    ASSERT_EQ(RC::SUCCESS, loader.add(reinterpret_cast<const char *>(&key), RID(i, i)));
+  }
+  ASSERT_EQ(RC::UNIQUE_INDEX_EXIST, loader.finish());
+  ASSERT_TRUE(handler.is_empty());
+}
+
+TEST(BplusTreeBulkLoaderLog, redo)
+{
+  filesystem::path test_directory = "bplus_tree_bulk_loader_log_test_dir";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  const filesystem::path bp_filename   = test_directory / "bplus_tree.bp";
+  const filesystem::path log_directory = test_directory / "clog";
+
+  auto bpm = make_unique<BufferPoolManager>();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+  auto            log_handler = make_unique<DiskLogHandler>();
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(bp_filename.c_str()));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(*log_handler, bp_filename.c_str(), buffer_pool));
+  ASSERT_EQ(RC::SUCCESS, log_handler->init(log_directory.c_str()));
+  IntegratedLogReplayer log_replayer(*bpm);
+  ASSERT_EQ(RC::SUCCESS, log_handler->replay(log_replayer, 0));
+  ASSERT_EQ(RC::SUCCESS, log_handler->start());
+
+  auto bplus_tree = make_unique<BplusTreeHandler>();
+  ASSERT_EQ(RC::SUCCESS, bplus_tree->create(*log_handler, *buffer_pool, AttrType::INTS, sizeof(int)));
+
+  const int key_num = 50000;
+  {
+    BplusTreeBulkLoader loader(*bplus_tree, 64 * 1024, 90);
+    for (int key : shuffled_keys(key_num)) {
+      ASSERT_EQ(RC::SUCCESS, loader.add(reinterpret_cast<const char *>(&key), RID(key, key)));
+    }
+    ASSERT_EQ(RC::SUCCESS, loader.finish());
+  }
+
+  // 日志落盘以后，在页面刷盘之前复制数据文件，重做以后应该得到同样的B+树
+  ASSERT_EQ(RC::SUCCESS, log_handler->stop());
+  ASSERT_EQ(RC::SUCCESS, log_handler->await_termination());
+  const filesystem::path bp_filename2 = test_directory / "bplus_tree2.bp";
+  ASSERT_TRUE(filesystem::copy_file(bp_filename, bp_filename2));
+
+  bplus_tree.reset();
+  bpm.reset();
+  log_handler.reset();
+
+  auto bpm2 = make_unique<BufferPoolManager>();
+  ASSERT_EQ(RC::SUCCESS, bpm2->init(make_unique<VacuousDoubleWriteBuffer>()));
+  auto            log_handler2 = make_unique<DiskLogHandler>();
+  DiskBufferPool *buffer_pool2 = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm2->open_file(*log_handler2, bp_filename2.c_str(), buffer_pool2));
+  ASSERT_EQ(RC::SUCCESS, log_handler2->init(log_directory.c_str()));
+  IntegratedLogReplayer log_replayer2(*bpm2);
+  ASSERT_EQ(RC::SUCCESS, log_handler2->replay(log_replayer2, 0));
+
+  auto tree_handler2 = make_unique<BplusTreeHandler>();
+  ASSERT_EQ(RC::SUCCESS, tree_handler2->open(*log_handler2, *buffer_pool2));
+  ASSERT_TRUE(tree_handler2->validate_tree());
+
+  vector<RID> rids;
+  ASSERT_EQ(RC::SUCCESS, list_all_values(*tree_handler2, rids));
+  ASSERT_EQ(key_num, static_cast<int>(rids.size()));
+  for (int i = 0; i < key_num; i++) {
+    ASSERT_EQ(i, rids[i].page_num);
+  }
+
+  tree_handler2.reset();
+  bpm2.reset();
+  log_handler2.reset();
+  filesystem::remove_all(test_directory);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  filesystem::path log_filename = filesystem::path(argv[0]).filename();
+  LoggerFactory::init_default(log_filename.string() + ".log", LOG_LEVEL_INFO);
+  return RUN_ALL_TESTS();
+}
@@ -17,6 +17,7 @@ See the Mulan PSL v2 for more details. */
 #include <filesystem>
 
 #include "common/log/log.h"
+#include "common/lang/algorithm.h"
 #include "common/lang/memory.h"
 #include "common/lang/filesystem.h"
 #include "sql/parser/parse_defs.h"
@@ -350,7 +351,9 @@ TEST(test_bplus_tree, test_leaf_index_node_handle)
           index_file_header.leaf_max_size));
   BplusTreeMiniTransaction mtr(tree_handler);
 
+  Page  page;
   Frame frame;
+  frame.set_page(&page);
 
   KeyComparator key_comparator;
   key_comparator.init(AttrType::INTS, 4);
@@ -432,7 +435,9 @@ TEST(test_bplus_tree, test_internal_index_node_handle)
           index_file_header.leaf_max_size));
   BplusTreeMiniTransaction mtr(tree_handler);
 
+  Page  page;
   Frame frame;
+  frame.set_page(&page);
 
   KeyComparator key_comparator;
   key_comparator.init(AttrType::INTS, 4);
@@ -568,6 +573,258 @@ TEST(test_bplus_tree, test_chars)
   ASSERT_EQ(2, count);
 }
 
+TEST(test_bplus_tree, test_long_chars)
+{
+  filesystem::path test_directory("bplus_tree");
+  filesystem::remove_all(test_directory);
+  filesystem::create_directories(test_directory);
+
+  filesystem::path buffer_pool_file = test_directory / "test_long_chars.bp";
+
+  VacuousLogHandler log_handler;
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(buffer_pool_file.c_str()));
+
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, buffer_pool_file.c_str(), buffer_pool));
+  ASSERT_NE(nullptr, buffer_pool);
+
+  const int        attr_length = 200;
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(log_handler, *buffer_pool, AttrType::CHARS, attr_length));
+
+  const int key_num = 5000;
+  char      key[attr_length];
+  auto      make_key = [&key](int i) {
+    memset(key, 0, sizeof(key));
+    snprintf(key, sizeof(key), "https://www.example.com/users/%08d/profile", i);
+  };
+
+  RID rid;
+  for (int i = 0; i < key_num; i++) {
+    const int value = static_cast<int>((i * 7919L) % key_num);
+    make_key(value);
+    rid.page_num = value / page_size;
+    rid.slot_num = value % page_size;
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry(key, &rid));
+  }
+  ASSERT_TRUE(handler.validate_tree());
+
+  // 内部节点只存放最短的分隔键值，比存放完整的键值多很多子节点
+  const int full_key_capacity = (BP_PAGE_DATA_SIZE - IndexNode::HEADER_SIZE) / (attr_length + sizeof(RID) + sizeof(PageNum));
+  int       max_children      = 0;
+  {
+    BplusTreeMiniTransaction mtr(handler);
+    Frame                   *root_frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, handler.buffer_pool().get_this_page(handler.file_header().root_page, &root_frame));
+    InternalIndexNodeHandler root_node(mtr, handler.file_header(), root_frame);
+    ASSERT_FALSE(root_node.is_leaf());
+    max_children = root_node.size();
+    for (int i = 0; i < root_node.size(); i++) {
+      Frame *child_frame = nullptr;
+      ASSERT_EQ(RC::SUCCESS, handler.buffer_pool().get_this_page(root_node.value_at(i), &child_frame));
+      InternalIndexNodeHandler child_node(mtr, handler.file_header(), child_frame);
+      if (!child_node.is_leaf()) {
+        max_children = max(max_children, child_node.size());
+      }
+      handler.buffer_pool().unpin_page(child_frame);
+    }
+    handler.buffer_pool().unpin_page(root_frame);
+  }
+  LOG_INFO("max children of internal node: %d, full key capacity: %d", max_children, full_key_capacity);
+  ASSERT_GT(max_children, full_key_capacity * 2);
+
+  for (int i = 0; i < key_num; i++) {
+    if (i % 3 != 0) {
+      make_key(i);
+      rid.page_num = i / page_size;
+      rid.slot_num = i % page_size;
+      ASSERT_EQ(RC::SUCCESS, handler.delete_entry(key, &rid));
+    }
+  }
+  ASSERT_TRUE(handler.validate_tree());
+
+  for (int i = 0; i < key_num; i += 7) {
+    make_key(i);
+    list<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, handler.get_entry(key, strlen(key), rids));
+    ASSERT_EQ(i % 3 == 0 ? 1 : 0, static_cast<int>(rids.size()));
+  }
+
+  handler.close();
+}
+
+TEST(test_bplus_tree, test_composite_key)
+{
+  filesystem::path test_directory("bplus_tree");
+  filesystem::remove_all(test_directory);
+  filesystem::create_directories(test_directory);
+
+  filesystem::path buffer_pool_file = test_directory / "test_composite_key.bp";
+
+  VacuousLogHandler log_handler;
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(buffer_pool_file.c_str()));
+
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, buffer_pool_file.c_str(), buffer_pool));
+  ASSERT_NE(nullptr, buffer_pool);
+
+  // (a int, b int)，b 取很大的值和负数，验证按照整个字段比较
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS,
+      handler.create(log_handler, *buffer_pool, {AttrType::INTS, AttrType::INTS}, {4, 4}, 10 /*internal*/, 10 /*leaf*/));
+  ASSERT_EQ(2, handler.file_header().attr_num);
+  ASSERT_EQ(8, handler.file_header().attr_length);
+
+  const int a_num = 10;
+  const int b_num = 100;
+  int       key[2];
+  RID       rid;
+  for (int i = 0; i < a_num * b_num; i++) {
+    const int value = (i * 7) % (a_num * b_num);
+    key[0]          = value % a_num - 5;
+    key[1]          = (value / a_num - b_num / 2) * 10000000;
+    rid.page_num    = value / page_size;
+    rid.slot_num    = value % page_size;
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry(reinterpret_cast<const char *>(key), &rid));
+  }
+  ASSERT_TRUE(handler.validate_tree());
+
+  auto count = [&handler](const int *left, int left_len, bool left_inclusive, const int *right, int right_len,
+                   bool right_inclusive) {
+    BplusTreeScanner scanner(handler);
+    EXPECT_EQ(RC::SUCCESS,
+        scanner.open(reinterpret_cast<const char *>(left), left_len, left_inclusive,
+            reinterpret_cast<const char *>(right), right_len, right_inclusive));
+    int num = 0;
+    RID rid;
+    while (scanner.next_entry(rid) == RC::SUCCESS) {
+      num++;
+    }
+    scanner.close();
+    return num;
+  };
+
+  // 只给出第一个字段
+  int a[1] = {0};
+  ASSERT_EQ(b_num, count(a, 4, true, a, 4, true));
+  ASSERT_EQ(b_num * 4, count(a, 4, false, nullptr, 0, false));
+  ASSERT_EQ(b_num * 5, count(nullptr, 0, false, a, 4, false));
+  ASSERT_EQ(b_num * 6, count(nullptr, 0, false, a, 4, true));
+
+  // 第一个字段等值，第二个字段是范围
+  int prefix[1] = {2};
+  int low[2]    = {2, 0};
+  int high[2]   = {2, 100000000};
+  ASSERT_EQ(b_num / 2, count(low, 8, true, prefix, 4, true));
+  ASSERT_EQ(b_num / 2, count(nullptr, 0, false, low, 8, false) - b_num * 7);
+  ASSERT_EQ(11, count(low, 8, true, high, 8, true));
+  ASSERT_EQ(10, count(low, 8, false, high, 8, true));
+  ASSERT_EQ(9, count(low, 8, false, high, 8, false));
+
+  // 完整的键值
+  list<RID> rids;
+  int       full_key[2] = {-5, -b_num / 2 * 10000000};
+  ASSERT_EQ(RC::SUCCESS, handler.get_entry(reinterpret_cast<const char *>(full_key), 8, rids));
+  ASSERT_EQ(1, static_cast<int>(rids.size()));
+
+  // 边界长度不是字段的边界
+  BplusTreeScanner scanner(handler);
+  ASSERT_EQ(RC::INVALID_ARGUMENT, scanner.open(reinterpret_cast<const char *>(low), 6, true, nullptr, 0, false));
+
+  handler.close();
+}
+
+TEST(test_bplus_tree, test_unique_insert)
+{
+  filesystem::path test_directory("bplus_tree");
+  filesystem::remove_all(test_directory);
+  filesystem::create_directories(test_directory);
+
+  filesystem::path buffer_pool_file = test_directory / "test_unique_insert.bp";
+
+  VacuousLogHandler log_handler;
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(buffer_pool_file.c_str()));
+
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, buffer_pool_file.c_str(), buffer_pool));
+  ASSERT_NE(nullptr, buffer_pool);
+
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(log_handler, *buffer_pool, AttrType::INTS, 4, 10 /*internal*/, 10 /*leaf*/));
+
+  // dead_rids 中的索引项对应的记录已经删除了，其它的都还有效
+  vector<RID> dead_rids;
+  int         check_num = 0;
+  auto unique_checker = [&dead_rids, &check_num](const RID &rid) {
+    check_num++;
+    return find(dead_rids.begin(), dead_rids.end(), rid) != dead_rids.end() ? RC::SUCCESS : RC::UNIQUE_INDEX_EXIST;
+  };
+  auto entry_num = [&handler](int key) {
+    list<RID> rids;
+    EXPECT_EQ(RC::SUCCESS, handler.get_entry(reinterpret_cast<const char *>(&key), sizeof(key), rids));
+    return static_cast<int>(rids.size());
+  };
+
+  const int key_num = 100;
+  for (int i = 0; i < key_num; i++) {
+    const int key = (i * 7) % key_num;
+    RID       rid(key + 1, 0);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry(reinterpret_cast<const char *>(&key), &rid, unique_checker));
+  }
+  ASSERT_EQ(0, check_num);
+
+  // 有效的键值冲突
+  const int key = key_num / 2;
+  RID       rid(1000, 0);
+  ASSERT_EQ(RC::UNIQUE_INDEX_EXIST, handler.insert_entry(reinterpret_cast<const char *>(&key), &rid, unique_checker));
+  ASSERT_EQ(1, check_num);
+  ASSERT_EQ(1, entry_num(key));
+
+  // 已经删除的旧版本不冲突，同一个键值的索引项会分布在多个叶子节点中
+  dead_rids.push_back(RID(key + 1, 0));
+  const int version_num = 30;
+  for (int i = 0; i < version_num; i++) {
+    check_num = 0;
+    rid       = RID(1000 + i, 0);
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry(reinterpret_cast<const char *>(&key), &rid, unique_checker));
+    ASSERT_EQ(i + 1, check_num);
+    dead_rids.push_back(rid);
+  }
+  ASSERT_TRUE(handler.validate_tree());
+  ASSERT_EQ(version_num + 1, entry_num(key));
+
+  // 插入到所有旧版本的前面、中间和后面，都要检查所有属性值相同的索引项
+  const RID rids[] = {RID(1, 0), RID(1000 + version_num / 2, 1), RID(2000, 0)};
+  for (const RID &new_rid : rids) {
+    const int old_num = entry_num(key);
+    check_num         = 0;
+    ASSERT_EQ(RC::SUCCESS, handler.insert_entry(reinterpret_cast<const char *>(&key), &new_rid, unique_checker));
+    ASSERT_EQ(old_num, check_num);
+    ASSERT_EQ(old_num + 1, entry_num(key));
+    dead_rids.push_back(new_rid);
+  }
+
+  // 旧版本中有一个还有效
+  dead_rids.erase(find(dead_rids.begin(), dead_rids.end(), RID(1000 + version_num / 3, 0)));
+  for (const RID &new_rid : {RID(2, 0), RID(1000 + version_num / 2, 2), RID(3000, 0)}) {
+    const int old_num = entry_num(key);
+    ASSERT_EQ(RC::UNIQUE_INDEX_EXIST,
+        handler.insert_entry(reinterpret_cast<const char *>(&key), &new_rid, unique_checker));
+    ASSERT_EQ(old_num, entry_num(key));
+  }
+
+  ASSERT_TRUE(handler.validate_tree());
+  ASSERT_EQ(1, entry_num(key - 1));
+  ASSERT_EQ(1, entry_num(key + 1));
+  handler.close();
+}
+
 TEST(test_bplus_tree, test_scanner)
 {
   LoggerFactory::init_default("test.log");
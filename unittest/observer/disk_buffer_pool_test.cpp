@@ -12,9 +12,13 @@ See the Mulan PSL v2 for more details. */
 // Created by wangyunlai on 2024/02/01
 //
 
+#include <fcntl.h>
 #include <filesystem>
+#include <fstream>
 
 #include "gtest/gtest.h"
+#include "common/lang/chrono.h"
+#include "common/lang/thread.h"
 #include "common/log/log.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/clog/vacuous_log_handler.h"
@@ -105,6 +109,68 @@ TEST(DiskBufferPool, allocate_dispose)
   ASSERT_EQ(buffer_pool_manager.close_file(buffer_pool_filename.c_str()), RC::SUCCESS);
 }
 
+TEST(DiskBufferPool, dispose_pinned_page)
+{
+  filesystem::path directory("buffer_pool_dispose_pinned");
+  filesystem::remove_all(directory);
+  filesystem::create_directories(directory);
+
+  filesystem::path buffer_pool_filename = directory / "buffer_pool.bp";
+
+  BufferPoolManager buffer_pool_manager;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool_manager.init(make_unique<VacuousDoubleWriteBuffer>()));
+  VacuousLogHandler log_handler;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool_manager.create_file(buffer_pool_filename.c_str()));
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool_manager.open_file(log_handler, buffer_pool_filename.c_str(), buffer_pool));
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+  const PageNum page_num = frame->page_num();
+
+  // 像B+树的乐观读一样还pin着页面时删除页面，页帧要等读者unpin以后才能淘汰
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->dispose_page(page_num));
+  ASSERT_EQ(1, frame->pin_count());
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  ASSERT_EQ(0, buffer_pool_page_count(buffer_pool));
+
+  // 删除的页面可以重新分配
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+  ASSERT_EQ(page_num, frame->page_num());
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+
+  ASSERT_EQ(buffer_pool_manager.close_file(buffer_pool_filename.c_str()), RC::SUCCESS);
+  filesystem::remove_all(directory);
+}
+
+TEST(Frame, version)
+{
+  Frame frame;
+  frame.pin();
+
+  uint64_t version = frame.version();
+  ASSERT_FALSE(Frame::is_writing_version(version));
+
+  // 读锁不修改版本号
+  frame.read_latch();
+  ASSERT_TRUE(frame.validate_version(version));
+  frame.read_unlatch();
+
+  // 只有最外层的写锁修改版本号，加着写锁时版本号是奇数
+  frame.write_latch();
+  ASSERT_TRUE(Frame::is_writing_version(frame.version()));
+  frame.write_latch();
+  frame.write_unlatch();
+  ASSERT_TRUE(Frame::is_writing_version(frame.version()));
+  frame.write_unlatch();
+
+  ASSERT_FALSE(Frame::is_writing_version(frame.version()));
+  ASSERT_FALSE(frame.validate_version(version));
+  ASSERT_EQ(version + 2, frame.version());
+
+  frame.unpin();
+}
+
 TEST(BufferPool, create)
 {
   filesystem::path test_directory("buffer_pool");
@@ -132,6 +198,409 @@ TEST(BufferPool, create)
   ASSERT_EQ(buffer_pool->id(), buffer_pool2->id());
 }
 
+TEST(BufferPool, flush_dirty_pages)
+{
+  filesystem::path test_directory("buffer_pool");
+  filesystem::path bp_file = test_directory / "flush_dirty_pages.bp";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(bp_file.c_str()));
+
+  VacuousLogHandler log_handler;
+  DiskBufferPool   *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+  PageNum page_num = frame->page_num();
+
+  // recovery lsn 是页面变脏后第一次修改的LSN
+  frame->set_lsn(10);
+  frame->mark_dirty();
+  frame->set_lsn(20);
+  ASSERT_EQ(10, frame->recovery_lsn());
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+
+  LSN min_recovery_lsn = -1;
+  ASSERT_EQ(RC::SUCCESS, bpm.flush_dirty_pages(min_recovery_lsn));
+  ASSERT_EQ(0, min_recovery_lsn);
+
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->get_this_page(page_num, &frame));
+  ASSERT_FALSE(frame->dirty());
+  ASSERT_EQ(0, frame->recovery_lsn());
+  ASSERT_EQ(20, frame->lsn());
+
+  frame->set_lsn(30);
+  frame->mark_dirty();
+  ASSERT_EQ(30, frame->recovery_lsn());
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+
+  ASSERT_EQ(RC::SUCCESS, bpm.flush_dirty_pages(min_recovery_lsn));
+  ASSERT_EQ(0, min_recovery_lsn);
+  ASSERT_EQ(RC::SUCCESS, bpm.sync_files());
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+}
+
+TEST(BufferPool, prefetch)
+{
+  filesystem::path test_directory("buffer_pool");
+  filesystem::path bp_file = test_directory / "prefetch.bp";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.init_prefetch(2 /*thread_num*/, 16 /*read_ahead_page_num*/));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(bp_file.c_str()));
+
+  VacuousLogHandler log_handler;
+  DiskBufferPool   *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+  ASSERT_EQ(16, buffer_pool->read_ahead_page_num());
+
+  // 每个页面的开头写上页面编号，释放一些页面制造空洞
+  const int page_num = 100;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+    *reinterpret_cast<PageNum *>(frame->data()) = frame->page_num();
+    frame->mark_dirty();
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+  for (PageNum i = 10; i < 20; i++) {
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->dispose_page(i));
+  }
+
+  LSN min_recovery_lsn = 0;
+  ASSERT_EQ(RC::SUCCESS, bpm.flush_dirty_pages(min_recovery_lsn));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+
+  // 预读之后页面都在内存中，而且没有被pin住
+  BPFrameManager &frame_manager = bpm.get_frame_manager();
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->prefetch_pages(1, 40));
+  for (int i = 0; i < 1000 && !frame_manager.contains(buffer_pool->id(), 40); i++) {
+    this_thread::sleep_for(chrono::milliseconds(1));
+  }
+  for (PageNum i = 1; i <= 40; i++) {
+    ASSERT_EQ(i < 10 || i >= 20, frame_manager.contains(buffer_pool->id(), i)) << "page " << i;
+  }
+  ASSERT_FALSE(frame_manager.contains(buffer_pool->id(), 41));
+
+  // 顺序扫描时在后台预读，读到的数据和预读无关
+  BufferPoolIterator iterator;
+  ASSERT_EQ(RC::SUCCESS, iterator.init(*buffer_pool, 1, true /*read_ahead*/));
+  int count = 0;
+  while (iterator.has_next()) {
+    PageNum current = iterator.next();
+    Frame  *frame   = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->get_this_page(current, &frame));
+    frame->read_latch();
+    ASSERT_EQ(current, *reinterpret_cast<PageNum *>(frame->data()));
+    frame->read_unlatch();
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+    count++;
+  }
+  ASSERT_EQ(page_num - 10, count);
+
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+}
+
+TEST(BufferPool, stat)
+{
+  filesystem::path test_directory("buffer_pool");
+  filesystem::path bp_file = test_directory / "stat.bp";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  // 只有一个页帧内存池，页面个数超过页帧个数时需要淘汰页面
+  BufferPoolManager bpm(1);
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(bp_file.c_str()));
+
+  VacuousLogHandler log_handler;
+  DiskBufferPool   *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+
+  const int page_num = DEFAULT_ITEM_NUM_PER_POOL * 2;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+    frame->mark_dirty();
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+
+  const BufferPoolStat &stat = buffer_pool->stat();
+  ASSERT_GE(stat.get(BufferPoolStatType::EVICT), static_cast<uint64_t>(page_num - DEFAULT_ITEM_NUM_PER_POOL));
+  ASSERT_GE(stat.get(BufferPoolStatType::DIRTY_FLUSH), stat.get(BufferPoolStatType::EVICT));
+  ASSERT_EQ(stat.get(BufferPoolStatType::DIRTY_FLUSH), stat.get(BufferPoolStatType::PAGE_WRITE));
+
+  // 最后分配的页面还在内存中，最早分配的页面已经被淘汰了
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->get_this_page(page_num, &frame));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  ASSERT_EQ(1, stat.get(BufferPoolStatType::PAGE_HIT));
+  ASSERT_EQ(0, stat.get(BufferPoolStatType::PAGE_MISS));
+
+  // 打开文件时读取了文件头页
+  const uint64_t read_count = stat.get(BufferPoolStatType::PAGE_READ);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->get_this_page(1, &frame));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  ASSERT_EQ(1, stat.get(BufferPoolStatType::PAGE_MISS));
+  ASSERT_EQ(read_count + 1, stat.get(BufferPoolStatType::PAGE_READ));
+
+  vector<pair<string, BufferPoolStat::Values>> stats;
+  bpm.collect_stats(stats);
+  ASSERT_EQ(1, stats.size());
+  ASSERT_EQ(bp_file.string(), stats[0].first);
+  ASSERT_EQ(1, stats[0].second[static_cast<size_t>(BufferPoolStatType::PAGE_HIT)]);
+
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+}
+
+TEST(BufferPool, stat_concurrency)
+{
+  BufferPoolStat stat;
+  const int      thread_num = 8;
+  const int      add_times  = 10000;
+
+  vector<thread> threads;
+  for (int i = 0; i < thread_num; i++) {
+    threads.emplace_back([&stat]() {
+      for (int j = 0; j < add_times; j++) {
+        stat.add(BufferPoolStatType::PAGE_HIT);
+        stat.add(BufferPoolStatType::READ_TIME_US, 2);
+      }
+    });
+  }
+  for (thread &t : threads) {
+    t.join();
+  }
+
+  ASSERT_EQ(thread_num * add_times, stat.get(BufferPoolStatType::PAGE_HIT));
+
+  BufferPoolStat::Values values{};
+  stat.collect(values);
+  ASSERT_EQ(thread_num * add_times, values[static_cast<size_t>(BufferPoolStatType::PAGE_HIT)]);
+  ASSERT_EQ(thread_num * add_times * 2, values[static_cast<size_t>(BufferPoolStatType::READ_TIME_US)]);
+  ASSERT_EQ(0, values[static_cast<size_t>(BufferPoolStatType::PAGE_MISS)]);
+}
+
+TEST(BufferPool, page_cleaner)
+{
+  filesystem::path test_directory("buffer_pool");
+  filesystem::path bp_file = test_directory / "page_cleaner.bp";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  BufferPoolManager bpm(DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE);
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(bp_file.c_str()));
+
+  VacuousLogHandler log_handler;
+  DiskBufferPool   *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+
+  // 页面编号越大，recovery lsn 越小
+  const int page_num = 100;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+    frame->set_lsn(1000 - frame->page_num());
+    frame->mark_dirty();
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+
+  BPFrameManager            &frame_manager = bpm.get_frame_manager();
+  vector<pair<LSN, FrameId>> dirty_frames;
+  frame_manager.find_dirty_list(dirty_frames);
+  ASSERT_EQ(page_num + 1, static_cast<int>(dirty_frames.size()));  // 包括文件头页
+
+  // 先刷新 recovery lsn 最小的页面，文件头页的 recovery lsn 是0
+  ASSERT_EQ(11, bpm.clean_pages(11));
+  dirty_frames.clear();
+  frame_manager.find_dirty_list(dirty_frames);
+  ASSERT_EQ(page_num - 10, static_cast<int>(dirty_frames.size()));
+  for (const auto &[recovery_lsn, frame_id] : dirty_frames) {
+    ASSERT_LE(frame_id.page_num(), page_num - 10);
+  }
+
+  // 超过高水位后，清理线程把脏页降到低水位以下
+  const int total_num = static_cast<int>(frame_manager.total_frame_num());
+  ASSERT_EQ(RC::INVALID_ARGUMENT, bpm.start_page_cleaner(20, 50, chrono::milliseconds(10)));
+  ASSERT_EQ(RC::SUCCESS, bpm.start_page_cleaner(50, 20, chrono::milliseconds(10)));
+  for (int i = 0; i < 1000 && static_cast<int>(dirty_frames.size()) > total_num * 20 / 100; i++) {
+    this_thread::sleep_for(chrono::milliseconds(1));
+    dirty_frames.clear();
+    frame_manager.find_dirty_list(dirty_frames);
+  }
+  bpm.stop_page_cleaner();
+
+  ASSERT_EQ(total_num * 20 / 100, static_cast<int>(dirty_frames.size()));
+  for (const auto &[recovery_lsn, frame_id] : dirty_frames) {
+    ASSERT_LE(frame_id.page_num(), total_num * 20 / 100);
+  }
+
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+}
+
+TEST(BufferPool, allocation_map)
+{
+  filesystem::path test_directory("buffer_pool");
+  filesystem::path bp_file = test_directory / "allocation_map.bp";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  BufferPoolManager bpm(DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE);
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(bp_file.c_str()));
+
+  VacuousLogHandler log_handler;
+  DiskBufferPool   *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+
+  // 直接回放分配页面的日志，快速地生成一个超过第一组的文件，第二组的第一个页面是位图页
+  const PageNum bitmap_page = BPFileHeader::FIRST_GROUP_PAGE_NUM;
+  const PageNum page_count  = bitmap_page + 10;
+  ASSERT_TRUE(DiskBufferPool::is_bitmap_page(bitmap_page));
+  ASSERT_NE(RC::SUCCESS, buffer_pool->redo_allocate_page(1, bitmap_page));
+
+  LSN lsn = 0;
+  for (PageNum page_num = 1; page_num < page_count; page_num++) {
+    if (page_num != bitmap_page) {
+      ASSERT_EQ(RC::SUCCESS, buffer_pool->redo_allocate_page(++lsn, page_num));
+    }
+  }
+  filesystem::resize_file(bp_file, static_cast<uintmax_t>(page_count) * BP_PAGE_SIZE);
+  ASSERT_EQ(page_count - 2, buffer_pool_page_count(buffer_pool));
+
+  // 释放的页面可以再次分配，优先使用前面的组
+  ASSERT_NE(RC::SUCCESS, buffer_pool->dispose_page(bitmap_page));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->dispose_page(bitmap_page + 5));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->dispose_page(100));
+  ASSERT_EQ(page_count - 4, buffer_pool_page_count(buffer_pool));
+
+  for (PageNum expect_page_num : {100, bitmap_page + 5, page_count}) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+    ASSERT_EQ(expect_page_num, frame->page_num());
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+  ASSERT_EQ(page_count - 1, buffer_pool_page_count(buffer_pool));
+
+  // 重新打开文件，分配信息都保存在文件中
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+  ASSERT_EQ(page_count - 1, buffer_pool_page_count(buffer_pool));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->dispose_page(page_count - 1));
+  ASSERT_EQ(page_count - 2, buffer_pool_page_count(buffer_pool));
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+  ASSERT_EQ(page_count - 1, frame->page_num());
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+}
+
+TEST(BufferPool, direct_io)
+{
+  filesystem::path test_directory("buffer_pool");
+  filesystem::path bp_file = test_directory / "direct_io.bp";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  BufferPoolManager bpm(DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE);
+  bpm.set_direct_io(true);
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(bp_file.c_str()));
+
+  VacuousLogHandler log_handler;
+  DiskBufferPool   *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+  ASSERT_NE(0, fcntl(buffer_pool->file_desc(), F_GETFL) & O_DIRECT);
+
+  const int page_num = 10;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(&frame->page()) % BP_PAGE_ALIGN);
+    memset(frame->data(), 'a' + frame->page_num(), BP_PAGE_DATA_SIZE);
+    frame->mark_dirty();
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+
+  // double write buffer 中的页面没有对齐，也可以写入
+  auto unaligned_buffer = make_unique<char[]>(sizeof(Page) + 1);
+  Page *unaligned_page  = reinterpret_cast<Page *>(unaligned_buffer.get() + 1);
+  Frame *frame          = nullptr;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->get_this_page(page_num, &frame));
+  memcpy(unaligned_page, &frame->page(), sizeof(Page));
+  memset(unaligned_page->data, 'z', BP_PAGE_DATA_SIZE);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->flush_all_pages());
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->write_page(page_num, *unaligned_page));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+  ASSERT_EQ(page_num, buffer_pool_page_count(buffer_pool));
+  for (PageNum i = 1; i <= page_num; i++) {
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->get_this_page(i, &frame));
+    ASSERT_EQ(i == page_num ? 'z' : 'a' + i, frame->data()[BP_PAGE_DATA_SIZE - 1]);
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+}
+
+TEST(BufferPool, verify_checksum)
+{
+  filesystem::path test_directory("buffer_pool");
+  filesystem::path bp_file = test_directory / "verify_checksum.bp";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  BufferPoolManager bpm(DEFAULT_ITEM_NUM_PER_POOL * BP_PAGE_SIZE);
+  bpm.set_verify_checksum(true);
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(bp_file.c_str()));
+
+  VacuousLogHandler log_handler;
+  DiskBufferPool   *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+
+  const int page_num = 3;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+    memset(frame->data(), 'a' + i, BP_PAGE_DATA_SIZE);
+    frame->mark_dirty();
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+
+  // 模拟页面只写了一半
+  {
+    fstream file(bp_file, ios::in | ios::out | ios::binary);
+    file.seekp(2 * BP_PAGE_SIZE + BP_PAGE_SIZE / 2);
+    file.put('x');
+  }
+
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+  Frame *frame = nullptr;
+  for (PageNum i = 1; i <= page_num; i++) {
+    RC rc = buffer_pool->get_this_page(i, &frame);
+    if (i == 2) {
+      ASSERT_EQ(RC::BUFFERPOOL_PAGE_CORRUPTED, rc);
+    } else {
+      ASSERT_EQ(RC::SUCCESS, rc);
+      ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+    }
+  }
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -180,6 +180,58 @@ TEST(DiskLogHandler, multi_thread)
   ASSERT_EQ(RC::SUCCESS, handler.await_termination());
 }
 
+TEST(DiskLogHandler, group_commit)
+{
+  const char *directory = "test_log_handler_group_commit";
+  filesystem::remove_all(directory);
+
+  DiskLogHandler  handler;
+  TestLogReplayer replayer;
+  ASSERT_EQ(RC::SUCCESS, handler.init(directory));
+  ASSERT_EQ(RC::SUCCESS, handler.replay(replayer, 0));
+  handler.set_flush_batch_size(64);
+  handler.set_flush_max_wait(chrono::microseconds(200));
+  ASSERT_EQ(RC::SUCCESS, handler.start());
+
+  // 每个线程都同步等待自己的日志落盘，模拟并发提交的事务
+  const int          threads            = 8;
+  const int          times_per_thread   = 500;
+  atomic<int>        failed_count{0};
+  ThreadPoolExecutor executor;
+  ASSERT_EQ(0, executor.init("TestGroupCommit", threads, threads, 60 * 1000));
+
+  for (int t = 0; t < threads; ++t) {
+    ASSERT_EQ(0, executor.execute([&handler, &failed_count]() -> void {
+      for (int i = 0; i < times_per_thread; ++i) {
+        LSN          lsn = 0;
+        vector<char> data(10);
+        if (handler.append(lsn, LogModule::Id::BUFFER_POOL, std::move(data)) != RC::SUCCESS ||
+            handler.wait_lsn(lsn) != RC::SUCCESS || handler.current_flushed_lsn() < lsn) {
+          failed_count++;
+        }
+      }
+    }));
+  }
+
+  ASSERT_EQ(0, executor.shutdown());
+  ASSERT_EQ(0, executor.await_termination());
+  ASSERT_EQ(0, failed_count.load());
+  ASSERT_EQ(threads * times_per_thread, handler.current_flushed_lsn());
+
+  ASSERT_EQ(RC::SUCCESS, handler.stop());
+  ASSERT_EQ(RC::SUCCESS, handler.await_termination());
+
+  int  count             = 0;
+  auto log_entry_counter = [&count](LogEntry &) -> RC {
+    count++;
+    return RC::SUCCESS;
+  };
+  ASSERT_EQ(RC::SUCCESS, handler.iterate(log_entry_counter, 0));
+  ASSERT_EQ(threads * times_per_thread, count);
+
+  filesystem::remove_all(directory);
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
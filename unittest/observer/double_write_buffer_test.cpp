@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include <filesystem>
+#include <fstream>
 
 #include "gtest/gtest.h"
 
@@ -21,6 +22,7 @@ See the Mulan PSL v2 for more details. */
 #include "storage/clog/vacuous_log_handler.h"
 #include "storage/clog/disk_log_handler.h"
 #include "storage/clog/integrated_log_replayer.h"
+#include "common/math/crc.h"
 
 using namespace std;
 using namespace common;
@@ -201,6 +203,72 @@ TEST(DoubleWriteBuffer, single_file_exception)
   bpm  = nullptr;
 }
 
+TEST(DoubleWriteBuffer, batch_flush)
+{
+  filesystem::path directory("double_write_buffer_test_batch_flush_dir");
+  filesystem::remove_all(directory);
+  filesystem::create_directories(directory);
+
+  filesystem::path buffer_pool_filename         = directory / "buffer_pool.bp";
+  filesystem::path double_write_buffer_filename = directory / "double_write_buffer.dwb";
+
+  const int         batch_pages = 4;
+  auto              bpm         = make_unique<BufferPoolManager>();
+  VacuousLogHandler log_handler;
+  auto              double_write_buffer = make_unique<DiskDoubleWriteBuffer>(*bpm, batch_pages);
+  ASSERT_EQ(RC::SUCCESS, double_write_buffer->open_file(double_write_buffer_filename.c_str()));
+  ASSERT_EQ(bpm->init(std::move(double_write_buffer)), RC::SUCCESS);
+
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(buffer_pool_filename.c_str()));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, buffer_pool_filename.c_str(), buffer_pool));
+  DiskDoubleWriteBuffer *disk_double_write_buffer = static_cast<DiskDoubleWriteBuffer *>(bpm->get_dblwr_buffer());
+
+  auto make_page = [](PageNum page_num, char value) {
+    Page page;
+    page.lsn = page_num;
+    memset(page.data, value, sizeof(page.data));
+    page.check_sum = crc32(page.data, BP_PAGE_DATA_SIZE);
+    return page;
+  };
+
+  // 没有攒够一批时页面只在内存中，重复写入同一个页面不占用新的位置
+  const uintmax_t bp_file_size = filesystem::file_size(buffer_pool_filename);
+  for (PageNum page_num : {3, 1, 2, 1}) {
+    Page page = make_page(page_num, 'a' + page_num);
+    ASSERT_EQ(RC::SUCCESS, disk_double_write_buffer->add_page(buffer_pool, page_num, page));
+  }
+  ASSERT_EQ(3, disk_double_write_buffer->page_count());
+  ASSERT_EQ(bp_file_size, filesystem::file_size(buffer_pool_filename));
+
+  Page page;
+  ASSERT_EQ(RC::SUCCESS, disk_double_write_buffer->read_page(buffer_pool, 2, page));
+  ASSERT_EQ('a' + 2, page.data[0]);
+
+  // 攒够一批后写入 double write buffer 文件和数据文件
+  page = make_page(4, 'a' + 4);
+  ASSERT_EQ(RC::SUCCESS, disk_double_write_buffer->add_page(buffer_pool, 4, page));
+  ASSERT_EQ(0, disk_double_write_buffer->page_count());
+  ASSERT_NE(RC::SUCCESS, disk_double_write_buffer->read_page(buffer_pool, 2, page));
+  ASSERT_EQ(static_cast<uintmax_t>(5 * BP_PAGE_SIZE), filesystem::file_size(buffer_pool_filename));
+
+  ifstream bp_file(buffer_pool_filename, ios::binary);
+  for (PageNum page_num = 1; page_num <= batch_pages; page_num++) {
+    bp_file.seekg(static_cast<streamoff>(page_num) * BP_PAGE_SIZE);
+    ASSERT_TRUE(bp_file.read(reinterpret_cast<char *>(&page), sizeof(page)));
+    ASSERT_EQ(page_num, page.lsn);
+    ASSERT_EQ('a' + page_num, page.data[BP_PAGE_DATA_SIZE - 1]);
+  }
+
+  // 页面都写回以后，文件头中的页面个数清零，重启时不需要恢复
+  DoubleWriteBufferHeader header;
+  ifstream                dblwr_file(double_write_buffer_filename, ios::binary);
+  ASSERT_TRUE(dblwr_file.read(reinterpret_cast<char *>(&header), sizeof(header)));
+  ASSERT_EQ(0, header.page_cnt);
+
+  bpm = nullptr;
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
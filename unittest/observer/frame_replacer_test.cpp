@@ -0,0 +1,126 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "common/lang/vector.h"
+#include "storage/buffer/frame_replacer.h"
+#include "gtest/gtest.h"
+
+static vector<PageNum> victims(FrameReplacer &replacer, size_t count = 0)
+{
+  vector<PageNum> pages;
+  replacer.foreach_victim([&pages, count](Frame *frame) {
+    pages.push_back(frame->page_num());
+    return count == 0 || pages.size() < count;
+  });
+  return pages;
+}
+
+class FrameReplacerTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    for (int i = 0; i < FRAME_NUM; i++) {
+      frames_[i].set_buffer_pool_id(1);
+      frames_[i].set_page_num(i);
+    }
+  }
+
+  static constexpr int FRAME_NUM = 16;
+  Frame                frames_[FRAME_NUM];
+};
+
+TEST_F(FrameReplacerTest, type_name)
+{
+  FrameReplacerType type = FrameReplacerType::LRU;
+  ASSERT_EQ(RC::SUCCESS, frame_replacer_type_from_string("LRU-K", type));
+  ASSERT_EQ(FrameReplacerType::LRU_K, type);
+  ASSERT_EQ(RC::SUCCESS, frame_replacer_type_from_string("2q", type));
+  ASSERT_EQ(FrameReplacerType::TWO_Q, type);
+  ASSERT_EQ(RC::INVALID_ARGUMENT, frame_replacer_type_from_string("clock", type));
+
+  for (FrameReplacerType item : {FrameReplacerType::LRU, FrameReplacerType::LRU_K, FrameReplacerType::TWO_Q}) {
+    ASSERT_EQ(item, FrameReplacer::create(item, FRAME_NUM)->type());
+  }
+}
+
+TEST_F(FrameReplacerTest, lru)
+{
+  LruFrameReplacer replacer;
+  for (int i = 0; i < 4; i++) {
+    replacer.insert(&frames_[i]);
+  }
+  replacer.access(&frames_[0]);
+  ASSERT_EQ(vector<PageNum>({1, 2, 3, 0}), victims(replacer));
+
+  replacer.remove(&frames_[2]);
+  ASSERT_EQ(vector<PageNum>({1, 3, 0}), victims(replacer));
+  ASSERT_EQ(vector<PageNum>({1}), victims(replacer, 1));
+}
+
+TEST_F(FrameReplacerTest, lru_k)
+{
+  LruKFrameReplacer replacer(2);
+
+  // 0 和 1 是热点页面，访问了多次
+  replacer.insert(&frames_[0]);
+  replacer.insert(&frames_[1]);
+  replacer.access(&frames_[0]);
+  replacer.access(&frames_[1]);
+  replacer.access(&frames_[0]);
+
+  // 扫描的页面只访问一次，先于热点页面被淘汰
+  for (int i = 2; i < 6; i++) {
+    replacer.insert(&frames_[i]);
+  }
+  ASSERT_EQ(vector<PageNum>({2, 3, 4, 5, 1, 0}), victims(replacer));
+
+  // 第二次访问后进入按照倒数第二次访问时间排序的集合
+  replacer.access(&frames_[3]);
+  ASSERT_EQ(vector<PageNum>({2, 4, 5, 1, 0, 3}), victims(replacer));
+
+  replacer.remove(&frames_[1]);
+  replacer.remove(&frames_[4]);
+  ASSERT_EQ(vector<PageNum>({2, 5, 0, 3}), victims(replacer));
+}
+
+TEST_F(FrameReplacerTest, two_q)
+{
+  TwoQFrameReplacer replacer(8);  // A1in 2 个，A1out 4 个
+
+  for (int i = 0; i < 4; i++) {
+    replacer.insert(&frames_[i]);
+  }
+  // A1in 超过了限制，先淘汰 A1in 中最早加入的页面，A1in 中的再次访问不改变顺序
+  replacer.access(&frames_[0]);
+  ASSERT_EQ(vector<PageNum>({0, 1, 2, 3}), victims(replacer));
+
+  // 从 A1in 淘汰的页面再次读入时直接进入 Am
+  replacer.remove(&frames_[0]);
+  replacer.remove(&frames_[1]);
+  replacer.insert(&frames_[0]);
+  ASSERT_EQ(vector<PageNum>({0, 2, 3}), victims(replacer));
+
+  // A1in 没有超过限制时优先淘汰 Am 中的页面
+  replacer.remove(&frames_[2]);
+  ASSERT_EQ(vector<PageNum>({0, 3}), victims(replacer));
+
+  // 扫描大量的新页面，Am 中的页面不会被淘汰
+  for (int i = 4; i < 10; i++) {
+    replacer.insert(&frames_[i]);
+  }
+  ASSERT_EQ(vector<PageNum>({3, 4, 5, 6, 7, 8, 9, 0}), victims(replacer));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
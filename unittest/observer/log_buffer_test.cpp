@@ -18,6 +18,8 @@ See the Mulan PSL v2 for more details. */
 #define protected public
 #include "storage/clog/log_buffer.h"
 #include "storage/clog/log_file.h"
+#include "storage/clog/log_entry.h"
+#include "common/lang/thread.h"
 
 using namespace std;
 using namespace common;
@@ -66,6 +68,75 @@ TEST(LogEntryBuffer, test_append)
   filesystem::remove("test_log_entry_buffer.log");
 }
 
+TEST(LogEntryBuffer, test_multi_thread_append)
+{
+  // 缓冲区很小，追加日志的线程需要等待刷盘线程释放槽位
+  const char    *filename = "test_log_entry_buffer_multi_thread.log";
+  LogEntryBuffer buffer;
+  ASSERT_EQ(RC::SUCCESS, buffer.init(0, 16 * 1024));
+
+  const int threads          = 8;
+  const int times_per_thread = 5000;
+  const LSN end_lsn          = threads * times_per_thread;
+
+  filesystem::remove(filename);
+  LogFileWriter writer;
+  ASSERT_EQ(RC::SUCCESS, writer.open(filename, end_lsn, LogSyncPolicy::NONE));
+
+  atomic<int> failed_count{0};
+  thread      flusher([&buffer, &writer, &failed_count, end_lsn]() {
+    while (buffer.flushed_lsn() < end_lsn) {
+      int count = 0;
+      if (buffer.flush(writer, count, 100) != RC::SUCCESS) {
+        failed_count++;
+        return;
+      }
+    }
+  });
+
+  vector<thread> appenders;
+  for (int t = 0; t < threads; t++) {
+    appenders.emplace_back([&buffer, &failed_count, t]() {
+      for (int i = 0; i < times_per_thread; i++) {
+        // 日志的长度不同，有一部分超过了槽位预先分配的内存
+        LSN          lsn = 0;
+        vector<char> data(1 + (t * times_per_thread + i) % 600, static_cast<char>(t));
+        if (buffer.append(lsn, LogModule::Id::BUFFER_POOL, std::move(data)) != RC::SUCCESS) {
+          failed_count++;
+        }
+      }
+    });
+  }
+
+  for (thread &appender : appenders) {
+    appender.join();
+  }
+  flusher.join();
+  writer.close();
+
+  ASSERT_EQ(0, failed_count.load());
+  ASSERT_EQ(end_lsn, buffer.current_lsn());
+  ASSERT_EQ(0, buffer.entry_number());
+
+  LogFileReader reader;
+  ASSERT_EQ(RC::SUCCESS, reader.open(filename));
+  LSN  expect_lsn = 1;
+  auto callback   = [&expect_lsn](LogEntry &entry) -> RC {
+    EXPECT_EQ(expect_lsn, entry.lsn());
+    EXPECT_GT(entry.payload_size(), 0);
+    for (int i = 1; i < entry.payload_size(); i++) {
+      EXPECT_EQ(entry.data()[0], entry.data()[i]);
+    }
+    expect_lsn++;
+    return RC::SUCCESS;
+  };
+  ASSERT_EQ(RC::SUCCESS, reader.iterate(callback));
+  ASSERT_EQ(end_lsn + 1, expect_lsn);
+  reader.close();
+
+  filesystem::remove(filename);
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
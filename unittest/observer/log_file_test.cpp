@@ -178,6 +178,93 @@ TEST(LogFileReadWrite, test_read_write)
   // filesystem::remove(log_file);
 }
 
+TEST(LogFileWriter, write_batch)
+{
+  const char *log_file = "test_log_file_write_batch.log";
+
+  filesystem::remove(log_file);
+
+  LogFileWriter writer;
+  LSN           end_lsn = 1000 - 1;
+  ASSERT_EQ(RC::SUCCESS, writer.open(log_file, end_lsn));
+
+  // 日志条数超过了一次writev的限制，并且最后一部分日志超出了文件允许的最大LSN
+  vector<LogEntry> entries(end_lsn + 10);
+  for (size_t i = 0; i < entries.size(); i++) {
+    vector<char> data(10 + i % 7, static_cast<char>(i));
+    ASSERT_EQ(RC::SUCCESS, entries[i].init(static_cast<LSN>(i + 1), LogModule::Id::BUFFER_POOL, std::move(data)));
+  }
+
+  vector<const LogEntry *> entry_ptrs;
+  for (const LogEntry &entry : entries) {
+    entry_ptrs.push_back(&entry);
+  }
+
+  int count = 0;
+  ASSERT_EQ(RC::LOG_FILE_FULL, writer.write_batch(entry_ptrs, count));
+  ASSERT_EQ(end_lsn, count);
+  ASSERT_TRUE(writer.full());
+  ASSERT_EQ(RC::SUCCESS, writer.sync());
+
+  // 写过的日志不能再写
+  ASSERT_EQ(RC::INVALID_ARGUMENT, writer.write_batch(span<const LogEntry *const>(entry_ptrs.data(), 1), count));
+  writer.close();
+
+  LogFileReader reader;
+  ASSERT_EQ(RC::SUCCESS, reader.open(log_file));
+
+  LSN  expect_lsn = 1;
+  auto callback   = [&expect_lsn](LogEntry &entry) -> RC {
+    EXPECT_EQ(expect_lsn, entry.lsn());
+    EXPECT_EQ(static_cast<int32_t>(10 + (expect_lsn - 1) % 7), entry.payload_size());
+    EXPECT_EQ(static_cast<char>(expect_lsn - 1), entry.data()[0]);
+    expect_lsn++;
+    return RC::SUCCESS;
+  };
+  ASSERT_EQ(RC::SUCCESS, reader.iterate(callback));
+  ASSERT_EQ(end_lsn + 1, expect_lsn);
+  reader.close();
+
+  filesystem::remove(log_file);
+}
+
+TEST(LogFileWriter, sync_policy)
+{
+  LogSyncPolicy policy = LogSyncPolicy::PER_BATCH;
+  ASSERT_EQ(RC::SUCCESS, log_sync_policy_from_string("PER-COMMIT", policy));
+  ASSERT_EQ(LogSyncPolicy::PER_COMMIT, policy);
+  ASSERT_EQ(RC::SUCCESS, log_sync_policy_from_string("none", policy));
+  ASSERT_EQ(LogSyncPolicy::NONE, policy);
+  ASSERT_NE(RC::SUCCESS, log_sync_policy_from_string("always", policy));
+
+  const char *log_file = "test_log_file_sync_policy.log";
+  for (LogSyncPolicy item :
+      {LogSyncPolicy::PER_COMMIT, LogSyncPolicy::PER_BATCH, LogSyncPolicy::PER_SECOND, LogSyncPolicy::NONE}) {
+    filesystem::remove(log_file);
+
+    LogFileWriter writer;
+    ASSERT_EQ(RC::SUCCESS, writer.open(log_file, 100, item));
+    ASSERT_EQ(item, writer.sync_policy());
+
+    vector<LogEntry>         entries(10);
+    vector<const LogEntry *> entry_ptrs;
+    for (size_t i = 0; i < entries.size(); i++) {
+      ASSERT_EQ(RC::SUCCESS, entries[i].init(static_cast<LSN>(i + 1), LogModule::Id::BUFFER_POOL, vector<char>(10)));
+      entry_ptrs.push_back(&entries[i]);
+    }
+
+    int count = 0;
+    ASSERT_EQ(RC::SUCCESS, writer.write_batch(entry_ptrs, count));
+    ASSERT_EQ(10, count);
+    ASSERT_EQ(RC::SUCCESS, writer.sync());
+    ASSERT_EQ(RC::SUCCESS, writer.close());
+
+    // 预分配的空间不能影响日志文件的大小
+    ASSERT_EQ(10 * (LogHeader::SIZE + 10), static_cast<int>(filesystem::file_size(log_file)));
+  }
+  filesystem::remove(log_file);
+}
+
 TEST(LogFileManager, get_lsn_from_filename)
 {
   const char *file_prefix = LogFileManager::file_prefix_;
@@ -390,6 +477,50 @@ TEST(LogFileManager, next_file)
   filesystem::remove_all(directory);
 }
 
+TEST(LogFileManager, remove_files_before)
+{
+  const char *directory                 = "remove_files_before";
+  const char *archive_directory         = "remove_files_before_archive";
+  int         max_entry_number_per_file = 1000;
+
+  filesystem::remove_all(directory);
+  filesystem::remove_all(archive_directory);
+  ASSERT_TRUE(filesystem::create_directory(directory));
+
+  LSN lsns[] = {0, 1000, 2000, 3000};
+  for (LSN lsn : lsns) {
+    string filename = string(LogFileManager::file_prefix_) + to_string(lsn) + LogFileManager::file_suffix_;
+    ofstream ofs(filesystem::path(directory) / filename);
+    ofs.close();
+  }
+
+  LogFileManager manager;
+  ASSERT_EQ(RC::SUCCESS, manager.init(directory, max_entry_number_per_file));
+
+  // 检查点在文件中间，这个文件要保留
+  ASSERT_EQ(RC::SUCCESS, manager.remove_files_before(1500));
+  vector<string> files;
+  ASSERT_EQ(RC::SUCCESS, manager.list_files(files, 0));
+  ASSERT_EQ(3, files.size());
+  ASSERT_FALSE(filesystem::exists(filesystem::path(directory) / "clog_0.log"));
+
+  // 归档而不是删除
+  manager.set_archive_directory(archive_directory);
+  ASSERT_EQ(RC::SUCCESS, manager.remove_files_before(2000));
+  ASSERT_EQ(RC::SUCCESS, manager.list_files(files, 0));
+  ASSERT_EQ(2, files.size());
+  ASSERT_TRUE(filesystem::exists(filesystem::path(archive_directory) / "clog_1000.log"));
+
+  // 最后一个文件正在写入，不会删除
+  ASSERT_EQ(RC::SUCCESS, manager.remove_files_before(100000));
+  ASSERT_EQ(RC::SUCCESS, manager.list_files(files, 0));
+  ASSERT_EQ(1, files.size());
+  ASSERT_TRUE(filesystem::exists(filesystem::path(directory) / "clog_3000.log"));
+
+  filesystem::remove_all(directory);
+  filesystem::remove_all(archive_directory);
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
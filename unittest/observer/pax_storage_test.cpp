@@ -22,6 +22,8 @@ See the Mulan PSL v2 for more details. */
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/record/record_manager.h"
 #include "storage/trx/vacuous_trx.h"
+#include "storage/trx/mvcc_trx.h"
+#include "sql/expr/expression.h"
 #include "storage/clog/vacuous_log_handler.h"
 #include "storage/clog/disk_log_handler.h"
 #include "storage/buffer/double_write_buffer.h"
@@ -36,7 +38,7 @@ using namespace common;
 class PaxRecordFileScannerWithParam : public testing::TestWithParam<int>
 {};
 
-TEST_P(PaxRecordFileScannerWithParam, DISABLED_test_file_iterator)
+TEST_P(PaxRecordFileScannerWithParam, test_file_iterator)
 {
   int               record_insert_num = GetParam();
   VacuousLogHandler log_handler;
@@ -88,7 +90,7 @@ TEST_P(PaxRecordFileScannerWithParam, DISABLED_test_file_iterator)
   ASSERT_EQ(count, 0);
 
   // chunk iterator
-  rc = chunk_scanner.open_scan_chunk(&table, *bp, log_handler, ReadWriteMode::READ_ONLY);
+  rc = chunk_scanner.open_scan_chunk(&table, *bp, &trx, log_handler, ReadWriteMode::READ_ONLY);
   ASSERT_EQ(rc, RC::SUCCESS);
   Chunk     chunk;
   FieldMeta fm;
@@ -127,7 +129,7 @@ TEST_P(PaxRecordFileScannerWithParam, DISABLED_test_file_iterator)
   ASSERT_EQ(count, rids.size());
 
   // chunk iterator
-  rc = chunk_scanner.open_scan_chunk(&table, *bp, log_handler, ReadWriteMode::READ_ONLY);
+  rc = chunk_scanner.open_scan_chunk(&table, *bp, &trx, log_handler, ReadWriteMode::READ_ONLY);
   ASSERT_EQ(rc, RC::SUCCESS);
   chunk.reset_data();
   count = 0;
@@ -158,7 +160,7 @@ TEST_P(PaxRecordFileScannerWithParam, DISABLED_test_file_iterator)
   ASSERT_EQ(count, rids.size() / 2);
 
   // chunk iterator
-  rc = chunk_scanner.open_scan_chunk(&table, *bp, log_handler, ReadWriteMode::READ_ONLY);
+  rc = chunk_scanner.open_scan_chunk(&table, *bp, &trx, log_handler, ReadWriteMode::READ_ONLY);
   ASSERT_EQ(rc, RC::SUCCESS);
   chunk.reset_data();
   count = 0;
@@ -176,7 +178,7 @@ TEST_P(PaxRecordFileScannerWithParam, DISABLED_test_file_iterator)
 class PaxPageHandlerTestWithParam : public testing::TestWithParam<int>
 {};
 
-TEST_P(PaxPageHandlerTestWithParam, DISABLED_PaxPageHandler)
+TEST_P(PaxPageHandlerTestWithParam, PaxPageHandler)
 {
   int               record_num = GetParam();
   VacuousLogHandler log_handler;
@@ -340,6 +342,129 @@ TEST_P(PaxPageHandlerTestWithParam, DISABLED_PaxPageHandler)
   delete bpm;
 }
 
+TEST(PaxChunkScanner, mvcc_and_predicates)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "record_manager.bp";
+  filesystem::remove(record_manager_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  RC              rc = bpm->create_file(record_manager_file);
+  ASSERT_EQ(rc, RC::SUCCESS);
+
+  rc = bpm->open_file(log_handler, record_manager_file, bp);
+  ASSERT_EQ(rc, RC::SUCCESS);
+
+  // | __trx_xid_begin | __trx_xid_end | c0 | c1 |
+  Table      table;
+  TableMeta &table_meta             = table.table_meta_;
+  table_meta.storage_format_        = StorageFormat::PAX_FORMAT;
+  MvccTrxKit trx_kit;
+  ASSERT_EQ(RC::SUCCESS, trx_kit.init());
+  table_meta.trx_fields_ = *trx_kit.trx_fields();
+  table_meta.fields_     = *trx_kit.trx_fields();
+  table_meta.fields_.emplace_back("c0", AttrType::INTS, 8, 4, true, 0, false);
+  table_meta.fields_.emplace_back("c1", AttrType::INTS, 12, 4, true, 1, false);
+
+  RecordFileHandler file_handler(StorageFormat::PAX_FORMAT);
+  rc = file_handler.init(*bp, log_handler, &table_meta);
+  ASSERT_EQ(rc, RC::SUCCESS);
+
+  const int32_t trx_id     = 5;
+  const int     record_num = 3000;
+  vector<RID>   rids;
+  for (int i = 0; i < record_num; i++) {
+    int32_t data[4] = {1, numeric_limits<int32_t>::max(), i, i * 10};  // committed
+    switch (i % 4) {
+      case 1: data[0] = -7; break;               // inserted by another trx, not committed
+      case 2: data[1] = 3; break;                // deleted before current trx
+      case 3: data[0] = -trx_id; break;          // inserted by current trx
+      default: break;
+    }
+    RID rid;
+    rc = file_handler.insert_record(reinterpret_cast<const char *>(data), sizeof(data), &rid);
+    ASSERT_EQ(rc, RC::SUCCESS);
+    rids.push_back(rid);
+  }
+  for (int i = 9; i < record_num; i += 10) {
+    ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[i]));
+  }
+
+  auto visible = [](int i) { return (i % 4 == 0 || i % 4 == 3) && i % 10 != 9; };
+
+  MvccTrx          trx(trx_kit, log_handler, trx_id);
+  ChunkFileScanner chunk_scanner;
+  Chunk            chunk;
+  chunk.add_column(make_unique<Column>(*table_meta.field(2), 10), 0);
+  chunk.add_column(make_unique<Column>(*table_meta.field(3), 10), 1);
+
+  // visibility only
+  rc = chunk_scanner.open_scan_chunk(&table, *bp, &trx, log_handler, ReadWriteMode::READ_ONLY);
+  ASSERT_EQ(rc, RC::SUCCESS);
+  int count = 0;
+  while (OB_SUCC(rc = chunk_scanner.next_chunk(chunk))) {
+    for (int i = 0; i < chunk.rows(); i++) {
+      int c0 = chunk.get_value(0, i).get_int();
+      ASSERT_TRUE(visible(c0));
+      ASSERT_EQ(c0 * 10, chunk.get_value(1, i).get_int());
+    }
+    count += chunk.rows();
+  }
+  ASSERT_EQ(rc, RC::RECORD_EOF);
+  chunk_scanner.close_scan();
+
+  int expected = 0;
+  for (int i = 0; i < record_num; i++) {
+    expected += visible(i) ? 1 : 0;
+  }
+  ASSERT_EQ(count, expected);
+
+  // visibility and predicates: c0 >= 1000 and c0 < 2000
+  ComparisonExpr       ge(CompOp::GREAT_EQUAL,
+      make_unique<FieldExpr>(&table, table_meta.field(2)),
+      make_unique<ValueExpr>(Value(1000)));
+  ComparisonExpr       lt(CompOp::LESS_THAN,
+      make_unique<FieldExpr>(&table, table_meta.field(2)),
+      make_unique<ValueExpr>(Value(2000)));
+  vector<Expression *> predicates{&ge, &lt};
+  rc = chunk_scanner.open_scan_chunk(&table, *bp, &trx, log_handler, ReadWriteMode::READ_ONLY, predicates);
+  ASSERT_EQ(rc, RC::SUCCESS);
+  count = 0;
+  while (OB_SUCC(rc = chunk_scanner.next_chunk(chunk))) {
+    for (int i = 0; i < chunk.rows(); i++) {
+      int c0 = chunk.get_value(0, i).get_int();
+      ASSERT_TRUE(visible(c0) && c0 >= 1000 && c0 < 2000);
+    }
+    count += chunk.rows();
+  }
+  ASSERT_EQ(rc, RC::RECORD_EOF);
+  chunk_scanner.close_scan();
+
+  expected = 0;
+  for (int i = 1000; i < 2000; i++) {
+    expected += visible(i) ? 1 : 0;
+  }
+  ASSERT_EQ(count, expected);
+
+  // a record being deleted by another trx conflicts with read-write scan
+  int32_t data[4] = {1, -7, record_num, record_num * 10};
+  RID     rid;
+  ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(reinterpret_cast<const char *>(data), sizeof(data), &rid));
+  rc = chunk_scanner.open_scan_chunk(&table, *bp, &trx, log_handler, ReadWriteMode::READ_WRITE);
+  ASSERT_EQ(rc, RC::SUCCESS);
+  while (OB_SUCC(rc = chunk_scanner.next_chunk(chunk))) {
+  }
+  ASSERT_EQ(rc, RC::LOCKED_CONCURRENCY_CONFLICT);
+  chunk_scanner.close_scan();
+
+  file_handler.close();
+  bpm->close_file(record_manager_file);
+  delete bpm;
+}
+
 INSTANTIATE_TEST_SUITE_P(PaxFileScannerTests, PaxRecordFileScannerWithParam, testing::Values(1, 10, 100, 1000, 2000, 10000));
 
 INSTANTIATE_TEST_SUITE_P(PaxPageTests, PaxPageHandlerTestWithParam, testing::Values(1, 10, 100, 337));
@@ -204,15 +204,15 @@ TEST(RecordFileScanner, test_record_file_iterator)
   delete bpm;
 }
 
-TEST(RecordManager, durability)
+/*
+ * 测试场景：
+ * 1. 创建一个文件，插入一些记录
+ * 2. 随机进行插入、更新、删除操作
+ * 3. 重启数据库，使用指定数量的线程回放日志，检查记录是否恢复
+ */
+static void test_durability(const char *directory_name, int replay_worker_num)
 {
-  /*
-   * 测试场景：
-   * 1. 创建一个文件，插入一些记录
-   * 2. 随机进行插入、更新、删除操作
-   * 3. 重启数据库，检查记录是否恢复
-   */
-  filesystem::path directory("record_manager_durability");
+  filesystem::path directory(directory_name);
   filesystem::remove_all(directory);
   ASSERT_TRUE(filesystem::create_directories(directory));
 
@@ -338,8 +338,10 @@ TEST(RecordManager, durability)
   ASSERT_NE(buffer_pool2, nullptr);
 
   IntegratedLogReplayer log_replayer2(bpm2);
+  ASSERT_EQ(log_replayer2.set_worker_num(replay_worker_num), RC::SUCCESS);
   ASSERT_EQ(log_handler2.init(directory.c_str()), RC::SUCCESS);
   ASSERT_EQ(log_handler2.replay(log_replayer2, 0), RC::SUCCESS);
+  ASSERT_EQ(log_replayer2.on_done(), RC::SUCCESS);
   ASSERT_EQ(log_handler2.start(), RC::SUCCESS);
 
   RecordFileHandler record_file_handler2(StorageFormat::ROW_FORMAT);
@@ -355,6 +357,10 @@ TEST(RecordManager, durability)
   bpm2.close_file(record_manager_file.c_str());
 }
 
+TEST(RecordManager, durability) { test_durability("record_manager_durability", 1); }
+
+TEST(RecordManager, durability_parallel_replay) { test_durability("record_manager_durability_parallel", 4); }
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);